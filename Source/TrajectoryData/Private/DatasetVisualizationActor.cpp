@@ -2,6 +2,7 @@
 
 #include "DatasetVisualizationActor.h"
 #include "TrajectoryDataLoader.h"
+#include "NiagaraDataInterfaceTrajectoryBuffer.h"
 #include "NiagaraDataInterfaceArrayFunctionLibrary.h"
 #include "NiagaraComponent.h"
 #include "NiagaraSystem.h"
@@ -9,7 +10,9 @@
 
 ADatasetVisualizationActor::ADatasetVisualizationActor()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	// Ticks only while budgeted population is in progress
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Create root scene component
 	USceneComponent* SceneRoot = CreateDefaultSubobject<USceneComponent>(TEXT("SceneRoot"));
@@ -46,12 +49,27 @@ void ADatasetVisualizationActor::EndPlay(const EEndPlayReason::Type EndPlayReaso
 		NiagaraComponent->Deactivate();
 	}
 
+	CancelBudgetedPopulation();
 	bBuffersBound = false;
 	CurrentDatasetIndex = -1;
 
 	Super::EndPlay(EndPlayReason);
 }
 
+void ADatasetVisualizationActor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (PopulationStage == EPopulationStage::Idle)
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	StepBudgetedPopulation(FPlatformTime::Seconds() + PopulationBudgetMs / 1000.0);
+	OnPopulationProgress.Broadcast(GetPopulationProgress());
+}
+
 bool ADatasetVisualizationActor::LoadAndBindDataset(int32 DatasetIndex)
 {
 	if (!BufferProvider)
@@ -67,40 +85,18 @@ bool ADatasetVisualizationActor::LoadAndBindDataset(int32 DatasetIndex)
 	}
 
 	// Load data into buffer
+	BufferProvider->bGenerateSampleTimeSteps = bTransferSampleTimeSteps;
 	if (!BufferProvider->UpdateFromDataset(DatasetIndex))
 	{
 		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: Failed to load dataset %d"), DatasetIndex);
 		return false;
 	}
 
-	// Populate the Position Array NDI with position data
-	if (!PopulatePositionArrayNDI())
+	if (!BindProviderDataToNiagara())
 	{
-		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: Failed to populate Position Array NDI"));
 		return false;
 	}
 
-	// Populate TrajectoryInfo arrays if enabled
-	if (bTransferTrajectoryInfo)
-	{
-		if (!PopulateTrajectoryInfoArrays())
-		{
-			UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate TrajectoryInfo arrays (non-critical)"));
-		}
-	}
-
-	// Populate SampleTimeSteps array
-	if (!PopulateSampleTimeStepsArray())
-	{
-		UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate SampleTimeSteps array (non-critical)"));
-	}
-
-	// Pass metadata parameters
-	if (!PassMetadataToNiagara())
-	{
-		UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to pass metadata to Niagara (non-critical)"));
-	}
-
 	// Activate Niagara if requested
 	if (bAutoActivate && !NiagaraComponent->IsActive())
 	{
@@ -133,6 +129,7 @@ void ADatasetVisualizationActor::LoadAndBindDatasetAsync(int32 DatasetIndex, TFu
 	TWeakObjectPtr<ADatasetVisualizationActor> WeakThis(this);
 
 	// UpdateFromDatasetAsync packs data on a background thread and calls back on the game thread
+	BufferProvider->bGenerateSampleTimeSteps = bTransferSampleTimeSteps;
 	BufferProvider->UpdateFromDatasetAsync(DatasetIndex,
 		[WeakThis, DatasetIndex, OnComplete](bool bUpdateSuccess)
 		{
@@ -152,35 +149,12 @@ void ADatasetVisualizationActor::LoadAndBindDatasetAsync(int32 DatasetIndex, TFu
 
 			ADatasetVisualizationActor* This = WeakThis.Get();
 
-			// Populate the Position Array NDI with position data
-			if (!This->PopulatePositionArrayNDI())
+			if (!This->BindProviderDataToNiagara())
 			{
-				UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: Failed to populate Position Array NDI"));
 				OnComplete(false);
 				return;
 			}
 
-			// Populate TrajectoryInfo arrays if enabled
-			if (This->bTransferTrajectoryInfo)
-			{
-				if (!This->PopulateTrajectoryInfoArrays())
-				{
-					UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate TrajectoryInfo arrays (non-critical)"));
-				}
-			}
-
-			// Populate SampleTimeSteps array
-			if (!This->PopulateSampleTimeStepsArray())
-			{
-				UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate SampleTimeSteps array (non-critical)"));
-			}
-
-			// Pass metadata parameters
-			if (!This->PassMetadataToNiagara())
-			{
-				UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to pass metadata to Niagara (non-critical)"));
-			}
-
 			// Activate Niagara if requested
 			if (This->bAutoActivate && !This->NiagaraComponent->IsActive())
 			{
@@ -198,27 +172,61 @@ void ADatasetVisualizationActor::LoadAndBindDatasetAsync(int32 DatasetIndex, TFu
 
 bool ADatasetVisualizationActor::SwitchToDataset(int32 DatasetIndex)
 {
-	// Deactivate current visualization
-	if (NiagaraComponent && NiagaraComponent->IsActive())
+	// Nothing on screen yet - nothing to keep visible while loading
+	if (!bBuffersBound)
 	{
-		NiagaraComponent->Deactivate();
+		return LoadAndBindDataset(DatasetIndex);
 	}
 
-	// Load new dataset
-	bool bSuccess = LoadAndBindDataset(DatasetIndex);
-
-	// Reactivate if requested
-	if (bSuccess && bAutoActivate)
+	if (!BufferProvider || !NiagaraComponent)
 	{
-		NiagaraComponent->Activate(true);
+		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: BufferProvider or NiagaraComponent is null"));
+		return false;
 	}
 
-	return bSuccess;
+	// The current dataset stays bound and rendering while the provider builds the new buffers in its back buffer
+	TWeakObjectPtr<ADatasetVisualizationActor> WeakThis(this);
+	TSharedRef<bool> bFailed = MakeShared<bool>(false);
+
+	BufferProvider->bGenerateSampleTimeSteps = bTransferSampleTimeSteps;
+	BufferProvider->UpdateFromDatasetDoubleBuffered(DatasetIndex,
+		[WeakThis, DatasetIndex, bFailed](bool bSwapped)
+		{
+			// Runs on game thread, at the frame boundary where the provider swapped its buffers
+			if (!bSwapped)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Switch to dataset %d failed or was superseded"), DatasetIndex);
+				*bFailed = true;
+				return;
+			}
+
+			if (!WeakThis.IsValid())
+			{
+				return;
+			}
+
+			// Populating the arrays in one call would convert and copy every sample in this frame, which is the
+			// hitch the double-buffered switch exists to avoid
+			ADatasetVisualizationActor* This = WeakThis.Get();
+			This->bBuffersBound = This->BindProviderDataToNiagara(true);
+			This->CurrentDatasetIndex = This->bBuffersBound ? DatasetIndex : -1;
+
+			UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Switched to dataset %d"), DatasetIndex);
+		});
+
+	// Set already if the provider rejected the request right away
+	return !*bFailed;
+}
+
+bool ADatasetVisualizationActor::IsDatasetSwitchPending() const
+{
+	return BufferProvider && BufferProvider->IsSwapPending();
 }
 
 bool ADatasetVisualizationActor::IsVisualizationReady() const
 {
 	return bBuffersBound && 
+	       !IsPopulating() &&
 	       BufferProvider && 
 	       BufferProvider->IsBufferValid() && 
 	       NiagaraComponent != nullptr;
@@ -267,6 +275,99 @@ void ADatasetVisualizationActor::SetVisualizationActive(bool bActivate)
 	}
 }
 
+float ADatasetVisualizationActor::GetPopulationProgress() const
+{
+	if (PopulationStage == EPopulationStage::Idle)
+	{
+		return 1.0f;
+	}
+
+	// Conversion dominates; each of the four transfers counts as one more chunk of work
+	const double TotalWork = (double)NumPopulationPositions + NumPopulationTrajectories + 4.0 * PopulationChunkSize;
+	const double DoneWork = (double)NumConvertedPositions + NumConvertedTrajectories + (double)NumPopulationTransfers * PopulationChunkSize;
+	return FMath::Clamp(static_cast<float>(DoneWork / TotalWork), 0.0f, 0.99f);
+}
+
+bool ADatasetVisualizationActor::BindProviderDataToNiagara(bool bForceBudgeted)
+{
+	if (bUseTrajectoryBufferInterface)
+	{
+		CancelBudgetedPopulation();
+		return BindTrajectoryBufferInterface();
+	}
+
+	if (bBudgetedPopulation || bForceBudgeted)
+	{
+		return StartBudgetedPopulation();
+	}
+	CancelBudgetedPopulation();
+
+	// Populate the Position Array NDI with position data
+	if (!PopulatePositionArrayNDI())
+	{
+		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: Failed to populate Position Array NDI"));
+		return false;
+	}
+
+	// Populate TrajectoryInfo arrays if enabled
+	if (bTransferTrajectoryInfo)
+	{
+		if (!PopulateTrajectoryInfoArrays())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate TrajectoryInfo arrays (non-critical)"));
+		}
+	}
+
+	// Populate SampleTimeSteps array if requested (time steps otherwise follow from the trajectory info)
+	if (bTransferSampleTimeSteps && !PopulateSampleTimeStepsArray())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate SampleTimeSteps array (non-critical)"));
+	}
+
+	// Pass metadata parameters
+	if (!PassMetadataToNiagara())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to pass metadata to Niagara (non-critical)"));
+	}
+
+	return true;
+}
+
+bool ADatasetVisualizationActor::BindTrajectoryBufferInterface()
+{
+	if (!BufferProvider || !NiagaraComponent || !BufferProvider->IsBufferValid())
+	{
+		return false;
+	}
+
+	// The NDI reads a single position buffer; paged (over MaxSingleBufferBytes) and ring-buffer resources would render nothing
+	const FTrajectoryPositionBufferResource* Resource = BufferProvider->GetPositionBufferResource();
+	if (Resource->IsPaged() || Resource->IsRingLayout())
+	{
+		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: bUseTrajectoryBufferInterface requires a single position buffer, but the provider's %lld samples are %s; use the Position Array path for this dataset"),
+			BufferProvider->GetMetadata().TotalSampleCount,
+			Resource->IsRingLayout() ? TEXT("in a ring buffer") : *FString::Printf(TEXT("split into %d pages"), Resource->GetPageTable().Num()));
+		return false;
+	}
+
+	// The NDI picks up this provider's current (and any later) data on its next tick
+	if (!UNiagaraDataInterfaceTrajectoryBuffer::SetNiagaraTrajectoryBufferProvider(NiagaraComponent, TrajectoryBufferParameterName, BufferProvider))
+	{
+		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: Niagara system has no '%s' User Parameter of type Trajectory Buffer"),
+			*TrajectoryBufferParameterName.ToString());
+		return false;
+	}
+
+	if (!PassMetadataToNiagara())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to pass metadata to Niagara (non-critical)"));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Bound Trajectory Buffer NDI to the provider's GPU buffer (%lld samples, no copy)"),
+		BufferProvider->GetMetadata().TotalSampleCount);
+	return true;
+}
+
 bool ADatasetVisualizationActor::PopulatePositionArrayNDI()
 {
 	// NOTE: This function runs on the GAME THREAD
@@ -286,7 +387,7 @@ bool ADatasetVisualizationActor::PopulatePositionArrayNDI()
 
 	// Get all positions from buffer provider as a flat array (const reference - no copy!)
 	FTrajectoryBufferMetadata Metadata = BufferProvider->GetMetadata();
-	const TArray<FVector3f>& AllPositions3f = BufferProvider->GetAllPositionsRef();
+	TConstArrayView<FVector3f> AllPositions3f = BufferProvider->GetAllPositionsRef();
 	
 	if (AllPositions3f.Num() == 0)
 	{
@@ -294,31 +395,41 @@ bool ADatasetVisualizationActor::PopulatePositionArrayNDI()
 		return false;
 	}
 
-	// GAME THREAD: Convert FVector3f to FVector for Niagara API
-	// Using ParallelFor to avoid frame drop for large datasets
+	// GAME THREAD: Convert FVector3f to FVector for Niagara API, all at once
+	PendingPositions.SetNumUninitialized(AllPositions3f.Num());
+	ConvertPositions(AllPositions3f, 0, AllPositions3f.Num());
+	TransferPositions();
+
+	return true;
+}
+
+void ADatasetVisualizationActor::ConvertPositions(TConstArrayView<FVector3f> Positions, int32 First, int32 Last)
+{
 	// Note: Niagara's SetNiagaraArrayPosition expects TArray<FVector> (double precision)
 	// even though internally it may use float precision
-	TArray<FVector> AllPositions;
-	AllPositions.SetNumUninitialized(AllPositions3f.Num());
-	
 	// Use parallel processing to convert millions of positions without stalling the frame
-	// This distributes the work across multiple threads
-	ParallelFor(AllPositions3f.Num(), [&AllPositions, &AllPositions3f](int32 Index)
+	ParallelFor(Last - First, [this, Positions, First](int32 Offset)
 	{
-		AllPositions[Index] = FVector(AllPositions3f[Index]);
+		PendingPositions[First + Offset] = FVector(Positions[First + Offset]);
 	});
+}
 
+void ADatasetVisualizationActor::TransferPositions()
+{
 	// GAME THREAD: Transfer to Niagara
 	// SetNiagaraArrayPosition runs on the game thread and handles internal Niagara updates
 	// This automatically finds or creates the Float3 Array NDI and populates it
 	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayPosition(
 		NiagaraComponent, 
 		PositionArrayParameterName, 
-		AllPositions
+		PendingPositions
 	);
 
 	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Successfully populated Position Array NDI with %d positions"), 
-	       AllPositions.Num());
+	       PendingPositions.Num());
+
+	// Niagara holds its own copy now
+	PendingPositions.Empty();
 
 	// Release CPU position data from BufferProvider to save memory
 	// The data has been transferred to Niagara, so we don't need the CPU copy anymore
@@ -326,8 +437,6 @@ bool ADatasetVisualizationActor::PopulatePositionArrayNDI()
 	{
 		BufferProvider->ReleaseCPUPositionData();
 	}
-
-	return true;
 }
 
 bool ADatasetVisualizationActor::PopulateTrajectoryInfoArrays()
@@ -350,26 +459,34 @@ bool ADatasetVisualizationActor::PopulateTrajectoryInfoArrays()
 	}
 
 	// GAME THREAD: Prepare arrays for each field
-	// Using SetNumUninitialized and ParallelFor to avoid frame drops
-	TArray<int32> TrajectoryId;
-	TArray<int32> StartIndex;
-	TArray<FVector> Extent;  // Using FVector for Niagara compatibility
-
-	// Pre-allocate arrays
 	const int32 NumTrajectories = TrajectoryInfo.Num();
-	TrajectoryId.SetNumUninitialized(NumTrajectories);
-	StartIndex.SetNumUninitialized(NumTrajectories);
-	Extent.SetNumUninitialized(NumTrajectories);
+	PendingTrajectoryIds.SetNumUninitialized(NumTrajectories);
+	PendingStartIndices.SetNumUninitialized(NumTrajectories);
+	PendingFirstSampleTimeSteps.SetNumUninitialized(NumTrajectories);
+	PendingExtents.SetNumUninitialized(NumTrajectories);
+
+	ConvertTrajectoryInfo(TrajectoryInfo, 0, NumTrajectories);
+	TransferTrajectoryInfo();
+
+	return true;
+}
 
+void ADatasetVisualizationActor::ConvertTrajectoryInfo(TConstArrayView<FTrajectoryBufferInfo> TrajectoryInfo, int32 First, int32 Last)
+{
 	// Pack data into arrays using parallel processing
-	ParallelFor(NumTrajectories, [&](int32 Index)
+	ParallelFor(Last - First, [this, TrajectoryInfo, First](int32 Offset)
 	{
+		const int32 Index = First + Offset;
 		const FTrajectoryBufferInfo& Info = TrajectoryInfo[Index];
-		TrajectoryId[Index] = Info.TrajectoryId;
-		StartIndex[Index] = Info.StartIndex;
-		Extent[Index] = FVector(Info.Extent);  // Convert FVector3f to FVector
+		PendingTrajectoryIds[Index] = Info.TrajectoryId;
+		PendingStartIndices[Index] = static_cast<int32>(Info.StartIndex);  // Position arrays bound to Niagara are int32-indexed
+		PendingFirstSampleTimeSteps[Index] = Info.GetSampleTimeStep(0);
+		PendingExtents[Index] = FVector(Info.Extent);  // Convert FVector3f to FVector for Niagara compatibility
 	});
+}
 
+void ADatasetVisualizationActor::TransferTrajectoryInfo()
+{
 	// GAME THREAD: Transfer arrays to Niagara
 	// SetNiagaraArray* functions run on the game thread
 	FString Prefix = TrajectoryInfoParameterPrefix.ToString();
@@ -377,27 +494,209 @@ bool ADatasetVisualizationActor::PopulateTrajectoryInfoArrays()
 	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayInt32(
 		NiagaraComponent, 
 		FName(*(Prefix + "StartIndex")), 
-		StartIndex
+		PendingStartIndices
 	);
 	
 	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayInt32(
 		NiagaraComponent, 
 		FName(*(Prefix + "TrajectoryId")), 
-		TrajectoryId
+		PendingTrajectoryIds
+	);
+	
+	// Compact time encoding: 4 bytes per trajectory instead of 4 bytes per sample
+	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayInt32(
+		NiagaraComponent, 
+		FName(*(Prefix + "FirstSampleTimeStep")), 
+		PendingFirstSampleTimeSteps
 	);
 	
 	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayPosition(
 		NiagaraComponent, 
 		FName(*(Prefix + "Extent")), 
-		Extent
+		PendingExtents
 	);
 
 	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Successfully populated TrajectoryInfo arrays with %d trajectories"), 
-	       NumTrajectories);
+	       PendingStartIndices.Num());
+
+	PendingTrajectoryIds.Empty();
+	PendingStartIndices.Empty();
+	PendingFirstSampleTimeSteps.Empty();
+	PendingExtents.Empty();
+}
+
+bool ADatasetVisualizationActor::StartBudgetedPopulation()
+{
+	CancelBudgetedPopulation();
+
+	if (!BufferProvider || !NiagaraComponent)
+	{
+		return false;
+	}
+
+	if (!BufferProvider->IsBufferValid() || BufferProvider->GetAllPositionsRef().Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("DatasetVisualizationActor: No positions available"));
+		return false;
+	}
 
+	// Allocate everything up front (the full double-precision position array too, since it is handed to Niagara in
+	// one call); the per-frame steps only convert and transfer
+	NumPopulationPositions = BufferProvider->GetAllPositionsRef().Num();
+	NumPopulationTrajectories = bTransferTrajectoryInfo ? BufferProvider->GetTrajectoryInfoRef().Num() : 0;
+	PendingPositions.SetNumUninitialized(NumPopulationPositions);
+	PendingTrajectoryIds.SetNumUninitialized(NumPopulationTrajectories);
+	PendingStartIndices.SetNumUninitialized(NumPopulationTrajectories);
+	PendingFirstSampleTimeSteps.SetNumUninitialized(NumPopulationTrajectories);
+	PendingExtents.SetNumUninitialized(NumPopulationTrajectories);
+
+	PopulationStage = EPopulationStage::ConvertPositions;
+	SetActorTickEnabled(true);
+
+	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Populating %d positions over several frames (%.1f ms per frame)"),
+		NumPopulationPositions, PopulationBudgetMs);
 	return true;
 }
 
+void ADatasetVisualizationActor::StepBudgetedPopulation(double Deadline)
+{
+	if (!BufferProvider || !NiagaraComponent)
+	{
+		CancelBudgetedPopulation();
+		return;
+	}
+
+	switch (PopulationStage)
+	{
+	case EPopulationStage::ConvertPositions:
+	{
+		// The provider's CPU positions must stay the ones population started with
+		TConstArrayView<FVector3f> Positions = BufferProvider->GetAllPositionsRef();
+		if (Positions.Num() != NumPopulationPositions)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Provider positions changed during population, stopping"));
+			CancelBudgetedPopulation();
+			return;
+		}
+
+		// At least one chunk per frame so population always advances
+		do
+		{
+			const int32 Last = FMath::Min(NumConvertedPositions + PopulationChunkSize, NumPopulationPositions);
+			ConvertPositions(Positions, NumConvertedPositions, Last);
+			NumConvertedPositions = Last;
+		}
+		while (NumConvertedPositions < NumPopulationPositions && FPlatformTime::Seconds() < Deadline);
+
+		if (NumConvertedPositions == NumPopulationPositions)
+		{
+			PopulationStage = EPopulationStage::TransferPositions;
+		}
+		break;
+	}
+
+	case EPopulationStage::TransferPositions:
+		// From here until the last transfer the arrays hold a mix of old and new data (e.g. during a dataset switch),
+		// so the simulation is held until all of them are set
+		if (!NiagaraComponent->IsPaused())
+		{
+			NiagaraComponent->SetPaused(true);
+			bPausedForPopulation = true;
+		}
+
+		// Not budgeted: the Niagara array library has no ranged setter, so the whole array is copied in this one call
+		// (the frame does nothing else)
+		TransferPositions();
+		++NumPopulationTransfers;
+		PopulationStage = EPopulationStage::ConvertTrajectoryInfo;
+		break;
+
+	case EPopulationStage::ConvertTrajectoryInfo:
+	{
+		TConstArrayView<FTrajectoryBufferInfo> TrajectoryInfo = BufferProvider->GetTrajectoryInfoRef();
+		if (NumPopulationTrajectories == 0 || TrajectoryInfo.Num() != NumPopulationTrajectories)
+		{
+			if (bTransferTrajectoryInfo)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: No matching trajectory info available, skipping TrajectoryInfo arrays"));
+			}
+			PopulationStage = EPopulationStage::TransferSampleTimeSteps;
+			++NumPopulationTransfers;
+			break;
+		}
+
+		while (NumConvertedTrajectories < NumPopulationTrajectories)
+		{
+			const int32 Last = FMath::Min(NumConvertedTrajectories + PopulationChunkSize, NumPopulationTrajectories);
+			ConvertTrajectoryInfo(TrajectoryInfo, NumConvertedTrajectories, Last);
+			NumConvertedTrajectories = Last;
+			if (FPlatformTime::Seconds() >= Deadline)
+			{
+				break;
+			}
+		}
+
+		if (NumConvertedTrajectories == NumPopulationTrajectories)
+		{
+			PopulationStage = EPopulationStage::TransferTrajectoryInfo;
+		}
+		break;
+	}
+
+	case EPopulationStage::TransferTrajectoryInfo:
+		TransferTrajectoryInfo();
+		++NumPopulationTransfers;
+		PopulationStage = EPopulationStage::TransferSampleTimeSteps;
+		break;
+
+	case EPopulationStage::TransferSampleTimeSteps:
+		if (bTransferSampleTimeSteps && !PopulateSampleTimeStepsArray())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to populate SampleTimeSteps array (non-critical)"));
+		}
+		++NumPopulationTransfers;
+		PopulationStage = EPopulationStage::TransferMetadata;
+		break;
+
+	case EPopulationStage::TransferMetadata:
+		if (!PassMetadataToNiagara())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DatasetVisualizationActor: Failed to pass metadata to Niagara (non-critical)"));
+		}
+		CancelBudgetedPopulation();
+		UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Budgeted population complete"));
+		break;
+
+	default:
+		break;
+	}
+}
+
+void ADatasetVisualizationActor::CancelBudgetedPopulation()
+{
+	PopulationStage = EPopulationStage::Idle;
+	NumPopulationPositions = 0;
+	NumPopulationTrajectories = 0;
+	NumConvertedPositions = 0;
+	NumConvertedTrajectories = 0;
+	NumPopulationTransfers = 0;
+
+	if (bPausedForPopulation)
+	{
+		if (NiagaraComponent)
+		{
+			NiagaraComponent->SetPaused(false);
+		}
+		bPausedForPopulation = false;
+	}
+
+	PendingPositions.Empty();
+	PendingTrajectoryIds.Empty();
+	PendingStartIndices.Empty();
+	PendingFirstSampleTimeSteps.Empty();
+	PendingExtents.Empty();
+}
+
 bool ADatasetVisualizationActor::PopulateSampleTimeStepsArray()
 {
 	// NOTE: This function runs on the GAME THREAD
@@ -425,18 +724,8 @@ bool ADatasetVisualizationActor::PopulateSampleTimeStepsArray()
 		SampleTimeSteps
 	);
 
-	// Get global time step range from metadata (already computed during dataset loading)
-	// This avoids iterating through 20M time steps on the game thread
-	FTrajectoryBufferMetadata Metadata = BufferProvider->GetMetadata();
-	int32 GlobalFirstTimeStep = Metadata.FirstTimeStep;
-	int32 GlobalLastTimeStep = Metadata.LastTimeStep;
-
-	// Transfer global time step range to Niagara as int parameters
-	NiagaraComponent->SetIntParameter(TEXT("GlobalFirstTimeStep"), GlobalFirstTimeStep);
-	NiagaraComponent->SetIntParameter(TEXT("GlobalLastTimeStep"), GlobalLastTimeStep);
-
-	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Successfully populated SampleTimeSteps array with %d entries (time range: %d to %d)"), 
-	       SampleTimeSteps.Num(), GlobalFirstTimeStep, GlobalLastTimeStep);
+	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Successfully populated SampleTimeSteps array with %d entries"), 
+	       SampleTimeSteps.Num());
 
 	return true;
 }
@@ -454,15 +743,21 @@ bool ADatasetVisualizationActor::PassMetadataToNiagara()
 	// Pass int parameters
 	NiagaraComponent->SetIntParameter(TEXT("NumTrajectories"), Metadata.NumTrajectories);
 	NiagaraComponent->SetIntParameter(TEXT("MaxSamplesPerTrajectory"), Metadata.MaxSamplesPerTrajectory);
-	NiagaraComponent->SetIntParameter(TEXT("TotalSampleCount"), Metadata.TotalSampleCount);
+	// Niagara ints are 32-bit; the position array this actor binds can't exceed that anyway
+	NiagaraComponent->SetIntParameter(TEXT("TotalSampleCount"), static_cast<int32>(FMath::Min<int64>(Metadata.TotalSampleCount, MAX_int32)));
 	NiagaraComponent->SetIntParameter(TEXT("FirstTimeStep"), Metadata.FirstTimeStep);
 	NiagaraComponent->SetIntParameter(TEXT("LastTimeStep"), Metadata.LastTimeStep);
+	NiagaraComponent->SetIntParameter(TEXT("TimeStepStride"), Metadata.TimeStepStride);
+
+	// Global time step range (already computed during dataset loading)
+	NiagaraComponent->SetIntParameter(TEXT("GlobalFirstTimeStep"), Metadata.FirstTimeStep);
+	NiagaraComponent->SetIntParameter(TEXT("GlobalLastTimeStep"), Metadata.LastTimeStep);
 
 	// Pass vector parameters
 	NiagaraComponent->SetVectorParameter(TEXT("BoundsMin"), Metadata.BoundsMin);
 	NiagaraComponent->SetVectorParameter(TEXT("BoundsMax"), Metadata.BoundsMax);
 
-	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Passed metadata to Niagara (%d trajectories, %d samples)"), 
+	UE_LOG(LogTemp, Log, TEXT("DatasetVisualizationActor: Passed metadata to Niagara (%d trajectories, %lld samples)"), 
 	       Metadata.NumTrajectories, Metadata.TotalSampleCount);
 
 	return true;
@@ -0,0 +1,575 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NiagaraDataInterfaceTrajectoryBuffer.h"
+#include "TrajectoryBufferProvider.h"
+#include "NiagaraComponent.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraSystemInstance.h"
+#include "NiagaraTypes.h"
+#include "NiagaraCompileHashVisitor.h"
+#include "NiagaraShaderParametersBuilder.h"
+#include "RenderingThread.h"
+#include "RenderResource.h"
+
+namespace NDITrajectoryBufferLocal
+{
+	/** Bump when the generated HLSL changes so scripts recompile */
+	static const TCHAR* HLSLVersion = TEXT("1");
+
+	static const FName GetNumTrajectoriesName(TEXT("GetNumTrajectories"));
+	static const FName GetTotalSampleCountName(TEXT("GetTotalSampleCount"));
+	static const FName GetTimeStepRangeName(TEXT("GetTimeStepRange"));
+	static const FName GetBoundsName(TEXT("GetBounds"));
+	static const FName GetTrajectoryInfoName(TEXT("GetTrajectoryInfo"));
+	static const FName GetSamplePositionName(TEXT("GetSamplePosition"));
+	static const FName GetSampleTimeStepName(TEXT("GetSampleTimeStep"));
+	static const FName GetPositionAtTimeStepName(TEXT("GetPositionAtTimeStep"));
+	static const FName GetPositionByIndexName(TEXT("GetPositionByIndex"));
+
+	/** Dataset-level values bound as shader parameters */
+	struct FBufferMetadata
+	{
+		int32 NumTrajectories = 0;
+		int32 TotalSampleCount = 0;
+		int32 FirstTimeStep = 0;
+		int32 LastTimeStep = 0;
+		int32 TimeStepStride = 1;
+		FVector3f BoundsMin = FVector3f::ZeroVector;
+		FVector3f BoundsMax = FVector3f::ZeroVector;
+	};
+
+	/** Game thread state of one system instance */
+	struct FInstanceData_GT
+	{
+		/** Provider and data generation last sent to the render thread */
+		TWeakObjectPtr<UTrajectoryBufferProvider> BoundProvider;
+		uint32 BoundGeneration = 0;
+		bool bBound = false;
+
+		/** Set by PerInstanceTick when the provider's data changed, consumed by ProvidePerInstanceDataForRenderThread */
+		bool bDataChanged = false;
+		FTrajectoryPositionBufferResource* Resource = nullptr;
+		FBufferMetadata Metadata;
+		TArray<FIntVector4> TrajectoryInfo;
+	};
+
+	/** Passed from the game thread to the render thread every frame (only filled when the data changed) */
+	struct FGameToRenderData
+	{
+		bool bDataChanged = false;
+
+		/** Only dereferenced on the render thread in the frame it was sent: the provider releases resources after later commands */
+		FTrajectoryPositionBufferResource* Resource = nullptr;
+		FBufferMetadata Metadata;
+		TArray<FIntVector4> TrajectoryInfo;
+	};
+
+	/** Render thread state of one system instance */
+	struct FInstanceData_RT
+	{
+		FBufferMetadata Metadata;
+
+		/** Reference to the provider's buffer (keeps the RHI buffer alive until the next change) */
+		FShaderResourceViewRHIRef PositionsSRV;
+
+		FBufferRHIRef TrajectoryInfoBuffer;
+		FShaderResourceViewRHIRef TrajectoryInfoSRV;
+	};
+
+	/** One-element buffers bound while no data is available */
+	class FDummyBuffers : public FRenderResource
+	{
+	public:
+		virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+		{
+			FRHIResourceCreateInfo PositionCreateInfo(TEXT("TrajectoryBufferDummyPositions"));
+			PositionBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FVector3f), sizeof(FVector3f), BUF_ShaderResource | BUF_Static, PositionCreateInfo);
+			PositionSRV = RHICmdList.CreateShaderResourceView(PositionBuffer);
+			void* PositionData = RHICmdList.LockBuffer(PositionBuffer, 0, sizeof(FVector3f), RLM_WriteOnly);
+			FMemory::Memzero(PositionData, sizeof(FVector3f));
+			RHICmdList.UnlockBuffer(PositionBuffer);
+
+			FRHIResourceCreateInfo InfoCreateInfo(TEXT("TrajectoryBufferDummyInfo"));
+			InfoBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FIntVector4), sizeof(FIntVector4), BUF_ShaderResource | BUF_Static, InfoCreateInfo);
+			InfoSRV = RHICmdList.CreateShaderResourceView(InfoBuffer);
+			void* InfoData = RHICmdList.LockBuffer(InfoBuffer, 0, sizeof(FIntVector4), RLM_WriteOnly);
+			FMemory::Memzero(InfoData, sizeof(FIntVector4));
+			RHICmdList.UnlockBuffer(InfoBuffer);
+		}
+
+		virtual void ReleaseRHI() override
+		{
+			PositionSRV.SafeRelease();
+			PositionBuffer.SafeRelease();
+			InfoSRV.SafeRelease();
+			InfoBuffer.SafeRelease();
+		}
+
+		FBufferRHIRef PositionBuffer;
+		FShaderResourceViewRHIRef PositionSRV;
+		FBufferRHIRef InfoBuffer;
+		FShaderResourceViewRHIRef InfoSRV;
+	};
+
+	static TGlobalResource<FDummyBuffers> GDummyBuffers;
+
+	/** Provider bound explicitly, or the first one on the actor owning the Niagara component */
+	static UTrajectoryBufferProvider* ResolveProvider(const UNiagaraDataInterfaceTrajectoryBuffer* Interface, FNiagaraSystemInstance* SystemInstance)
+	{
+		if (UTrajectoryBufferProvider* Provider = Interface->Provider.Get())
+		{
+			return Provider;
+		}
+
+		USceneComponent* AttachComponent = SystemInstance ? SystemInstance->GetAttachComponent() : nullptr;
+		AActor* Owner = AttachComponent ? AttachComponent->GetOwner() : nullptr;
+		return Owner ? Owner->FindComponentByClass<UTrajectoryBufferProvider>() : nullptr;
+	}
+}
+
+struct FNDITrajectoryBufferProxy : public FNiagaraDataInterfaceProxy
+{
+	virtual int32 PerInstanceDataPassedToRenderThreadSize() const override { return sizeof(NDITrajectoryBufferLocal::FGameToRenderData); }
+
+	virtual void ConsumePerInstanceDataFromGameThread(void* PerInstanceData, const FNiagaraSystemInstanceID& Instance) override
+	{
+		using namespace NDITrajectoryBufferLocal;
+
+		FGameToRenderData* Data = static_cast<FGameToRenderData*>(PerInstanceData);
+		if (Data->bDataChanged)
+		{
+			FInstanceData_RT& InstanceData = SystemInstancesToData.FindOrAdd(Instance);
+			InstanceData.Metadata = Data->Metadata;
+			InstanceData.PositionsSRV = Data->Resource ? Data->Resource->GetBufferSRV() : FShaderResourceViewRHIRef();
+			InstanceData.TrajectoryInfoSRV.SafeRelease();
+			InstanceData.TrajectoryInfoBuffer.SafeRelease();
+
+			if (Data->TrajectoryInfo.Num() > 0)
+			{
+				FRHICommandListImmediate& RHICmdList = FRHICommandListExecutor::GetImmediateCommandList();
+				const uint32 InfoBytes = Data->TrajectoryInfo.Num() * sizeof(FIntVector4);
+				FRHIResourceCreateInfo CreateInfo(TEXT("TrajectoryBufferNDIInfo"));
+				InstanceData.TrajectoryInfoBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FIntVector4), InfoBytes, BUF_ShaderResource | BUF_Static, CreateInfo);
+				InstanceData.TrajectoryInfoSRV = RHICmdList.CreateShaderResourceView(InstanceData.TrajectoryInfoBuffer);
+				void* InfoData = RHICmdList.LockBuffer(InstanceData.TrajectoryInfoBuffer, 0, InfoBytes, RLM_WriteOnly);
+				FMemory::Memcpy(InfoData, Data->TrajectoryInfo.GetData(), InfoBytes);
+				RHICmdList.UnlockBuffer(InstanceData.TrajectoryInfoBuffer);
+			}
+
+			// Nothing to read without both buffers
+			if (!InstanceData.PositionsSRV.IsValid() || !InstanceData.TrajectoryInfoSRV.IsValid())
+			{
+				InstanceData.Metadata.NumTrajectories = 0;
+				InstanceData.Metadata.TotalSampleCount = 0;
+			}
+		}
+		Data->~FGameToRenderData();
+	}
+
+	TMap<FNiagaraSystemInstanceID, NDITrajectoryBufferLocal::FInstanceData_RT> SystemInstancesToData;
+};
+
+UNiagaraDataInterfaceTrajectoryBuffer::UNiagaraDataInterfaceTrajectoryBuffer(FObjectInitializer const& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Proxy.Reset(new FNDITrajectoryBufferProxy());
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::SetNiagaraTrajectoryBufferProvider(UNiagaraComponent* NiagaraComponent, FName OverrideName, UTrajectoryBufferProvider* InProvider)
+{
+	UNiagaraDataInterfaceTrajectoryBuffer* Interface = UNiagaraFunctionLibrary::GetDataInterface<UNiagaraDataInterfaceTrajectoryBuffer>(NiagaraComponent, OverrideName);
+	if (!Interface)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("NiagaraDataInterfaceTrajectoryBuffer: No Trajectory Buffer user parameter named '%s'"), *OverrideName.ToString());
+		return false;
+	}
+
+	Interface->Provider = InProvider;
+	return true;
+}
+
+void UNiagaraDataInterfaceTrajectoryBuffer::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		ENiagaraTypeRegistryFlags Flags = ENiagaraTypeRegistryFlags::AllowAnyVariable | ENiagaraTypeRegistryFlags::AllowParameter;
+		FNiagaraTypeRegistry::Register(FNiagaraTypeDefinition(GetClass()), Flags);
+	}
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::Equals(const UNiagaraDataInterface* Other) const
+{
+	if (!Super::Equals(Other))
+	{
+		return false;
+	}
+	return CastChecked<const UNiagaraDataInterfaceTrajectoryBuffer>(Other)->Provider == Provider;
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::CopyToInternal(UNiagaraDataInterface* Destination) const
+{
+	if (!Super::CopyToInternal(Destination))
+	{
+		return false;
+	}
+	CastChecked<UNiagaraDataInterfaceTrajectoryBuffer>(Destination)->Provider = Provider;
+	return true;
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	new (PerInstanceData) NDITrajectoryBufferLocal::FInstanceData_GT();
+	return true;
+}
+
+void UNiagaraDataInterfaceTrajectoryBuffer::DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	static_cast<FInstanceData_GT*>(PerInstanceData)->~FInstanceData_GT();
+
+	ENQUEUE_RENDER_COMMAND(RemoveTrajectoryBufferNDIInstance)(
+		[RT_Proxy = GetProxyAs<FNDITrajectoryBufferProxy>(), InstanceID = SystemInstance->GetId()](FRHICommandListImmediate& RHICmdList)
+		{
+			RT_Proxy->SystemInstancesToData.Remove(InstanceID);
+		});
+}
+
+int32 UNiagaraDataInterfaceTrajectoryBuffer::PerInstanceDataSize() const
+{
+	return sizeof(NDITrajectoryBufferLocal::FInstanceData_GT);
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds)
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	FInstanceData_GT* InstanceData = static_cast<FInstanceData_GT*>(PerInstanceData);
+	UTrajectoryBufferProvider* CurrentProvider = ResolveProvider(this, SystemInstance);
+	const uint32 Generation = CurrentProvider ? CurrentProvider->GetDataGeneration() : 0;
+
+	if (InstanceData->bBound && InstanceData->BoundProvider.Get() == CurrentProvider && InstanceData->BoundGeneration == Generation)
+	{
+		return false;
+	}
+
+	InstanceData->BoundProvider = CurrentProvider;
+	InstanceData->BoundGeneration = Generation;
+	InstanceData->bBound = true;
+	InstanceData->bDataChanged = true;
+	InstanceData->Resource = nullptr;
+	InstanceData->Metadata = FBufferMetadata();
+	InstanceData->TrajectoryInfo.Reset();
+
+	FTrajectoryPositionBufferResource* Resource = CurrentProvider ? CurrentProvider->GetPositionBufferResource() : nullptr;
+	if (!Resource)
+	{
+		return false;
+	}
+
+	if (Resource->IsPaged() || Resource->IsRingLayout())
+	{
+		UE_LOG(LogTemp, Error, TEXT("NiagaraDataInterfaceTrajectoryBuffer: Provider %s uses the %s layout, which is not supported (positions over %llu bytes are paged); binding no trajectories"),
+			*CurrentProvider->GetName(), Resource->IsRingLayout() ? TEXT("ring-buffer") : TEXT("paged"), FTrajectoryPositionBufferResource::MaxSingleBufferBytes);
+		return false;
+	}
+
+	// Single buffers are at most MaxSingleBufferBytes, so every sample index fits an int
+	const FTrajectoryBufferMetadata& ProviderMetadata = CurrentProvider->GetMetadata();
+	const TArray<FTrajectoryBufferInfo>& ProviderInfo = CurrentProvider->GetTrajectoryInfoRef();
+	InstanceData->Resource = Resource;
+	InstanceData->Metadata.NumTrajectories = ProviderInfo.Num();
+	InstanceData->Metadata.TotalSampleCount = static_cast<int32>(FMath::Min<int64>(ProviderMetadata.TotalSampleCount, MAX_int32));
+	InstanceData->Metadata.FirstTimeStep = ProviderMetadata.FirstTimeStep;
+	InstanceData->Metadata.LastTimeStep = ProviderMetadata.LastTimeStep;
+	InstanceData->Metadata.TimeStepStride = ProviderMetadata.TimeStepStride;
+	InstanceData->Metadata.BoundsMin = FVector3f(ProviderMetadata.BoundsMin);
+	InstanceData->Metadata.BoundsMax = FVector3f(ProviderMetadata.BoundsMax);
+
+	InstanceData->TrajectoryInfo.SetNumUninitialized(ProviderInfo.Num());
+	for (int32 TrajIdx = 0; TrajIdx < ProviderInfo.Num(); ++TrajIdx)
+	{
+		const FTrajectoryBufferInfo& Info = ProviderInfo[TrajIdx];
+		InstanceData->TrajectoryInfo[TrajIdx] = FIntVector4(static_cast<int32>(Info.StartIndex), Info.SampleCount, Info.GetSampleTimeStep(0), Info.TrajectoryId);
+	}
+
+	return false;
+}
+
+void UNiagaraDataInterfaceTrajectoryBuffer::ProvidePerInstanceDataForRenderThread(void* DataForRenderThread, void* PerInstanceData, const FNiagaraSystemInstanceID& SystemInstance)
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	FInstanceData_GT* InstanceData = static_cast<FInstanceData_GT*>(PerInstanceData);
+	FGameToRenderData* RenderData = new (DataForRenderThread) FGameToRenderData();
+	if (InstanceData->bDataChanged)
+	{
+		RenderData->bDataChanged = true;
+		RenderData->Resource = InstanceData->Resource;
+		RenderData->Metadata = InstanceData->Metadata;
+		RenderData->TrajectoryInfo = MoveTemp(InstanceData->TrajectoryInfo);
+		InstanceData->bDataChanged = false;
+		InstanceData->Resource = nullptr;
+	}
+}
+
+#if WITH_EDITORONLY_DATA
+void UNiagaraDataInterfaceTrajectoryBuffer::GetFunctionsInternal(TArray<FNiagaraFunctionSignature>& OutFunctions) const
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	FNiagaraFunctionSignature DefaultSignature;
+	DefaultSignature.Inputs.Emplace(FNiagaraTypeDefinition(GetClass()), TEXT("TrajectoryBuffer"));
+	DefaultSignature.bMemberFunction = true;
+	DefaultSignature.bRequiresContext = false;
+	DefaultSignature.bSupportsCPU = false;
+	DefaultSignature.bSupportsGPU = true;
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetNumTrajectoriesName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("NumTrajectories"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetTotalSampleCountName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("TotalSampleCount"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetTimeStepRangeName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("FirstTimeStep"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("LastTimeStep"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("TimeStepStride"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetBoundsName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("BoundsMin"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("BoundsMax"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetTrajectoryInfoName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Trajectory"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("StartIndex"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("SampleCount"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("FirstSampleTimeStep"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("TrajectoryId"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetSamplePositionName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Trajectory"));
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Sample"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Position"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetBoolDef(), TEXT("bValid"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetSampleTimeStepName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Trajectory"));
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Sample"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("TimeStep"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetPositionAtTimeStepName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Trajectory"));
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetFloatDef(), TEXT("TimeStep"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Position"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetBoolDef(), TEXT("bValid"));
+	}
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetPositionByIndexName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Position"));
+	}
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::AppendCompileHash(FNiagaraCompileHashVisitor* InVisitor) const
+{
+	bool bSuccess = Super::AppendCompileHash(InVisitor);
+	bSuccess &= InVisitor->UpdateString(TEXT("NDITrajectoryBufferHLSLVersion"), NDITrajectoryBufferLocal::HLSLVersion);
+	bSuccess &= InVisitor->UpdateShaderParameters<FShaderParameters>();
+	return bSuccess;
+}
+
+void UNiagaraDataInterfaceTrajectoryBuffer::GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, FString& OutHLSL)
+{
+	const TCHAR* Format = TEXT(R"(
+int {Symbol}_NumTrajectories;
+int {Symbol}_TotalSampleCount;
+int {Symbol}_FirstTimeStep;
+int {Symbol}_LastTimeStep;
+int {Symbol}_TimeStepStride;
+float3 {Symbol}_BoundsMin;
+float3 {Symbol}_BoundsMax;
+StructuredBuffer<float3> {Symbol}_Positions;
+StructuredBuffer<int4> {Symbol}_TrajectoryInfo;
+
+int4 {Symbol}_GetInfo(int Trajectory)
+{
+	return (Trajectory >= 0 && Trajectory < {Symbol}_NumTrajectories) ? {Symbol}_TrajectoryInfo[Trajectory] : int4(0, 0, 0, 0);
+}
+)");
+
+	FStringFormatNamedArguments Args;
+	Args.Add(TEXT("Symbol"), ParamInfo.DataInterfaceHLSLSymbol);
+	OutHLSL += FString::Format(Format, Args);
+}
+
+bool UNiagaraDataInterfaceTrajectoryBuffer::GetFunctionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo, int FunctionInstanceIndex, FString& OutHLSL)
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	const TCHAR* Format = nullptr;
+	if (FunctionInfo.DefinitionName == GetNumTrajectoriesName)
+	{
+		Format = TEXT(R"(
+void {Function}(out int NumTrajectories)
+{
+	NumTrajectories = {Symbol}_NumTrajectories;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetTotalSampleCountName)
+	{
+		Format = TEXT(R"(
+void {Function}(out int TotalSampleCount)
+{
+	TotalSampleCount = {Symbol}_TotalSampleCount;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetTimeStepRangeName)
+	{
+		Format = TEXT(R"(
+void {Function}(out int FirstTimeStep, out int LastTimeStep, out int TimeStepStride)
+{
+	FirstTimeStep = {Symbol}_FirstTimeStep;
+	LastTimeStep = {Symbol}_LastTimeStep;
+	TimeStepStride = {Symbol}_TimeStepStride;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetBoundsName)
+	{
+		Format = TEXT(R"(
+void {Function}(out float3 BoundsMin, out float3 BoundsMax)
+{
+	BoundsMin = {Symbol}_BoundsMin;
+	BoundsMax = {Symbol}_BoundsMax;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetTrajectoryInfoName)
+	{
+		Format = TEXT(R"(
+void {Function}(int Trajectory, out int StartIndex, out int SampleCount, out int FirstSampleTimeStep, out int TrajectoryId)
+{
+	int4 Info = {Symbol}_GetInfo(Trajectory);
+	StartIndex = Info.x;
+	SampleCount = Info.y;
+	FirstSampleTimeStep = Info.z;
+	TrajectoryId = Info.w;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetSamplePositionName)
+	{
+		Format = TEXT(R"(
+void {Function}(int Trajectory, int Sample, out float3 Position, out bool bValid)
+{
+	int4 Info = {Symbol}_GetInfo(Trajectory);
+	Position = float3(0.0f, 0.0f, 0.0f);
+	bValid = false;
+	if (Sample >= 0 && Sample < Info.y)
+	{
+		float3 SamplePosition = {Symbol}_Positions[Info.x + Sample];
+		bValid = !any(isnan(SamplePosition));
+		Position = bValid ? SamplePosition : Position;
+	}
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetSampleTimeStepName)
+	{
+		Format = TEXT(R"(
+void {Function}(int Trajectory, int Sample, out int TimeStep)
+{
+	TimeStep = {Symbol}_GetInfo(Trajectory).z + Sample * {Symbol}_TimeStepStride;
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetPositionAtTimeStepName)
+	{
+		Format = TEXT(R"(
+void {Function}(int Trajectory, float TimeStep, out float3 Position, out bool bValid)
+{
+	int4 Info = {Symbol}_GetInfo(Trajectory);
+	float Sample = (TimeStep - (float)Info.z) / (float)max({Symbol}_TimeStepStride, 1);
+	Position = float3(0.0f, 0.0f, 0.0f);
+	bValid = false;
+	if (Info.y > 0 && Sample >= 0.0f && Sample <= (float)(Info.y - 1))
+	{
+		int Sample0 = (int)Sample;
+		int Sample1 = min(Sample0 + 1, Info.y - 1);
+		float3 Blended = lerp({Symbol}_Positions[Info.x + Sample0], {Symbol}_Positions[Info.x + Sample1], Sample - (float)Sample0);
+		bValid = !any(isnan(Blended));
+		Position = bValid ? Blended : Position;
+	}
+}
+)");
+	}
+	else if (FunctionInfo.DefinitionName == GetPositionByIndexName)
+	{
+		Format = TEXT(R"(
+void {Function}(int Index, out float3 Position)
+{
+	Position = (Index >= 0 && Index < {Symbol}_TotalSampleCount) ? {Symbol}_Positions[Index] : float3(0.0f, 0.0f, 0.0f);
+}
+)");
+	}
+
+	if (!Format)
+	{
+		return false;
+	}
+
+	FStringFormatNamedArguments Args;
+	Args.Add(TEXT("Function"), FunctionInfo.InstanceName);
+	Args.Add(TEXT("Symbol"), ParamInfo.DataInterfaceHLSLSymbol);
+	OutHLSL += FString::Format(Format, Args);
+	return true;
+}
+#endif
+
+void UNiagaraDataInterfaceTrajectoryBuffer::BuildShaderParameters(FNiagaraShaderParametersBuilder& ShaderParametersBuilder) const
+{
+	ShaderParametersBuilder.AddNestedStruct<FShaderParameters>();
+}
+
+void UNiagaraDataInterfaceTrajectoryBuffer::SetShaderParameters(const FNiagaraDataInterfaceSetShaderParametersContext& Context) const
+{
+	using namespace NDITrajectoryBufferLocal;
+
+	FNDITrajectoryBufferProxy& DIProxy = Context.GetProxy<FNDITrajectoryBufferProxy>();
+	const FInstanceData_RT* InstanceData = DIProxy.SystemInstancesToData.Find(Context.GetSystemInstanceID());
+	const bool bHasData = InstanceData && InstanceData->Metadata.NumTrajectories > 0;
+
+	FShaderParameters* Parameters = Context.GetParameterNestedStruct<FShaderParameters>();
+	const FBufferMetadata Metadata = bHasData ? InstanceData->Metadata : FBufferMetadata();
+	Parameters->NumTrajectories = Metadata.NumTrajectories;
+	Parameters->TotalSampleCount = Metadata.TotalSampleCount;
+	Parameters->FirstTimeStep = Metadata.FirstTimeStep;
+	Parameters->LastTimeStep = Metadata.LastTimeStep;
+	Parameters->TimeStepStride = Metadata.TimeStepStride;
+	Parameters->BoundsMin = Metadata.BoundsMin;
+	Parameters->BoundsMax = Metadata.BoundsMax;
+	Parameters->Positions = bHasData ? InstanceData->PositionsSRV.GetReference() : GDummyBuffers.PositionSRV.GetReference();
+	Parameters->TrajectoryInfo = bHasData ? InstanceData->TrajectoryInfoSRV.GetReference() : GDummyBuffers.InfoSRV.GetReference();
+}
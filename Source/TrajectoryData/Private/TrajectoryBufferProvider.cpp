@@ -2,10 +2,16 @@
 
 #include "TrajectoryBufferProvider.h"
 #include "TrajectoryDataLoader.h"
+#include "TrajectoryStreamingSession.h"
 #include "RenderingThread.h"
 #include "RHICommandList.h"
 #include "NiagaraComponent.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include <atomic>
 
 // ============================================================================
 // FTrajectoryPositionBufferResource Implementation
@@ -16,7 +22,10 @@ void FTrajectoryPositionBufferResource::Initialize(const TArray<FVector3f>& Posi
 	// Store data on game thread before passing to render thread
 	// This is safe because we're copying the data
 	CPUPositionData = PositionData;
+	SharedArena.Reset();
+	bRingLayout = false;
 	NumElements = PositionData.Num();
+	BuildPageTable();
 
 	// Capture data size for render thread (CPUPositionData will be accessed on render thread)
 	// The actual data copy to GPU happens on the render thread in InitResource()
@@ -36,7 +45,10 @@ void FTrajectoryPositionBufferResource::Initialize(TArray<FVector3f>&& PositionD
 	// Move data on game thread - this transfers ownership to CPUPositionData
 	// Safe because the moved-from array is no longer used by the caller
 	CPUPositionData = MoveTemp(PositionData);
+	SharedArena.Reset();
+	bRingLayout = false;
 	NumElements = CPUPositionData.Num();
+	BuildPageTable();
 
 	// Queue GPU upload on render thread
 	// CPUPositionData is owned by this object and won't be modified on game thread after this point
@@ -51,6 +63,154 @@ void FTrajectoryPositionBufferResource::Initialize(TArray<FVector3f>&& PositionD
 		});
 }
 
+void FTrajectoryPositionBufferResource::Initialize(const TSharedPtr<const FTrajectorySampleArena>& SampleArena)
+{
+	// Share the arena instead of copying - it is immutable once loading has completed,
+	// so the render thread can read it while the game thread keeps using the dataset
+	CPUPositionData.Empty();
+	SharedArena = SampleArena;
+	bRingLayout = false;
+	NumElements = SharedArena.IsValid() ? SharedArena->GetTotalSampleCount() : 0;
+	BuildPageTable();
+
+	// Queue GPU upload on render thread
+	ENQUEUE_RENDER_COMMAND(UpdateTrajectoryPositionBuffer)(
+		[this](FRHICommandListImmediate& RHICmdList)
+		{
+			if (IsInitialized())
+			{
+				ReleaseResource();
+			}
+			InitResource(RHICmdList);
+		});
+}
+
+void FTrajectoryPositionBufferResource::BuildPageTable()
+{
+	PageTable.Reset();
+	PageSizeSamples = 0;
+
+	int32 PageSize = RequestedPageSizeSamples;
+	if (PageSize <= 0)
+	{
+		if ((uint64)NumElements * sizeof(FVector3f) <= MaxSingleBufferBytes)
+		{
+			return;
+		}
+		PageSize = DefaultPageSizeSamples;
+	}
+
+	// Power of two so shaders can split indices with a shift and a mask; 2^28 samples (3 GB) keep a page's byte size 32-bit
+	PageSizeSamples = static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Min(PageSize, 1 << 28))));
+
+	const int64 NumPages = FMath::DivideAndRoundUp(NumElements, (int64)PageSizeSamples);
+	PageTable.SetNumUninitialized(static_cast<int32>(NumPages));
+	for (int32 Page = 0; Page < PageTable.Num(); ++Page)
+	{
+		const int64 FirstSample = (int64)Page * PageSizeSamples;
+		PageTable[Page].FirstSample = FirstSample;
+		PageTable[Page].NumSamples = static_cast<int32>(FMath::Min<int64>(PageSizeSamples, NumElements - FirstSample));
+		PageTable[Page].Reserved = 0;
+	}
+}
+
+void FTrajectoryPositionBufferResource::InitializeRing(int32 InNumTrajectories, int32 InNumSegments, int32 InSamplesPerSegment)
+{
+	checkf((int64)InNumSegments * InSamplesPerSegment <= MAX_int32 / (int32)sizeof(FVector3f),
+		TEXT("Trajectory ring buffer exceeds the maximum buffer size"));
+
+	CPUPositionData.Empty();
+	SharedArena.Reset();
+	bRingLayout = true;
+	RingNumTrajectories = InNumTrajectories;
+	RingNumSegments = InNumSegments;
+	RingSamplesPerSegment = InSamplesPerSegment;
+	NumElements = (int64)InNumSegments * InSamplesPerSegment;
+	PageSizeSamples = 0;
+	PageTable.Reset();
+
+	// Created once; segments are overwritten in place by UploadRingSegment
+	ENQUEUE_RENDER_COMMAND(InitTrajectoryRingBuffer)(
+		[this](FRHICommandListImmediate& RHICmdList)
+		{
+			if (IsInitialized())
+			{
+				ReleaseResource();
+			}
+			InitResource(RHICmdList);
+		});
+}
+
+bool FTrajectoryPositionBufferResource::UploadRingSegment(int32 Segment, const TSharedPtr<const FTrajectorySampleArena>& IntervalArena)
+{
+	if (!bRingLayout || !IntervalArena.IsValid() || Segment < 0 || Segment >= RingNumSegments)
+	{
+		return false;
+	}
+
+	if (IntervalArena->GetTotalSampleCount() > RingSamplesPerSegment || IntervalArena->Num() > RingNumTrajectories)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TrajectoryPositionBufferResource: Interval (%d trajectories, %d samples) doesn't fit a ring segment (%d trajectories, %d samples)"),
+			IntervalArena->Num(), IntervalArena->GetTotalSampleCount(), RingNumTrajectories, RingSamplesPerSegment);
+		return false;
+	}
+
+	const int32 SegmentSampleBase = Segment * RingSamplesPerSegment;
+	const int32 SegmentEntryBase = Segment * RingNumTrajectories;
+	const int32 NumRingTrajectories = RingNumTrajectories;
+
+	// Only this segment's samples and entries are written: the interval is staged in transient upload buffers and
+	// copied into the segment's region, so the other segments keep their contents
+	ENQUEUE_RENDER_COMMAND(UploadTrajectoryRingSegment)(
+		[this, IntervalArena, SegmentSampleBase, SegmentEntryBase, NumRingTrajectories](FRHICommandListImmediate& RHICmdList)
+		{
+			if (!StructuredBuffer.IsValid() || !RingEntryBuffer.IsValid())
+			{
+				return;
+			}
+
+			const FTrajectorySampleArena& Arena = *IntervalArena;
+			const uint32 PositionBytes = Arena.GetTotalSampleCount() * sizeof(FVector3f);
+			const uint32 EntryBytes = NumRingTrajectories * sizeof(FTrajectoryRingEntry);
+
+			FBufferRHIRef PositionStaging;
+			if (PositionBytes > 0)
+			{
+				FRHIResourceCreateInfo StagingCreateInfo(TEXT("TrajectoryRingPositionStaging"));
+				PositionStaging = RHICmdList.CreateStructuredBuffer(sizeof(FVector3f), PositionBytes, BUF_SourceCopy | BUF_Static, ERHIAccess::CopySrc, StagingCreateInfo);
+				void* PositionDst = RHICmdList.LockBuffer(PositionStaging, 0, PositionBytes, RLM_WriteOnly);
+				FMemory::Memcpy(PositionDst, Arena.Positions.GetData(), PositionBytes);
+				RHICmdList.UnlockBuffer(PositionStaging);
+			}
+
+			FRHIResourceCreateInfo EntryStagingCreateInfo(TEXT("TrajectoryRingEntryStaging"));
+			FBufferRHIRef EntryStaging = RHICmdList.CreateStructuredBuffer(sizeof(FTrajectoryRingEntry), EntryBytes, BUF_SourceCopy | BUF_Static, ERHIAccess::CopySrc, EntryStagingCreateInfo);
+			FTrajectoryRingEntry* Entries = static_cast<FTrajectoryRingEntry*>(RHICmdList.LockBuffer(EntryStaging, 0, EntryBytes, RLM_WriteOnly));
+			for (int32 TrajIdx = 0; TrajIdx < NumRingTrajectories; ++TrajIdx)
+			{
+				const bool bHasSamples = TrajIdx < Arena.Num() && Arena.SampleCounts[TrajIdx] > 0;
+				Entries[TrajIdx].SampleOffset = bHasSamples ? SegmentSampleBase + Arena.SampleOffsets[TrajIdx] : -1;
+				Entries[TrajIdx].FirstSampleTimeStep = bHasSamples ? Arena.FirstSampleTimeSteps[TrajIdx] : 0;
+				Entries[TrajIdx].SampleCount = bHasSamples ? Arena.SampleCounts[TrajIdx] : 0;
+			}
+			RHICmdList.UnlockBuffer(EntryStaging);
+
+			RHICmdList.Transition({
+				FRHITransitionInfo(StructuredBuffer, ERHIAccess::SRVMask, ERHIAccess::CopyDest),
+				FRHITransitionInfo(RingEntryBuffer, ERHIAccess::SRVMask, ERHIAccess::CopyDest) });
+			if (PositionStaging.IsValid())
+			{
+				RHICmdList.CopyBufferRegion(StructuredBuffer, SegmentSampleBase * sizeof(FVector3f), PositionStaging, 0, PositionBytes);
+			}
+			RHICmdList.CopyBufferRegion(RingEntryBuffer, SegmentEntryBase * sizeof(FTrajectoryRingEntry), EntryStaging, 0, EntryBytes);
+			RHICmdList.Transition({
+				FRHITransitionInfo(StructuredBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask),
+				FRHITransitionInfo(RingEntryBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask) });
+		});
+
+	return true;
+}
+
 void FTrajectoryPositionBufferResource::InitResource(FRHICommandListBase& RHICmdList)
 {
 	FRenderResource::InitResource(RHICmdList);
@@ -60,11 +220,46 @@ void FTrajectoryPositionBufferResource::InitResource(FRHICommandListBase& RHICmd
 		return;
 	}
 
+	if (bRingLayout)
+	{
+		// Ring buffers are static: segments are updated by region copies (UploadRingSegment), never by locking the
+		// live buffer, which would discard (rename) it along with the other segments
+		FRHIResourceCreateInfo CreateInfo(TEXT("TrajectoryRingPositionBuffer"));
+		const uint32 BufferSize = static_cast<uint32>(NumElements * sizeof(FVector3f));
+		StructuredBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FVector3f), BufferSize, BUF_ShaderResource | BUF_Static, CreateInfo);
+		BufferSRV = RHICmdList.CreateShaderResourceView(StructuredBuffer);
+
+		FRHIResourceCreateInfo EntryCreateInfo(TEXT("TrajectoryRingEntryBuffer"));
+		const int32 NumEntries = RingNumSegments * RingNumTrajectories;
+		const uint32 EntryBufferSize = NumEntries * sizeof(FTrajectoryRingEntry);
+		RingEntryBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FTrajectoryRingEntry), EntryBufferSize, BUF_ShaderResource | BUF_Static, EntryCreateInfo);
+		RingEntrySRV = RHICmdList.CreateShaderResourceView(RingEntryBuffer);
+
+		// All segments start empty. Positions are only addressed through an entry's sample range, so only the
+		// (small) entry buffer is initialized; the position buffer is left as created
+		FTrajectoryRingEntry* Entries = static_cast<FTrajectoryRingEntry*>(RHICmdList.LockBuffer(RingEntryBuffer, 0, EntryBufferSize, RLM_WriteOnly));
+		for (int32 EntryIdx = 0; EntryIdx < NumEntries; ++EntryIdx)
+		{
+			Entries[EntryIdx] = { -1, 0, 0 };
+		}
+		RHICmdList.UnlockBuffer(RingEntryBuffer);
+		return;
+	}
+
+	if (PageSizeSamples > 0)
+	{
+		InitPagedResource(RHICmdList);
+		return;
+	}
+
 	// Create structured buffer
 	FRHIResourceCreateInfo CreateInfo(TEXT("TrajectoryPositionBuffer"));
 	
+	// Single buffers are at most MaxSingleBufferBytes (larger datasets are paged by BuildPageTable)
 	const uint32 ElementSize = sizeof(FVector3f);
-	const uint32 BufferSize = NumElements * ElementSize;
+	const uint64 BufferSize64 = (uint64)NumElements * ElementSize;
+	checkf(BufferSize64 <= MAX_uint32, TEXT("Trajectory position buffer of %llu bytes must be paged"), BufferSize64);
+	const uint32 BufferSize = static_cast<uint32>(BufferSize64);
 
 	StructuredBuffer = RHICmdList.CreateStructuredBuffer(
 		ElementSize,
@@ -76,17 +271,64 @@ void FTrajectoryPositionBufferResource::InitResource(FRHICommandListBase& RHICmd
 	// Create shader resource view
 	BufferSRV = RHICmdList.CreateShaderResourceView(StructuredBuffer);
 
-	// Upload data to GPU
-	if (CPUPositionData.Num() > 0)
+	// Upload data to GPU (directly from the shared sample arena if there is one)
+	TConstArrayView<FVector3f> PositionData = GetCPUPositionData();
+	if (PositionData.Num() > 0)
 	{
 		void* BufferData = RHICmdList.LockBuffer(StructuredBuffer, 0, BufferSize, RLM_WriteOnly);
-		FMemory::Memcpy(BufferData, CPUPositionData.GetData(), BufferSize);
+		FMemory::Memcpy(BufferData, PositionData.GetData(), BufferSize);
 		RHICmdList.UnlockBuffer(StructuredBuffer);
 	}
 }
 
+void FTrajectoryPositionBufferResource::InitPagedResource(FRHICommandListBase& RHICmdList)
+{
+	TConstArrayView<FVector3f> PositionData = GetCPUPositionData();
+
+	PageBuffers.SetNum(PageTable.Num());
+	PageSRVs.SetNum(PageTable.Num());
+	for (int32 Page = 0; Page < PageTable.Num(); ++Page)
+	{
+		const FTrajectoryBufferPage& PageEntry = PageTable[Page];
+		const uint32 PageBytes = static_cast<uint32>(PageEntry.NumSamples * sizeof(FVector3f));
+
+		FRHIResourceCreateInfo CreateInfo(TEXT("TrajectoryPositionBufferPage"));
+		PageBuffers[Page] = RHICmdList.CreateStructuredBuffer(sizeof(FVector3f), PageBytes, BUF_ShaderResource | BUF_Static, CreateInfo);
+		PageSRVs[Page] = RHICmdList.CreateShaderResourceView(PageBuffers[Page]);
+
+		// Pages are uploaded one at a time, so no single lock has to map the whole dataset
+		if (PositionData.Num() > 0)
+		{
+			void* PageData = RHICmdList.LockBuffer(PageBuffers[Page], 0, PageBytes, RLM_WriteOnly);
+			FMemory::Memcpy(PageData, PositionData.GetData() + PageEntry.FirstSample, PageBytes);
+			RHICmdList.UnlockBuffer(PageBuffers[Page]);
+		}
+	}
+
+	// Page table as uint4 {FirstSample low, FirstSample high, NumSamples, 0}
+	FRHIResourceCreateInfo PageTableCreateInfo(TEXT("TrajectoryPositionPageTable"));
+	const uint32 PageTableBytes = FMath::Max(PageTable.Num(), 1) * sizeof(FUintVector4);
+	PageTableBuffer = RHICmdList.CreateStructuredBuffer(sizeof(FUintVector4), PageTableBytes, BUF_ShaderResource | BUF_Static, PageTableCreateInfo);
+	PageTableSRV = RHICmdList.CreateShaderResourceView(PageTableBuffer);
+
+	FUintVector4* PageTableData = static_cast<FUintVector4*>(RHICmdList.LockBuffer(PageTableBuffer, 0, PageTableBytes, RLM_WriteOnly));
+	FMemory::Memzero(PageTableData, PageTableBytes);
+	for (int32 Page = 0; Page < PageTable.Num(); ++Page)
+	{
+		const uint64 FirstSample = static_cast<uint64>(PageTable[Page].FirstSample);
+		PageTableData[Page] = FUintVector4(static_cast<uint32>(FirstSample), static_cast<uint32>(FirstSample >> 32), PageTable[Page].NumSamples, 0);
+	}
+	RHICmdList.UnlockBuffer(PageTableBuffer);
+}
+
 void FTrajectoryPositionBufferResource::ReleaseResource()
 {
+	PageTableSRV.SafeRelease();
+	PageTableBuffer.SafeRelease();
+	PageSRVs.Empty();
+	PageBuffers.Empty();
+	RingEntrySRV.SafeRelease();
+	RingEntryBuffer.SafeRelease();
 	BufferSRV.SafeRelease();
 	StructuredBuffer.SafeRelease();
 	FRenderResource::ReleaseResource();
@@ -98,41 +340,61 @@ void FTrajectoryPositionBufferResource::ReleaseResource()
 
 UTrajectoryBufferProvider::UTrajectoryBufferProvider()
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	// Only ticks while a double-buffered update waits for its swap
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
 	PositionBufferResource = new FTrajectoryPositionBufferResource();
 }
 
 UTrajectoryBufferProvider::~UTrajectoryBufferProvider()
 {
-	if (PositionBufferResource)
-	{
-		// Release on render thread
-		FTrajectoryPositionBufferResource* ResourceToDelete = PositionBufferResource;
-		ENQUEUE_RENDER_COMMAND(ReleaseTrajectoryPositionBuffer)(
-			[ResourceToDelete](FRHICommandListImmediate& RHICmdList)
-			{
-				ResourceToDelete->ReleaseResource();
-				delete ResourceToDelete;
-			});
-		PositionBufferResource = nullptr;
-	}
+	ReleaseBufferResource(PositionBufferResource);
+	ReleaseBufferResource(BackBufferResource);
 }
 
 void UTrajectoryBufferProvider::BeginDestroy()
 {
 	Super::BeginDestroy();
 
-	if (PositionBufferResource)
+	ReleaseBufferResource(PositionBufferResource);
+	ReleaseBufferResource(BackBufferResource);
+}
+
+void UTrajectoryBufferProvider::ReleaseBufferResource(FTrajectoryPositionBufferResource*& Resource)
+{
+	if (Resource)
 	{
 		// Release on render thread
-		FTrajectoryPositionBufferResource* ResourceToDelete = PositionBufferResource;
+		FTrajectoryPositionBufferResource* ResourceToDelete = Resource;
 		ENQUEUE_RENDER_COMMAND(ReleaseTrajectoryPositionBuffer)(
 			[ResourceToDelete](FRHICommandListImmediate& RHICmdList)
 			{
 				ResourceToDelete->ReleaseResource();
 				delete ResourceToDelete;
 			});
-		PositionBufferResource = nullptr;
+		Resource = nullptr;
+	}
+}
+
+void UTrajectoryBufferProvider::BuildMetadata(const FLoadedDataset& Dataset, FTrajectoryBufferMetadata& OutMetadata)
+{
+	OutMetadata.NumTrajectories = Dataset.GetNumTrajectories();
+	OutMetadata.FirstTimeStep = Dataset.DatasetInfo.Metadata.FirstTimeStep;
+	OutMetadata.LastTimeStep = Dataset.DatasetInfo.Metadata.LastTimeStep;
+	OutMetadata.TimeStepStride = FMath::Max(Dataset.LoadParams.SampleRate, 1);
+	OutMetadata.BoundsMin = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMin[0],
+								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[1],
+								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[2]);
+	OutMetadata.BoundsMax = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMax[0],
+								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[1],
+								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[2]);
+
+	// Calculate max samples per trajectory
+	OutMetadata.MaxSamplesPerTrajectory = 0;
+	for (int32 TrajIdx = 0; TrajIdx < Dataset.GetNumTrajectories(); ++TrajIdx)
+	{
+		OutMetadata.MaxSamplesPerTrajectory = FMath::Max(OutMetadata.MaxSamplesPerTrajectory, Dataset.GetTrajectoryView(TrajIdx).Samples.Num());
 	}
 }
 
@@ -159,47 +421,49 @@ bool UTrajectoryBufferProvider::UpdateFromDataset(int32 DatasetIndex)
 	}
 
 	const FLoadedDataset& Dataset = LoadedDatasets[DatasetIndex];
-	if (Dataset.Trajectories.Num() == 0)
+	if (Dataset.GetNumTrajectories() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("TrajectoryBufferProvider: Dataset has no trajectories"));
 		return false;
 	}
 
-	// Update metadata
-	Metadata.NumTrajectories = Dataset.Trajectories.Num();
-	Metadata.FirstTimeStep = Dataset.DatasetInfo.Metadata.FirstTimeStep;
-	Metadata.LastTimeStep = Dataset.DatasetInfo.Metadata.LastTimeStep;
-	Metadata.BoundsMin = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMin[0],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[1],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[2]);
-	Metadata.BoundsMax = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMax[0],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[1],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[2]);
+	// A direct update replaces a pending double-buffered one
+	CancelBackBuffer();
 
-	// Calculate max samples per trajectory
-	Metadata.MaxSamplesPerTrajectory = 0;
-	for (const FLoadedTrajectory& Traj : Dataset.Trajectories)
-	{
-		Metadata.MaxSamplesPerTrajectory = FMath::Max(Metadata.MaxSamplesPerTrajectory, Traj.Samples.Num());
-	}
+	// Update metadata
+	BuildMetadata(Dataset, Metadata);
 
 	// GAME THREAD: Pack trajectory data into flat position array
-	// This happens on the game thread - all array building/population is done here
+	// This is driven from the game thread, which fans the copy out to the task graph workers
+	// (sample arenas are already flat - only trajectory info and time steps are generated)
 	TArray<FVector3f> PositionData;
 	PackTrajectories(Dataset, PositionData);
 
-	Metadata.TotalSampleCount = PositionData.Num();
+	Metadata.TotalSampleCount = Dataset.SampleArena.IsValid() ? Dataset.SampleArena->GetTotalSampleCount() : PositionData.Num();
 
 	// THREAD HANDOFF: Transfer data to render thread via Initialize()
 	// Initialize() stores the data and enqueues GPU upload to the render thread
 	// After this call, we don't modify PositionData or the buffer resource data on game thread
+	RingSegments.Reset();
+	RingSession = nullptr;
+
 	if (PositionBufferResource)
 	{
-		PositionBufferResource->InitializeResource();
-		PositionBufferResource->Initialize(MoveTemp(PositionData));
+		PositionBufferResource->SetRequestedPageSize(PageSizeSamples);
+		if (Dataset.SampleArena.IsValid())
+		{
+			PositionBufferResource->Initialize(Dataset.SampleArena);
+		}
+		else
+		{
+			PositionBufferResource->Initialize(MoveTemp(PositionData));
+		}
+		Metadata.PageSizeSamples = PositionBufferResource->GetPageSizeSamples();
+		Metadata.NumPages = PositionBufferResource->GetPageTable().Num();
 	}
+	++DataGeneration;
 
-	UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Updated with %d trajectories, %d total samples, %.2f MB"),
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Updated with %d trajectories, %lld total samples, %.2f MB"),
 		Metadata.NumTrajectories, Metadata.TotalSampleCount, 
 		(Metadata.TotalSampleCount * sizeof(FVector3f)) / (1024.0f * 1024.0f));
 
@@ -215,99 +479,275 @@ int32 UTrajectoryBufferProvider::GetTrajectoryId(int32 TrajectoryIndex) const
 	return -1;
 }
 
+int32 UTrajectoryBufferProvider::GetSampleTimeStep(int32 TrajectoryIndex, int32 SampleIndex) const
+{
+	if (TrajectoryInfo.IsValidIndex(TrajectoryIndex))
+	{
+		return TrajectoryInfo[TrajectoryIndex].GetSampleTimeStep(SampleIndex);
+	}
+	return -1;
+}
+
 TArray<FVector3f> UTrajectoryBufferProvider::GetAllPositions() const
 {
 	if (PositionBufferResource)
 	{
-		return PositionBufferResource->GetCPUPositionData();
+		return TArray<FVector3f>(PositionBufferResource->GetCPUPositionData());
 	}
 	return TArray<FVector3f>();
 }
 
-const TArray<FVector3f>& UTrajectoryBufferProvider::GetAllPositionsRef() const
+TConstArrayView<FVector3f> UTrajectoryBufferProvider::GetAllPositionsRef() const
 {
 	if (PositionBufferResource)
 	{
 		return PositionBufferResource->GetCPUPositionData();
 	}
-	// Return a reference to a thread-local static empty array for thread safety
-	static thread_local TArray<FVector3f> EmptyArray;
-	return EmptyArray;
+	return TConstArrayView<FVector3f>();
 }
 
 void UTrajectoryBufferProvider::PackTrajectories(const FLoadedDataset& Dataset, TArray<FVector3f>& OutPositionData)
 {
-	PackTrajectoriesStatic(Dataset, OutPositionData, SampleTimeSteps, TrajectoryInfo);
+	PackTrajectoriesStatic(Dataset, OutPositionData, SampleTimeSteps, TrajectoryInfo, bGenerateSampleTimeSteps);
+}
+
+namespace TrajectoryBufferPacking
+{
+	/** Trajectories per block of the prefix sum / trajectory info pass */
+	constexpr int32 InfoBlockSize = 16 * 1024;
+
+	/** Samples per fill chunk: 32K samples = 384 KB of positions + 128 KB of time steps, roughly one core's L2 */
+	constexpr int32 SampleChunkSize = 32 * 1024;
+
+	/**
+	 * Run work items on up to MaxWorkers threads; each worker pulls the next item until all are done
+	 * (MaxWorkers <= 0 uses all task graph workers plus the calling thread)
+	 */
+	void RunParallel(int32 NumItems, int32 MaxWorkers, TFunctionRef<void(int32)> Body)
+	{
+		const int32 AvailableWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		const int32 NumWorkers = FMath::Min(MaxWorkers > 0 ? MaxWorkers : AvailableWorkers, NumItems);
+		if (NumWorkers <= 1)
+		{
+			for (int32 ItemIdx = 0; ItemIdx < NumItems; ++ItemIdx)
+			{
+				Body(ItemIdx);
+			}
+			return;
+		}
+
+		std::atomic<int32> NextItem(0);
+		ParallelFor(NumWorkers, [&NextItem, NumItems, &Body](int32 WorkerIdx)
+		{
+			for (int32 ItemIdx = NextItem++; ItemIdx < NumItems; ItemIdx = NextItem++)
+			{
+				Body(ItemIdx);
+			}
+		}, EParallelForFlags::Unbalanced);
+	}
+
 }
 
 void UTrajectoryBufferProvider::PackTrajectoriesStatic(
 	const FLoadedDataset& Dataset,
 	TArray<FVector3f>& OutPositionData,
 	TArray<int32>& OutSampleTimeSteps,
-	TArray<FTrajectoryBufferInfo>& OutTrajectoryInfo)
-{
-	// Calculate total samples needed
-	int32 TotalSamples = 0;
-	for (const FLoadedTrajectory& Traj : Dataset.Trajectories)
-	{
-		TotalSamples += Traj.Samples.Num();
-	}
-
-	// Pre-allocate arrays
-	OutPositionData.Reserve(TotalSamples);
-	OutSampleTimeSteps.Reset();
-	OutSampleTimeSteps.Reserve(TotalSamples);
-	OutTrajectoryInfo.Reset();
-	OutTrajectoryInfo.Reserve(Dataset.Trajectories.Num());
-
-	// Pack all trajectories sequentially
-	int32 CurrentIndex = 0;
-	for (const FLoadedTrajectory& Traj : Dataset.Trajectories)
-	{
-		// Store trajectory info
-		FTrajectoryBufferInfo Info;
-		Info.TrajectoryId = static_cast<int32>(Traj.TrajectoryId);  // Cast int64 to int32
-		Info.StartIndex = CurrentIndex;
-		Info.SampleCount = Traj.Samples.Num();
-		Info.StartTimeStep = Traj.StartTimeStep;
-		Info.EndTimeStep = Traj.EndTimeStep;
-		Info.Extent = Traj.Extent;
-		OutTrajectoryInfo.Add(Info);
-
-		// Copy positions using efficient bulk operations
-		// TArray::Append is optimized for bulk copying and handles all memory operations internally
-		OutPositionData.Append(Traj.Samples);
-
-		// Generate time steps for each sample in this trajectory
-		int32 NumSamples = Traj.Samples.Num();
-		if (NumSamples > 0)
+	TArray<FTrajectoryBufferInfo>& OutTrajectoryInfo,
+	bool bGenerateSampleTimeSteps,
+	int32 MaxWorkers)
+{
+	using namespace TrajectoryBufferPacking;
+
+	const FTrajectorySampleArena* Arena = Dataset.SampleArena.Get();
+	const int32 NumTrajectories = Dataset.GetNumTrajectories();
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumTrajectories, InfoBlockSize);
+
+	OutTrajectoryInfo.SetNumUninitialized(NumTrajectories);
+
+	// Per-trajectory arrays record their grid like sample arenas: sample k at FirstSampleTimeStep + k * SampleRate
+	const int32 LoadSampleRate = FMath::Max(Dataset.LoadParams.SampleRate, 1);
+
+	// Pass 1: sample count per block of trajectories
+	TArray<int64> BlockOffsets;
+	BlockOffsets.SetNumZeroed(NumBlocks + 1);
+	if (!Arena)
+	{
+		RunParallel(NumBlocks, MaxWorkers, [&Dataset, &BlockOffsets, NumTrajectories](int32 BlockIdx)
+		{
+			const int32 BlockEnd = FMath::Min((BlockIdx + 1) * InfoBlockSize, NumTrajectories);
+			int64 BlockSamples = 0;
+			for (int32 TrajIdx = BlockIdx * InfoBlockSize; TrajIdx < BlockEnd; ++TrajIdx)
+			{
+				BlockSamples += Dataset.Trajectories[TrajIdx].Samples.Num();
+			}
+			BlockOffsets[BlockIdx + 1] = BlockSamples;
+		});
+
+		// Exclusive scan over the (few) block sums
+		for (int32 BlockIdx = 0; BlockIdx < NumBlocks; ++BlockIdx)
+		{
+			BlockOffsets[BlockIdx + 1] += BlockOffsets[BlockIdx];
+		}
+	}
+
+	// Indices are 64-bit throughout; only the CPU-side arrays (TArray) are limited to MAX_int32 elements
+	const int64 TotalSamples = Arena ? Arena->GetTotalSampleCount() : BlockOffsets[NumBlocks];
+	checkf(TotalSamples <= MAX_int32, TEXT("CPU position array exceeds %d samples"), MAX_int32);
+
+	// Pass 2: trajectory info, with each block continuing the scan from its block offset
+	// (sample arenas already carry their offsets)
+	RunParallel(NumBlocks, MaxWorkers, [&Dataset, Arena, &BlockOffsets, &OutTrajectoryInfo, NumTrajectories, LoadSampleRate](int32 BlockIdx)
+	{
+		const int32 BlockEnd = FMath::Min((BlockIdx + 1) * InfoBlockSize, NumTrajectories);
+		int64 CurrentIndex = BlockOffsets[BlockIdx];
+		for (int32 TrajIdx = BlockIdx * InfoBlockSize; TrajIdx < BlockEnd; ++TrajIdx)
 		{
-			if (NumSamples == 1)
+			FTrajectoryBufferInfo& Info = OutTrajectoryInfo[TrajIdx];
+			if (Arena)
 			{
-				// Single sample - use start time step
-				OutSampleTimeSteps.Add(Traj.StartTimeStep);
+				Info.TrajectoryId = static_cast<int32>(Arena->TrajectoryIds[TrajIdx]);  // Cast int64 to int32
+				Info.StartIndex = Arena->SampleOffsets[TrajIdx];
+				Info.SampleCount = Arena->SampleCounts[TrajIdx];
+				Info.StartTimeStep = Arena->StartTimeSteps[TrajIdx];
+				Info.EndTimeStep = Arena->EndTimeSteps[TrajIdx];
+				Info.Extent = Arena->Extents[TrajIdx];
+				Info.FirstSampleOffset = Arena->FirstSampleTimeSteps[TrajIdx] - Info.StartTimeStep;
+				Info.TimeStepStride = Arena->SampleRate;
 			}
 			else
 			{
-				// Multiple samples - distribute evenly between start and end time steps
-				for (int32 i = 0; i < NumSamples; ++i)
+				const FLoadedTrajectory& Traj = Dataset.Trajectories[TrajIdx];
+				Info.TrajectoryId = static_cast<int32>(Traj.TrajectoryId);  // Cast int64 to int32
+				Info.StartIndex = CurrentIndex;
+				Info.SampleCount = Traj.Samples.Num();
+				Info.StartTimeStep = Traj.StartTimeStep;
+				Info.EndTimeStep = Traj.EndTimeStep;
+				Info.Extent = Traj.Extent;
+				Info.FirstSampleOffset = Traj.FirstSampleTimeStep - Traj.StartTimeStep;
+				Info.TimeStepStride = LoadSampleRate;
+				CurrentIndex += Info.SampleCount;
+			}
+		}
+	});
+
+	// Pass 3: positions (and time steps) in cache-sized sample chunks. A chunk covers a fixed sample range, so long
+	// trajectories are split across chunks and every worker gets the same amount of work
+	if (bGenerateSampleTimeSteps)
+	{
+		OutSampleTimeSteps.SetNumUninitialized(TotalSamples);
+	}
+	else
+	{
+		OutSampleTimeSteps.Empty();
+	}
+
+	if (Arena)
+	{
+		// Sample arena is already laid out exactly like the position buffer - no position copy needed
+		OutPositionData.Reset();
+		if (!bGenerateSampleTimeSteps)
+		{
+			return;
+		}
+	}
+	else
+	{
+		OutPositionData.SetNumUninitialized(TotalSamples);
+	}
+
+	const int32 NumChunks = static_cast<int32>(FMath::DivideAndRoundUp<int64>(TotalSamples, SampleChunkSize));
+	RunParallel(NumChunks, MaxWorkers, [&](int32 ChunkIdx)
+	{
+		const int64 ChunkStart = (int64)ChunkIdx * SampleChunkSize;
+		const int64 ChunkEnd = FMath::Min(ChunkStart + SampleChunkSize, TotalSamples);
+
+		// Trajectory holding the chunk's first sample: last one starting at or before it
+		int32 TrajIdx = Algo::UpperBoundBy(OutTrajectoryInfo, ChunkStart, &FTrajectoryBufferInfo::StartIndex) - 1;
+		for (; TrajIdx < NumTrajectories && OutTrajectoryInfo[TrajIdx].StartIndex < ChunkEnd; ++TrajIdx)
+		{
+			const FTrajectoryBufferInfo& Info = OutTrajectoryInfo[TrajIdx];
+			const int64 First = FMath::Max(ChunkStart, Info.StartIndex);
+			const int64 Last = FMath::Min(ChunkEnd, Info.StartIndex + Info.SampleCount);
+			if (First >= Last)
+			{
+				continue;
+			}
+
+			if (!Arena)
+			{
+				FMemory::Memcpy(OutPositionData.GetData() + First, Dataset.Trajectories[TrajIdx].Samples.GetData() + (First - Info.StartIndex),
+					(Last - First) * sizeof(FVector3f));
+			}
+
+			// Expanded from the compact time encoding (samples lie on a regular grid)
+			if (bGenerateSampleTimeSteps)
+			{
+				for (int64 SampleIdx = First; SampleIdx < Last; ++SampleIdx)
 				{
-					// Linear interpolation: TimeStep = StartTime + (i / (NumSamples - 1)) * (EndTime - StartTime)
-					float t = static_cast<float>(i) / static_cast<float>(NumSamples - 1);
-					int32 TimeStep = Traj.StartTimeStep + FMath::RoundToInt(t * (Traj.EndTimeStep - Traj.StartTimeStep));
-					OutSampleTimeSteps.Add(TimeStep);
+					OutSampleTimeSteps[SampleIdx] = Info.GetSampleTimeStep(static_cast<int32>(SampleIdx - Info.StartIndex));
 				}
 			}
 		}
+	});
+}
 
-		CurrentIndex += Traj.Samples.Num();
+void UTrajectoryBufferProvider::BenchmarkPacking(int32 DatasetIndex, int32 Iterations)
+{
+	UTrajectoryDataLoader* Loader = UTrajectoryDataLoader::Get();
+	if (!Loader || !Loader->GetLoadedDatasets().IsValidIndex(DatasetIndex))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryBufferProvider: Invalid dataset index %d"), DatasetIndex);
+		return;
 	}
 
-	check(OutPositionData.Num() == TotalSamples);
-	check(OutSampleTimeSteps.Num() == TotalSamples);
-	check(OutTrajectoryInfo.Num() == Dataset.Trajectories.Num());
+	const FLoadedDataset& Dataset = Loader->GetLoadedDatasets()[DatasetIndex];
+	Iterations = FMath::Max(Iterations, 1);
+
+	TArray<FVector3f> PositionData;
+	TArray<int32> TimeSteps;
+	TArray<FTrajectoryBufferInfo> Info;
+
+	// Warm-up: first-touch page faults of the output arrays would otherwise be charged to the first run
+	PackTrajectoriesStatic(Dataset, PositionData, TimeSteps, Info, false, 1);
+
+	UE_LOG(LogTemp, Display, TEXT("TrajectoryBufferProvider: Packing benchmark - %d trajectories, %d samples, %d iterations"),
+		Info.Num(), Dataset.SampleArena.IsValid() ? Dataset.SampleArena->GetTotalSampleCount() : PositionData.Num(), Iterations);
+
+	const int32 AvailableWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	double SingleThreadMs = 0.0;
+	for (int32 NumWorkers = 1; ; NumWorkers = FMath::Min(NumWorkers * 2, AvailableWorkers))
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			PackTrajectoriesStatic(Dataset, PositionData, TimeSteps, Info, false, NumWorkers);
+		}
+		const double AverageMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+		if (NumWorkers == 1)
+		{
+			SingleThreadMs = AverageMs;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("TrajectoryBufferProvider:   %2d workers: %8.2f ms (%.2fx)"),
+			NumWorkers, AverageMs, AverageMs > 0.0 ? SingleThreadMs / AverageMs : 0.0);
+
+		if (NumWorkers >= AvailableWorkers)
+		{
+			break;
+		}
+	}
 }
 
+static FAutoConsoleCommand GTrajectoryBufferPackingBenchmarkCommand(
+	TEXT("TrajectoryData.BenchmarkBufferPacking"),
+	TEXT("Time UTrajectoryBufferProvider packing of a loaded dataset with 1, 2, 4, ... workers. Usage: TrajectoryData.BenchmarkBufferPacking [DatasetIndex=0] [Iterations=5]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const int32 DatasetIndex = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+		const int32 Iterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 5;
+		UTrajectoryBufferProvider::BenchmarkPacking(DatasetIndex, Iterations);
+	}));
+
 void UTrajectoryBufferProvider::ReleaseCPUPositionData()
 {
 	if (PositionBufferResource)
@@ -339,29 +779,21 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 	}
 
 	const FLoadedDataset& Dataset = LoadedDatasets[DatasetIndex];
-	if (Dataset.Trajectories.Num() == 0)
+	if (Dataset.GetNumTrajectories() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("TrajectoryBufferProvider: Dataset has no trajectories"));
 		OnComplete(false);
 		return;
 	}
 
+	// A direct update replaces a pending double-buffered one
+	CancelBackBuffer();
+
 	// Update metadata on game thread (fast)
-	Metadata.NumTrajectories = Dataset.Trajectories.Num();
-	Metadata.FirstTimeStep = Dataset.DatasetInfo.Metadata.FirstTimeStep;
-	Metadata.LastTimeStep = Dataset.DatasetInfo.Metadata.LastTimeStep;
-	Metadata.BoundsMin = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMin[0],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[1],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMin[2]);
-	Metadata.BoundsMax = FVector(Dataset.DatasetInfo.Metadata.BoundingBoxMax[0],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[1],
-								  Dataset.DatasetInfo.Metadata.BoundingBoxMax[2]);
+	BuildMetadata(Dataset, Metadata);
 
-	Metadata.MaxSamplesPerTrajectory = 0;
-	for (const FLoadedTrajectory& Traj : Dataset.Trajectories)
-	{
-		Metadata.MaxSamplesPerTrajectory = FMath::Max(Metadata.MaxSamplesPerTrajectory, Traj.Samples.Num());
-	}
+	// Sample arenas are shared and immutable - keep a reference so the upload can use it without repacking
+	TSharedPtr<const FTrajectorySampleArena> SampleArena = Dataset.SampleArena;
 
 	// Capture a const pointer to the dataset for the background thread.
 	// CONTRACT: The caller must not call UnloadAll() or otherwise modify the loaded datasets
@@ -372,8 +804,10 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 	TWeakObjectPtr<UTrajectoryBufferProvider> WeakThis(this);
 	TWeakObjectPtr<UTrajectoryDataLoader> WeakLoader(Loader);
 
+	const bool bWithSampleTimeSteps = bGenerateSampleTimeSteps;
+
 	// Offload CPU-heavy data packing to a background thread
-	Async(EAsyncExecution::ThreadPool, [WeakThis, WeakLoader, DatasetPtr, OnComplete]()
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WeakLoader, DatasetPtr, SampleArena, bWithSampleTimeSteps, OnComplete]()
 	{
 		// Guard: if the loader has been GC'd the DatasetPtr is no longer safe to use
 		if (!WeakLoader.IsValid())
@@ -391,7 +825,7 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 		TArray<int32> NewSampleTimeSteps;
 		TArray<FTrajectoryBufferInfo> NewTrajectoryInfo;
 
-		PackTrajectoriesStatic(*DatasetPtr, PositionData, NewSampleTimeSteps, NewTrajectoryInfo);
+		PackTrajectoriesStatic(*DatasetPtr, PositionData, NewSampleTimeSteps, NewTrajectoryInfo, bWithSampleTimeSteps);
 
 		// Return to game thread to update class members and initialise GPU buffer
 		Async(EAsyncExecution::TaskGraphMainThread,
@@ -399,6 +833,7 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 			 Positions = MoveTemp(PositionData),
 			 TimeSteps = MoveTemp(NewSampleTimeSteps),
 			 TrajInfo = MoveTemp(NewTrajectoryInfo),
+			 SampleArena,
 			 OnComplete]() mutable
 		{
 			if (!WeakThis.IsValid())
@@ -411,16 +846,28 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 			// Move packed data into class members
 			WeakThis->TrajectoryInfo = MoveTemp(TrajInfo);
 			WeakThis->SampleTimeSteps = MoveTemp(TimeSteps);
-			WeakThis->Metadata.TotalSampleCount = Positions.Num();
+			WeakThis->Metadata.TotalSampleCount = SampleArena.IsValid() ? SampleArena->GetTotalSampleCount() : Positions.Num();
 
 			// Initialise GPU buffer
+			WeakThis->RingSegments.Reset();
+			WeakThis->RingSession = nullptr;
 			if (WeakThis->PositionBufferResource)
 			{
-				WeakThis->PositionBufferResource->InitializeResource();
-				WeakThis->PositionBufferResource->Initialize(MoveTemp(Positions));
+				WeakThis->PositionBufferResource->SetRequestedPageSize(WeakThis->PageSizeSamples);
+				if (SampleArena.IsValid())
+				{
+					WeakThis->PositionBufferResource->Initialize(SampleArena);
+				}
+				else
+				{
+					WeakThis->PositionBufferResource->Initialize(MoveTemp(Positions));
+				}
+				WeakThis->Metadata.PageSizeSamples = WeakThis->PositionBufferResource->GetPageSizeSamples();
+				WeakThis->Metadata.NumPages = WeakThis->PositionBufferResource->GetPageTable().Num();
 			}
+			++WeakThis->DataGeneration;
 
-			UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Async update complete – %d trajectories, %d total samples, %.2f MB"),
+			UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Async update complete – %d trajectories, %lld total samples, %.2f MB"),
 				WeakThis->Metadata.NumTrajectories, WeakThis->Metadata.TotalSampleCount,
 				(WeakThis->Metadata.TotalSampleCount * sizeof(FVector3f)) / (1024.0f * 1024.0f));
 
@@ -429,6 +876,312 @@ void UTrajectoryBufferProvider::UpdateFromDatasetAsync(int32 DatasetIndex, TFunc
 	});
 }
 
+void UTrajectoryBufferProvider::UpdateFromDatasetDoubleBuffered(int32 DatasetIndex, TFunction<void(bool)> OnSwapped)
+{
+	// NOTE: Must be called on the GAME THREAD
+	check(IsInGameThread());
+
+	UTrajectoryDataLoader* Loader = UTrajectoryDataLoader::Get();
+	if (!Loader)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryBufferProvider: TrajectoryLoader not found"));
+		OnSwapped(false);
+		return;
+	}
+
+	const TArray<FLoadedDataset>& LoadedDatasets = Loader->GetLoadedDatasets();
+	if (!LoadedDatasets.IsValidIndex(DatasetIndex))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryBufferProvider: Invalid dataset index %d"), DatasetIndex);
+		OnSwapped(false);
+		return;
+	}
+
+	const FLoadedDataset& Dataset = LoadedDatasets[DatasetIndex];
+	if (Dataset.GetNumTrajectories() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TrajectoryBufferProvider: Dataset has no trajectories"));
+		OnSwapped(false);
+		return;
+	}
+
+	// Only the newest request gets swapped in
+	CancelBackBuffer();
+	const uint32 RequestId = ++BackBufferRequestId;
+	bBackBufferPending = true;
+	OnBackBufferSwapped = MoveTemp(OnSwapped);
+
+	FTrajectoryBufferMetadata NewMetadata;
+	BuildMetadata(Dataset, NewMetadata);
+
+	// Same contract as UpdateFromDatasetAsync: the dataset must stay loaded until the packing is done
+	TSharedPtr<const FTrajectorySampleArena> SampleArena = Dataset.SampleArena;
+	const FLoadedDataset* DatasetPtr = &Dataset;
+
+	TWeakObjectPtr<UTrajectoryBufferProvider> WeakThis(this);
+	TWeakObjectPtr<UTrajectoryDataLoader> WeakLoader(Loader);
+
+	const bool bWithSampleTimeSteps = bGenerateSampleTimeSteps;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, WeakLoader, DatasetPtr, SampleArena, NewMetadata, bWithSampleTimeSteps, RequestId]() mutable
+	{
+		TArray<FVector3f> PositionData;
+		TArray<int32> NewSampleTimeSteps;
+		TArray<FTrajectoryBufferInfo> NewTrajectoryInfo;
+
+		const bool bLoaderValid = WeakLoader.IsValid();
+		if (bLoaderValid)
+		{
+			PackTrajectoriesStatic(*DatasetPtr, PositionData, NewSampleTimeSteps, NewTrajectoryInfo, bWithSampleTimeSteps);
+		}
+
+		Async(EAsyncExecution::TaskGraphMainThread,
+			[WeakThis,
+			 Positions = MoveTemp(PositionData),
+			 TimeSteps = MoveTemp(NewSampleTimeSteps),
+			 TrajInfo = MoveTemp(NewTrajectoryInfo),
+			 SampleArena,
+			 NewMetadata,
+			 bLoaderValid,
+			 RequestId]() mutable
+		{
+			// Superseded requests were already reported as failed by CancelBackBuffer()
+			if (!WeakThis.IsValid() || WeakThis->BackBufferRequestId != RequestId)
+			{
+				return;
+			}
+
+			if (!bLoaderValid)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("TrajectoryBufferProvider: DataLoader was destroyed during async packing"));
+				WeakThis->CancelBackBuffer();
+				return;
+			}
+
+			WeakThis->BackMetadata = NewMetadata;
+			WeakThis->BackMetadata.TotalSampleCount = SampleArena.IsValid() ? SampleArena->GetTotalSampleCount() : Positions.Num();
+			WeakThis->BackTrajectoryInfo = MoveTemp(TrajInfo);
+			WeakThis->BackSampleTimeSteps = MoveTemp(TimeSteps);
+
+			// Upload into the back buffer while the front buffer keeps rendering
+			WeakThis->BackBufferResource = new FTrajectoryPositionBufferResource();
+			WeakThis->BackBufferResource->SetRequestedPageSize(WeakThis->PageSizeSamples);
+			if (SampleArena.IsValid())
+			{
+				WeakThis->BackBufferResource->Initialize(SampleArena);
+			}
+			else
+			{
+				WeakThis->BackBufferResource->Initialize(MoveTemp(Positions));
+			}
+			WeakThis->BackMetadata.PageSizeSamples = WeakThis->BackBufferResource->GetPageSizeSamples();
+			WeakThis->BackMetadata.NumPages = WeakThis->BackBufferResource->GetPageTable().Num();
+			WeakThis->BackBufferFence.BeginFence();
+
+			// The swap happens in the first tick after the fence has passed
+			WeakThis->SetComponentTickEnabled(true);
+		});
+	});
+}
+
+void UTrajectoryBufferProvider::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (BackBufferResource && BackBufferFence.IsFenceComplete())
+	{
+		SwapBackBuffer();
+	}
+	else if (!bBackBufferPending)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UTrajectoryBufferProvider::SwapBackBuffer()
+{
+	check(IsInGameThread());
+
+	// Resource pointer and CPU-side data change together between two frames
+	Swap(PositionBufferResource, BackBufferResource);
+	Metadata = MoveTemp(BackMetadata);
+	TrajectoryInfo = MoveTemp(BackTrajectoryInfo);
+	SampleTimeSteps = MoveTemp(BackSampleTimeSteps);
+	BackMetadata = FTrajectoryBufferMetadata();
+	RingSegments.Reset();
+	RingSession = nullptr;
+
+	// Render commands already queued for the old front buffer still run before its release
+	ReleaseBufferResource(BackBufferResource);
+
+	bBackBufferPending = false;
+	SetComponentTickEnabled(false);
+	++DataGeneration;
+
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Swapped in back buffer – %d trajectories, %lld total samples, %.2f MB"),
+		Metadata.NumTrajectories, Metadata.TotalSampleCount,
+		(Metadata.TotalSampleCount * sizeof(FVector3f)) / (1024.0f * 1024.0f));
+
+	TFunction<void(bool)> OnSwapped = MoveTemp(OnBackBufferSwapped);
+	OnBackBufferSwapped = nullptr;
+	if (OnSwapped)
+	{
+		OnSwapped(true);
+	}
+}
+
+void UTrajectoryBufferProvider::CancelBackBuffer()
+{
+	if (!bBackBufferPending)
+	{
+		return;
+	}
+
+	++BackBufferRequestId;
+	bBackBufferPending = false;
+	ReleaseBufferResource(BackBufferResource);
+	BackMetadata = FTrajectoryBufferMetadata();
+	BackTrajectoryInfo.Empty();
+	BackSampleTimeSteps.Empty();
+
+	TFunction<void(bool)> OnSwapped = MoveTemp(OnBackBufferSwapped);
+	OnBackBufferSwapped = nullptr;
+	if (OnSwapped)
+	{
+		OnSwapped(false);
+	}
+}
+
+int32 UTrajectoryBufferProvider::UpdateFromStreamingSession(const FTrajectoryStreamingSession& Session, int32 NumSegments)
+{
+	check(IsInGameThread());
+
+	if (!PositionBufferResource)
+	{
+		return 0;
+	}
+
+	TArray<TSharedPtr<const FTrajectoryStreamedInterval>> ResidentIntervals;
+	Session.GetResidentIntervals(ResidentIntervals);
+	if (ResidentIntervals.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Trajectory indices are the same in every interval of a session
+	const int32 NumTrajectories = ResidentIntervals[0]->SampleArena.IsValid() ? ResidentIntervals[0]->SampleArena->Num() : 0;
+	const int32 SampleRate = FMath::Max(Session.GetParams().LoadParams.SampleRate, 1);
+	const int32 IntervalSize = FMath::Max(Session.GetDatasetInfo().Metadata.TimeStepIntervalSize, 1);
+	const int32 SamplesPerSegment = NumTrajectories * ((IntervalSize - 1) / SampleRate + 1);
+	if (NumSegments <= 0)
+	{
+		const FTrajectoryStreamingParams& StreamingParams = Session.GetParams();
+		NumSegments = 1 + FMath::Max(StreamingParams.KeepBehindIntervals, 0) + FMath::DivideAndRoundUp(FMath::Max(StreamingParams.WindowTimeSteps, 0), IntervalSize) +
+			FMath::Max(StreamingParams.MaxConcurrentLoads, 1);
+	}
+
+	// (Re)create the ring only when the session or its dimensions change
+	if (RingSession != &Session || !PositionBufferResource->IsRingLayout() || RingSegments.Num() != NumSegments ||
+		PositionBufferResource->GetRingNumTrajectories() != NumTrajectories ||
+		PositionBufferResource->GetRingSamplesPerSegment() != SamplesPerSegment)
+	{
+		PositionBufferResource->InitializeRing(NumTrajectories, NumSegments, SamplesPerSegment);
+		RingSegments.Reset();
+		RingSegments.SetNum(NumSegments);
+		RingSession = &Session;
+
+		TrajectoryInfo.Reset();
+		SampleTimeSteps.Reset();
+		Metadata.NumTrajectories = NumTrajectories;
+		Metadata.TotalSampleCount = (int64)NumSegments * SamplesPerSegment;
+		Metadata.PageSizeSamples = 0;
+		Metadata.NumPages = 0;
+		Metadata.MaxSamplesPerTrajectory = (IntervalSize - 1) / SampleRate + 1;
+		Metadata.FirstTimeStep = Session.GetStartTimeStep();
+		Metadata.LastTimeStep = Session.GetEndTimeStep();
+		Metadata.TimeStepStride = SampleRate;
+
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryBufferProvider: Created ring buffer with %d segments of %d samples (%.2f MB)"),
+			NumSegments, SamplesPerSegment, ((int64)NumSegments * SamplesPerSegment * sizeof(FVector3f)) / (1024.0f * 1024.0f));
+	}
+
+	// Segments whose interval is no longer resident can be reused
+	TArray<int32> FreeSegments;
+	for (int32 Segment = RingSegments.Num() - 1; Segment >= 0; --Segment)
+	{
+		const FRingSegment& RingSegment = RingSegments[Segment];
+		const bool bStillResident = RingSegment.EndTimeStep >= RingSegment.StartTimeStep &&
+			ResidentIntervals.ContainsByPredicate([&RingSegment](const TSharedPtr<const FTrajectoryStreamedInterval>& Interval)
+			{
+				return Interval->StartTimeStep == RingSegment.StartTimeStep;
+			});
+		if (!bStillResident)
+		{
+			FreeSegments.Add(Segment);
+		}
+	}
+
+	// Upload newly resident intervals, nearest to the cursor first (the rest waits for a free segment)
+	const float Cursor = Session.GetCursor();
+	ResidentIntervals.Sort([Cursor](const TSharedPtr<const FTrajectoryStreamedInterval>& A, const TSharedPtr<const FTrajectoryStreamedInterval>& B)
+	{
+		return FMath::Abs(A->StartTimeStep - Cursor) < FMath::Abs(B->StartTimeStep - Cursor);
+	});
+
+	int32 NumUploaded = 0;
+	for (const TSharedPtr<const FTrajectoryStreamedInterval>& Interval : ResidentIntervals)
+	{
+		if (FindRingSegment(Interval->StartTimeStep) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		if (FreeSegments.Num() == 0)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("TrajectoryBufferProvider: No free ring segment for interval %d-%d"), Interval->StartTimeStep, Interval->EndTimeStep);
+			break;
+		}
+
+		const int32 Segment = FreeSegments.Pop(EAllowShrinking::No);
+		if (PositionBufferResource->UploadRingSegment(Segment, Interval->SampleArena))
+		{
+			RingSegments[Segment].StartTimeStep = Interval->StartTimeStep;
+			RingSegments[Segment].EndTimeStep = Interval->EndTimeStep;
+			++NumUploaded;
+		}
+		else
+		{
+			RingSegments[Segment] = FRingSegment();
+		}
+	}
+
+	return NumUploaded;
+}
+
+int32 UTrajectoryBufferProvider::FindRingSegment(int32 TimeStep) const
+{
+	for (int32 Segment = 0; Segment < RingSegments.Num(); ++Segment)
+	{
+		if (TimeStep >= RingSegments[Segment].StartTimeStep && TimeStep <= RingSegments[Segment].EndTimeStep)
+		{
+			return Segment;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FShaderResourceViewRHIRef FTrajectoryPositionBufferResource::GetBufferSRV() const
+{
+	// A paged resource has no single buffer; binding one page would silently read the wrong samples
+	if (IsPaged())
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryPositionBufferResource: GetBufferSRV() called on a paged resource (%d pages), use GetPageSRV() and GetPageTableSRV()"),
+			PageTable.Num());
+		return FShaderResourceViewRHIRef();
+	}
+	return BufferSRV;
+}
+
 // Initialize the resource
 void FTrajectoryPositionBufferResource::InitializeResource()
 {
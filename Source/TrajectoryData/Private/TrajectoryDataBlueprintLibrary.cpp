@@ -265,7 +265,7 @@ int32 UTrajectoryDataBlueprintLibrary::GetNumLoadedTrajectories()
 		int32 TotalCount = 0;
 		for (const FLoadedDataset& Dataset : Loader->GetLoadedDatasets())
 		{
-			TotalCount += Dataset.Trajectories.Num();
+			TotalCount += Dataset.GetNumTrajectories();
 		}
 		return TotalCount;
 	}
@@ -2,32 +2,79 @@
 
 #include "TrajectoryDataCppApi.h"
 #include "TrajectoryDataStructures.h"
+#include "TrajectoryShardCodec.h"
+#include "TrajectoryShardReader.h"
+#include "TrajectoryDataLoader.h"
+#include "TrajectoryDataSettings.h"
 #include "Misc/Paths.h"
-#include "Misc/FileHelper.h"
 #include "HAL/PlatformFileManager.h"
-#include "HAL/RunnableThread.h"
 #include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
+#include "HAL/Thread.h"
 #include "Async/Async.h"
+#include <limits>
 
 FTrajectoryDataCppApi* FTrajectoryDataCppApi::Instance = nullptr;
 FCriticalSection FTrajectoryDataCppApi::InstanceMutex;
 
 FTrajectoryDataCppApi::FTrajectoryDataCppApi()
+	: NumActiveWorkers(0)
+	, NumRunningTasks(0)
+	, NextSequenceNumber(0)
+	, bShuttingDown(false)
+	, NumCompletedTasks(0)
+	, NumRejectedTasks(0)
+	, NumCoalescedTasks(0)
+	, NumBatches(0)
+	, TotalQueueLatencySeconds(0.0)
+	, MaxQueueLatencySeconds(0.0)
+	, TotalExecutionSeconds(0.0)
+	, SchedulerEvent(FPlatformProcess::GetSynchEventFromPool(false))
 {
+	SchedulerThread = MakeUnique<FThread>(TEXT("TrajectoryQueryScheduler"), [this]()
+	{
+		RunScheduler();
+	});
 }
 
 FTrajectoryDataCppApi::~FTrajectoryDataCppApi()
 {
-	// Wait for all tasks to complete
-	FScopeLock Lock(&TaskMutex);
-	for (TSharedPtr<FTrajectoryQueryTask>& Task : ActiveTasks)
+	// Fail queued tasks (their callbacks still fire, with an error) and stop accepting new ones
+	TArray<TSharedPtr<FTrajectoryQueryTask>> DroppedTasks;
+	{
+		FScopeLock Lock(&TaskMutex);
+		bShuttingDown = true;
+		DroppedTasks = MoveTemp(PendingTasks);
+		PendingTasks.Empty();
+	}
+
+	for (const TSharedPtr<FTrajectoryQueryTask>& Task : DroppedTasks)
+	{
+		Task->Cancel();
+		Task->Fail(TEXT("Trajectory query API is shutting down"));
+		FTrajectoryQueryTask::InvokeCallbackOnGameThread(Task);
+	}
+
+	SchedulerEvent->Trigger();
+	SchedulerThread->Join();
+	SchedulerThread.Reset();
+
+	// Workers reference this instance - wait until all of them have returned
+	for (;;)
 	{
-		if (Task.IsValid())
 		{
-			Task->Stop();
+			FScopeLock Lock(&TaskMutex);
+			if (NumActiveWorkers == 0)
+			{
+				break;
+			}
 		}
+		FPlatformProcess::Sleep(0.001f);
 	}
-	ActiveTasks.Empty();
+
+	FPlatformProcess::ReturnSynchEventToPool(SchedulerEvent);
+	SchedulerEvent = nullptr;
 }
 
 FTrajectoryDataCppApi* FTrajectoryDataCppApi::Get()
@@ -44,31 +91,212 @@ FTrajectoryDataCppApi* FTrajectoryDataCppApi::Get()
 	return Instance;
 }
 
-void FTrajectoryDataCppApi::CleanupCompletedTasks()
+bool FTrajectoryDataCppApi::IsTaskOrderedBefore(const TSharedPtr<FTrajectoryQueryTask>& A, const TSharedPtr<FTrajectoryQueryTask>& B)
+{
+	if (A->Priority != B->Priority)
+	{
+		return A->Priority > B->Priority;
+	}
+	return A->SequenceNumber < B->SequenceNumber;
+}
+
+bool FTrajectoryDataCppApi::SubmitTask(const TSharedPtr<FTrajectoryQueryTask>& Task)
+{
+	const UTrajectoryDataSettings* Settings = UTrajectoryDataSettings::Get();
+	const int32 MaxQueued = FMath::Max(1, Settings->MaxQueuedQueries);
+
+	{
+		FScopeLock Lock(&TaskMutex);
+		if (bShuttingDown)
+		{
+			return false;
+		}
+
+		// Back-pressure: refuse new work instead of letting the queue (and its latency) grow without bound
+		if (PendingTasks.Num() >= MaxQueued)
+		{
+			++NumRejectedTasks;
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataCppApi: Query queue is full (%d queued), rejecting query for %s"),
+				PendingTasks.Num(), *Task->DatasetPath);
+			return false;
+		}
+
+		Task->SequenceNumber = NextSequenceNumber++;
+		Task->SubmitTime = FPlatformTime::Seconds();
+		PendingTasks.HeapPush(Task, [](const TSharedPtr<FTrajectoryQueryTask>& A, const TSharedPtr<FTrajectoryQueryTask>& B)
+		{
+			return IsTaskOrderedBefore(A, B);
+		});
+	}
+
+	SchedulerEvent->Trigger();
+	return true;
+}
+
+void FTrajectoryDataCppApi::RunScheduler()
+{
+	TArray<TSharedPtr<FTrajectoryQueryTask>> Batch;
+	for (;;)
+	{
+		const UTrajectoryDataSettings* Settings = UTrajectoryDataSettings::Get();
+		const double CoalescingWindowSeconds = FMath::Max(0.0f, Settings->QueryCoalescingWindowMs) / 1000.0;
+		const int32 MaxWorkers = FMath::Max(1, Settings->MaxConcurrentQueries);
+		const int32 MaxBatchSize = FMath::Max(1, Settings->MaxCoalescedQueries);
+
+		// Time until the next task may start, negative to wait for the next trigger (new task, finished worker, shutdown)
+		double WaitSeconds = -1.0;
+		{
+			FScopeLock Lock(&TaskMutex);
+			if (bShuttingDown)
+			{
+				return;
+			}
+
+			if (PendingTasks.Num() > 0 && NumActiveWorkers < MaxWorkers)
+			{
+				// Give queries submitted right after this one (e.g. by other systems in the same frame) a chance to join the batch
+				const double RemainingWindow = PendingTasks.HeapTop()->SubmitTime + CoalescingWindowSeconds - FPlatformTime::Seconds();
+				if (RemainingWindow > 0.0)
+				{
+					WaitSeconds = RemainingWindow;
+				}
+				else
+				{
+					PopBatch(MaxBatchSize, Batch);
+					++NumActiveWorkers;
+				}
+			}
+		}
+
+		if (Batch.Num() > 0)
+		{
+			// Workers run on the shared thread pool instead of a dedicated OS thread per query
+			// Note: Capturing 'this' is safe because the destructor waits for all workers to return
+			Async(EAsyncExecution::ThreadPool, [this, Batch = MoveTemp(Batch)]()
+			{
+				RunBatch(Batch);
+			});
+			Batch.Reset();
+			continue;
+		}
+
+		if (WaitSeconds >= 0.0)
+		{
+			SchedulerEvent->Wait(static_cast<uint32>(FMath::CeilToDouble(WaitSeconds * 1000.0)));
+		}
+		else
+		{
+			SchedulerEvent->Wait();
+		}
+	}
+}
+
+void FTrajectoryDataCppApi::PopBatch(int32 MaxBatchSize, TArray<TSharedPtr<FTrajectoryQueryTask>>& OutBatch)
 {
+	TSharedPtr<FTrajectoryQueryTask> Task;
+	PendingTasks.HeapPop(Task, [](const TSharedPtr<FTrajectoryQueryTask>& A, const TSharedPtr<FTrajectoryQueryTask>& B)
+	{
+		return IsTaskOrderedBefore(A, B);
+	}, EAllowShrinking::No);
+	OutBatch.Add(Task);
+
+	// Pull all queued queries of the same dataset into the batch, whatever their priority:
+	// sharing the shard pass only makes them finish earlier
+	if (MaxBatchSize > 1)
+	{
+		const FString& BatchDatasetPath = Task->DatasetPath;
+		const int32 NumPendingBefore = PendingTasks.Num();
+		PendingTasks.RemoveAll([&OutBatch, &BatchDatasetPath, MaxBatchSize](const TSharedPtr<FTrajectoryQueryTask>& Pending)
+		{
+			if (OutBatch.Num() < MaxBatchSize && Pending->DatasetPath == BatchDatasetPath)
+			{
+				OutBatch.Add(Pending);
+				return true;
+			}
+			return false;
+		});
+
+		if (PendingTasks.Num() != NumPendingBefore)
+		{
+			PendingTasks.Heapify([](const TSharedPtr<FTrajectoryQueryTask>& A, const TSharedPtr<FTrajectoryQueryTask>& B)
+			{
+				return IsTaskOrderedBefore(A, B);
+			});
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (const TSharedPtr<FTrajectoryQueryTask>& BatchTask : OutBatch)
+	{
+		const double QueueLatency = StartTime - BatchTask->SubmitTime;
+		TotalQueueLatencySeconds += QueueLatency;
+		MaxQueueLatencySeconds = FMath::Max(MaxQueueLatencySeconds, QueueLatency);
+	}
+	NumRunningTasks += OutBatch.Num();
+	NumCoalescedTasks += OutBatch.Num() - 1;
+}
+
+void FTrajectoryDataCppApi::RunBatch(const TArray<TSharedPtr<FTrajectoryQueryTask>>& Batch)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FTrajectoryQueryTask::ExecuteBatch(Batch);
+
+	// Demultiplex: each query gets its own result on its own delegate
+	for (const TSharedPtr<FTrajectoryQueryTask>& Task : Batch)
+	{
+		FTrajectoryQueryTask::InvokeCallbackOnGameThread(Task);
+	}
+
 	FScopeLock Lock(&TaskMutex);
-	
-	// Remove completed tasks
-	ActiveTasks.RemoveAll([](const TSharedPtr<FTrajectoryQueryTask>& Task) {
-		return Task.IsValid() && Task->IsComplete();
-	});
+	TotalExecutionSeconds += (FPlatformTime::Seconds() - StartTime) * Batch.Num();
+	NumCompletedTasks += Batch.Num();
+	NumRunningTasks -= Batch.Num();
+	++NumBatches;
+	--NumActiveWorkers;
+
+	// A worker slot is free again. Triggered under the lock: once NumActiveWorkers is released the destructor may proceed
+	SchedulerEvent->Trigger();
+}
+
+FTrajectoryQueryStats FTrajectoryDataCppApi::GetStats() const
+{
+	FScopeLock Lock(&TaskMutex);
+
+	FTrajectoryQueryStats Stats;
+	Stats.QueuedQueries = PendingTasks.Num();
+	Stats.RunningQueries = NumRunningTasks;
+	Stats.CompletedQueries = NumCompletedTasks;
+	Stats.RejectedQueries = NumRejectedTasks;
+	Stats.CoalescedQueries = NumCoalescedTasks;
+	Stats.Batches = NumBatches;
+	Stats.MaxQueueLatencyMs = MaxQueueLatencySeconds * 1000.0;
+
+	// Queue latency is recorded when a task starts, execution time when it finishes
+	const int64 NumStartedTasks = NumCompletedTasks + NumRunningTasks;
+	if (NumStartedTasks > 0)
+	{
+		Stats.AverageQueueLatencyMs = TotalQueueLatencySeconds * 1000.0 / NumStartedTasks;
+	}
+	if (NumCompletedTasks > 0)
+	{
+		Stats.AverageExecutionMs = TotalExecutionSeconds * 1000.0 / NumCompletedTasks;
+	}
+
+	return Stats;
 }
 
 bool FTrajectoryDataCppApi::QuerySingleTimeStepAsync(
 	const FString& DatasetPath,
 	const TArray<int64>& TrajectoryIds,
 	int32 TimeStep,
-	FOnTrajectoryQueryComplete OnComplete)
+	FOnTrajectoryQueryComplete OnComplete,
+	ETrajectoryQueryPriority Priority)
 {
 	if (DatasetPath.IsEmpty() || TrajectoryIds.Num() == 0)
 	{
 		return false;
 	}
 	
-	// Clean up old tasks
-	CleanupCompletedTasks();
-	
-	// Create new query task
 	TSharedPtr<FTrajectoryQueryTask> Task = MakeShared<FTrajectoryQueryTask>(
 		FTrajectoryQueryTask::EQueryType::SingleTimeStep,
 		DatasetPath,
@@ -76,16 +304,11 @@ bool FTrajectoryDataCppApi::QuerySingleTimeStepAsync(
 		TimeStep,
 		TimeStep,
 		OnComplete,
-		FOnTrajectoryTimeRangeComplete()
+		FOnTrajectoryTimeRangeComplete(),
+		Priority
 	);
 	
-	// Add to active tasks
-	{
-		FScopeLock Lock(&TaskMutex);
-		ActiveTasks.Add(Task);
-	}
-	
-	return true;
+	return SubmitTask(Task);
 }
 
 bool FTrajectoryDataCppApi::QueryTimeRangeAsync(
@@ -93,17 +316,14 @@ bool FTrajectoryDataCppApi::QueryTimeRangeAsync(
 	const TArray<int64>& TrajectoryIds,
 	int32 StartTimeStep,
 	int32 EndTimeStep,
-	FOnTrajectoryTimeRangeComplete OnComplete)
+	FOnTrajectoryTimeRangeComplete OnComplete,
+	ETrajectoryQueryPriority Priority)
 {
 	if (DatasetPath.IsEmpty() || TrajectoryIds.Num() == 0 || StartTimeStep > EndTimeStep)
 	{
 		return false;
 	}
 	
-	// Clean up old tasks
-	CleanupCompletedTasks();
-	
-	// Create new query task
 	TSharedPtr<FTrajectoryQueryTask> Task = MakeShared<FTrajectoryQueryTask>(
 		FTrajectoryQueryTask::EQueryType::TimeRange,
 		DatasetPath,
@@ -111,16 +331,63 @@ bool FTrajectoryDataCppApi::QueryTimeRangeAsync(
 		StartTimeStep,
 		EndTimeStep,
 		FOnTrajectoryQueryComplete(),
-		OnComplete
+		OnComplete,
+		Priority
 	);
 	
-	// Add to active tasks
+	return SubmitTask(Task);
+}
+
+bool FTrajectoryDataCppApi::QueryTimeRangeStreamingAsync(
+	const FString& DatasetPath,
+	const TArray<int64>& TrajectoryIds,
+	int32 StartTimeStep,
+	int32 EndTimeStep,
+	FOnTrajectoryChunk OnChunk,
+	FOnTrajectoryStreamComplete OnComplete,
+	ETrajectoryQueryPriority Priority)
+{
+	if (DatasetPath.IsEmpty() || TrajectoryIds.Num() == 0 || StartTimeStep > EndTimeStep || !OnChunk.IsBound())
 	{
-		FScopeLock Lock(&TaskMutex);
-		ActiveTasks.Add(Task);
+		return false;
 	}
 	
-	return true;
+	TSharedPtr<FTrajectoryQueryTask> Task = MakeShared<FTrajectoryQueryTask>(
+		DatasetPath,
+		TrajectoryIds,
+		StartTimeStep,
+		EndTimeStep,
+		OnChunk,
+		OnComplete,
+		Priority
+	);
+	
+	return SubmitTask(Task);
+}
+
+bool FTrajectoryDataCppApi::QueryPositionsAtTimeAsync(
+	const FString& DatasetPath,
+	const TArray<int64>& TrajectoryIds,
+	double Time,
+	ETrajectoryInterpolation Interpolation,
+	FOnTrajectoryInterpolatedComplete OnComplete,
+	ETrajectoryQueryPriority Priority)
+{
+	if (DatasetPath.IsEmpty() || TrajectoryIds.Num() == 0 || !FMath::IsFinite(Time))
+	{
+		return false;
+	}
+	
+	TSharedPtr<FTrajectoryQueryTask> Task = MakeShared<FTrajectoryQueryTask>(
+		DatasetPath,
+		TrajectoryIds,
+		Time,
+		Interpolation,
+		OnComplete,
+		Priority
+	);
+	
+	return SubmitTask(Task);
 }
 
 // ============================================================================
@@ -134,7 +401,8 @@ FTrajectoryQueryTask::FTrajectoryQueryTask(
 	int32 InStartTimeStep,
 	int32 InEndTimeStep,
 	FOnTrajectoryQueryComplete InSingleCallback,
-	FOnTrajectoryTimeRangeComplete InRangeCallback)
+	FOnTrajectoryTimeRangeComplete InRangeCallback,
+	ETrajectoryQueryPriority InPriority)
 	: QueryType(InQueryType)
 	, DatasetPath(InDatasetPath)
 	, TrajectoryIds(InTrajectoryIds)
@@ -142,501 +410,655 @@ FTrajectoryQueryTask::FTrajectoryQueryTask(
 	, EndTimeStep(InEndTimeStep)
 	, SingleTimeStepCallback(InSingleCallback)
 	, TimeRangeCallback(InRangeCallback)
-	, Thread(nullptr)
+	, Loader(UTrajectoryDataLoader::Get())
+	, Priority(InPriority)
+	, SequenceNumber(0)
+	, SubmitTime(0.0)
 	, bShouldStop(false)
-	, bIsComplete(false)
+	, bFailed(false)
+	, ChunkStartTimeStep(0)
+	, ChunkEndTimeStep(-1)
+	, Interpolation(ETrajectoryInterpolation::Linear)
+	, FirstTapTimeStep(0)
 {
-	// Create and start thread
-	Thread = FRunnableThread::Create(this, TEXT("TrajectoryQueryTask"));
 }
 
-FTrajectoryQueryTask::~FTrajectoryQueryTask()
+FTrajectoryQueryTask::FTrajectoryQueryTask(
+	const FString& InDatasetPath,
+	const TArray<int64>& InTrajectoryIds,
+	int32 InStartTimeStep,
+	int32 InEndTimeStep,
+	FOnTrajectoryChunk InChunkVisitor,
+	FOnTrajectoryStreamComplete InStreamCallback,
+	ETrajectoryQueryPriority InPriority)
+	: QueryType(EQueryType::TimeRangeStream)
+	, DatasetPath(InDatasetPath)
+	, TrajectoryIds(InTrajectoryIds)
+	, StartTimeStep(InStartTimeStep)
+	, EndTimeStep(InEndTimeStep)
+	, ChunkVisitor(InChunkVisitor)
+	, StreamCallback(InStreamCallback)
+	, Loader(UTrajectoryDataLoader::Get())
+	, Priority(InPriority)
+	, SequenceNumber(0)
+	, SubmitTime(0.0)
+	, bShouldStop(false)
+	, bFailed(false)
+	, ChunkStartTimeStep(0)
+	, ChunkEndTimeStep(-1)
+	, Interpolation(ETrajectoryInterpolation::Linear)
+	, FirstTapTimeStep(0)
 {
-	if (Thread)
-	{
-		// Request graceful stop
-		Stop();
-		
-		// Wait for thread to complete
-		Thread->WaitForCompletion();
-		
-		delete Thread;
-		Thread = nullptr;
-	}
 }
 
-bool FTrajectoryQueryTask::Init()
+FTrajectoryQueryTask::FTrajectoryQueryTask(
+	const FString& InDatasetPath,
+	const TArray<int64>& InTrajectoryIds,
+	double InTime,
+	ETrajectoryInterpolation InInterpolation,
+	FOnTrajectoryInterpolatedComplete InInterpolatedCallback,
+	ETrajectoryQueryPriority InPriority)
+	: QueryType(EQueryType::Interpolated)
+	, DatasetPath(InDatasetPath)
+	, TrajectoryIds(InTrajectoryIds)
+	, StartTimeStep(0)
+	, EndTimeStep(-1)
+	, InterpolatedCallback(InInterpolatedCallback)
+	, Loader(UTrajectoryDataLoader::Get())
+	, Priority(InPriority)
+	, SequenceNumber(0)
+	, SubmitTime(0.0)
+	, bShouldStop(false)
+	, bFailed(false)
+	, ChunkStartTimeStep(0)
+	, ChunkEndTimeStep(-1)
+	, Interpolation(InInterpolation)
+	, FirstTapTimeStep(0)
 {
-	return true;
+	InterpolatedResult.Time = InTime;
 }
 
-uint32 FTrajectoryQueryTask::Run()
+void FTrajectoryQueryTask::Fail(const FString& InErrorMessage)
 {
-	// Execute the appropriate query type
+	bFailed = true;
 	if (QueryType == EQueryType::SingleTimeStep)
 	{
-		ExecuteSingleTimeStepQuery();
+		SingleResult.bSuccess = false;
+		SingleResult.ErrorMessage = InErrorMessage;
+		SingleResult.Samples.Reset();
+	}
+	else if (QueryType == EQueryType::TimeRange)
+	{
+		RangeResult.bSuccess = false;
+		RangeResult.ErrorMessage = InErrorMessage;
+		RangeResult.TimeSeries.Reset();
+	}
+	else if (QueryType == EQueryType::TimeRangeStream)
+	{
+		StreamResult.bSuccess = false;
+		StreamResult.ErrorMessage = InErrorMessage;
 	}
 	else
 	{
-		ExecuteTimeRangeQuery();
+		InterpolatedResult.bSuccess = false;
+		InterpolatedResult.ErrorMessage = InErrorMessage;
+		InterpolatedResult.TrajectoryIds.Reset();
+		InterpolatedResult.Positions.Reset();
 	}
-	
-	// Invoke callback on game thread
-	InvokeCallbackOnGameThread();
-	
-	bIsComplete = true;
-	return 0;
 }
 
-void FTrajectoryQueryTask::Stop()
+bool FTrajectoryQueryTask::Prepare(const FTrajectoryDatasetHandle& DatasetHandle)
 {
-	bShouldStop = true;
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle.DatasetMeta;
+
+	if (QueryType == EQueryType::SingleTimeStep)
+	{
+		// Validate time step
+		if (StartTimeStep < DatasetMeta.FirstTimeStep || StartTimeStep > DatasetMeta.LastTimeStep)
+		{
+			Fail(FString::Printf(
+				TEXT("Time step %d is out of range [%d, %d]"),
+				StartTimeStep, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep));
+			return false;
+		}
+
+		bool bHasShard = false;
+		for (const auto& ShardEntry : DatasetHandle.ShardInfoTable)
+		{
+			bHasShard |= ShardEntry.Value.ContainsTimeRange(StartTimeStep, StartTimeStep);
+		}
+		if (!bHasShard)
+		{
+			Fail(FString::Printf(TEXT("Shard file not found for time step %d in %s"), StartTimeStep, *DatasetPath));
+			return false;
+		}
+
+		// One result slot per requested trajectory (duplicates dropped); slots without a sample are removed by Finish
+		ResultIndexById.Reserve(TrajectoryIds.Num());
+		SingleResult.Samples.Reserve(TrajectoryIds.Num());
+		for (int64 TrajId : TrajectoryIds)
+		{
+			if (!ResultIndexById.Contains(TrajId))
+			{
+				ResultIndexById.Add(TrajId, SingleResult.Samples.Num());
+				SingleResult.Samples.Add(FTrajectorySample(TrajId, StartTimeStep, FVector::ZeroVector, false));
+			}
+		}
+		SampleFound.Init(false, SingleResult.Samples.Num());
+	}
+	else if (QueryType == EQueryType::TimeRangeStream)
+	{
+		// Validate time range
+		if (StartTimeStep < DatasetMeta.FirstTimeStep || EndTimeStep > DatasetMeta.LastTimeStep)
+		{
+			Fail(FString::Printf(
+				TEXT("Time range [%d, %d] is out of dataset range [%d, %d]"),
+				StartTimeStep, EndTimeStep, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep));
+			return false;
+		}
+
+		// Only IDs are kept per query; samples live in the chunk of the shard being processed
+		ResultIndexById.Reserve(TrajectoryIds.Num());
+		StreamTrajectoryIds.Reserve(TrajectoryIds.Num());
+		for (int64 TrajId : TrajectoryIds)
+		{
+			if (!ResultIndexById.Contains(TrajId))
+			{
+				ResultIndexById.Add(TrajId, StreamTrajectoryIds.Num());
+				StreamTrajectoryIds.Add(TrajId);
+			}
+		}
+		ChunkRowByResultIndex.Init(INDEX_NONE, StreamTrajectoryIds.Num());
+	}
+	else if (QueryType == EQueryType::Interpolated)
+	{
+		const double Time = InterpolatedResult.Time;
+		if (!(Time >= DatasetMeta.FirstTimeStep && Time <= DatasetMeta.LastTimeStep))
+		{
+			Fail(FString::Printf(
+				TEXT("Time %f is out of range [%d, %d]"),
+				Time, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep));
+			return false;
+		}
+
+		// Read the four time steps around Time (clamped to the dataset; missing taps stay NaN)
+		const int32 BaseTimeStep = FMath::FloorToInt32(Time);
+		FirstTapTimeStep = BaseTimeStep - 1;
+		StartTimeStep = FMath::Max(FirstTapTimeStep, DatasetMeta.FirstTimeStep);
+		EndTimeStep = FMath::Min(FirstTapTimeStep + FTrajectoryInterpolationTaps::NumTaps - 1, DatasetMeta.LastTimeStep);
+
+		ResultIndexById.Reserve(TrajectoryIds.Num());
+		InterpolatedResult.TrajectoryIds.Reserve(TrajectoryIds.Num());
+		for (int64 TrajId : TrajectoryIds)
+		{
+			if (!ResultIndexById.Contains(TrajId))
+			{
+				ResultIndexById.Add(TrajId, InterpolatedResult.TrajectoryIds.Num());
+				InterpolatedResult.TrajectoryIds.Add(TrajId);
+			}
+		}
+		InterpolationTaps.Init(InterpolatedResult.TrajectoryIds.Num());
+	}
+	else
+	{
+		// Validate time range
+		if (StartTimeStep < DatasetMeta.FirstTimeStep || EndTimeStep > DatasetMeta.LastTimeStep)
+		{
+			Fail(FString::Printf(
+				TEXT("Time range [%d, %d] is out of dataset range [%d, %d]"),
+				StartTimeStep, EndTimeStep, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep));
+			return false;
+		}
+
+		// Initialize result time series for each requested trajectory (in request order, duplicates dropped)
+		const int32 NumSamples = EndTimeStep - StartTimeStep + 1;
+		ResultIndexById.Reserve(TrajectoryIds.Num());
+		RangeResult.TimeSeries.Reserve(TrajectoryIds.Num());
+		for (int64 TrajId : TrajectoryIds)
+		{
+			if (ResultIndexById.Contains(TrajId))
+			{
+				continue;
+			}
+			ResultIndexById.Add(TrajId, RangeResult.TimeSeries.Num());
+
+			FTrajectoryTimeSeries& Series = RangeResult.TimeSeries.AddDefaulted_GetRef();
+			Series.TrajectoryId = TrajId;
+			Series.StartTimeStep = StartTimeStep;
+			Series.EndTimeStep = EndTimeStep;
+
+			// Get extent from metadata if available
+			if (const FTrajectoryMetaBinary* Meta = DatasetHandle.TrajMetas.Find(TrajId))
+			{
+				Series.Extent = FVector(Meta->Extent[0], Meta->Extent[1], Meta->Extent[2]);
+			}
+
+			Series.Samples.SetNumZeroed(NumSamples);
+		}
+	}
+
+	return true;
 }
 
-void FTrajectoryQueryTask::Exit()
+void FTrajectoryQueryTask::CollectShardTrajectories(const FTrajectoryDatasetHandle& DatasetHandle, const FShardInfo& ShardInfo,
+	TArray<int64>& OutTrajectoryIds) const
 {
+	const int32 OverlapStart = FMath::Max(StartTimeStep, ShardInfo.StartTimeStep);
+	const int32 OverlapEnd = FMath::Min(EndTimeStep, ShardInfo.EndTimeStep);
+	if (OverlapEnd < OverlapStart)
+	{
+		return;
+	}
+
+	// Hashed metadata lookups only: trajectories that don't live in this part of the range never touch the shard
+	for (const auto& Pair : ResultIndexById)
+	{
+		const FTrajectoryMetaBinary* TrajMeta = DatasetHandle.TrajMetas.Find(Pair.Key);
+		if (TrajMeta && TrajMeta->StartTimeStep <= OverlapEnd && TrajMeta->EndTimeStep >= OverlapStart)
+		{
+			OutTrajectoryIds.Add(Pair.Key);
+		}
+	}
 }
 
-void FTrajectoryQueryTask::ExecuteSingleTimeStepQuery()
+void FTrajectoryQueryTask::ConsumeEntry(const FShardInfo& ShardInfo, const FTrajectoryEntryHeaderBinary& EntryHeader,
+	int32 TimeStepIntervalSize, const FPositionSampleBinary* EntrySlots)
 {
-	SingleResult.bSuccess = false;
-	
-	// Validate dataset path
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	if (!PlatformFile.DirectoryExists(*DatasetPath))
+	const int32* ResultIndex = ResultIndexById.Find(static_cast<int64>(EntryHeader.TrajectoryId));
+	if (!ResultIndex || EntryHeader.StartTimeStepInInterval == -1)
 	{
-		SingleResult.ErrorMessage = FString::Printf(TEXT("Dataset directory does not exist: %s"), *DatasetPath);
 		return;
 	}
-	
-	// Read dataset metadata
-	FString MetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-meta.bin"));
-	if (!PlatformFile.FileExists(*MetaPath))
+
+	// Valid slots of the entry clipped to the requested range
+	const int32 FirstSlot = FMath::Max(EntryHeader.StartTimeStepInInterval, StartTimeStep - ShardInfo.StartTimeStep);
+	const int32 LastSlot = FMath::Min3(EntryHeader.StartTimeStepInInterval + EntryHeader.ValidSampleCount,
+		EndTimeStep - ShardInfo.StartTimeStep + 1, TimeStepIntervalSize) - 1;
+	if (LastSlot < FirstSlot)
 	{
-		SingleResult.ErrorMessage = TEXT("dataset-meta.bin not found");
 		return;
 	}
-	
-	TArray<uint8> MetaData;
-	if (!FFileHelper::LoadFileToArray(MetaData, *MetaPath))
+
+	if (QueryType == EQueryType::SingleTimeStep)
 	{
-		SingleResult.ErrorMessage = TEXT("Failed to read dataset-meta.bin");
+		const FPositionSampleBinary& PosBinary = EntrySlots[FirstSlot];
+
+		FTrajectorySample& Sample = SingleResult.Samples[*ResultIndex];
+		Sample.Position = FVector(PosBinary.X, PosBinary.Y, PosBinary.Z);
+		// Check if sample is valid (not NaN)
+		Sample.bIsValid = !FMath::IsNaN(PosBinary.X) && !FMath::IsNaN(PosBinary.Y) && !FMath::IsNaN(PosBinary.Z);
+		SampleFound[*ResultIndex] = true;
 		return;
 	}
-	
-	if (MetaData.Num() < sizeof(FDatasetMetaBinary))
+
+	if (QueryType == EQueryType::TimeRangeStream)
 	{
-		SingleResult.ErrorMessage = TEXT("dataset-meta.bin is too small");
+		const int32 ChunkRow = ChunkRowByResultIndex[*ResultIndex];
+		if (ChunkRow == INDEX_NONE)
+		{
+			return;
+		}
+
+		// Copy the float samples as stored; missing samples stay NaN
+		const int32 NumChunkTimeSteps = ChunkEndTimeStep - ChunkStartTimeStep + 1;
+		FVector3f* RowPositions = ChunkPositions.GetData() + (int64)ChunkRow * NumChunkTimeSteps;
+		for (int32 Slot = FirstSlot; Slot <= LastSlot; ++Slot)
+		{
+			const FPositionSampleBinary& PosBinary = EntrySlots[Slot];
+			RowPositions[ShardInfo.StartTimeStep + Slot - ChunkStartTimeStep] = FVector3f(PosBinary.X, PosBinary.Y, PosBinary.Z);
+		}
 		return;
 	}
-	
-	FDatasetMetaBinary DatasetMeta;
-	FMemory::Memcpy(&DatasetMeta, MetaData.GetData(), sizeof(FDatasetMetaBinary));
-	
-	// Validate time step
-	if (StartTimeStep < DatasetMeta.FirstTimeStep || StartTimeStep > DatasetMeta.LastTimeStep)
+
+	if (QueryType == EQueryType::Interpolated)
 	{
-		SingleResult.ErrorMessage = FString::Printf(
-			TEXT("Time step %d is out of range [%d, %d]"),
-			StartTimeStep, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep);
+		// Samples go straight into the SoA taps; missing samples are already NaN
+		for (int32 Slot = FirstSlot; Slot <= LastSlot; ++Slot)
+		{
+			const FPositionSampleBinary& PosBinary = EntrySlots[Slot];
+			InterpolationTaps.Set(*ResultIndex, ShardInfo.StartTimeStep + Slot - FirstTapTimeStep, PosBinary.X, PosBinary.Y, PosBinary.Z);
+		}
 		return;
 	}
-	
-	// Calculate which shard file contains this time step
-	// Shard files are named with the actual starting timestep of the interval they cover
-	int32 IntervalIndex = (StartTimeStep - DatasetMeta.FirstTimeStep) / DatasetMeta.TimeStepIntervalSize;
-	int32 ShardStartTimeStep = IntervalIndex * DatasetMeta.TimeStepIntervalSize + DatasetMeta.FirstTimeStep;
-	FString ShardPath = FPaths::Combine(DatasetPath, FString::Printf(TEXT("shard-%d.bin"), ShardStartTimeStep));
-	
-	if (!PlatformFile.FileExists(*ShardPath))
+
+	FTrajectoryTimeSeries& Series = RangeResult.TimeSeries[*ResultIndex];
+	for (int32 Slot = FirstSlot; Slot <= LastSlot; ++Slot)
 	{
-		SingleResult.ErrorMessage = FString::Printf(TEXT("Shard file not found: %s"), *ShardPath);
-		return;
+		const FPositionSampleBinary& PosBinary = EntrySlots[Slot];
+
+		// Check if sample is valid (not NaN)
+		if (!FMath::IsNaN(PosBinary.X) && !FMath::IsNaN(PosBinary.Y) && !FMath::IsNaN(PosBinary.Z))
+		{
+			Series.Samples[ShardInfo.StartTimeStep + Slot - StartTimeStep] = FVector(PosBinary.X, PosBinary.Y, PosBinary.Z);
+		}
 	}
-	
-	// Load shard file
-	TArray<uint8> ShardData;
-	if (!FFileHelper::LoadFileToArray(ShardData, *ShardPath))
+}
+
+void FTrajectoryQueryTask::BeginShard(const FTrajectoryDatasetHandle& DatasetHandle, const FShardInfo& ShardInfo)
+{
+	if (QueryType != EQueryType::TimeRangeStream)
 	{
-		SingleResult.ErrorMessage = FString::Printf(TEXT("Failed to read shard file: %s"), *ShardPath);
 		return;
 	}
-	
-	if (ShardData.Num() < sizeof(FDataBlockHeaderBinary))
+
+	ChunkStartTimeStep = FMath::Max(StartTimeStep, ShardInfo.StartTimeStep);
+	ChunkEndTimeStep = FMath::Min(EndTimeStep, ShardInfo.EndTimeStep);
+
+	for (int32 ChunkRow = 0; ChunkRow < ChunkTrajectoryIds.Num(); ++ChunkRow)
 	{
-		SingleResult.ErrorMessage = TEXT("Shard file is too small");
-		return;
+		ChunkRowByResultIndex[ResultIndexById.FindChecked(ChunkTrajectoryIds[ChunkRow])] = INDEX_NONE;
 	}
-	
-	// Parse shard header
-	FDataBlockHeaderBinary ShardHeader;
-	FMemory::Memcpy(&ShardHeader, ShardData.GetData(), sizeof(FDataBlockHeaderBinary));
-
-	// Validate magic number
-	if (FMemory::Memcmp(ShardHeader.Magic, "TDDB", 4) != 0)
-	{
-		SingleResult.ErrorMessage = FString::Printf(
-			TEXT("Invalid magic number in shard file %s (got '%c%c%c%c', expected 'TDDB')"),
-			*ShardPath,
-			ShardHeader.Magic[0], ShardHeader.Magic[1], ShardHeader.Magic[2], ShardHeader.Magic[3]);
-		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: %s"), *SingleResult.ErrorMessage);
-		return;
+	ChunkTrajectoryIds.Reset();
+	CollectShardTrajectories(DatasetHandle, ShardInfo, ChunkTrajectoryIds);
+
+	// Keep request order within the chunk
+	ChunkTrajectoryIds.Sort([this](int64 A, int64 B)
+	{
+		return ResultIndexById.FindChecked(A) < ResultIndexById.FindChecked(B);
+	});
+	for (int32 ChunkRow = 0; ChunkRow < ChunkTrajectoryIds.Num(); ++ChunkRow)
+	{
+		ChunkRowByResultIndex[ResultIndexById.FindChecked(ChunkTrajectoryIds[ChunkRow])] = ChunkRow;
 	}
 
-	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataCppApi: Shard header - FormatVersion=%d, TrajectoryEntryCount=%d, DataSectionOffset=%lld, TimeStepIntervalSize=%d, GlobalIntervalIndex=%d"),
-		ShardHeader.FormatVersion,
-		ShardHeader.TrajectoryEntryCount,
-		ShardHeader.DataSectionOffset,
-		ShardHeader.TimeStepIntervalSize,
-		ShardHeader.GlobalIntervalIndex);
+	// The buffer is reused between shards, so the peak is one chunk
+	const int64 NumChunkSamples = (int64)ChunkTrajectoryIds.Num() * FMath::Max(ChunkEndTimeStep - ChunkStartTimeStep + 1, 0);
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	ChunkPositions.SetNumUninitialized(NumChunkSamples, EAllowShrinking::No);
+	for (FVector3f& Position : ChunkPositions)
+	{
+		Position = FVector3f(NaN, NaN, NaN);
+	}
+}
 
-	// Validate DataSectionOffset is within the file and past the header
-	if (ShardHeader.DataSectionOffset < static_cast<int64>(sizeof(FDataBlockHeaderBinary)) || ShardHeader.DataSectionOffset >= ShardData.Num())
+void FTrajectoryQueryTask::EndShard()
+{
+	if (QueryType != EQueryType::TimeRangeStream || ChunkTrajectoryIds.Num() == 0 || bShouldStop)
 	{
-		SingleResult.ErrorMessage = FString::Printf(
-			TEXT("Shard file %s has invalid DataSectionOffset=%lld (file size=%d, header size=%d)"),
-			*ShardPath, ShardHeader.DataSectionOffset, ShardData.Num(), (int32)sizeof(FDataBlockHeaderBinary));
-		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: %s"), *SingleResult.ErrorMessage);
 		return;
 	}
 
-	// Calculate the time step index within this interval
-	// Use the ShardStartTimeStep we calculated when determining which file to open
-	int32 IntervalStartTimeStep = ShardStartTimeStep;
-	int32 TimeStepIndexInInterval = StartTimeStep - IntervalStartTimeStep;
-	
-	// Parse shard entries
-	const uint8* DataPtr = ShardData.GetData() + ShardHeader.DataSectionOffset;
-	int64 RemainingBytes = ShardData.Num() - ShardHeader.DataSectionOffset;
-	
-	for (int32 i = 0; i < ShardHeader.TrajectoryEntryCount && RemainingBytes > 0; ++i)
+	FTrajectoryChunkView Chunk;
+	Chunk.StartTimeStep = ChunkStartTimeStep;
+	Chunk.EndTimeStep = ChunkEndTimeStep;
+	Chunk.TrajectoryIds = ChunkTrajectoryIds;
+	Chunk.Positions = ChunkPositions;
+
+	++StreamResult.NumChunks;
+	for (const FVector3f& Position : ChunkPositions)
 	{
-		if (bShouldStop)
-		{
-			SingleResult.ErrorMessage = TEXT("Query was cancelled");
-			return;
-		}
-		
-		// Check if we have enough data for header
-		if (RemainingBytes < sizeof(FTrajectoryEntryHeaderBinary))
-		{
-			break;
-		}
-		
-		// Parse entry header
-		FTrajectoryEntryHeaderBinary EntryHeader;
-		FMemory::Memcpy(&EntryHeader, DataPtr, sizeof(FTrajectoryEntryHeaderBinary));
-		DataPtr += sizeof(FTrajectoryEntryHeaderBinary);
-		RemainingBytes -= sizeof(FTrajectoryEntryHeaderBinary);
-		
-		// Check if this trajectory is in our query list
-		bool bIsRequested = TrajectoryIds.Contains(EntryHeader.TrajectoryId);
-		
-		// Calculate positions array size
-		int32 PositionsArraySize = DatasetMeta.TimeStepIntervalSize * sizeof(FPositionSampleBinary);
-		
-		if (RemainingBytes < PositionsArraySize)
-		{
-			break;
-		}
-		
-		// If this trajectory is requested, extract the sample
-		if (bIsRequested)
-		{
-			// Check if this trajectory has valid data at the requested time step
-			if (EntryHeader.StartTimeStepInInterval != -1 &&
-				TimeStepIndexInInterval >= EntryHeader.StartTimeStepInInterval &&
-				TimeStepIndexInInterval < EntryHeader.StartTimeStepInInterval + EntryHeader.ValidSampleCount)
-			{
-				// Calculate offset to the requested sample
-				int32 SampleOffset = TimeStepIndexInInterval * sizeof(FPositionSampleBinary);
-				const uint8* SamplePtr = DataPtr + SampleOffset;
-				
-				FPositionSampleBinary PosBinary;
-				FMemory::Memcpy(&PosBinary, SamplePtr, sizeof(FPositionSampleBinary));
-				
-				// Check if sample is valid (not NaN)
-				bool bIsValid = !FMath::IsNaN(PosBinary.X) && !FMath::IsNaN(PosBinary.Y) && !FMath::IsNaN(PosBinary.Z);
-				
-				FTrajectorySample Sample;
-				Sample.TrajectoryId = EntryHeader.TrajectoryId;
-				Sample.TimeStep = StartTimeStep;
-				Sample.Position = FVector(PosBinary.X, PosBinary.Y, PosBinary.Z);
-				Sample.bIsValid = bIsValid;
-				
-				SingleResult.Samples.Add(Sample);
-			}
-		}
-		
-		// Move to next entry
-		DataPtr += PositionsArraySize;
-		RemainingBytes -= PositionsArraySize;
+		StreamResult.NumSamples += FMath::IsNaN(Position.X) ? 0 : 1;
+	}
+
+	if (!ChunkVisitor.Execute(Chunk))
+	{
+		StreamResult.bStoppedByVisitor = true;
+		bShouldStop = true;
 	}
-	
-	SingleResult.bSuccess = true;
 }
 
-void FTrajectoryQueryTask::ExecuteTimeRangeQuery()
+void FTrajectoryQueryTask::Finish()
 {
-	RangeResult.bSuccess = false;
-	
-	// Validate dataset path
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	if (!PlatformFile.DirectoryExists(*DatasetPath))
+	if (bFailed)
 	{
-		RangeResult.ErrorMessage = FString::Printf(TEXT("Dataset directory does not exist: %s"), *DatasetPath);
 		return;
 	}
-	
-	// Read dataset metadata
-	FString MetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-meta.bin"));
-	if (!PlatformFile.FileExists(*MetaPath))
+
+	if (bShouldStop && !StreamResult.bStoppedByVisitor)
 	{
-		RangeResult.ErrorMessage = TEXT("dataset-meta.bin not found");
+		Fail(TEXT("Query was cancelled"));
 		return;
 	}
-	
-	TArray<uint8> MetaData;
-	if (!FFileHelper::LoadFileToArray(MetaData, *MetaPath))
+
+	if (QueryType == EQueryType::SingleTimeStep)
 	{
-		RangeResult.ErrorMessage = TEXT("Failed to read dataset-meta.bin");
-		return;
+		// Keep only trajectories with data at the time step, in request order
+		int32 NumKept = 0;
+		for (int32 Index = 0; Index < SingleResult.Samples.Num(); ++Index)
+		{
+			if (SampleFound[Index])
+			{
+				SingleResult.Samples[NumKept++] = SingleResult.Samples[Index];
+			}
+		}
+		SingleResult.Samples.SetNum(NumKept);
+		SingleResult.bSuccess = true;
 	}
-	
-	if (MetaData.Num() < sizeof(FDatasetMetaBinary))
+	else if (QueryType == EQueryType::TimeRange)
 	{
-		RangeResult.ErrorMessage = TEXT("dataset-meta.bin is too small");
-		return;
+		RangeResult.bSuccess = true;
 	}
-	
-	FDatasetMetaBinary DatasetMeta;
-	FMemory::Memcpy(&DatasetMeta, MetaData.GetData(), sizeof(FDatasetMetaBinary));
-	
-	// Validate time range
-	if (StartTimeStep < DatasetMeta.FirstTimeStep || EndTimeStep > DatasetMeta.LastTimeStep)
+	else if (QueryType == EQueryType::TimeRangeStream)
 	{
-		RangeResult.ErrorMessage = FString::Printf(
-			TEXT("Time range [%d, %d] is out of dataset range [%d, %d]"),
-			StartTimeStep, EndTimeStep, DatasetMeta.FirstTimeStep, DatasetMeta.LastTimeStep);
-		return;
+		StreamResult.bSuccess = true;
+		ChunkPositions.Empty();
+		ChunkTrajectoryIds.Empty();
 	}
-	
-	// Read trajectory metadata
-	FString TrajMetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-trajmeta.bin"));
-	if (!PlatformFile.FileExists(*TrajMetaPath))
+	else
 	{
-		RangeResult.ErrorMessage = TEXT("dataset-trajmeta.bin not found");
-		return;
+		const float Alpha = static_cast<float>(InterpolatedResult.Time - (FirstTapTimeStep + 1));
+		FTrajectoryInterpolation::Interpolate(InterpolationTaps, Alpha, Interpolation, InterpolatedResult.Positions);
+		InterpolatedResult.bSuccess = true;
+		InterpolationTaps = FTrajectoryInterpolationTaps();
 	}
-	
-	TArray<uint8> TrajMetaData;
-	if (!FFileHelper::LoadFileToArray(TrajMetaData, *TrajMetaPath))
+
+	ResultIndexById.Empty();
+}
+
+void FTrajectoryQueryTask::ExecuteBatch(const TArray<TSharedPtr<FTrajectoryQueryTask>>& Tasks)
+{
+	if (Tasks.Num() == 0)
 	{
-		RangeResult.ErrorMessage = TEXT("Failed to read dataset-trajmeta.bin");
 		return;
 	}
-	
-	int32 NumTrajectories = TrajMetaData.Num() / sizeof(FTrajectoryMetaBinary);
-	// FTrajectoryMetaBinary uses #pragma pack(push, 1), so its alignment is 1 byte,
-	// making a direct cast from uint8* safe on all platforms.
-	static_assert(alignof(FTrajectoryMetaBinary) == 1, "FTrajectoryMetaBinary must be byte-aligned (packed) for direct pointer cast");
-	const FTrajectoryMetaBinary* TrajMetasPtr = reinterpret_cast<const FTrajectoryMetaBinary*>(TrajMetaData.GetData());
 
-	// Build map of trajectory ID to metadata directly from the loaded binary data
-	TMap<int64, FTrajectoryMetaBinary> TrajMetaMap;
-	TrajMetaMap.Reserve(NumTrajectories);
-	for (int32 i = 0; i < NumTrajectories; ++i)
+	// All tasks of a batch query the same dataset
+	const FString& BatchDatasetPath = Tasks[0]->DatasetPath;
+	UTrajectoryDataLoader* BatchLoader = Tasks[0]->Loader;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.DirectoryExists(*BatchDatasetPath))
 	{
-		TrajMetaMap.Add(TrajMetasPtr[i].TrajectoryId, TrajMetasPtr[i]);
+		for (const TSharedPtr<FTrajectoryQueryTask>& Task : Tasks)
+		{
+			Task->Fail(FString::Printf(TEXT("Dataset directory does not exist: %s"), *BatchDatasetPath));
+		}
+		return;
 	}
-	
-	// Initialize result time series for each requested trajectory
-	TMap<int64, FTrajectoryTimeSeries> TimeSeriesMap;
-	for (int64 TrajId : TrajectoryIds)
-	{
-		FTrajectoryTimeSeries Series;
-		Series.TrajectoryId = TrajId;
-		Series.StartTimeStep = StartTimeStep;
-		Series.EndTimeStep = EndTimeStep;
-		
-		// Get extent from metadata if available
-		if (const FTrajectoryMetaBinary* Meta = TrajMetaMap.Find(TrajId))
-		{
-			Series.Extent = FVector(Meta->Extent[0], Meta->Extent[1], Meta->Extent[2]);
-		}
-		
-		// Preallocate samples array
-		int32 NumSamples = EndTimeStep - StartTimeStep + 1;
-		Series.Samples.SetNumZeroed(NumSamples);
-		
-		TimeSeriesMap.Add(TrajId, Series);
+
+	// Metadata, shard table and shard mappings are shared with the loader's handle cache,
+	// so repeated queries neither re-read metadata files nor re-map shards
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = BatchLoader ? BatchLoader->AcquireDatasetHandle(BatchDatasetPath) : nullptr;
+	if (!DatasetHandle.IsValid())
+	{
+		for (const TSharedPtr<FTrajectoryQueryTask>& Task : Tasks)
+		{
+			Task->Fail(FString::Printf(TEXT("Failed to open dataset (dataset-meta.bin or dataset-trajmeta.bin missing or invalid): %s"), *BatchDatasetPath));
+		}
+		return;
 	}
-	
-	// Calculate which shards we need to load
-	int32 StartIntervalIndex = (StartTimeStep - DatasetMeta.FirstTimeStep) / DatasetMeta.TimeStepIntervalSize;
-	int32 EndIntervalIndex = (EndTimeStep - DatasetMeta.FirstTimeStep) / DatasetMeta.TimeStepIntervalSize;
-	
-	// Load each required shard
-	for (int32 IntervalIndex = StartIntervalIndex; IntervalIndex <= EndIntervalIndex; ++IntervalIndex)
+
+	TArray<FTrajectoryQueryTask*> ActiveTasks;
+	for (const TSharedPtr<FTrajectoryQueryTask>& Task : Tasks)
 	{
-		if (bShouldStop)
+		if (Task->bShouldStop)
 		{
-			RangeResult.ErrorMessage = TEXT("Query was cancelled");
-			return;
+			Task->Fail(TEXT("Query was cancelled"));
 		}
-		
-		// Calculate the actual starting timestep for this interval's shard file
-		// Shard files are named with the actual starting timestep of the interval they cover
-		int32 ShardStartTimeStep = IntervalIndex * DatasetMeta.TimeStepIntervalSize + DatasetMeta.FirstTimeStep;
-		FString ShardPath = FPaths::Combine(DatasetPath, FString::Printf(TEXT("shard-%d.bin"), ShardStartTimeStep));
-		
-		if (!PlatformFile.FileExists(*ShardPath))
+		else if (Task->Prepare(*DatasetHandle))
 		{
-			continue; // Skip missing shards
+			ActiveTasks.Add(Task.Get());
 		}
-		
-		// Load shard file
-		TArray<uint8> ShardData;
-		if (!FFileHelper::LoadFileToArray(ShardData, *ShardPath))
+	}
+
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle->DatasetMeta;
+	const int32 IntervalSize = DatasetMeta.TimeStepIntervalSize;
+	const FTrajectoryQuantization Quantization = FTrajectoryQuantization::FromDatasetMeta(DatasetMeta);
+	FTrajectoryDecodeScratch DecodeScratch;
+	TArray<FPositionSampleBinary> Slots;
+	TArray<int64> ShardTrajIds;
+	TArray<int32> EntryIndices;
+	TSet<int64> SeenTrajIds;
+
+	// Chronological shard order (streaming queries visit their chunks in time order)
+	TArray<int32> ShardFileIndices;
+	DatasetHandle->ShardInfoTable.GetKeys(ShardFileIndices);
+	ShardFileIndices.Sort([&DatasetHandle](int32 A, int32 B)
+	{
+		return DatasetHandle->ShardInfoTable.FindChecked(A).StartTimeStep < DatasetHandle->ShardInfoTable.FindChecked(B).StartTimeStep;
+	});
+
+	// One pass per shard for all tasks of the batch: each requested trajectory is resolved and decoded once,
+	// then handed to every task that asked for it
+	for (int32 ShardFileIndex : ShardFileIndices)
+	{
+		const FShardInfo& ShardInfo = DatasetHandle->ShardInfoTable.FindChecked(ShardFileIndex);
+
+		ShardTrajIds.Reset();
+		for (FTrajectoryQueryTask* Task : ActiveTasks)
 		{
-			continue; // Skip failed loads
+			if (!Task->bShouldStop)
+			{
+				Task->CollectShardTrajectories(*DatasetHandle, ShardInfo, ShardTrajIds);
+			}
 		}
-		
-		if (ShardData.Num() < sizeof(FDataBlockHeaderBinary))
+
+		if (ShardTrajIds.Num() == 0)
 		{
 			continue;
 		}
-		
-		// Parse shard header
-		FDataBlockHeaderBinary ShardHeader;
-		FMemory::Memcpy(&ShardHeader, ShardData.GetData(), sizeof(FDataBlockHeaderBinary));
 
-		// Validate magic number
-		if (FMemory::Memcmp(ShardHeader.Magic, "TDDB", 4) != 0)
+		// Overlapping queries ask for the same trajectories - resolve each of them once
+		if (ActiveTasks.Num() > 1)
+		{
+			SeenTrajIds.Reset();
+			ShardTrajIds.RemoveAll([&SeenTrajIds](int64 TrajId)
+			{
+				bool bAlreadySeen = false;
+				SeenTrajIds.Add(TrajId, &bAlreadySeen);
+				return bAlreadySeen;
+			});
+		}
+
+		TSharedPtr<FMappedShardFile> MappedShard = BatchLoader->GetOrMapShardFile(DatasetHandle, ShardFileIndex, ShardInfo.FilePath);
+		if (!MappedShard.IsValid())
 		{
-			UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: Invalid magic number in shard file %s (got '%c%c%c%c', expected 'TDDB')"),
-				*ShardPath,
-				ShardHeader.Magic[0], ShardHeader.Magic[1], ShardHeader.Magic[2], ShardHeader.Magic[3]);
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: Failed to map shard file: %s"), *ShardInfo.FilePath);
 			continue; // Skip this shard
 		}
 
-		UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataCppApi: Shard header - FormatVersion=%d, TrajectoryEntryCount=%d, DataSectionOffset=%lld, TimeStepIntervalSize=%d, GlobalIntervalIndex=%d"),
-			ShardHeader.FormatVersion,
-			ShardHeader.TrajectoryEntryCount,
-			ShardHeader.DataSectionOffset,
-			ShardHeader.TimeStepIntervalSize,
-			ShardHeader.GlobalIntervalIndex);
+		const uint8* MappedData = MappedShard->MappedRegion->GetMappedPtr();
+		const int64 MappedSize = MappedShard->MappedRegion->GetMappedSize();
+		FDataBlockHeaderBinary ShardHeader;
+		if (!BatchLoader->ReadShardHeaderMapped(MappedData, MappedSize, ShardHeader))
+		{
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: Invalid header in shard file: %s"), *ShardInfo.FilePath);
+			continue; // Skip this shard
+		}
 
-		// Validate DataSectionOffset is within the file and past the header
-		if (ShardHeader.DataSectionOffset < static_cast<int64>(sizeof(FDataBlockHeaderBinary)) || ShardHeader.DataSectionOffset >= ShardData.Num())
+		const FTrajectoryShardReader ShardReader(MappedData, MappedSize, ShardHeader, DatasetMeta.EntrySizeBytes);
+		if (!ShardReader.IsValid() || ShardHeader.TimeStepIntervalSize != IntervalSize)
 		{
-			UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: Shard file %s has invalid DataSectionOffset=%lld (file size=%d, header size=%d)"),
-				*ShardPath, ShardHeader.DataSectionOffset, ShardData.Num(), (int32)sizeof(FDataBlockHeaderBinary));
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryDataCppApi: Invalid entry layout in shard file: %s"), *ShardInfo.FilePath);
 			continue; // Skip this shard
 		}
 
-		// Use the ShardStartTimeStep we calculated when determining which file to open
-		int32 IntervalStartTimeStep = ShardStartTimeStep;
-		
-		// Parse shard entries
-		const uint8* DataPtr = ShardData.GetData() + ShardHeader.DataSectionOffset;
-		int64 RemainingBytes = ShardData.Num() - ShardHeader.DataSectionOffset;
-		
-		for (int32 i = 0; i < ShardHeader.TrajectoryEntryCount && RemainingBytes > 0; ++i)
+		// Seek straight to each requested entry (EntryOffsetIndex from trajectory metadata, verified against the stored ID);
+		// only the pages holding requested entries are touched
+		BatchLoader->ResolveShardEntryIndices(ShardReader, ShardInfo.FilePath, ShardInfo.StartTimeStep, ShardInfo.EndTimeStep,
+			ShardTrajIds, DatasetHandle->TrajMetas, ETrajectoryEntryLookup::DirectSeek, EntryIndices);
+
+		if (ShardReader.IsCompressed())
+		{
+			Slots.SetNumUninitialized(IntervalSize, EAllowShrinking::No);
+		}
+
+		for (FTrajectoryQueryTask* Task : ActiveTasks)
 		{
-			if (bShouldStop)
+			if (!Task->bShouldStop)
 			{
-				RangeResult.ErrorMessage = TEXT("Query was cancelled");
-				return;
+				Task->BeginShard(*DatasetHandle, ShardInfo);
 			}
-			
-			// Check if we have enough data for header
-			if (RemainingBytes < sizeof(FTrajectoryEntryHeaderBinary))
+		}
+
+		for (int32 Index = 0; Index < ShardTrajIds.Num(); ++Index)
+		{
+			const TConstArrayView<uint8> EntryData = ShardReader.GetEntryData(EntryIndices[Index]);
+			if (EntryData.Num() < (int64)sizeof(FTrajectoryEntryHeaderBinary))
 			{
-				break;
+				continue;
 			}
-			
-			// Parse entry header
+
 			FTrajectoryEntryHeaderBinary EntryHeader;
-			FMemory::Memcpy(&EntryHeader, DataPtr, sizeof(FTrajectoryEntryHeaderBinary));
-			DataPtr += sizeof(FTrajectoryEntryHeaderBinary);
-			RemainingBytes -= sizeof(FTrajectoryEntryHeaderBinary);
-			
-			// Check if this trajectory is in our query list
-			FTrajectoryTimeSeries* Series = TimeSeriesMap.Find(EntryHeader.TrajectoryId);
-			
-			// Calculate positions array size
-			int32 PositionsArraySize = DatasetMeta.TimeStepIntervalSize * sizeof(FPositionSampleBinary);
-			
-			if (RemainingBytes < PositionsArraySize)
+			FMemory::Memcpy(&EntryHeader, EntryData.GetData(), sizeof(FTrajectoryEntryHeaderBinary));
+			if (EntryHeader.StartTimeStepInInterval == -1)
 			{
-				break;
+				continue;
+			}
+
+			const FPositionSampleBinary* EntrySlots = nullptr;
+			if (ShardReader.IsCompressed())
+			{
+				// Compressed entries are delta coded, so they are decoded as a whole
+				if (!FTrajectoryShardCodec::DecodeEntry(EntryData, IntervalSize, Quantization, Slots.GetData(), DecodeScratch))
+				{
+					UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataCppApi: Malformed entry for trajectory %lld in %s"),
+						ShardTrajIds[Index], *ShardInfo.FilePath);
+					continue;
+				}
+				EntrySlots = Slots.GetData();
 			}
-			
-			// If this trajectory is requested, extract samples in our time range
-			if (Series && EntryHeader.StartTimeStepInInterval != -1)
+			else
 			{
-				// Calculate which samples to extract
-				int32 FirstSampleInInterval = EntryHeader.StartTimeStepInInterval;
-				int32 LastSampleInInterval = FirstSampleInInterval + EntryHeader.ValidSampleCount - 1;
-				
-				for (int32 TimeStepInInterval = 0; TimeStepInInterval < DatasetMeta.TimeStepIntervalSize; ++TimeStepInInterval)
+				if (EntryData.Num() < (int64)sizeof(FTrajectoryEntryHeaderBinary) + (int64)IntervalSize * sizeof(FPositionSampleBinary))
 				{
-					int32 AbsoluteTimeStep = IntervalStartTimeStep + TimeStepInInterval;
-					
-					// Check if this time step is in our query range
-					if (AbsoluteTimeStep >= StartTimeStep && AbsoluteTimeStep <= EndTimeStep)
-					{
-						// Check if this time step has valid data
-						if (TimeStepInInterval >= FirstSampleInInterval && TimeStepInInterval <= LastSampleInInterval)
-						{
-							// Extract sample
-							int32 SampleOffset = TimeStepInInterval * sizeof(FPositionSampleBinary);
-							const uint8* SamplePtr = DataPtr + SampleOffset;
-							
-							FPositionSampleBinary PosBinary;
-							FMemory::Memcpy(&PosBinary, SamplePtr, sizeof(FPositionSampleBinary));
-							
-							// Check if sample is valid (not NaN)
-							if (!FMath::IsNaN(PosBinary.X) && !FMath::IsNaN(PosBinary.Y) && !FMath::IsNaN(PosBinary.Z))
-							{
-								// Store in result
-								int32 ResultIndex = AbsoluteTimeStep - StartTimeStep;
-								Series->Samples[ResultIndex] = FVector(PosBinary.X, PosBinary.Y, PosBinary.Z);
-							}
-						}
-					}
+					continue;
 				}
+				// FPositionSampleBinary is packed, so the mapped bytes can be read in place
+				EntrySlots = reinterpret_cast<const FPositionSampleBinary*>(EntryData.GetData() + sizeof(FTrajectoryEntryHeaderBinary));
 			}
-			
-			// Move to next entry
-			DataPtr += PositionsArraySize;
-			RemainingBytes -= PositionsArraySize;
+
+			for (FTrajectoryQueryTask* Task : ActiveTasks)
+			{
+				if (!Task->bShouldStop)
+				{
+					Task->ConsumeEntry(ShardInfo, EntryHeader, IntervalSize, EntrySlots);
+				}
+			}
+		}
+
+		for (FTrajectoryQueryTask* Task : ActiveTasks)
+		{
+			Task->EndShard();
 		}
 	}
-	
-	// Convert map to array
-	for (auto& Pair : TimeSeriesMap)
+
+	for (FTrajectoryQueryTask* Task : ActiveTasks)
 	{
-		RangeResult.TimeSeries.Add(Pair.Value);
+		Task->Finish();
 	}
-	
-	RangeResult.bSuccess = true;
 }
 
-void FTrajectoryQueryTask::InvokeCallbackOnGameThread()
+void FTrajectoryQueryTask::InvokeCallbackOnGameThread(const TSharedPtr<FTrajectoryQueryTask>& Task)
 {
-	// Schedule callback on game thread
-	AsyncTask(ENamedThreads::GameThread, [this]()
+	// Schedule callback on game thread; the lambda owns a reference so the result outlives the worker
+	AsyncTask(ENamedThreads::GameThread, [Task]()
 	{
-		if (QueryType == EQueryType::SingleTimeStep && SingleTimeStepCallback.IsBound())
+		if (Task->QueryType == EQueryType::SingleTimeStep && Task->SingleTimeStepCallback.IsBound())
+		{
+			Task->SingleTimeStepCallback.Execute(Task->SingleResult);
+		}
+		else if (Task->QueryType == EQueryType::TimeRange && Task->TimeRangeCallback.IsBound())
+		{
+			Task->TimeRangeCallback.Execute(Task->RangeResult);
+		}
+		else if (Task->QueryType == EQueryType::TimeRangeStream && Task->StreamCallback.IsBound())
 		{
-			SingleTimeStepCallback.Execute(SingleResult);
+			Task->StreamCallback.Execute(Task->StreamResult);
 		}
-		else if (QueryType == EQueryType::TimeRange && TimeRangeCallback.IsBound())
+		else if (Task->QueryType == EQueryType::Interpolated && Task->InterpolatedCallback.IsBound())
 		{
-			TimeRangeCallback.Execute(RangeResult);
+			Task->InterpolatedCallback.Execute(Task->InterpolatedResult);
 		}
 	});
 }
@@ -4,25 +4,31 @@
 #include "TrajectoryDataSettings.h"
 #include "TrajectoryDataMemoryEstimator.h"
 #include "TrajectoryDataBlueprintLibrary.h"
+#include "TrajectoryShardCodec.h"
 #include "Misc/Paths.h"
 #include "Misc/FileHelper.h"
+#include "Misc/ScopeTryLock.h"
 #include "HAL/PlatformFileManager.h"
 #include "HAL/RunnableThread.h"
 #include "GenericPlatform/GenericPlatformFile.h"
 #include "Async/Async.h"
 #include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
 
 UTrajectoryDataLoader* UTrajectoryDataLoader::Instance = nullptr;
 
 UTrajectoryDataLoader::UTrajectoryDataLoader()
 	: CurrentMemoryUsage(0)
 	, bIsLoadingAsync(false)
+	, ShardEntryIndexCacheBytes(0)
+	, DatasetHandleAccessCounter(0)
 {
 }
 
 UTrajectoryDataLoader::~UTrajectoryDataLoader()
 {
 	CancelAsyncLoad();
+	StopStreaming();
 }
 
 UTrajectoryDataLoader* UTrajectoryDataLoader::Get()
@@ -70,13 +76,14 @@ FTrajectoryLoadValidation UTrajectoryDataLoader::ValidateLoadParams(const FTraje
 		return Validation;
 	}
 
-	// Read dataset metadata
-	FDatasetMetaBinary DatasetMeta;
-	if (!ReadDatasetMeta(DatasetInfo.DatasetPath, DatasetMeta))
+	// Open dataset (reuses cached metadata if the dataset was opened before)
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = AcquireDatasetHandle(DatasetInfo.DatasetPath);
+	if (!DatasetHandle.IsValid())
 	{
 		Validation.Message = TEXT("Failed to read dataset metadata");
 		return Validation;
 	}
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle->DatasetMeta;
 
 	// Validate time range
 	int32 StartTime = (Params.StartTimeStep < 0) ? DatasetMeta.FirstTimeStep : Params.StartTimeStep;
@@ -95,18 +102,34 @@ FTrajectoryLoadValidation UTrajectoryDataLoader::ValidateLoadParams(const FTraje
 		return Validation;
 	}
 
-	// Read trajectory metadata
-	TArray<FTrajectoryMetaBinary> TrajMetas;
-	if (!ReadTrajectoryMeta(DatasetInfo.DatasetPath, TrajMetas))
+	// Trajectory metadata was read when the dataset was opened
+	const FTrajectoryMetaTable& TrajMetas = DatasetHandle->TrajMetas;
+
+	// Spatial selections are only resolved here if the dataset's spatial index is already open: opening it may build
+	// it from every position of the dataset, which must not happen during validation (LoadTrajectoriesAsync validates
+	// on the game thread). Otherwise the load resolves the region and the estimate assumes every candidate matches.
+	bool bSpatialIndexOpen = false;
+	if (Params.SelectionStrategy == ETrajectorySelectionStrategy::SpatialRegion)
 	{
-		Validation.Message = TEXT("Failed to read trajectory metadata");
-		return Validation;
+		FScopeTryLock IndexLock(&DatasetHandle->SpatialIndexMutex);
+		bSpatialIndexOpen = IndexLock.IsLocked() && DatasetHandle->SpatialIndex.IsValid();
 	}
+	const bool bEstimateSpatialSelection = Params.SelectionStrategy == ETrajectorySelectionStrategy::SpatialRegion && !bSpatialIndexOpen;
 
 	// Build trajectory ID list based on selection strategy
-	TArray<int64> TrajectoryIds = BuildTrajectoryIdList(Params, DatasetMeta, TrajMetas);
+	TArray<int64> TrajectoryIds;
+	int32 NumTrajectoriesToLoad = 0;
+	if (bEstimateSpatialSelection)
+	{
+		NumTrajectoriesToLoad = (Params.NumTrajectories > 0) ? FMath::Min(Params.NumTrajectories, TrajMetas.Num()) : TrajMetas.Num();
+	}
+	else
+	{
+		TrajectoryIds = BuildTrajectoryIdList(Params, DatasetMeta, TrajMetas, DatasetHandle);
+		NumTrajectoriesToLoad = TrajectoryIds.Num();
+	}
 	
-	if (TrajectoryIds.Num() == 0)
+	if (NumTrajectoriesToLoad == 0)
 	{
 		Validation.Message = TEXT("No trajectories selected to load");
 		return Validation;
@@ -114,16 +137,16 @@ FTrajectoryLoadValidation UTrajectoryDataLoader::ValidateLoadParams(const FTraje
 
 	// Calculate memory requirement
 	int32 NumSamples = (EndTime - StartTime) / Params.SampleRate;
-	Validation.NumTrajectoriesToLoad = TrajectoryIds.Num();
+	Validation.NumTrajectoriesToLoad = NumTrajectoriesToLoad;
 	Validation.NumSamplesPerTrajectory = NumSamples;
 	
 	// Memory calculation: trajectory metadata + sample data
 	// Bytes per sample: FVector3f Position (12 bytes: 3 floats)
 	static constexpr int32 BytesPerSample = sizeof(FVector3f);
-	int64 SampleMemory = (int64)TrajectoryIds.Num() * NumSamples * BytesPerSample;
+	int64 SampleMemory = (int64)NumTrajectoriesToLoad * NumSamples * BytesPerSample;
 	
 	// Trajectory metadata overhead
-	int64 TrajMetaMemory = (int64)TrajectoryIds.Num() * 128; // Approximate overhead per trajectory
+	int64 TrajMetaMemory = (int64)NumTrajectoriesToLoad * 128; // Approximate overhead per trajectory
 	
 	Validation.EstimatedMemoryBytes = SampleMemory + TrajMetaMemory;
 
@@ -149,8 +172,8 @@ FTrajectoryLoadValidation UTrajectoryDataLoader::ValidateLoadParams(const FTraje
 		// Convert to GB for display
 		float RequiredGB = static_cast<float>(Validation.EstimatedMemoryBytes * BytesToGB);
 		Validation.Message = FString::Printf(
-			TEXT("Can load %d trajectories with %d samples each (Estimated memory: %.2f GB)"),
-			Validation.NumTrajectoriesToLoad, Validation.NumSamplesPerTrajectory, RequiredGB);
+			TEXT("Can load %s%d trajectories with %d samples each (Estimated memory: %.2f GB)"),
+			bEstimateSpatialSelection ? TEXT("up to ") : TEXT(""), Validation.NumTrajectoriesToLoad, Validation.NumSamplesPerTrajectory, RequiredGB);
 	}
 
 	return Validation;
@@ -208,6 +231,66 @@ void UTrajectoryDataLoader::UnloadAll()
 	CurrentMemoryUsage = 0;
 }
 
+bool UTrajectoryDataLoader::StartStreaming(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryStreamingParams& Params)
+{
+	StopStreaming();
+
+	if (Params.LoadParams.SampleRate < 1)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Sample rate must be >= 1 for streaming"));
+		return false;
+	}
+
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = AcquireDatasetHandle(DatasetInfo.DatasetPath);
+	if (!DatasetHandle.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Failed to open dataset for streaming: %s"), *DatasetInfo.DatasetPath);
+		return false;
+	}
+
+	TSharedPtr<FTrajectoryStreamingSession> NewSession = MakeShared<FTrajectoryStreamingSession>(this, DatasetInfo, Params, DatasetHandle);
+	if (NewSession->GetNumIntervals() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: No shard intervals in streaming range %d-%d of %s"),
+			NewSession->GetStartTimeStep(), NewSession->GetEndTimeStep(), *DatasetInfo.DatasetPath);
+		return false;
+	}
+
+	StreamingSession = NewSession;
+
+	// Start loading the first intervals right away
+	StreamingSession->UpdateCursor(StreamingSession->GetStartTimeStep(), 0.0f);
+
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Started streaming %s (time steps %d-%d, %d intervals)"),
+		*DatasetInfo.DatasetPath, StreamingSession->GetStartTimeStep(), StreamingSession->GetEndTimeStep(), StreamingSession->GetNumIntervals());
+
+	return true;
+}
+
+void UTrajectoryDataLoader::UpdateStreamingCursor(float TimeStep, float PlaybackSpeed)
+{
+	if (StreamingSession.IsValid())
+	{
+		StreamingSession->UpdateCursor(TimeStep, PlaybackSpeed);
+	}
+}
+
+void UTrajectoryDataLoader::StopStreaming()
+{
+	// Destroying the session waits for its background loads
+	StreamingSession.Reset();
+}
+
+bool UTrajectoryDataLoader::IsStreamingTimeStepResident(int32 TimeStep) const
+{
+	return StreamingSession.IsValid() && StreamingSession->IsTimeStepResident(TimeStep);
+}
+
+int64 UTrajectoryDataLoader::GetStreamingMemoryUsage() const
+{
+	return StreamingSession.IsValid() ? StreamingSession->GetResidentMemoryBytes() : 0;
+}
+
 FShardFileData UTrajectoryDataLoader::LoadShardFile(const FString& ShardFilePath)
 {
 	FShardFileData ShardData;
@@ -276,10 +359,11 @@ FShardFileData UTrajectoryDataLoader::LoadShardFile(const FString& ShardFilePath
 	}
 
 	// Validate format version
-	if (ShardData.Header.FormatVersion != 1)
+	// Raw entry access is only defined for the fixed-size layout; compressed shards are read by LoadTrajectoriesSync/Async
+	if (ShardData.Header.FormatVersion != TrajectoryShardFormat::Uncompressed)
 	{
 		delete FileHandle;
-		ShardData.ErrorMessage = FString::Printf(TEXT("Unsupported shard file format version: %d"), 
+		ShardData.ErrorMessage = FString::Printf(TEXT("Unsupported shard file format version: %d (LoadShardFile only reads version 1 shards)"), 
 			ShardData.Header.FormatVersion);
 		return ShardData;
 	}
@@ -399,29 +483,26 @@ FShardFileData UTrajectoryDataLoader::LoadShardFile(const FString& ShardFilePath
 	return ShardData;
 }
 
-FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryLoadParams& Params)
+FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryLoadParams& Params,
+	bool bRegisterDataset, const TSharedPtr<FTrajectoryDatasetHandle>& InDatasetHandle)
 {
 	FTrajectoryLoadResult Result;
 	Result.bSuccess = false;
 
-	// Read dataset metadata
-	FDatasetMetaBinary DatasetMeta;
-	if (!ReadDatasetMeta(DatasetInfo.DatasetPath, DatasetMeta))
+	// Open dataset: metadata, shard table and shard mappings are reused from earlier loads
+	// of the same dataset as long as its files are unchanged on disk
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = InDatasetHandle.IsValid() ? InDatasetHandle : AcquireDatasetHandle(DatasetInfo.DatasetPath);
+	if (!DatasetHandle.IsValid())
 	{
 		Result.ErrorMessage = TEXT("Failed to read dataset metadata");
 		return Result;
 	}
 
-	// Read trajectory metadata
-	TArray<FTrajectoryMetaBinary> TrajMetas;
-	if (!ReadTrajectoryMeta(DatasetInfo.DatasetPath, TrajMetas))
-	{
-		Result.ErrorMessage = TEXT("Failed to read trajectory metadata");
-		return Result;
-	}
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle->DatasetMeta;
+	const FTrajectoryMetaTable& TrajMetas = DatasetHandle->TrajMetas;
 
 	// Build trajectory ID list
-	TArray<int64> TrajectoryIds = BuildTrajectoryIdList(Params, DatasetMeta, TrajMetas);
+	TArray<int64> TrajectoryIds = BuildTrajectoryIdList(Params, DatasetMeta, TrajMetas, DatasetHandle);
 	
 	if (TrajectoryIds.Num() == 0)
 	{
@@ -436,15 +517,9 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 	Result.LoadedStartTimeStep = StartTime;
 	Result.LoadedEndTimeStep = EndTime;
 
-	// Create map of trajectory ID to metadata for quick lookup
-	TMap<int64, FTrajectoryMetaBinary> TrajMetaMap;
-	for (const FTrajectoryMetaBinary& TrajMeta : TrajMetas)
-	{
-		TrajMetaMap.Add(TrajMeta.TrajectoryId, TrajMeta);
-	}
-
-	// Discover all shard files and build time-range information table
-	TMap<int32, FShardInfo> ShardInfoTable = DiscoverShardFiles(DatasetInfo.DatasetPath, DatasetMeta);
+	// Trajectory metadata (binary search by ID) and shard time-range table built when the dataset was opened
+	const FTrajectoryMetaTable& TrajMetaTable = DatasetHandle->TrajMetas;
+	const TMap<int32, FShardInfo>& ShardInfoTable = DatasetHandle->ShardInfoTable;
 
 	// Filter shards to only load those containing data in the requested time range
 	TArray<int32> RelevantShards;
@@ -460,86 +535,208 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 	}
 
 	// Sort shards by index to ensure they are processed in chronological order
-	// This is critical for maintaining temporal ordering of samples when using Append()
+	// This is critical for maintaining temporal ordering of samples (output offsets are assigned in this order)
 	RelevantShards.Sort();
 
 	UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Loading from %d shard(s) for time range %d-%d"),
 		RelevantShards.Num(), StartTime, EndTime);
 
+	const bool bUseSampleArena = (Params.SampleLayout == ETrajectorySampleLayout::SampleArena);
+
+	// Output slot i belongs to TrajIdsArray[i] (requested trajectories that exist in the metadata, without duplicates)
+	TArray<int64> TrajIdsArray;
+	TrajIdsArray.Reserve(TrajectoryIds.Num());
+	{
+		TSet<int64> AddedTrajIds;
+		AddedTrajIds.Reserve(TrajectoryIds.Num());
+		for (int64 TrajId : TrajectoryIds)
+		{
+			bool bAlreadyAdded = false;
+			AddedTrajIds.Add(TrajId, &bAlreadyAdded);
+			if (!bAlreadyAdded && TrajMetaTable.Contains(TrajId))
+			{
+				TrajIdsArray.Add(TrajId);
+			}
+		}
+	}
+
+	const int32 NumTrajectories = TrajIdsArray.Num();
+	const int32 NumShards = RelevantShards.Num();
+
+	// Sample grid of every trajectory, shared by both layouts: lifetime clipped to the requested range, one sample
+	// every SampleRate time steps. Every shard continues this grid (see GetEntryLoadRange), so sample k is always
+	// time step GridFirstTimeSteps[i] + k * SampleRate.
+	TArray<int32> GridFirstTimeSteps;
+	GridFirstTimeSteps.SetNumUninitialized(NumTrajectories);
+	for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
+	{
+		const FTrajectoryMetaBinary& TrajMeta = TrajMetaTable.FindChecked(TrajIdsArray[TrajIdx]);
+		GridFirstTimeSteps[TrajIdx] = FMath::Max(StartTime, TrajMeta.StartTimeStep);
+	}
+
+	// Coarse sample rates read pre-decimated LOD shards, so I/O shrinks with the decimation factor. Candidate levels
+	// have a factor dividing the rate and a LOD shard for every relevant shard.
+	TArray<const FTrajectoryLodLevel*> CandidateLodLevels;
+	if (Params.bUseLodPyramid && Params.SampleRate > 1)
+	{
+		for (const FTrajectoryLodLevel& LodLevel : DatasetHandle->LodLevels)
+		{
+			if (LodLevel.DecimationFactor < 2 || Params.SampleRate % LodLevel.DecimationFactor != 0)
+			{
+				continue;
+			}
+
+			const int32* MissingShard = RelevantShards.FindByPredicate([&LodLevel](int32 ShardIndex) { return !LodLevel.ShardPaths.Contains(ShardIndex); });
+			if (MissingShard)
+			{
+				UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: LOD level %d has no shard %d, not using it"), LodLevel.DecimationFactor, *MissingShard);
+				continue;
+			}
+			CandidateLodLevels.Add(&LodLevel);
+		}
+	}
+
+	// LOD shards only hold time steps FirstTimeStep + k * DecimationFactor, so each trajectory reads the coarsest
+	// candidate level its grid lies on and the full-resolution shards otherwise. The loaded samples are the same
+	// whether or not the LOD files exist. LoadLevels[0] is the full-resolution level.
+	TArray<const FTrajectoryLodLevel*> LoadLevels;
+	LoadLevels.Add(nullptr);
+	TArray<int32> TrajLoadLevels;
+	TrajLoadLevels.SetNumZeroed(NumTrajectories);
+	for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
+	{
+		const int32 GridOffset = GridFirstTimeSteps[TrajIdx] - DatasetMeta.FirstTimeStep;
+		for (int32 CandidateIdx = CandidateLodLevels.Num() - 1; CandidateIdx >= 0; --CandidateIdx)
+		{
+			if (GridOffset % CandidateLodLevels[CandidateIdx]->DecimationFactor == 0)
+			{
+				TrajLoadLevels[TrajIdx] = LoadLevels.AddUnique(CandidateLodLevels[CandidateIdx]);
+				break;
+			}
+		}
+	}
+	const int32 NumLoadLevels = LoadLevels.Num();
+
+	// Output slots reading each level (each plan only resolves and maps entries of its own level)
+	TArray<TArray<int32>> LevelTrajIndices;
+	TArray<TArray<int64>> LevelTrajIds;
+	LevelTrajIndices.SetNum(NumLoadLevels);
+	LevelTrajIds.SetNum(NumLoadLevels);
+	for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
+	{
+		LevelTrajIndices[TrajLoadLevels[TrajIdx]].Add(TrajIdx);
+		LevelTrajIds[TrajLoadLevels[TrajIdx]].Add(TrajIdsArray[TrajIdx]);
+	}
+
+	for (int32 LevelIdx = 1; LevelIdx < NumLoadLevels; ++LevelIdx)
+	{
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Reading LOD level %d for %d of %d trajectories (sample rate %d)"),
+			LoadLevels[LevelIdx]->DecimationFactor, LevelTrajIds[LevelIdx].Num(), NumTrajectories, Params.SampleRate);
+	}
+
 	// Initialize trajectory data structures - one per requested trajectory
-	TMap<int64, FLoadedTrajectory> TrajectoryMap;
-	for (int64 TrajId : TrajectoryIds)
+	TArray<FLoadedTrajectory> NewTrajectories;
+	TSharedPtr<FTrajectorySampleArena> SampleArena;
+
+	if (bUseSampleArena)
+	{
+		// Sample arena: each trajectory gets one contiguous slot sized from metadata, so shard workers
+		// can write straight into their final location without per-shard buffers or a merge pass
+		SampleArena = MakeShared<FTrajectorySampleArena>();
+		SampleArena->SampleRate = Params.SampleRate;
+		SampleArena->ReserveTrajectories(NumTrajectories);
+
+		for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
+		{
+			const int64 TrajId = TrajIdsArray[TrajIdx];
+			const FTrajectoryMetaBinary& TrajMeta = TrajMetaTable.FindChecked(TrajId);
+			const int32 FirstSampleTimeStep = GridFirstTimeSteps[TrajIdx];
+			const int32 LastSampleTimeStep = FMath::Min(EndTime, TrajMeta.EndTimeStep);
+			const int32 SampleCount = (LastSampleTimeStep >= FirstSampleTimeStep)
+				? (LastSampleTimeStep - FirstSampleTimeStep) / Params.SampleRate + 1
+				: 0;
+
+			SampleArena->AddTrajectory(TrajId, TrajMeta.StartTimeStep, TrajMeta.EndTimeStep,
+				FVector3f(TrajMeta.Extent[0], TrajMeta.Extent[1], TrajMeta.Extent[2]), FirstSampleTimeStep, SampleCount);
+		}
+
+		SampleArena->AllocatePositions();
+	}
+	else
 	{
-		const FTrajectoryMetaBinary* TrajMeta = TrajMetaMap.Find(TrajId);
-		if (TrajMeta)
+		NewTrajectories.SetNum(NumTrajectories);
+		for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
 		{
-			FLoadedTrajectory& LoadedTraj = TrajectoryMap.Add(TrajId);
-			LoadedTraj.TrajectoryId = TrajId;
-			LoadedTraj.StartTimeStep = TrajMeta->StartTimeStep;
-			LoadedTraj.EndTimeStep = TrajMeta->EndTimeStep;
-			LoadedTraj.Extent = FVector3f(TrajMeta->Extent[0], TrajMeta->Extent[1], TrajMeta->Extent[2]);
-			LoadedTraj.Samples.Reserve((EndTime - StartTime) / Params.SampleRate);
+			const FTrajectoryMetaBinary& TrajMeta = TrajMetaTable.FindChecked(TrajIdsArray[TrajIdx]);
+			FLoadedTrajectory& LoadedTraj = NewTrajectories[TrajIdx];
+			LoadedTraj.TrajectoryId = TrajIdsArray[TrajIdx];
+			LoadedTraj.StartTimeStep = TrajMeta.StartTimeStep;
+			LoadedTraj.EndTimeStep = TrajMeta.EndTimeStep;
+			LoadedTraj.Extent = FVector3f(TrajMeta.Extent[0], TrajMeta.Extent[1], TrajMeta.Extent[2]);
+			LoadedTraj.FirstSampleTimeStep = GridFirstTimeSteps[TrajIdx];
 		}
 	}
+
+	// Raw pointer for the shard workers (each worker writes a disjoint time range of each slot)
+	FTrajectorySampleArena* ArenaPtr = SampleArena.Get();
 	
 	int64 MemoryUsed = 0;
 
-	// OPTIMIZATION 1 & 2: Parallelize shard processing and eliminate lock contention
-	// Process shards in parallel using per-shard result maps, then merge sequentially
-	// This removes all locking from the hot path while maintaining temporal ordering
+	// The load runs in passes so that no worker ever needs a lock and no merge step is needed:
+	//   1. Map shards and resolve the entry index of every (trajectory, shard) pair
+	//   2. Count samples per (trajectory, shard) and prefix-sum them into output offsets
+	//      (the sample arena already knows its offsets from metadata and skips this pass)
+	//   3. Fill - every (trajectory, shard) pair copies its samples to its own precomputed range
 	
-	// Structure to hold per-shard trajectory samples before merging
-	struct FShardTrajectoryData
+	// Per-shard state shared by all passes, one plan per (load level, relevant shard):
+	// plan LevelIdx * NumShards + ShardArrayIndex reads RelevantShards[ShardArrayIndex] at LoadLevels[LevelIdx]
+	struct FShardLoadPlan
 	{
-		TMap<int64, TArray<FVector3f>> TrajectorySamples;  // Per-trajectory samples for this shard
-		int32 ShardIndex;
-		FCriticalSection Mutex;  // Per-shard mutex for thread-safe map access
-	};
-	
-	// Structure to hold debug information for trajectory loading
-	struct FTrajectoryLoadDebugInfo
-	{
-		int64 TrajId;
-		int32 ShardIndex;
-		int32 ShardStartTimeStep;
-		int32 ShardEndTimeStep;
-		int32 StartTimeStepInInterval;
-		int32 ValidSampleCount;
-		int32 RequestedStartTimeStep;
-		int32 RequestedEndTimeStep;
-		int32 ValidRangeStart;
-		int32 ValidRangeEnd;
-		int32 LoadStart;
-		int32 LoadEnd;
-		int32 SamplesLoaded;
+		TSharedPtr<FMappedShardFile> MappedShard;
+		FDataBlockHeaderBinary Header;
+		FString ShardPath;  // Full-resolution or LOD shard
+		int32 ShardIndex = INDEX_NONE;
+		int32 StartTimeStep = 0;
+		int32 EndTimeStep = 0;
+		int32 DecimationFactor = 1;  // Shard slot k holds time step StartTimeStep + k * DecimationFactor
+		int32 SlotStride = 1;  // Every SlotStride-th slot is loaded
+		int32 EntrySizeBytes = 0;
+		TArray<int32> EntryIndices;  // Entry index per output slot, INDEX_NONE if the trajectory has no entry here or reads another level
+		bool bValid = false;
 	};
 	
-	// Thread-safe collection of debug info
-	TArray<FTrajectoryLoadDebugInfo> DebugInfoArray;
-	FCriticalSection DebugMutex;
-	
-	// Array to collect results from all shards (indexed by position in RelevantShards array)
-	TArray<FShardTrajectoryData> ShardResults;
-	ShardResults.SetNum(RelevantShards.Num());
+	const int32 NumPlans = NumLoadLevels * NumShards;
+	TArray<FShardLoadPlan> ShardPlans;
+	ShardPlans.SetNum(NumPlans);
 	
 	// OPTIMIZATION 3: Shard prefetching with futures
 	// Pre-start async mapping for all shards to enable parallel I/O
 	TArray<TFuture<TSharedPtr<FMappedShardFile>>> MappedShardFutures;
-	MappedShardFutures.Reserve(RelevantShards.Num());
+	MappedShardFutures.Reserve(NumPlans);
 	
-	for (int32 ShardArrayIndex = 0; ShardArrayIndex < RelevantShards.Num(); ++ShardArrayIndex)
+	for (int32 PlanIndex = 0; PlanIndex < NumPlans; ++PlanIndex)
 	{
-		int32 ShardIndex = RelevantShards[ShardArrayIndex];
+		const int32 LevelIdx = PlanIndex / NumShards;
+		const FTrajectoryLodLevel* LodLevel = LoadLevels[LevelIdx];
+		const int32 DecimationFactor = LodLevel ? LodLevel->DecimationFactor : 1;
+		int32 ShardIndex = RelevantShards[PlanIndex % NumShards];
 		const FShardInfo* ShardInfo = ShardInfoTable.Find(ShardIndex);
-		if (ShardInfo)
+		if (ShardInfo && LevelTrajIds[LevelIdx].Num() > 0)
 		{
-			FString ShardPath = ShardInfo->FilePath;
+			// Shards mapped by an earlier load of this dataset are reused without any I/O
+			if (TSharedPtr<FMappedShardFile> CachedShard = DatasetHandle->FindMappedShard(ShardIndex, DecimationFactor))
+			{
+				MappedShardFutures.Add(MakeFulfilledPromise<TSharedPtr<FMappedShardFile>>(CachedShard).GetFuture());
+				continue;
+			}
+
+			FString ShardPath = LodLevel ? LodLevel->ShardPaths.FindChecked(ShardIndex) : ShardInfo->FilePath;
 			// Start async memory-mapping immediately to hide I/O latency
 			// Note: Capture ShardPath by value since async task may outlive this scope
 			// Note: Capturing 'this' is safe because we wait for futures via Get() before returning
-			MappedShardFutures.Add(Async(EAsyncExecution::ThreadPool, [this, ShardPath]()
+			MappedShardFutures.Add(Async(EAsyncExecution::ThreadPool, [this, DatasetHandle, ShardIndex, ShardPath, DecimationFactor]()
 			{
-				return MapShardFile(ShardPath);
+				return GetOrMapShardFile(DatasetHandle, ShardIndex, ShardPath, DecimationFactor);
 			}));
 		}
 		else
@@ -549,24 +746,19 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 		}
 	}
 	
-	// OPTIMIZATION 4: Pre-compute trajectory arrays/sets once (used by all shards)
-	// Create once outside the parallel loop to avoid redundant construction
-	// Array copy first, then create set from it to avoid reading TrajectoryIds twice
-	TArray<int64> TrajIdsArray = TrajectoryIds;
-	TSet<int64> RequestedTrajIdSet(TrajIdsArray);
-	
-	// Process each relevant shard to accumulate trajectory data across time intervals
-	// Use ParallelFor to process multiple shards concurrently
-	ParallelFor(RelevantShards.Num(), [&](int32 ShardArrayIndex)
+	// ===== PASS 1: MAP SHARDS AND RESOLVE ENTRIES =====
+	ParallelFor(NumPlans, [&](int32 PlanIndex)
 	{
-		int32 ShardIndex = RelevantShards[ShardArrayIndex];
+		const int32 LevelIdx = PlanIndex / NumShards;
+		const FTrajectoryLodLevel* LodLevel = LoadLevels[LevelIdx];
+		int32 ShardIndex = RelevantShards[PlanIndex % NumShards];
 		const FShardInfo* ShardInfo = ShardInfoTable.Find(ShardIndex);
-		if (!ShardInfo)
+		if (!ShardInfo || LevelTrajIds[LevelIdx].Num() == 0)
 		{
 			return;
 		}
 
-		FString ShardPath = ShardInfo->FilePath;
+		FString ShardPath = LodLevel ? LodLevel->ShardPaths.FindChecked(ShardIndex) : ShardInfo->FilePath;
 
 		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 		if (!PlatformFile.FileExists(*ShardPath))
@@ -577,298 +769,335 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 
 		// OPTIMIZATION 3: Wait for prefetched shard mapping to complete
 		// By the time we reach this shard, its I/O may already be done
-		TSharedPtr<FMappedShardFile> MappedShard = MappedShardFutures[ShardArrayIndex].Get();
+		TSharedPtr<FMappedShardFile> MappedShard = MappedShardFutures[PlanIndex].Get();
 		if (!MappedShard.IsValid())
 		{
 			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Failed to map shard file: %s"), *ShardPath);
 			return;
 		}
 
+		FShardLoadPlan& Plan = ShardPlans[PlanIndex];
+
 		// Read shard header from mapped memory
-		FDataBlockHeaderBinary ShardHeader;
 		const uint8* MappedData = MappedShard->MappedRegion->GetMappedPtr();
 		int64 MappedSize = MappedShard->MappedRegion->GetMappedSize();
 		
-		if (!ReadShardHeaderMapped(MappedData, MappedSize, ShardHeader))
+		if (!ReadShardHeaderMapped(MappedData, MappedSize, Plan.Header))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Failed to read shard header: %s"), *ShardPath);
 			return;
 		}
 
+		if (LodLevel && Plan.Header.TimeStepIntervalSize != LodLevel->TimeStepIntervalSize)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: LOD shard %s has interval size %d, expected %d"),
+				*ShardPath, Plan.Header.TimeStepIntervalSize, LodLevel->TimeStepIntervalSize);
+			return;
+		}
+
 		UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Processing shard %d with %d trajectory entries"),
-			ShardIndex, ShardHeader.TrajectoryEntryCount);
+			ShardIndex, Plan.Header.TrajectoryEntryCount);
+
+		// OPTIMIZATION 4: Resolve entry positions only for requested trajectory IDs
+		// DirectSeek mode computes data_section_offset + idx * entry_size_bytes from trajectory metadata
+		// (or a cached per-shard index), so only the pages holding requested entries are touched
+		const int32 EntrySizeBytes = LodLevel ? LodLevel->EntrySizeBytes : DatasetMeta.EntrySizeBytes;
+		FTrajectoryShardReader ShardReader(MappedData, MappedSize, Plan.Header, EntrySizeBytes);
+		if (!ShardReader.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Invalid entry layout in shard: %s"), *ShardPath);
+			return;
+		}
 
-		// OPTIMIZATION 4: Build index only for requested trajectory IDs
-		// Instead of indexing all entries, only index those we're interested in
-		TMap<int64, int32> TrajIdToEntryIndex;
-		TrajIdToEntryIndex.Reserve(FMath::Min(TrajectoryIds.Num(), ShardHeader.TrajectoryEntryCount));
-		
-		int64 DataSectionStart = ShardHeader.DataSectionOffset;
-		int32 EntrySize = DatasetMeta.EntrySizeBytes;
-		
-		for (int32 EntryIdx = 0; EntryIdx < ShardHeader.TrajectoryEntryCount; ++EntryIdx)
+		TArray<int32> LevelEntryIndices;
+		ResolveShardEntryIndices(ShardReader, ShardPath, ShardInfo->StartTimeStep, ShardInfo->EndTimeStep,
+			LevelTrajIds[LevelIdx], TrajMetaTable, Params.EntryLookup, LevelEntryIndices);
+
+		Plan.EntryIndices.Init(INDEX_NONE, NumTrajectories);
+		for (int32 Index = 0; Index < LevelEntryIndices.Num(); ++Index)
 		{
-			int64 EntryOffset = DataSectionStart + (EntryIdx * EntrySize);
-			if (EntryOffset + (int64)sizeof(uint64) > MappedSize)
-			{
-				break;
-			}
-			
-			// Read trajectory ID from entry
-			uint64 EntryTrajId;
-			FMemory::Memcpy(&EntryTrajId, MappedData + EntryOffset, sizeof(uint64));
-			
-			// OPTIMIZATION 4: Only index entries for trajectories we're loading
-			if (RequestedTrajIdSet.Contains(EntryTrajId))
-			{
-				TrajIdToEntryIndex.Add(EntryTrajId, EntryIdx);
-			}
+			Plan.EntryIndices[LevelTrajIndices[LevelIdx][Index]] = LevelEntryIndices[Index];
 		}
-		
-		UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Built index for %d requested entries in shard %d"),
-			TrajIdToEntryIndex.Num(), ShardIndex);
 
-		// OPTIMIZATION 2: Use per-shard result structure to eliminate global lock contention
-		// Collect samples for this shard into a local structure with per-shard mutex
-		FShardTrajectoryData& ShardResult = ShardResults[ShardArrayIndex];
-		ShardResult.ShardIndex = ShardIndex;
-		
-		// Capture ShardInfo values to avoid pointer lifetime issues
-		int32 ShardStartTimeStep = ShardInfo->StartTimeStep;
-		int32 ShardEndTimeStep = ShardInfo->EndTimeStep;
-		
-		// Note: ParallelFor in UE uses the task graph system which automatically manages thread pools
-		// The task graph naturally limits parallelism based on available worker threads
-		// UE's scheduler will balance work between game thread and worker threads automatically
+		Plan.DecimationFactor = LodLevel ? LodLevel->DecimationFactor : 1;
+		Plan.SlotStride = Params.SampleRate / Plan.DecimationFactor;
+		Plan.EntrySizeBytes = EntrySizeBytes;
+		Plan.MappedShard = MappedShard;
+		Plan.ShardPath = ShardPath;
+		Plan.ShardIndex = ShardIndex;
+		Plan.StartTimeStep = ShardInfo->StartTimeStep;
+		Plan.EndTimeStep = ShardInfo->EndTimeStep;
+		Plan.bValid = true;
+	}, EParallelForFlags::Unbalanced);
+	
+	// ===== BUILD WORK BATCHES =====
+	// One flat list of (shard, trajectory) work items instead of a ParallelFor over shards with a nested ParallelFor
+	// over all trajectories: pairs whose lifetime doesn't overlap the shard never become tasks, and consecutive items
+	// of a shard are grouped into batches of roughly equal expected sample count so a few large shards or many tiny
+	// ones both keep every worker busy. Batches are scheduled unbalanced, so idle workers pick up remaining batches.
+	struct FShardLoadWorkItem
+	{
+		int32 PlanIndex;
+		int32 TrajIdx;
+		int32 EntryIdx;
+		int32 OutputOffset;  // First sample in the trajectory's Samples (per-trajectory arrays only)
+	};
+	
+	struct FShardLoadBatch
+	{
+		int32 PlanIndex;
+		int32 FirstItem;
+		int32 EndItem;  // Exclusive
+	};
+	
+	TArray<FShardLoadWorkItem> WorkItems;
+	TArray<int32> WorkItemExpectedSamples;
+	int64 TotalExpectedSamples = 0;
+	
+	for (int32 PlanIndex = 0; PlanIndex < NumPlans; ++PlanIndex)
+	{
+		const FShardLoadPlan& Plan = ShardPlans[PlanIndex];
+		if (!Plan.bValid)
+		{
+			continue;
+		}
 		
-		ParallelFor(TrajIdsArray.Num(), [this, &TrajIdsArray, &TrajMetaMap, &ShardResult, &DebugInfoArray, &DebugMutex,
-			MappedData, MappedSize, &ShardHeader, &DatasetMeta, &Params, ShardStartTimeStep, ShardEndTimeStep,
-			&TrajIdToEntryIndex, DataSectionStart, EntrySize, ShardIndex](int32 Index)
+		for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
 		{
-			int64 TrajId = TrajIdsArray[Index];
-			const FTrajectoryMetaBinary* TrajMeta = TrajMetaMap.Find(TrajId);
-			
-			if (!TrajMeta)
-			{
-				return;
-			}
-			
-			// Check if this trajectory has data in this time interval
-			if (TrajMeta->EndTimeStep < ShardStartTimeStep || TrajMeta->StartTimeStep > ShardEndTimeStep)
+			const int32 EntryIdx = Plan.EntryIndices[TrajIdx];
+			if (EntryIdx == INDEX_NONE)
 			{
-				// Trajectory doesn't exist in this time interval
-				return;
+				// This trajectory doesn't have an entry in this shard
+				continue;
 			}
 			
-			// Use index for O(1) lookup instead of O(M) linear search
-			const int32* EntryIdxPtr = TrajIdToEntryIndex.Find(TrajId);
-			if (!EntryIdxPtr)
+			// Expected samples from metadata: lifetime clipped to the shard interval and the requested range
+			const FTrajectoryMetaBinary& TrajMeta = TrajMetaTable.FindChecked(TrajIdsArray[TrajIdx]);
+			const int32 OverlapStart = FMath::Max3(TrajMeta.StartTimeStep, Plan.StartTimeStep, StartTime);
+			const int32 OverlapEnd = FMath::Min3(TrajMeta.EndTimeStep, Plan.EndTimeStep, EndTime);
+			if (OverlapEnd < OverlapStart)
 			{
-				// This trajectory doesn't have an entry in this shard
-				return;
+				continue;
 			}
 			
-			int32 EntryIdx = *EntryIdxPtr;
-			
-			// Calculate absolute offset to this entry in the file
-			// Per specification: file_offset = data_section_offset + (entry_offset_index * entry_size_bytes)
-			int64 EntryOffset = DataSectionStart + (EntryIdx * EntrySize);
-			
-			// Validate entry is within mapped file bounds
-			if (EntryOffset + EntrySize > MappedSize)
+			const int32 ExpectedSamples = (OverlapEnd - OverlapStart) / Params.SampleRate + 1;
+			WorkItems.Add({ PlanIndex, TrajIdx, EntryIdx, 0 });
+			WorkItemExpectedSamples.Add(ExpectedSamples);
+			TotalExpectedSamples += ExpectedSamples;
+		}
+	}
+	
+	// Aim for several batches per worker so stragglers can be balanced, but keep batches large enough
+	// that task overhead stays negligible against the copy work
+	constexpr int32 BatchesPerWorker = 4;
+	constexpr int64 MinSamplesPerBatch = 16 * 1024;
+	const int32 NumWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+	const int64 TargetSamplesPerBatch = FMath::Max(MinSamplesPerBatch, TotalExpectedSamples / (NumWorkers * BatchesPerWorker));
+	
+	TArray<FShardLoadBatch> Batches;
+	{
+		int64 BatchSamples = 0;
+		for (int32 ItemIdx = 0; ItemIdx < WorkItems.Num(); ++ItemIdx)
+		{
+			const int32 PlanIndex = WorkItems[ItemIdx].PlanIndex;
+			if (Batches.Num() == 0 || Batches.Last().PlanIndex != PlanIndex || BatchSamples >= TargetSamplesPerBatch)
 			{
-				return;
+				Batches.Add({ PlanIndex, ItemIdx, ItemIdx });
+				BatchSamples = 0;
 			}
 			
-			// ===== READ ENTRY HEADER FROM BINARY FILE =====
-			// Per specification, each entry has fixed layout:
-			// Offset 0:  uint64 trajectory_id (8 bytes)
-			// Offset 8:  int32 start_time_step_in_interval (4 bytes)
-			// Offset 12: int32 valid_sample_count (4 bytes)
-			// Offset 16: float32[time_step_interval_size][3] positions array
-			
-			const uint8* EntryPtr = MappedData + EntryOffset;
-			
-			// Read trajectory_id at offset 0 (8 bytes) - not used, but here for clarity
-			// uint64 EntryTrajId;
-			// FMemory::Memcpy(&EntryTrajId, EntryPtr + 0, sizeof(uint64));
-			
-			// Read start_time_step_in_interval at offset 8 (4 bytes)
-			// Per specification: -1 if no valid samples exist in this interval
-			int32 StartTimeStepInInterval;
-			FMemory::Memcpy(&StartTimeStepInInterval, EntryPtr + 8, sizeof(int32));
-			
-			// Read valid_sample_count at offset 12 (4 bytes)
-			int32 ValidSampleCount;
-			FMemory::Memcpy(&ValidSampleCount, EntryPtr + 12, sizeof(int32));
+			Batches.Last().EndItem = ItemIdx + 1;
+			BatchSamples += WorkItemExpectedSamples[ItemIdx];
+		}
+	}
+	
+	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Scheduling %d work items in %d batches (%lld expected samples, %d workers)"),
+		WorkItems.Num(), Batches.Num(), TotalExpectedSamples, NumWorkers);
+	
+	// ===== PASS 2: COUNT AND PREFIX SUM (per-trajectory arrays only) =====
+	if (!bUseSampleArena)
+	{
+		// Count - every work item writes only its own counter
+		ParallelFor(Batches.Num(), [&](int32 BatchIdx)
+		{
+			const FShardLoadBatch& Batch = Batches[BatchIdx];
+			const FShardLoadPlan& Plan = ShardPlans[Batch.PlanIndex];
+			const FTrajectoryShardReader ShardReader(Plan.MappedShard->MappedRegion->GetMappedPtr(),
+				Plan.MappedShard->MappedRegion->GetMappedSize(), Plan.Header, Plan.EntrySizeBytes);
 			
-			// Check for sentinel value indicating no valid samples in this interval
-			// Per specification: start_time_step_in_interval == -1 means "none valid"
-			if (StartTimeStepInInterval == -1)
+			for (int32 ItemIdx = Batch.FirstItem; ItemIdx < Batch.EndItem; ++ItemIdx)
 			{
-				return; // No valid samples in this interval for this trajectory
+				FShardLoadWorkItem& Item = WorkItems[ItemIdx];
+				FShardEntryLoadRange Range;
+				Item.OutputOffset = GetEntryLoadRange(ShardReader.GetEntryPtr(Item.EntryIdx), Plan.StartTimeStep, Plan.Header.TimeStepIntervalSize,
+					Plan.DecimationFactor, GridFirstTimeSteps[Item.TrajIdx], Params, Range)
+					? FMath::DivideAndRoundUp(Range.LoadEnd - Range.LoadStart, Plan.SlotStride)
+					: 0;
 			}
-			
-			// Validate sample count - should be positive if StartTimeStepInInterval is valid
-			if (ValidSampleCount <= 0)
+		}, EParallelForFlags::Unbalanced);
+		
+		// Prefix sum in work item order - a trajectory's items all belong to plans of its level, which are sorted
+		// by shard, and RelevantShards is chronological, so each trajectory's slices end up in temporal order
+		TArray<int32> TrajSampleCounts;
+		TrajSampleCounts.SetNumZeroed(NumTrajectories);
+		for (FShardLoadWorkItem& Item : WorkItems)
+		{
+			const int32 ItemCount = Item.OutputOffset;
+			Item.OutputOffset = TrajSampleCounts[Item.TrajIdx];
+			TrajSampleCounts[Item.TrajIdx] += ItemCount;
+		}
+		
+		// Allocate each trajectory's samples exactly once
+		ParallelFor(NumTrajectories, [&](int32 TrajIdx)
+		{
+			NewTrajectories[TrajIdx].Samples.SetNumUninitialized(TrajSampleCounts[TrajIdx]);
+		});
+	}
+	
+	// ===== PASS 3: FILL =====
+	// Every work item owns a disjoint output range - no locks and no merge needed
+	// Compressed shards (format version 2) store bbox-relative quantized positions
+	const FTrajectoryQuantization Quantization = FTrajectoryQuantization::FromDatasetMeta(DatasetMeta);
+	
+	auto FillEntry = [&](const FShardLoadPlan& Plan, const FTrajectoryShardReader& ShardReader, const FShardLoadWorkItem& Item,
+		TArray<FPositionSampleBinary>& DecodedSlots, FTrajectoryDecodeScratch& DecodeScratch)
+	{
+		const int32 TrajIdx = Item.TrajIdx;
+		const int32 EntryIdx = Item.EntryIdx;
+		
+		// ===== READ ENTRY HEADER AND DETERMINE WHICH SAMPLES TO LOAD =====
+		const uint8* EntryPtr = ShardReader.GetEntryPtr(EntryIdx);
+		FShardEntryLoadRange Range;
+		if (!GetEntryLoadRange(EntryPtr, Plan.StartTimeStep, Plan.Header.TimeStepIntervalSize, Plan.DecimationFactor, GridFirstTimeSteps[TrajIdx], Params, Range))
+		{
+			return;
+		}
+		
+		const FPositionSampleBinary* PositionsArray = nullptr;
+		if (ShardReader.IsCompressed())
+		{
+			// Decode the entry into interval slots so the copy below works the same for both formats
+			// (only slots in the entry's valid range are written, which contains [LoadStart, LoadEnd))
+			DecodedSlots.SetNumUninitialized(Plan.Header.TimeStepIntervalSize, EAllowShrinking::No);
+			if (!FTrajectoryShardCodec::DecodeEntry(ShardReader.GetEntryData(EntryIdx), Plan.Header.TimeStepIntervalSize,
+				Quantization, DecodedSlots.GetData(), DecodeScratch))
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Trajectory %llu in shard has valid StartTimeStepInInterval (%d) but invalid ValidSampleCount (%d). Skipping."),
-					TrajId, StartTimeStepInInterval, ValidSampleCount);
-				return; // Invalid data - skip this trajectory entry
+				UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Malformed compressed entry for trajectory %lld in shard %d. Skipping."),
+					TrajIdsArray[TrajIdx], Plan.ShardIndex);
+				return;
 			}
-			
+			PositionsArray = DecodedSlots.GetData();
+		}
+		else
+		{
 			// Positions array starts at offset 16
 			// It contains ALL time_step_interval_size samples (indexed 0..TimeStepIntervalSize-1)
 			// Invalid samples are marked with NaN values
 			const int32 PositionsArrayOffset = 16;
-			const FPositionSampleBinary* PositionsArray = reinterpret_cast<const FPositionSampleBinary*>(EntryPtr + PositionsArrayOffset);
-			
-			// ===== DETERMINE WHICH SAMPLES TO LOAD =====
-			
-			// Calculate the valid range within this shard
-			// StartTimeStepInInterval tells us where valid data starts (0-based index in interval)
-			// ValidSampleCount tells us how many consecutive samples are valid
-			int32 ValidRangeStart = StartTimeStepInInterval;
-			int32 ValidRangeEnd = StartTimeStepInInterval + ValidSampleCount;
-			
-			// Clamp to the requested time range (convert global time steps to shard-relative indices)
-			int32 LoadStart = ValidRangeStart;
-			int32 LoadEnd = ValidRangeEnd;
-			
-			if (Params.StartTimeStep >= 0)
-			{
-				int32 RequestedStartRelative = Params.StartTimeStep - ShardStartTimeStep;
-				LoadStart = FMath::Max(LoadStart, RequestedStartRelative);
-			}
-			
-			if (Params.EndTimeStep >= 0)
-			{
-				int32 RequestedEndRelative = Params.EndTimeStep - ShardStartTimeStep + 1;
-				LoadEnd = FMath::Min(LoadEnd, RequestedEndRelative);
-			}
-			
-			// Ensure we stay within the shard's time step interval bounds
-			LoadStart = FMath::Clamp(LoadStart, 0, ShardHeader.TimeStepIntervalSize);
-			LoadEnd = FMath::Clamp(LoadEnd, 0, ShardHeader.TimeStepIntervalSize);
-			
-			if (LoadStart >= LoadEnd)
-			{
-				return; // No samples to load from this shard for this trajectory
-			}
-			
-			// ===== LOAD POSITION SAMPLES =====
-			
-			TArray<FVector3f> ShardSamples;
+			PositionsArray = reinterpret_cast<const FPositionSampleBinary*>(EntryPtr + PositionsArrayOffset);
+		}
+		
+		// ===== LOCATE OUTPUT RANGE =====
+		FVector3f* OutSamples = nullptr;
+		int32 FirstTimeStepIdx = Range.LoadStart;
+		int32 NumSamples = 0;
+		
+		if (ArenaPtr)
+		{
+			// Arena slot sample k holds global time step FirstSampleTimeStep + k * SampleRate
+			const int32 FirstSampleTimeStep = ArenaPtr->FirstSampleTimeSteps[TrajIdx];
+			const int32 SlotSampleCount = ArenaPtr->SampleCounts[TrajIdx];
+			const int32 GlobalLoadStart = Plan.StartTimeStep + Range.LoadStart * Plan.DecimationFactor;
+			const int32 GlobalLoadEnd = Plan.StartTimeStep + (Range.LoadEnd - 1) * Plan.DecimationFactor + 1; // Exclusive
 			
-			// FAST PATH: Sample rate 1 - bulk load all consecutive samples with memcpy
-			// NOTE: NaN values are preserved and passed through to Niagara for HLSL-based filtering
-			// This maintains correct position array indexing for trajectory ID mapping in Niagara
-			if (Params.SampleRate == 1)
-			{
-				// Calculate exact number of samples to load
-				int32 NumSamples = LoadEnd - LoadStart;
-				
-				// Pre-allocate array
-				ShardSamples.SetNumUninitialized(NumSamples);
-				
-				// Bulk copy position data using memcpy (including NaN values)
-				// FPositionSampleBinary (3 floats, 12 bytes) maps directly to FVector3f (3 floats, 12 bytes)
-				// PositionsArray[LoadStart] corresponds to time step (ShardStartTimeStep + LoadStart)
-				// NaN values represent invalid/missing samples per specification and are handled in Niagara HLSL
-				FMemory::Memcpy(ShardSamples.GetData(), &PositionsArray[LoadStart], NumSamples * sizeof(FPositionSampleBinary));
-			}
-			else
+			if (GlobalLoadEnd <= FirstSampleTimeStep)
 			{
-				// SLOW PATH: Sample rate > 1 - load individual samples with skipping
-				// NOTE: NaN values are preserved and passed through to Niagara for HLSL-based filtering
-				int32 NumSamplesToLoad = ((LoadEnd - LoadStart) + Params.SampleRate - 1) / Params.SampleRate;
-				ShardSamples.SetNumUninitialized(NumSamplesToLoad);
-				
-				// Iterate through the range with sample rate stride
-				int32 SampleIndex = 0;
-				for (int32 TimeStepIdx = LoadStart; TimeStepIdx < LoadEnd; TimeStepIdx += Params.SampleRate)
-				{
-					// Read position from PositionsArray[TimeStepIdx]
-					// This corresponds to global time step: ShardStartTimeStep + TimeStepIdx
-					const FPositionSampleBinary& BinarySample = PositionsArray[TimeStepIdx];
-					
-					// Copy sample including NaN values (handled in Niagara HLSL)
-					ShardSamples[SampleIndex++] = FVector3f(BinarySample.X, BinarySample.Y, BinarySample.Z);
-				}
+				return;
 			}
 			
-			// ===== STORE RESULTS IN PER-SHARD MAP =====
-			
-			// Capture sample count BEFORE moving the array
-			int32 SamplesLoadedCount = ShardSamples.Num();
-			
-			// Store results with per-shard locking (much smaller contention than global lock)
-			// Use FindOrAdd for safety in case a trajectory appears multiple times in a shard
-			if (ShardSamples.Num() > 0)
-			{
-				FScopeLock Lock(&ShardResult.Mutex);
-				ShardResult.TrajectorySamples.FindOrAdd(TrajId).Append(MoveTemp(ShardSamples));
-			}
+			// Range of slot samples whose time steps fall into [GlobalLoadStart, GlobalLoadEnd)
+			const int32 FirstSlotSample = FMath::DivideAndRoundUp(FMath::Max(GlobalLoadStart - FirstSampleTimeStep, 0), Params.SampleRate);
+			const int32 EndSlotSample = FMath::Min(FMath::DivideAndRoundUp(GlobalLoadEnd - FirstSampleTimeStep, Params.SampleRate), SlotSampleCount);
 			
-			// Capture debug information (thread-safe)
+			OutSamples = ArenaPtr->Positions.GetData() + ArenaPtr->SampleOffsets[TrajIdx] + FirstSlotSample;
+			FirstTimeStepIdx = (FirstSampleTimeStep + FirstSlotSample * Params.SampleRate - Plan.StartTimeStep) / Plan.DecimationFactor;
+			NumSamples = EndSlotSample - FirstSlotSample;
+		}
+		else
+		{
+			// Offset computed by the prefix sum - shards are laid out in chronological order
+			OutSamples = NewTrajectories[TrajIdx].Samples.GetData() + Item.OutputOffset;
+			NumSamples = FMath::DivideAndRoundUp(Range.LoadEnd - Range.LoadStart, Plan.SlotStride);
+		}
+		
+		if (NumSamples <= 0)
+		{
+			return;
+		}
+		
+		// ===== LOAD POSITION SAMPLES =====
+		// NOTE: NaN values are preserved and passed through to Niagara for HLSL-based filtering
+		// This maintains correct position array indexing for trajectory ID mapping in Niagara
+		
+		if (Plan.SlotStride == 1)
+		{
+			// FAST PATH: Every slot is loaded (sample rate 1, or the LOD level matches the sample rate) - bulk copy with memcpy
+			// FPositionSampleBinary (3 floats, 12 bytes) maps directly to FVector3f (3 floats, 12 bytes)
+			// PositionsArray[FirstTimeStepIdx] corresponds to time step (ShardStartTimeStep + FirstTimeStepIdx * Plan.DecimationFactor)
+			FMemory::Memcpy(OutSamples, &PositionsArray[FirstTimeStepIdx], NumSamples * sizeof(FPositionSampleBinary));
+		}
+		else
+		{
+			// SLOW PATH: Copy every SlotStride-th slot
+			int32 TimeStepIdx = FirstTimeStepIdx;
+			for (int32 SampleIdx = 0; SampleIdx < NumSamples; ++SampleIdx)
 			{
-				FTrajectoryLoadDebugInfo DebugInfo;
-				DebugInfo.TrajId = TrajId;
-				DebugInfo.ShardIndex = ShardIndex;
-				DebugInfo.ShardStartTimeStep = ShardStartTimeStep;
-				DebugInfo.ShardEndTimeStep = ShardEndTimeStep;
-				DebugInfo.StartTimeStepInInterval = StartTimeStepInInterval;
-				DebugInfo.ValidSampleCount = ValidSampleCount;
-				DebugInfo.RequestedStartTimeStep = Params.StartTimeStep;
-				DebugInfo.RequestedEndTimeStep = Params.EndTimeStep;
-				DebugInfo.ValidRangeStart = ValidRangeStart;
-				DebugInfo.ValidRangeEnd = ValidRangeEnd;
-				DebugInfo.LoadStart = LoadStart;
-				DebugInfo.LoadEnd = LoadEnd;
-				DebugInfo.SamplesLoaded = SamplesLoadedCount;  // Use captured count, not after Move
-				
-				FScopeLock DebugLock(&DebugMutex);
-				DebugInfoArray.Add(DebugInfo);
+				const FPositionSampleBinary& BinarySample = PositionsArray[TimeStepIdx];
+				OutSamples[SampleIdx] = FVector3f(BinarySample.X, BinarySample.Y, BinarySample.Z);
+				TimeStepIdx += Plan.SlotStride;
 			}
-		});
-	});
-	
-	// OPTIMIZATION 1 & 2: Merge shard results sequentially in chronological order
-	// This maintains temporal ordering while avoiding all locking during parallel processing
-	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Merging results from %d shards"), ShardResults.Num());
+		}
+	};
 	
-	for (const FShardTrajectoryData& ShardResult : ShardResults)
+	ParallelFor(Batches.Num(), [&](int32 BatchIdx)
 	{
-		for (const auto& SampleEntry : ShardResult.TrajectorySamples)
+		const FShardLoadBatch& Batch = Batches[BatchIdx];
+		const FShardLoadPlan& Plan = ShardPlans[Batch.PlanIndex];
+		const FTrajectoryShardReader ShardReader(Plan.MappedShard->MappedRegion->GetMappedPtr(),
+			Plan.MappedShard->MappedRegion->GetMappedSize(), Plan.Header, Plan.EntrySizeBytes);
+		
+		// Decode buffers are reused for all entries of the batch
+		TArray<FPositionSampleBinary> DecodedSlots;
+		FTrajectoryDecodeScratch DecodeScratch;
+		
+		for (int32 ItemIdx = Batch.FirstItem; ItemIdx < Batch.EndItem; ++ItemIdx)
 		{
-			int64 TrajId = SampleEntry.Key;
-			const TArray<FVector3f>& ShardSamples = SampleEntry.Value;
-			
-			FLoadedTrajectory* LoadedTraj = TrajectoryMap.Find(TrajId);
-			if (LoadedTraj)
-			{
-				// Append samples in chronological order (shards are processed in sorted order)
-				LoadedTraj->Samples.Append(ShardSamples);
-			}
+			FillEntry(Plan, ShardReader, WorkItems[ItemIdx], DecodedSlots, DecodeScratch);
 		}
+	}, EParallelForFlags::Unbalanced);
+
+	// Calculate memory usage
+	// Note: Samples are already in temporal order because every (trajectory, shard) pair was written
+	// to the range reserved for it in chronological shard order - no sorting or merging needed
+	for (const FLoadedTrajectory& Traj : NewTrajectories)
+	{
+		MemoryUsed += sizeof(FLoadedTrajectory) + Traj.Samples.Num() * sizeof(FVector3f);
 	}
 
-	// Convert map to array
-	TArray<FLoadedTrajectory> NewTrajectories;
-	for (auto& TrajEntry : TrajectoryMap)
+	if (SampleArena.IsValid())
 	{
-		FLoadedTrajectory& Traj = TrajEntry.Value;
-		
-		// Note: Samples are already in temporal order because:
-		// 1. Shards are merged sequentially in chronological order (sorted by time)
-		// 2. Within each shard, samples are loaded in consecutive order
-		// No sorting needed!
-		
-		// Calculate memory usage
-		int64 TrajMemory = sizeof(FLoadedTrajectory) + Traj.Samples.Num() * sizeof(FVector3f);
-		MemoryUsed += TrajMemory;
-		
-		NewTrajectories.Add(MoveTemp(Traj));
+		MemoryUsed += SampleArena->GetAllocatedSize();
+	}
+
+	// Streaming intervals are owned by their session - hand the samples back without keeping a dataset entry
+	if (!bRegisterDataset)
+	{
+		Result.bSuccess = true;
+		Result.NumTrajectoriesLoaded = bUseSampleArena ? SampleArena->Num() : NewTrajectories.Num();
+		Result.Trajectories = MoveTemp(NewTrajectories);
+		Result.SampleArena = SampleArena;
+		Result.MemoryUsedBytes = MemoryUsed;
+		return Result;
 	}
 
 	// Create a new loaded dataset entry
@@ -876,21 +1105,27 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 	LoadedDataset.LoadParams = Params;
 	LoadedDataset.DatasetInfo = DatasetInfo;
 	LoadedDataset.Trajectories = MoveTemp(NewTrajectories);
+	LoadedDataset.SampleArena = SampleArena;
 	LoadedDataset.MemoryUsedBytes = MemoryUsed;
 
 	// Add to loaded datasets array
 	LoadedDatasets.Add(MoveTemp(LoadedDataset));
 	CurrentMemoryUsage += MemoryUsed;
 
+	const FLoadedDataset& NewDataset = LoadedDatasets.Last();
+
 	Result.bSuccess = true;
-	Result.Trajectories = LoadedDatasets.Last().Trajectories;
+	Result.Trajectories = NewDataset.Trajectories;
+	Result.SampleArena = NewDataset.SampleArena;
+	Result.NumTrajectoriesLoaded = NewDataset.GetNumTrajectories();
 	Result.MemoryUsedBytes = MemoryUsed;
 
 	UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Successfully loaded %d trajectories, using %s memory (Total datasets: %d, Total memory: %s)"),
-		Result.Trajectories.Num(), *UTrajectoryDataBlueprintLibrary::FormatMemorySize(MemoryUsed),
+		Result.NumTrajectoriesLoaded, *UTrajectoryDataBlueprintLibrary::FormatMemorySize(MemoryUsed),
 		LoadedDatasets.Num(), *UTrajectoryDataBlueprintLibrary::FormatMemorySize(CurrentMemoryUsage));
 
 	// DEBUG: Export loaded data to human-readable text file for debugging
+	if (UTrajectoryDataSettings::Get()->bDebugLogging)
 	{
 		FString DebugFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DebugTrajectoryData.txt"));
 		FString DebugOutput;
@@ -899,42 +1134,72 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 		DebugOutput += FString::Printf(TEXT("Dataset Path: %s\n"), *DatasetInfo.DatasetPath);
 		DebugOutput += FString::Printf(TEXT("Time Range: %d - %d\n"), StartTime, EndTime);
 		DebugOutput += FString::Printf(TEXT("Sample Rate: %d\n"), Params.SampleRate);
-		DebugOutput += FString::Printf(TEXT("Total Trajectories Loaded: %d\n"), Result.Trajectories.Num());
+		for (int32 LevelIdx = 0; LevelIdx < NumLoadLevels; ++LevelIdx)
+		{
+			DebugOutput += FString::Printf(TEXT("LOD Decimation Factor %d: %d trajectories\n"),
+				LoadLevels[LevelIdx] ? LoadLevels[LevelIdx]->DecimationFactor : 1, LevelTrajIds[LevelIdx].Num());
+		}
+		DebugOutput += FString::Printf(TEXT("Total Trajectories Loaded: %d\n"), Result.NumTrajectoriesLoaded);
 		DebugOutput += FString::Printf(TEXT("Memory Used: %lld bytes\n\n"), MemoryUsed);
 		
 		// Add debug info section showing LoadStart calculations
+		// Recomputed here from the shard plans so the parallel passes stay free of debug bookkeeping
 		DebugOutput += FString::Printf(TEXT("=== LoadStart Calculation Debug ===\n"));
-		DebugOutput += FString::Printf(TEXT("Total load operations: %d\n\n"), DebugInfoArray.Num());
-		
-		// Show first 20 debug entries
-		int32 NumToShow = FMath::Min(20, DebugInfoArray.Num());
-		for (int32 i = 0; i < NumToShow; ++i)
-		{
-			const FTrajectoryLoadDebugInfo& Info = DebugInfoArray[i];
-			DebugOutput += FString::Printf(TEXT("--- Load Operation %d ---\n"), i);
-			DebugOutput += FString::Printf(TEXT("TrajID: %lld, ShardIndex: %d\n"), Info.TrajId, Info.ShardIndex);
-			DebugOutput += FString::Printf(TEXT("Shard Time Range: %d - %d\n"), Info.ShardStartTimeStep, Info.ShardEndTimeStep);
-			DebugOutput += FString::Printf(TEXT("Requested Time Range: %d - %d\n"), Info.RequestedStartTimeStep, Info.RequestedEndTimeStep);
-			DebugOutput += FString::Printf(TEXT("StartTimeStepInInterval: %d\n"), Info.StartTimeStepInInterval);
-			DebugOutput += FString::Printf(TEXT("ValidSampleCount: %d\n"), Info.ValidSampleCount);
-			DebugOutput += FString::Printf(TEXT("ValidRange: [%d, %d)\n"), Info.ValidRangeStart, Info.ValidRangeEnd);
-			DebugOutput += FString::Printf(TEXT("LoadStart: %d, LoadEnd: %d\n"), Info.LoadStart, Info.LoadEnd);
-			DebugOutput += FString::Printf(TEXT("PositionsArray indices read: [%d, %d)\n"), Info.LoadStart, Info.LoadEnd);
-			DebugOutput += FString::Printf(TEXT("Global time steps read: [%d, %d)\n"), 
-				Info.ShardStartTimeStep + Info.LoadStart, Info.ShardStartTimeStep + Info.LoadEnd);
-			DebugOutput += FString::Printf(TEXT("Samples Loaded: %d\n\n"), Info.SamplesLoaded);
-		}
 		
-		if (DebugInfoArray.Num() > NumToShow)
+		constexpr int32 MaxLoadOperationsToShow = 20;
+		int32 NumLoadOperations = 0;
+		for (const FShardLoadPlan& Plan : ShardPlans)
 		{
-			DebugOutput += FString::Printf(TEXT("... (%d more load operations omitted) ...\n\n"), DebugInfoArray.Num() - NumToShow);
+			if (!Plan.bValid)
+			{
+				continue;
+			}
+			
+			const FTrajectoryShardReader ShardReader(Plan.MappedShard->MappedRegion->GetMappedPtr(),
+				Plan.MappedShard->MappedRegion->GetMappedSize(), Plan.Header, Plan.EntrySizeBytes);
+			
+			for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
+			{
+				FShardEntryLoadRange Range;
+				const int32 EntryIdx = Plan.EntryIndices[TrajIdx];
+				if (EntryIdx == INDEX_NONE ||
+					!GetEntryLoadRange(ShardReader.GetEntryPtr(EntryIdx), Plan.StartTimeStep, Plan.Header.TimeStepIntervalSize, Plan.DecimationFactor,
+						GridFirstTimeSteps[TrajIdx], Params, Range))
+				{
+					continue;
+				}
+				
+				if (NumLoadOperations < MaxLoadOperationsToShow)
+				{
+					DebugOutput += FString::Printf(TEXT("--- Load Operation %d ---\n"), NumLoadOperations);
+					DebugOutput += FString::Printf(TEXT("TrajID: %lld, ShardIndex: %d\n"), TrajIdsArray[TrajIdx], Plan.ShardIndex);
+					DebugOutput += FString::Printf(TEXT("Shard Time Range: %d - %d\n"), Plan.StartTimeStep, Plan.EndTimeStep);
+					DebugOutput += FString::Printf(TEXT("Requested Time Range: %d - %d\n"), Params.StartTimeStep, Params.EndTimeStep);
+					DebugOutput += FString::Printf(TEXT("StartTimeStepInInterval: %d\n"), Range.StartTimeStepInInterval);
+					DebugOutput += FString::Printf(TEXT("ValidSampleCount: %d\n"), Range.ValidSampleCount);
+					DebugOutput += FString::Printf(TEXT("ValidRange: [%d, %d)\n"), Range.ValidRangeStart, Range.ValidRangeEnd);
+					DebugOutput += FString::Printf(TEXT("LoadStart: %d, LoadEnd: %d\n"), Range.LoadStart, Range.LoadEnd);
+					DebugOutput += FString::Printf(TEXT("PositionsArray indices read: [%d, %d)\n"), Range.LoadStart, Range.LoadEnd);
+					DebugOutput += FString::Printf(TEXT("Global time steps read: [%d, %d)\n"), 
+						Plan.StartTimeStep + Range.LoadStart * Plan.DecimationFactor, Plan.StartTimeStep + (Range.LoadEnd - 1) * Plan.DecimationFactor + 1);
+					DebugOutput += FString::Printf(TEXT("Samples Loaded: %d\n\n"),
+						FMath::DivideAndRoundUp(Range.LoadEnd - Range.LoadStart, Plan.SlotStride));
+				}
+				++NumLoadOperations;
+			}
+		}
+		
+		DebugOutput += FString::Printf(TEXT("Total load operations: %d\n\n"), NumLoadOperations);
+		if (NumLoadOperations > MaxLoadOperationsToShow)
+		{
+			DebugOutput += FString::Printf(TEXT("... (%d more load operations omitted) ...\n\n"), NumLoadOperations - MaxLoadOperationsToShow);
 		}
 		
 		DebugOutput += FString::Printf(TEXT("=== Loaded Trajectory Data ===\n\n"));
 		
-		for (int32 TrajIdx = 0; TrajIdx < Result.Trajectories.Num(); ++TrajIdx)
+		for (int32 TrajIdx = 0; TrajIdx < NewDataset.GetNumTrajectories(); ++TrajIdx)
 		{
-			const FLoadedTrajectory& Traj = Result.Trajectories[TrajIdx];
+			const FLoadedTrajectoryView Traj = NewDataset.GetTrajectoryView(TrajIdx);
 			DebugOutput += FString::Printf(TEXT("--- Trajectory %d ---\n"), TrajIdx);
 			DebugOutput += FString::Printf(TEXT("Trajectory ID: %lld\n"), Traj.TrajectoryId);
 			DebugOutput += FString::Printf(TEXT("Start Time Step: %d\n"), Traj.StartTimeStep);
@@ -993,6 +1258,9 @@ FTrajectoryLoadResult UTrajectoryDataLoader::LoadTrajectoriesInternal(const FTra
 			*UTrajectoryDataBlueprintLibrary::FormatMemorySize(CurrentMemoryUsage));
 	}
 
+	// Shards mapped during this load count against the dataset handle budget
+	TrimDatasetHandleCache();
+
 	return Result;
 }
 
@@ -1040,46 +1308,15 @@ bool UTrajectoryDataLoader::ReadDatasetMeta(const FString& DatasetPath, FDataset
 	return true;
 }
 
-bool UTrajectoryDataLoader::ReadTrajectoryMeta(const FString& DatasetPath, TArray<FTrajectoryMetaBinary>& OutMetas)
+bool UTrajectoryDataLoader::ReadTrajectoryMeta(const FString& DatasetPath, FTrajectoryMetaTable& OutMetas)
 {
 	FString TrajMetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-trajmeta.bin"));
-	
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	
-	// Get file size
-	int64 FileSize = PlatformFile.FileSize(*TrajMetaPath);
-	if (FileSize <= 0)
-	{
-		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Invalid file size for dataset-trajmeta.bin"));
-		return false;
-	}
-
-	int32 NumTrajectories = FileSize / sizeof(FTrajectoryMetaBinary);
-	if (FileSize % sizeof(FTrajectoryMetaBinary) != 0)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: File size not a multiple of trajectory meta size"));
-	}
-
-	// Memory-map the file for fast reading
-	TUniquePtr<IMappedFileHandle> MappedFileHandle(PlatformFile.OpenMapped(*TrajMetaPath));
-	if (!MappedFileHandle.IsValid())
+	if (!OutMetas.Open(TrajMetaPath))
 	{
-		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Failed to memory-map file: %s"), *TrajMetaPath);
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Failed to read dataset-trajmeta.bin: %s"), *TrajMetaPath);
 		return false;
 	}
 
-	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFileHandle->MapRegion(0, FileSize));
-	if (!MappedRegion.IsValid())
-	{
-		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Failed to map file region: %s"), *TrajMetaPath);
-		return false;
-	}
-
-	// Direct copy from mapped memory
-	const uint8* MappedData = MappedRegion->GetMappedPtr();
-	OutMetas.SetNum(NumTrajectories);
-	FMemory::Memcpy(OutMetas.GetData(), MappedData, NumTrajectories * sizeof(FTrajectoryMetaBinary));
-
 	return true;
 }
 
@@ -1118,7 +1355,8 @@ bool UTrajectoryDataLoader::ReadShardHeader(const FString& ShardPath, FDataBlock
 
 
 TArray<int64> UTrajectoryDataLoader::BuildTrajectoryIdList(const FTrajectoryLoadParams& Params,
-	const FDatasetMetaBinary& DatasetMeta, const TArray<FTrajectoryMetaBinary>& TrajMetas)
+	const FDatasetMetaBinary& DatasetMeta, const FTrajectoryMetaTable& TrajMetas,
+	const TSharedPtr<FTrajectoryDatasetHandle>& DatasetHandle)
 {
 	TArray<int64> TrajectoryIds;
 
@@ -1157,19 +1395,31 @@ TArray<int64> UTrajectoryDataLoader::BuildTrajectoryIdList(const FTrajectoryLoad
 
 	case ETrajectorySelectionStrategy::ExplicitList:
 		{
-			// Create a set of available trajectory IDs
-			TSet<int64> AvailableIds;
-			for (const FTrajectoryMetaBinary& TrajMeta : TrajMetas)
+			// Add only trajectory IDs that exist in the dataset (binary search on the sorted metadata, so the cost
+			// scales with the selection instead of the dataset)
+			for (const FTrajectoryLoadSelection& Selection : Params.TrajectorySelections)
 			{
-				AvailableIds.Add(TrajMeta.TrajectoryId);
+				if (TrajMetas.Contains(Selection.TrajectoryId))
+				{
+					TrajectoryIds.Add(Selection.TrajectoryId);
+				}
 			}
+		}
+		break;
 
-			// Add only trajectory IDs that exist in the dataset
-			for (const FTrajectoryLoadSelection& Selection : Params.TrajectorySelections)
+	case ETrajectorySelectionStrategy::SpatialRegion:
+		{
+			TSharedPtr<const FTrajectorySpatialIndex> SpatialIndex = DatasetHandle.IsValid() ? GetOrBuildSpatialIndex(DatasetHandle) : nullptr;
+			if (SpatialIndex.IsValid())
 			{
-				if (AvailableIds.Contains(Selection.TrajectoryId))
+				const int32 StartTime = (Params.StartTimeStep < 0) ? DatasetMeta.FirstTimeStep : Params.StartTimeStep;
+				const int32 EndTime = (Params.EndTimeStep < 0) ? DatasetMeta.LastTimeStep : Params.EndTimeStep;
+				SpatialIndex->QueryRegion(Params.SpatialRegion, StartTime, EndTime, TrajectoryIds);
+
+				// Optional limit: keep the matches with the lowest IDs
+				if (Params.NumTrajectories > 0 && TrajectoryIds.Num() > Params.NumTrajectories)
 				{
-					TrajectoryIds.Add(Selection.TrajectoryId);
+					TrajectoryIds.SetNum(Params.NumTrajectories);
 				}
 			}
 		}
@@ -1239,6 +1489,13 @@ bool UTrajectoryDataLoader::ReadShardHeaderMapped(const uint8* MappedData, int64
 		return false;
 	}
 
+	// Version 1 (fixed-size float32 entries) and version 2 (compressed entries with offset table)
+	if (OutHeader.FormatVersion < TrajectoryShardFormat::Uncompressed || OutHeader.FormatVersion > TrajectoryShardFormat::Compressed)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryDataLoader: Unsupported shard file format version: %d"), OutHeader.FormatVersion);
+		return false;
+	}
+
 	return true;
 }
 
@@ -1332,6 +1589,719 @@ TMap<int32, FShardInfo> UTrajectoryDataLoader::DiscoverShardFiles(const FString&
 	return ShardInfoTable;
 }
 
+TSharedPtr<FTrajectoryDatasetHandle> UTrajectoryDataLoader::AcquireDatasetHandle(const FString& DatasetPath)
+{
+	const FString HandleKey = GetDatasetHandleKey(DatasetPath);
+
+	TSharedPtr<FTrajectoryDatasetHandle> Handle;
+	{
+		FScopeLock Lock(&DatasetHandleMutex);
+		Handle = DatasetHandleCache.FindRef(HandleKey);
+	}
+
+	// Validate outside the lock - this stats every file of the dataset, so it is done at most once per recheck
+	// interval (loads and C++ API query batches acquire the handle far more often than datasets change)
+	if (Handle.IsValid())
+	{
+		if (Handle->IsUpToDate(UTrajectoryDataSettings::Get()->DatasetHandleRecheckIntervalSeconds))
+		{
+			FScopeLock Lock(&DatasetHandleMutex);
+			Handle->LastAccess = ++DatasetHandleAccessCounter;
+			return Handle;
+		}
+
+		FScopeLock Lock(&DatasetHandleMutex);
+		if (DatasetHandleCache.FindRef(HandleKey) == Handle)
+		{
+			DatasetHandleCache.Remove(HandleKey);
+		}
+	}
+
+	Handle = BuildDatasetHandle(DatasetPath);
+	if (!Handle.IsValid())
+	{
+		return nullptr;
+	}
+
+	if (UTrajectoryDataSettings::Get()->MaxCachedDatasetHandles > 0)
+	{
+		{
+			FScopeLock Lock(&DatasetHandleMutex);
+			Handle->LastAccess = ++DatasetHandleAccessCounter;
+			DatasetHandleCache.Add(HandleKey, Handle);
+		}
+		TrimDatasetHandleCache();
+	}
+
+	return Handle;
+}
+
+void UTrajectoryDataLoader::InvalidateDatasetHandle(const FString& DatasetPath)
+{
+	FScopeLock Lock(&DatasetHandleMutex);
+	DatasetHandleCache.Remove(GetDatasetHandleKey(DatasetPath));
+}
+
+void UTrajectoryDataLoader::ClearDatasetHandleCache()
+{
+	FScopeLock Lock(&DatasetHandleMutex);
+	DatasetHandleCache.Empty();
+}
+
+int64 UTrajectoryDataLoader::GetDatasetHandleCacheMemoryUsage() const
+{
+	FScopeLock Lock(&DatasetHandleMutex);
+
+	int64 TotalBytes = 0;
+	for (const auto& HandleEntry : DatasetHandleCache)
+	{
+		TotalBytes += HandleEntry.Value->GetAllocatedSize();
+	}
+	return TotalBytes;
+}
+
+TArray<FTrajectoryLodLevel> UTrajectoryDataLoader::DiscoverLodLevels(const FString& DatasetPath, const FDatasetMetaBinary& DatasetMeta)
+{
+	TArray<FTrajectoryLodLevel> LodLevels;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// LOD levels live in lod-<factor>/ subdirectories (see UTrajectoryLodPyramidCommandlet)
+	TArray<FString> LodDirectories;
+	PlatformFile.IterateDirectory(*DatasetPath, [&LodDirectories](const TCHAR* FilenameOrDirectory, bool bIsDirectory) -> bool
+	{
+		if (bIsDirectory && FPaths::GetCleanFilename(FilenameOrDirectory).StartsWith(TEXT("lod-")))
+		{
+			LodDirectories.Add(FilenameOrDirectory);
+		}
+		return true;
+	});
+
+	for (const FString& LodDirectory : LodDirectories)
+	{
+		const FString FactorPart = FPaths::GetCleanFilename(LodDirectory).Mid(4); // Skip "lod-"
+		if (!FactorPart.IsNumeric())
+		{
+			continue;
+		}
+
+		FTrajectoryLodLevel LodLevel;
+		LodLevel.DecimationFactor = FCString::Atoi(*FactorPart);
+		LodLevel.DirectoryPath = LodDirectory;
+
+		// The LOD level must decimate whole shard intervals so its slots stay on one global time step grid
+		if (LodLevel.DecimationFactor < 2 || DatasetMeta.TimeStepIntervalSize % LodLevel.DecimationFactor != 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Ignoring LOD level %s (factor must divide the interval size %d)"),
+				*LodDirectory, DatasetMeta.TimeStepIntervalSize);
+			continue;
+		}
+
+		FDatasetMetaBinary LodMeta;
+		if (!ReadDatasetMeta(LodDirectory, LodMeta))
+		{
+			continue;
+		}
+
+		if (LodMeta.TimeStepIntervalSize != DatasetMeta.TimeStepIntervalSize / LodLevel.DecimationFactor ||
+			LodMeta.FirstTimeStep != DatasetMeta.FirstTimeStep || LodMeta.TrajectoryCount != DatasetMeta.TrajectoryCount)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Ignoring LOD level %s (metadata doesn't match the dataset)"), *LodDirectory);
+			continue;
+		}
+
+		LodLevel.TimeStepIntervalSize = LodMeta.TimeStepIntervalSize;
+		LodLevel.EntrySizeBytes = LodMeta.EntrySizeBytes;
+
+		// LOD shards keep the file names of the shards they were built from
+		PlatformFile.IterateDirectory(*LodDirectory, [&LodLevel](const TCHAR* FilenameOrDirectory, bool bIsDirectory) -> bool
+		{
+			const FString Filename = FPaths::GetCleanFilename(FilenameOrDirectory);
+			if (!bIsDirectory && Filename.StartsWith(TEXT("shard-")) && Filename.EndsWith(TEXT(".bin")))
+			{
+				const FString NumberPart = Filename.Mid(6).LeftChop(4);
+				if (NumberPart.IsNumeric())
+				{
+					LodLevel.ShardPaths.Add(FCString::Atoi(*NumberPart), FilenameOrDirectory);
+				}
+			}
+			return true;
+		});
+
+		if (LodLevel.ShardPaths.Num() > 0)
+		{
+			LodLevels.Add(MoveTemp(LodLevel));
+		}
+	}
+
+	LodLevels.Sort([](const FTrajectoryLodLevel& A, const FTrajectoryLodLevel& B)
+	{
+		return A.DecimationFactor < B.DecimationFactor;
+	});
+
+	return LodLevels;
+}
+
+TSharedPtr<FTrajectoryDatasetHandle> UTrajectoryDataLoader::BuildDatasetHandle(const FString& DatasetPath)
+{
+	TSharedPtr<FTrajectoryDatasetHandle> Handle = MakeShared<FTrajectoryDatasetHandle>(DatasetPath);
+
+	// Capture metadata stamps before reading so a concurrent rewrite is detected on the next acquire
+	const FString MetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-meta.bin"));
+	const FString TrajMetaPath = FPaths::Combine(DatasetPath, TEXT("dataset-trajmeta.bin"));
+	Handle->FileStamps.Add(MetaPath, FTrajectoryFileStamp::Capture(MetaPath));
+	Handle->FileStamps.Add(TrajMetaPath, FTrajectoryFileStamp::Capture(TrajMetaPath));
+
+	if (!ReadDatasetMeta(DatasetPath, Handle->DatasetMeta))
+	{
+		return nullptr;
+	}
+
+	// Trajectory metadata stays memory-mapped; lookups binary-search the sorted records instead of building a hash map
+	if (!ReadTrajectoryMeta(DatasetPath, Handle->TrajMetas))
+	{
+		return nullptr;
+	}
+
+	Handle->ShardInfoTable = DiscoverShardFiles(DatasetPath, Handle->DatasetMeta);
+	for (const auto& ShardEntry : Handle->ShardInfoTable)
+	{
+		const FString& ShardPath = ShardEntry.Value.FilePath;
+		Handle->FileStamps.Add(ShardPath, FTrajectoryFileStamp::Capture(ShardPath));
+	}
+
+	Handle->LodLevels = DiscoverLodLevels(DatasetPath, Handle->DatasetMeta);
+	for (const FTrajectoryLodLevel& LodLevel : Handle->LodLevels)
+	{
+		const FString LodMetaPath = FPaths::Combine(LodLevel.DirectoryPath, TEXT("dataset-meta.bin"));
+		Handle->FileStamps.Add(LodMetaPath, FTrajectoryFileStamp::Capture(LodMetaPath));
+		for (const auto& LodShardEntry : LodLevel.ShardPaths)
+		{
+			Handle->FileStamps.Add(LodShardEntry.Value, FTrajectoryFileStamp::Capture(LodShardEntry.Value));
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Opened dataset %s (%d trajectories, %d shards, %d LOD levels)"),
+		*DatasetPath, Handle->TrajMetas.Num(), Handle->ShardInfoTable.Num(), Handle->LodLevels.Num());
+
+	return Handle;
+}
+
+TSharedPtr<FMappedShardFile> UTrajectoryDataLoader::GetOrMapShardFile(const TSharedPtr<FTrajectoryDatasetHandle>& Handle, int32 FileIndex, const FString& ShardPath,
+	int32 DecimationFactor)
+{
+	if (TSharedPtr<FMappedShardFile> CachedShard = Handle->FindMappedShard(FileIndex, DecimationFactor))
+	{
+		return CachedShard;
+	}
+
+	TSharedPtr<FMappedShardFile> MappedShard = MapShardFile(ShardPath);
+	if (!MappedShard.IsValid())
+	{
+		return nullptr;
+	}
+
+	// Only keep the mapping if the handle itself is cached; uncached handles release it with the load
+	if (UTrajectoryDataSettings::Get()->MaxCachedDatasetHandles > 0)
+	{
+		return Handle->AddMappedShard(FileIndex, MappedShard, DecimationFactor);
+	}
+
+	return MappedShard;
+}
+
+TSharedPtr<const FTrajectorySpatialIndex> UTrajectoryDataLoader::GetSpatialIndex(const FString& DatasetPath)
+{
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = AcquireDatasetHandle(DatasetPath);
+	if (!DatasetHandle.IsValid())
+	{
+		return nullptr;
+	}
+
+	return GetOrBuildSpatialIndex(DatasetHandle);
+}
+
+bool UTrajectoryDataLoader::QueryTrajectoriesInRegion(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectorySpatialRegion& Region,
+	int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds)
+{
+	OutTrajectoryIds.Reset();
+
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle = AcquireDatasetHandle(DatasetInfo.DatasetPath);
+	if (!DatasetHandle.IsValid())
+	{
+		return false;
+	}
+
+	TSharedPtr<const FTrajectorySpatialIndex> SpatialIndex = GetOrBuildSpatialIndex(DatasetHandle);
+	if (!SpatialIndex.IsValid())
+	{
+		return false;
+	}
+
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle->DatasetMeta;
+	const int32 StartTime = (StartTimeStep < 0) ? DatasetMeta.FirstTimeStep : StartTimeStep;
+	const int32 EndTime = (EndTimeStep < 0) ? DatasetMeta.LastTimeStep : EndTimeStep;
+	SpatialIndex->QueryRegion(Region, StartTime, EndTime, OutTrajectoryIds);
+
+	return true;
+}
+
+TSharedPtr<const FTrajectorySpatialIndex> UTrajectoryDataLoader::GetOrBuildSpatialIndex(const TSharedPtr<FTrajectoryDatasetHandle>& Handle)
+{
+	// Held while building so concurrent loads of the same dataset build the index only once
+	FScopeLock Lock(&Handle->SpatialIndexMutex);
+	if (Handle->SpatialIndex.IsValid())
+	{
+		return Handle->SpatialIndex;
+	}
+
+	// The index file is only valid for the exact shard files it was built from
+	TMap<FString, FTrajectoryFileStamp> SourceStamps;
+	for (const auto& ShardEntry : Handle->ShardInfoTable)
+	{
+		const FString& ShardPath = ShardEntry.Value.FilePath;
+		SourceStamps.Add(ShardPath, Handle->FileStamps.FindRef(ShardPath));
+	}
+
+	const FString IndexPath = FPaths::Combine(Handle->GetDatasetPath(), TEXT("dataset-spatial-index.bin"));
+	TSharedPtr<FTrajectorySpatialIndex> SpatialIndex = MakeShared<FTrajectorySpatialIndex>();
+	if (SpatialIndex->Load(IndexPath, SourceStamps))
+	{
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Loaded spatial index %s (%lld boxes)"), *IndexPath, SpatialIndex->GetNumBoxes());
+	}
+	else
+	{
+		const double BuildStartTime = FPlatformTime::Seconds();
+		SpatialIndex = BuildSpatialIndex(Handle);
+
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Built spatial index for %s (%lld boxes in %d intervals, %.2f s)"),
+			*Handle->GetDatasetPath(), SpatialIndex->GetNumBoxes(), SpatialIndex->GetIntervals().Num(), FPlatformTime::Seconds() - BuildStartTime);
+
+		if (!SpatialIndex->Save(IndexPath, SourceStamps))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Failed to write spatial index %s, it will be rebuilt when the dataset is reopened"),
+				*IndexPath);
+		}
+	}
+
+	Handle->SpatialIndex = SpatialIndex;
+	Handle->SpatialIndexBytes.store(SpatialIndex->GetAllocatedSize(), std::memory_order_relaxed);
+	return SpatialIndex;
+}
+
+TSharedPtr<FTrajectorySpatialIndex> UTrajectoryDataLoader::BuildSpatialIndex(const TSharedPtr<FTrajectoryDatasetHandle>& Handle)
+{
+	const FDatasetMetaBinary& DatasetMeta = Handle->DatasetMeta;
+	const FTrajectoryQuantization Quantization = FTrajectoryQuantization::FromDatasetMeta(DatasetMeta);
+
+	TArray<int32> ShardIndices;
+	Handle->ShardInfoTable.GenerateKeyArray(ShardIndices);
+
+	struct FShardBounds
+	{
+		TArray<uint64> TrajectoryIds;
+		TArray<FBox3f> Bounds;
+	};
+
+	TArray<FShardBounds> ShardBounds;
+	ShardBounds.SetNum(ShardIndices.Num());
+
+	ParallelFor(ShardIndices.Num(), [&](int32 ShardArrayIndex)
+	{
+		const int32 ShardIndex = ShardIndices[ShardArrayIndex];
+		const FString& ShardPath = Handle->ShardInfoTable.FindChecked(ShardIndex).FilePath;
+
+		// Reuse a mapping held by the handle, but don't keep the whole dataset mapped for a one-time scan
+		TSharedPtr<FMappedShardFile> MappedShard = Handle->FindMappedShard(ShardIndex);
+		if (!MappedShard.IsValid())
+		{
+			MappedShard = MapShardFile(ShardPath);
+		}
+
+		FDataBlockHeaderBinary Header;
+		if (!MappedShard.IsValid() ||
+			!ReadShardHeaderMapped(MappedShard->MappedRegion->GetMappedPtr(), MappedShard->MappedRegion->GetMappedSize(), Header))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Failed to read shard for spatial index: %s"), *ShardPath);
+			return;
+		}
+
+		const FTrajectoryShardReader ShardReader(MappedShard->MappedRegion->GetMappedPtr(),
+			MappedShard->MappedRegion->GetMappedSize(), Header, DatasetMeta.EntrySizeBytes);
+		if (!ShardReader.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryDataLoader: Invalid entry layout in shard: %s"), *ShardPath);
+			return;
+		}
+
+		FShardBounds& Result = ShardBounds[ShardArrayIndex];
+		Result.TrajectoryIds.Reserve(ShardReader.GetEntryCount());
+		Result.Bounds.Reserve(ShardReader.GetEntryCount());
+
+		TArray<FPositionSampleBinary> DecodedSlots;
+		FTrajectoryDecodeScratch DecodeScratch;
+
+		for (int32 EntryIdx = 0; EntryIdx < ShardReader.GetEntryCount(); ++EntryIdx)
+		{
+			const TConstArrayView<uint8> EntryData = ShardReader.GetEntryData(EntryIdx);
+			if (EntryData.Num() < (int32)sizeof(FTrajectoryEntryHeaderBinary))
+			{
+				continue;
+			}
+
+			FTrajectoryEntryHeaderBinary EntryHeader;
+			FMemory::Memcpy(&EntryHeader, EntryData.GetData(), sizeof(EntryHeader));
+			if (EntryHeader.StartTimeStepInInterval < 0 || EntryHeader.ValidSampleCount <= 0 ||
+				(int64)EntryHeader.StartTimeStepInInterval + EntryHeader.ValidSampleCount > Header.TimeStepIntervalSize)
+			{
+				continue;
+			}
+
+			const int32 EndSlot = EntryHeader.StartTimeStepInInterval + EntryHeader.ValidSampleCount;
+			const FPositionSampleBinary* Positions = nullptr;
+			if (ShardReader.IsCompressed())
+			{
+				DecodedSlots.SetNumUninitialized(Header.TimeStepIntervalSize, EAllowShrinking::No);
+				if (!FTrajectoryShardCodec::DecodeEntry(EntryData, Header.TimeStepIntervalSize, Quantization, DecodedSlots.GetData(), DecodeScratch))
+				{
+					continue;
+				}
+				Positions = DecodedSlots.GetData();
+			}
+			else
+			{
+				if (EntryData.Num() < (int64)sizeof(FTrajectoryEntryHeaderBinary) + (int64)EndSlot * sizeof(FPositionSampleBinary))
+				{
+					continue;
+				}
+				Positions = reinterpret_cast<const FPositionSampleBinary*>(EntryData.GetData() + sizeof(FTrajectoryEntryHeaderBinary));
+			}
+
+			FBox3f Bounds(ForceInit);
+			for (int32 SlotIdx = EntryHeader.StartTimeStepInInterval; SlotIdx < EndSlot; ++SlotIdx)
+			{
+				const FPositionSampleBinary& Sample = Positions[SlotIdx];
+				if (!FMath::IsNaN(Sample.X) && !FMath::IsNaN(Sample.Y) && !FMath::IsNaN(Sample.Z))
+				{
+					Bounds += FVector3f(Sample.X, Sample.Y, Sample.Z);
+				}
+			}
+
+			if (Bounds.IsValid)
+			{
+				Result.TrajectoryIds.Add(EntryHeader.TrajectoryId);
+				Result.Bounds.Add(Bounds);
+			}
+		}
+	}, EParallelForFlags::Unbalanced);
+
+	TSharedPtr<FTrajectorySpatialIndex> SpatialIndex = MakeShared<FTrajectorySpatialIndex>();
+	for (int32 ShardArrayIndex = 0; ShardArrayIndex < ShardIndices.Num(); ++ShardArrayIndex)
+	{
+		const FShardInfo& ShardInfo = Handle->ShardInfoTable.FindChecked(ShardIndices[ShardArrayIndex]);
+		SpatialIndex->AddInterval(ShardIndices[ShardArrayIndex], ShardInfo.StartTimeStep, ShardInfo.EndTimeStep,
+			MoveTemp(ShardBounds[ShardArrayIndex].TrajectoryIds), MoveTemp(ShardBounds[ShardArrayIndex].Bounds));
+	}
+	SpatialIndex->Finalize();
+
+	return SpatialIndex;
+}
+
+void UTrajectoryDataLoader::TrimDatasetHandleCache()
+{
+	const UTrajectoryDataSettings* Settings = UTrajectoryDataSettings::Get();
+	const int32 MaxHandles = FMath::Max(Settings->MaxCachedDatasetHandles, 0);
+	const int64 BudgetBytes = (int64)FMath::Max(Settings->DatasetHandleCacheBudgetMB, 0) * 1024 * 1024;
+
+	FScopeLock Lock(&DatasetHandleMutex);
+
+	// Most recently used first
+	TArray<TPair<FString, TSharedPtr<FTrajectoryDatasetHandle>>> Handles;
+	for (const auto& HandleEntry : DatasetHandleCache)
+	{
+		Handles.Emplace(HandleEntry.Key, HandleEntry.Value);
+	}
+	Handles.Sort([](const TPair<FString, TSharedPtr<FTrajectoryDatasetHandle>>& A, const TPair<FString, TSharedPtr<FTrajectoryDatasetHandle>>& B)
+	{
+		return A.Value->LastAccess > B.Value->LastAccess;
+	});
+
+	int64 TotalBytes = 0;
+	for (int32 HandleIdx = 0; HandleIdx < Handles.Num(); ++HandleIdx)
+	{
+		const TSharedPtr<FTrajectoryDatasetHandle>& Handle = Handles[HandleIdx].Value;
+		const int64 HandleBytes = Handle->GetAllocatedSize();
+
+		if (HandleIdx >= MaxHandles || (HandleIdx > 0 && TotalBytes + HandleBytes > BudgetBytes))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Closing least recently used dataset %s (%s)"),
+				*Handle->GetDatasetPath(), *UTrajectoryDataBlueprintLibrary::FormatMemorySize(HandleBytes));
+			DatasetHandleCache.Remove(Handles[HandleIdx].Key);
+			continue;
+		}
+
+		// The most recently used dataset alone exceeds the budget - keep its metadata but drop its mappings
+		if (HandleBytes > BudgetBytes)
+		{
+			UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Dataset %s exceeds the handle cache budget, releasing its shard mappings"),
+				*Handle->GetDatasetPath());
+			Handle->ReleaseMappedShards();
+		}
+
+		TotalBytes += Handle->GetAllocatedSize();
+	}
+}
+
+FString UTrajectoryDataLoader::GetDatasetHandleKey(const FString& DatasetPath)
+{
+	FString HandleKey = FPaths::ConvertRelativePathToFull(DatasetPath);
+	FPaths::NormalizeDirectoryName(HandleKey);
+	return HandleKey;
+}
+
+bool UTrajectoryDataLoader::GetEntryLoadRange(const uint8* EntryPtr, int32 ShardStartTimeStep, int32 TimeStepIntervalSize, int32 DecimationFactor,
+	int32 GridFirstTimeStep, const FTrajectoryLoadParams& Params, FShardEntryLoadRange& OutRange)
+{
+	// Per specification, each entry has fixed layout:
+	// Offset 0:  uint64 trajectory_id (8 bytes)
+	// Offset 8:  int32 start_time_step_in_interval (4 bytes)
+	// Offset 12: int32 valid_sample_count (4 bytes)
+	// Offset 16: float32[time_step_interval_size][3] positions array
+	// No entry: out of range, or a malformed offset table record in a compressed (version 2) shard
+	if (!EntryPtr)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutRange.StartTimeStepInInterval, EntryPtr + 8, sizeof(int32));
+	FMemory::Memcpy(&OutRange.ValidSampleCount, EntryPtr + 12, sizeof(int32));
+
+	// Per specification: start_time_step_in_interval == -1 means "none valid"
+	if (OutRange.StartTimeStepInInterval == -1)
+	{
+		return false;
+	}
+
+	// Validate sample count - should be positive if StartTimeStepInInterval is valid
+	if (OutRange.ValidSampleCount <= 0)
+	{
+		uint64 EntryTrajId;
+		FMemory::Memcpy(&EntryTrajId, EntryPtr, sizeof(uint64));
+		UE_LOG(LogTemp, Warning, TEXT("Trajectory %llu in shard has valid StartTimeStepInInterval (%d) but invalid ValidSampleCount (%d). Skipping."),
+			EntryTrajId, OutRange.StartTimeStepInInterval, OutRange.ValidSampleCount);
+		return false;
+	}
+
+	// StartTimeStepInInterval tells us where valid data starts (0-based index in interval)
+	// ValidSampleCount tells us how many consecutive samples are valid
+	OutRange.ValidRangeStart = OutRange.StartTimeStepInInterval;
+	OutRange.ValidRangeEnd = OutRange.StartTimeStepInInterval + OutRange.ValidSampleCount;
+
+	// Clamp to the requested time range (convert global time steps to shard-relative slot indices,
+	// slot k holds time step ShardStartTimeStep + k * DecimationFactor)
+	int32 LoadStart = OutRange.ValidRangeStart;
+	int32 LoadEnd = OutRange.ValidRangeEnd;
+
+	if (Params.StartTimeStep >= 0)
+	{
+		const int32 RelativeStart = Params.StartTimeStep - ShardStartTimeStep;
+		if (RelativeStart > 0)
+		{
+			LoadStart = FMath::Max(LoadStart, FMath::DivideAndRoundUp(RelativeStart, DecimationFactor));
+		}
+	}
+
+	if (Params.EndTimeStep >= 0)
+	{
+		const int32 RelativeEnd = Params.EndTimeStep - ShardStartTimeStep;
+		LoadEnd = FMath::Min(LoadEnd, (RelativeEnd >= 0) ? RelativeEnd / DecimationFactor + 1 : 0);
+	}
+
+	// Start on the trajectory's sample grid (GridFirstTimeStep + k * SampleRate) instead of restarting the stride at
+	// this shard's first slot, so consecutive shards continue the same grid
+	if (Params.SampleRate > 1)
+	{
+		const int32 GlobalLoadStart = ShardStartTimeStep + LoadStart * DecimationFactor;
+		const int32 GridLoadStart = (GlobalLoadStart <= GridFirstTimeStep)
+			? GridFirstTimeStep
+			: GridFirstTimeStep + FMath::DivideAndRoundUp(GlobalLoadStart - GridFirstTimeStep, Params.SampleRate) * Params.SampleRate;
+		LoadStart = FMath::DivideAndRoundUp(GridLoadStart - ShardStartTimeStep, DecimationFactor);
+	}
+
+	// Ensure we stay within the shard's time step interval bounds
+	OutRange.LoadStart = FMath::Clamp(LoadStart, 0, TimeStepIntervalSize);
+	OutRange.LoadEnd = FMath::Clamp(LoadEnd, 0, TimeStepIntervalSize);
+
+	return OutRange.LoadStart < OutRange.LoadEnd;
+}
+
+void UTrajectoryDataLoader::ResolveShardEntryIndices(const FTrajectoryShardReader& ShardReader, const FString& ShardPath,
+	int32 ShardStartTimeStep, int32 ShardEndTimeStep, const TArray<int64>& TrajIds,
+	const FTrajectoryMetaTable& TrajMetaTable, ETrajectoryEntryLookup EntryLookup,
+	TArray<int32>& OutEntryIndices)
+{
+	OutEntryIndices.Init(INDEX_NONE, TrajIds.Num());
+
+	if (EntryLookup == ETrajectoryEntryLookup::FullScan)
+	{
+		// Legacy behaviour: read the ID of every entry in the shard
+		FShardEntryIndex ScannedIndex;
+		ShardReader.BuildEntryIndex(ScannedIndex);
+
+		for (int32 Index = 0; Index < TrajIds.Num(); ++Index)
+		{
+			if (const int32* EntryIdx = ScannedIndex.EntryIndexById.Find(TrajIds[Index]))
+			{
+				OutEntryIndices[Index] = *EntryIdx;
+			}
+		}
+		return;
+	}
+
+	TSharedPtr<const FShardEntryIndex> CachedIndex = FindCachedShardEntryIndex(ShardPath);
+
+	int32 NumSeekHits = 0;
+	int32 NumIndexHits = 0;
+	int32 NumSearchHits = 0;
+	TArray<int32> UnresolvedIndices;
+
+	for (int32 Index = 0; Index < TrajIds.Num(); ++Index)
+	{
+		const int64 TrajId = TrajIds[Index];
+		const FTrajectoryMetaBinary* TrajMeta = TrajMetaTable.Find(TrajId);
+		if (!TrajMeta)
+		{
+			continue;
+		}
+
+		// Trajectories that don't live in this interval have no entry here - don't touch the shard for them
+		if (TrajMeta->EndTimeStep < ShardStartTimeStep || TrajMeta->StartTimeStep > ShardEndTimeStep)
+		{
+			continue;
+		}
+
+		// 1. Direct seek to EntryOffsetIndex from trajectory metadata (verified against the stored ID)
+		int32 EntryIdx = ShardReader.FindEntryBySeekHint(static_cast<uint64>(TrajId), TrajMeta->EntryOffsetIndex);
+		if (EntryIdx != INDEX_NONE)
+		{
+			++NumSeekHits;
+		}
+		else if (CachedIndex.IsValid())
+		{
+			// 2. Index built by an earlier scan of this shard
+			if (const int32* CachedEntryIdx = CachedIndex->EntryIndexById.Find(TrajId))
+			{
+				EntryIdx = *CachedEntryIdx;
+				++NumIndexHits;
+			}
+		}
+		else
+		{
+			// 3. Binary search - entries are written in Trajectory-Meta order, which is sorted by ID
+			EntryIdx = ShardReader.FindEntryByBinarySearch(static_cast<uint64>(TrajId));
+			if (EntryIdx != INDEX_NONE)
+			{
+				++NumSearchHits;
+			}
+			else
+			{
+				UnresolvedIndices.Add(Index);
+			}
+		}
+
+		OutEntryIndices[Index] = EntryIdx;
+	}
+
+	// 4. The layout can't be trusted for the remaining trajectories - scan the shard once
+	// and keep the resulting index so following loads of this shard don't have to scan again
+	if (UnresolvedIndices.Num() > 0)
+	{
+		TSharedPtr<const FShardEntryIndex> ScannedIndex = GetOrBuildShardEntryIndex(ShardPath, ShardReader);
+		for (int32 Index : UnresolvedIndices)
+		{
+			if (const int32* EntryIdx = ScannedIndex->EntryIndexById.Find(TrajIds[Index]))
+			{
+				OutEntryIndices[Index] = *EntryIdx;
+				++NumIndexHits;
+			}
+		}
+
+		UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Direct seek could not resolve %d trajectories in %s, fell back to entry index"),
+			UnresolvedIndices.Num(), *ShardPath);
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryDataLoader: Resolved entries in %s (seek: %d, binary search: %d, index: %d)"),
+		*ShardPath, NumSeekHits, NumSearchHits, NumIndexHits);
+}
+
+TSharedPtr<const FShardEntryIndex> UTrajectoryDataLoader::FindCachedShardEntryIndex(const FString& ShardPath)
+{
+	TSharedPtr<const FShardEntryIndex> CachedIndex;
+	{
+		FScopeLock Lock(&ShardEntryIndexMutex);
+		CachedIndex = ShardEntryIndexCache.FindRef(ShardPath);
+	}
+
+	if (!CachedIndex.IsValid())
+	{
+		return nullptr;
+	}
+
+	// Only reuse the index if the shard file has not been rewritten since it was built
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (PlatformFile.FileSize(*ShardPath) != CachedIndex->FileSize ||
+		PlatformFile.GetTimeStamp(*ShardPath) != CachedIndex->FileTimeStamp)
+	{
+		FScopeLock Lock(&ShardEntryIndexMutex);
+		if (ShardEntryIndexCache.FindRef(ShardPath) == CachedIndex)
+		{
+			ShardEntryIndexCache.Remove(ShardPath);
+			ShardEntryIndexCacheBytes -= CachedIndex->GetAllocatedSize();
+		}
+		return nullptr;
+	}
+
+	return CachedIndex;
+}
+
+TSharedPtr<const FShardEntryIndex> UTrajectoryDataLoader::GetOrBuildShardEntryIndex(const FString& ShardPath, const FTrajectoryShardReader& ShardReader)
+{
+	if (TSharedPtr<const FShardEntryIndex> CachedIndex = FindCachedShardEntryIndex(ShardPath))
+	{
+		return CachedIndex;
+	}
+
+	// Scan outside the lock - other shards may be building their indices concurrently
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TSharedPtr<FShardEntryIndex> NewIndex = MakeShared<FShardEntryIndex>();
+	NewIndex->FileSize = PlatformFile.FileSize(*ShardPath);
+	NewIndex->FileTimeStamp = PlatformFile.GetTimeStamp(*ShardPath);
+	ShardReader.BuildEntryIndex(*NewIndex);
+
+	const int64 IndexBytes = NewIndex->GetAllocatedSize();
+
+	FScopeLock Lock(&ShardEntryIndexMutex);
+
+	if (TSharedPtr<const FShardEntryIndex>* Existing = ShardEntryIndexCache.Find(ShardPath))
+	{
+		ShardEntryIndexCacheBytes -= (*Existing)->GetAllocatedSize();
+		ShardEntryIndexCache.Remove(ShardPath);
+	}
+
+	if (ShardEntryIndexCacheBytes + IndexBytes > MaxShardEntryIndexCacheBytes)
+	{
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryDataLoader: Shard entry index cache exceeds %s, flushing %d cached indices"),
+			*UTrajectoryDataBlueprintLibrary::FormatMemorySize(MaxShardEntryIndexCacheBytes), ShardEntryIndexCache.Num());
+		ShardEntryIndexCache.Empty();
+		ShardEntryIndexCacheBytes = 0;
+	}
+
+	ShardEntryIndexCache.Add(ShardPath, NewIndex);
+	ShardEntryIndexCacheBytes += IndexBytes;
+
+	return NewIndex;
+}
+
 int64 UTrajectoryDataLoader::CalculateMemoryRequirement(const FTrajectoryLoadParams& Params,
 	const FDatasetMetaBinary& DatasetMeta)
 {
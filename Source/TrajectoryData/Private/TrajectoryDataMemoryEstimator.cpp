@@ -50,8 +50,12 @@ int64 UTrajectoryDataMemoryEstimator::CalculateDatasetMemoryFromMetadata(const F
 	const int64 DataBlockHeaderSize = 32;
 	
 	// 4. Data entries: entry_size_bytes per trajectory
-	// entry_size_bytes is stored in the dataset metadata
-	const int64 DataEntriesSize = static_cast<int64>(DatasetMetadata.EntrySizeBytes) * DatasetMetadata.TrajectoryCount;
+	// entry_size_bytes is stored in the dataset metadata; compressed datasets (format version 2) store 0
+	// because their entries vary in size - use the decoded size, which is what ends up in memory
+	const int64 EntrySizeBytes = (DatasetMetadata.EntrySizeBytes > 0)
+		? DatasetMetadata.EntrySizeBytes
+		: 16 + static_cast<int64>(DatasetMetadata.TimeStepIntervalSize) * 3 * sizeof(float);
+	const int64 DataEntriesSize = EntrySizeBytes * DatasetMetadata.TrajectoryCount;
 	
 	// Total memory required
 	const int64 TotalMemory = DatasetMetaSize + TrajectoryMetaSize + DataBlockHeaderSize + DataEntriesSize;
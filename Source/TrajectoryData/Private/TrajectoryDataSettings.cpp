@@ -5,6 +5,13 @@
 UTrajectoryDataSettings::UTrajectoryDataSettings()
 	: bAutoScanOnStartup(true)
 	, bDebugLogging(false)
+	, MaxCachedDatasetHandles(4)
+	, DatasetHandleCacheBudgetMB(8192)
+	, DatasetHandleRecheckIntervalSeconds(1.0f)
+	, MaxConcurrentQueries(4)
+	, MaxQueuedQueries(1024)
+	, QueryCoalescingWindowMs(1.0f)
+	, MaxCoalescedQueries(64)
 {
 }
 
@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryDatasetHandle.h"
+#include "TrajectorySpatialIndex.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+FTrajectoryFileStamp FTrajectoryFileStamp::Capture(const FString& FilePath)
+{
+	FTrajectoryFileStamp Stamp;
+
+	FFileStatData StatData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*FilePath);
+	if (StatData.bIsValid && !StatData.bIsDirectory)
+	{
+		Stamp.FileSize = StatData.FileSize;
+		Stamp.ModificationTime = StatData.ModificationTime;
+	}
+
+	return Stamp;
+}
+
+FTrajectoryDatasetHandle::FTrajectoryDatasetHandle(const FString& InDatasetPath)
+	: SpatialIndexBytes(0)
+	, LastAccess(0)
+	, DatasetPath(InDatasetPath)
+	, MappedBytes(0)
+	, LastValidatedTime(FPlatformTime::Seconds())
+{
+}
+
+bool FTrajectoryDatasetHandle::IsUpToDate(double RecheckIntervalSeconds) const
+{
+	const double Now = FPlatformTime::Seconds();
+	if (RecheckIntervalSeconds > 0.0 && Now - LastValidatedTime.load(std::memory_order_relaxed) < RecheckIntervalSeconds)
+	{
+		return true;
+	}
+
+	for (const auto& StampEntry : FileStamps)
+	{
+		if (FTrajectoryFileStamp::Capture(StampEntry.Key) != StampEntry.Value)
+		{
+			UE_LOG(LogTemp, Log, TEXT("TrajectoryDatasetHandle: File changed on disk, handle is stale: %s"), *StampEntry.Key);
+			return false;
+		}
+	}
+
+	LastValidatedTime.store(Now, std::memory_order_relaxed);
+	return true;
+}
+
+const FTrajectoryLodLevel* FTrajectoryDatasetHandle::FindLodLevel(int32 SampleRate) const
+{
+	// Levels are sorted by ascending factor - the last match is the coarsest
+	const FTrajectoryLodLevel* BestLevel = nullptr;
+	for (const FTrajectoryLodLevel& LodLevel : LodLevels)
+	{
+		if (LodLevel.DecimationFactor > 1 && SampleRate % LodLevel.DecimationFactor == 0)
+		{
+			BestLevel = &LodLevel;
+		}
+	}
+	return BestLevel;
+}
+
+TSharedPtr<FMappedShardFile> FTrajectoryDatasetHandle::FindMappedShard(int32 FileIndex, int32 DecimationFactor) const
+{
+	FScopeLock Lock(&MappedShardMutex);
+	return MappedShards.FindRef(GetMappedShardKey(FileIndex, DecimationFactor));
+}
+
+TSharedPtr<FMappedShardFile> FTrajectoryDatasetHandle::AddMappedShard(int32 FileIndex, const TSharedPtr<FMappedShardFile>& MappedShard, int32 DecimationFactor)
+{
+	if (!MappedShard.IsValid() || !MappedShard->MappedRegion.IsValid())
+	{
+		return MappedShard;
+	}
+
+	FScopeLock Lock(&MappedShardMutex);
+
+	const int64 ShardKey = GetMappedShardKey(FileIndex, DecimationFactor);
+	if (const TSharedPtr<FMappedShardFile>* Existing = MappedShards.Find(ShardKey))
+	{
+		return *Existing;
+	}
+
+	MappedShards.Add(ShardKey, MappedShard);
+	MappedBytes += MappedShard->MappedRegion->GetMappedSize();
+
+	return MappedShard;
+}
+
+void FTrajectoryDatasetHandle::ReleaseMappedShard(int32 FileIndex)
+{
+	FScopeLock Lock(&MappedShardMutex);
+
+	TSharedPtr<FMappedShardFile> MappedShard;
+	if (MappedShards.RemoveAndCopyValue(GetMappedShardKey(FileIndex, 1), MappedShard))
+	{
+		MappedBytes -= MappedShard->MappedRegion->GetMappedSize();
+	}
+
+	for (const FTrajectoryLodLevel& LodLevel : LodLevels)
+	{
+		if (MappedShards.RemoveAndCopyValue(GetMappedShardKey(FileIndex, LodLevel.DecimationFactor), MappedShard))
+		{
+			MappedBytes -= MappedShard->MappedRegion->GetMappedSize();
+		}
+	}
+}
+
+void FTrajectoryDatasetHandle::ReleaseMappedShards()
+{
+	FScopeLock Lock(&MappedShardMutex);
+	MappedShards.Empty();
+	MappedBytes = 0;
+}
+
+int64 FTrajectoryDatasetHandle::GetMappedBytes() const
+{
+	FScopeLock Lock(&MappedShardMutex);
+	return MappedBytes;
+}
+
+int64 FTrajectoryDatasetHandle::GetAllocatedSize() const
+{
+	int64 MetadataBytes = sizeof(FTrajectoryDatasetHandle)
+		+ TrajMetas.GetAllocatedSize()
+		+ ShardInfoTable.GetAllocatedSize()
+		+ LodLevels.GetAllocatedSize()
+		+ FileStamps.GetAllocatedSize()
+		+ SpatialIndexBytes.load(std::memory_order_relaxed);
+
+	return MetadataBytes + GetMappedBytes();
+}
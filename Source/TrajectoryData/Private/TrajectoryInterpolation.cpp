@@ -0,0 +1,104 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryInterpolation.h"
+#include "Math/VectorRegister.h"
+#include <limits>
+
+void FTrajectoryInterpolationTaps::Init(int32 InNum)
+{
+	Num = InNum;
+
+	const int32 PaddedNum = Align(InNum, 4);
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	for (TArray<float>& Axis : Coords)
+	{
+		Axis.Init(NaN, PaddedNum);
+	}
+}
+
+void FTrajectoryInterpolation::Interpolate(const FTrajectoryInterpolationTaps& Taps, float Alpha, ETrajectoryInterpolation Mode,
+	TArray<FVector3f>& OutPositions)
+{
+	const int32 PaddedNum = Taps.GetPaddedNum();
+
+	// Results are computed per axis (SoA) and interleaved at the end
+	TArray<float> Result[3];
+	for (TArray<float>& Axis : Result)
+	{
+		Axis.SetNumUninitialized(PaddedNum);
+	}
+
+	if (Alpha <= 0.0f)
+	{
+		// Exactly on a time step: no neighbour needed, gaps after it don't matter
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			FMemory::Memcpy(Result[Axis].GetData(), Taps.Coords[3 + Axis].GetData(), PaddedNum * sizeof(float));
+		}
+	}
+	else if (Mode == ETrajectoryInterpolation::Linear)
+	{
+		const VectorRegister4Float A = VectorSetFloat1(Alpha);
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const float* P1 = Taps.Coords[3 + Axis].GetData();
+			const float* P2 = Taps.Coords[6 + Axis].GetData();
+			float* Out = Result[Axis].GetData();
+
+			// NaN in either neighbour propagates into the result
+			for (int32 Index = 0; Index < PaddedNum; Index += 4)
+			{
+				const VectorRegister4Float V1 = VectorLoad(P1 + Index);
+				const VectorRegister4Float V2 = VectorLoad(P2 + Index);
+				VectorStore(VectorMultiplyAdd(VectorSubtract(V2, V1), A, V1), Out + Index);
+			}
+		}
+	}
+	else
+	{
+		// Uniform Catmull-Rom: p(a) = 0.5 * (2 p1 + (p2 - p0) a + (2 p0 - 5 p1 + 4 p2 - p3) a^2 + (3 p1 - p0 - 3 p2 + p3) a^3)
+		const float A2 = Alpha * Alpha;
+		const float A3 = A2 * Alpha;
+
+		// Expanded into per-tap weights
+		const VectorRegister4Float W0 = VectorSetFloat1(0.5f * (-Alpha + 2.0f * A2 - A3));
+		const VectorRegister4Float W1 = VectorSetFloat1(0.5f * (2.0f - 5.0f * A2 + 3.0f * A3));
+		const VectorRegister4Float W2 = VectorSetFloat1(0.5f * (Alpha + 4.0f * A2 - 3.0f * A3));
+		const VectorRegister4Float W3 = VectorSetFloat1(0.5f * (-A2 + A3));
+		const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const float* P0 = Taps.Coords[0 + Axis].GetData();
+			const float* P1 = Taps.Coords[3 + Axis].GetData();
+			const float* P2 = Taps.Coords[6 + Axis].GetData();
+			const float* P3 = Taps.Coords[9 + Axis].GetData();
+			float* Out = Result[Axis].GetData();
+
+			for (int32 Index = 0; Index < PaddedNum; Index += 4)
+			{
+				const VectorRegister4Float V1 = VectorLoad(P1 + Index);
+				const VectorRegister4Float V2 = VectorLoad(P2 + Index);
+				VectorRegister4Float V0 = VectorLoad(P0 + Index);
+				VectorRegister4Float V3 = VectorLoad(P3 + Index);
+
+				// Missing outer taps (NaN != NaN) are reflected from the inner ones
+				V0 = VectorSelect(VectorCompareNE(V0, V0), VectorSubtract(VectorMultiply(Two, V1), V2), V0);
+				V3 = VectorSelect(VectorCompareNE(V3, V3), VectorSubtract(VectorMultiply(Two, V2), V1), V3);
+
+				VectorRegister4Float Sum = VectorMultiply(V0, W0);
+				Sum = VectorMultiplyAdd(V1, W1, Sum);
+				Sum = VectorMultiplyAdd(V2, W2, Sum);
+				Sum = VectorMultiplyAdd(V3, W3, Sum);
+				VectorStore(Sum, Out + Index);
+			}
+		}
+	}
+
+	OutPositions.SetNumUninitialized(Taps.Num);
+	for (int32 Index = 0; Index < Taps.Num; ++Index)
+	{
+		OutPositions[Index] = FVector3f(Result[0][Index], Result[1][Index], Result[2][Index]);
+	}
+}
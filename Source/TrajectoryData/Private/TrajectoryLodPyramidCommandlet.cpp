@@ -0,0 +1,248 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryLodPyramidCommandlet.h"
+#include "TrajectoryDataLoader.h"
+#include "TrajectoryShardReader.h"
+#include "TrajectoryShardCodec.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include <limits>
+
+UTrajectoryLodPyramidCommandlet::UTrajectoryLodPyramidCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UTrajectoryLodPyramidCommandlet::Main(const FString& Params)
+{
+	FString DatasetPath;
+	if (!FParse::Value(*Params, TEXT("Dataset="), DatasetPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Missing -Dataset=<dataset directory>"));
+		return 1;
+	}
+
+	FString FactorList = TEXT("2,4,8,16");
+	FParse::Value(*Params, TEXT("Factors="), FactorList, false);
+
+	TArray<FString> FactorStrings;
+	FactorList.ParseIntoArray(FactorStrings, TEXT(","));
+
+	int32 NumFailedLevels = 0;
+	for (const FString& FactorString : FactorStrings)
+	{
+		const int32 DecimationFactor = FCString::Atoi(*FactorString);
+		if (!BuildLodLevel(DatasetPath, DecimationFactor))
+		{
+			++NumFailedLevels;
+		}
+	}
+
+	return (NumFailedLevels == 0) ? 0 : 1;
+}
+
+bool UTrajectoryLodPyramidCommandlet::BuildLodLevel(const FString& DatasetPath, int32 DecimationFactor)
+{
+	UTrajectoryDataLoader* Loader = UTrajectoryDataLoader::Get();
+
+	FDatasetMetaBinary DatasetMeta;
+	if (!Loader->ReadDatasetMeta(DatasetPath, DatasetMeta))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to read dataset metadata: %s"), *DatasetPath);
+		return false;
+	}
+
+	const int32 IntervalSize = DatasetMeta.TimeStepIntervalSize;
+	if (DecimationFactor < 2 || IntervalSize % DecimationFactor != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TrajectoryLodPyramidCommandlet: Skipping factor %d (must be >= 2 and divide the interval size %d)"),
+			DecimationFactor, IntervalSize);
+		return false;
+	}
+
+	const int32 LodIntervalSize = IntervalSize / DecimationFactor;
+	const FString LodDirectory = FPaths::Combine(DatasetPath, FString::Printf(TEXT("lod-%d"), DecimationFactor));
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.CreateDirectoryTree(*LodDirectory))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to create directory: %s"), *LodDirectory);
+		return false;
+	}
+
+	// Same dataset, fewer slots per interval
+	FDatasetMetaBinary LodMeta = DatasetMeta;
+	LodMeta.TimeStepIntervalSize = LodIntervalSize;
+	if (LodMeta.FormatVersion == TrajectoryShardFormat::Uncompressed)
+	{
+		LodMeta.EntrySizeBytes = sizeof(FTrajectoryEntryHeaderBinary) + LodIntervalSize * sizeof(FPositionSampleBinary);
+	}
+
+	const FString LodMetaPath = FPaths::Combine(LodDirectory, TEXT("dataset-meta.bin"));
+	if (!FFileHelper::SaveArrayToFile(TArrayView<const uint8>(reinterpret_cast<const uint8*>(&LodMeta), sizeof(LodMeta)), *LodMetaPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to write %s"), *LodMetaPath);
+		return false;
+	}
+
+	const FTrajectoryQuantization Quantization = FTrajectoryQuantization::FromDatasetMeta(DatasetMeta);
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	const FPositionSampleBinary MissingSample = { NaN, NaN, NaN };
+
+	TArray<FPositionSampleBinary> Slots;
+	TArray<FPositionSampleBinary> LodSlots;
+	TArray<uint8> EntryBytes;
+	FTrajectoryDecodeScratch DecodeScratch;
+	Slots.SetNumUninitialized(IntervalSize);
+	LodSlots.SetNumUninitialized(LodIntervalSize);
+
+	const TMap<int32, FShardInfo> ShardInfoTable = Loader->DiscoverShardFiles(DatasetPath, DatasetMeta);
+	for (const auto& ShardEntry : ShardInfoTable)
+	{
+		const FString& ShardPath = ShardEntry.Value.FilePath;
+		const FString LodShardPath = FPaths::Combine(LodDirectory, FPaths::GetCleanFilename(ShardPath));
+
+		TSharedPtr<FMappedShardFile> MappedShard = Loader->MapShardFile(ShardPath);
+		FDataBlockHeaderBinary Header;
+		if (!MappedShard.IsValid() ||
+			!Loader->ReadShardHeaderMapped(MappedShard->MappedRegion->GetMappedPtr(), MappedShard->MappedRegion->GetMappedSize(), Header))
+		{
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to read shard: %s"), *ShardPath);
+			return false;
+		}
+
+		const FTrajectoryShardReader ShardReader(MappedShard->MappedRegion->GetMappedPtr(),
+			MappedShard->MappedRegion->GetMappedSize(), Header, DatasetMeta.EntrySizeBytes);
+		if (!ShardReader.IsValid() || Header.TimeStepIntervalSize != IntervalSize)
+		{
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Invalid entry layout in shard: %s"), *ShardPath);
+			return false;
+		}
+
+		TUniquePtr<IFileHandle> LodFile(PlatformFile.OpenWrite(*LodShardPath));
+		if (!LodFile.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to open %s for writing"), *LodShardPath);
+			return false;
+		}
+
+		const int32 EntryCount = ShardReader.GetEntryCount();
+
+		// Same interval, same entry order (entry_offset_index stays valid), fewer slots
+		FDataBlockHeaderBinary LodHeader = Header;
+		LodHeader.TimeStepIntervalSize = LodIntervalSize;
+		LodHeader.DataSectionOffset = sizeof(FDataBlockHeaderBinary);
+		bool bWriteOk = LodFile->Write(reinterpret_cast<const uint8*>(&LodHeader), sizeof(LodHeader));
+
+		// Compressed shards: the offset table is written once all entry sizes are known
+		TArray<uint64> EntryOffsets;
+		int64 WriteOffset = sizeof(FDataBlockHeaderBinary);
+		if (ShardReader.IsCompressed())
+		{
+			EntryOffsets.SetNumZeroed(EntryCount + 1);
+			bWriteOk &= LodFile->Write(reinterpret_cast<const uint8*>(EntryOffsets.GetData()), EntryOffsets.Num() * sizeof(uint64));
+			WriteOffset += EntryOffsets.Num() * sizeof(uint64);
+		}
+
+		for (int32 EntryIdx = 0; EntryIdx < EntryCount && bWriteOk; ++EntryIdx)
+		{
+			const TConstArrayView<uint8> EntryData = ShardReader.GetEntryData(EntryIdx);
+			const int64 MinEntryBytes = ShardReader.IsCompressed()
+				? FTrajectoryShardCodec::CompressedEntryHeaderSize
+				: sizeof(FTrajectoryEntryHeaderBinary) + (int64)IntervalSize * sizeof(FPositionSampleBinary);
+			if (EntryData.Num() < MinEntryBytes)
+			{
+				bWriteOk = false;
+				break;
+			}
+
+			FTrajectoryEntryHeaderBinary EntryHeader;
+			FMemory::Memcpy(&EntryHeader, EntryData.GetData(), sizeof(EntryHeader));
+
+			// Decode the full-resolution slots
+			for (FPositionSampleBinary& Slot : Slots)
+			{
+				Slot = MissingSample;
+			}
+
+			if (ShardReader.IsCompressed())
+			{
+				if (!FTrajectoryShardCodec::DecodeEntry(EntryData, IntervalSize, Quantization, Slots.GetData(), DecodeScratch))
+				{
+					bWriteOk = false;
+					break;
+				}
+			}
+			else
+			{
+				FMemory::Memcpy(Slots.GetData(), EntryData.GetData() + sizeof(FTrajectoryEntryHeaderBinary), IntervalSize * sizeof(FPositionSampleBinary));
+			}
+
+			// LOD slot k = full-resolution slot k * DecimationFactor; the valid range shrinks to the slots it still covers
+			int32 LodStart = -1;
+			int32 LodCount = 0;
+			if (EntryHeader.StartTimeStepInInterval >= 0 && EntryHeader.ValidSampleCount > 0)
+			{
+				const int32 FirstLodSlot = FMath::DivideAndRoundUp(EntryHeader.StartTimeStepInInterval, DecimationFactor);
+				const int32 LastLodSlot = (EntryHeader.StartTimeStepInInterval + EntryHeader.ValidSampleCount - 1) / DecimationFactor;
+				if (FirstLodSlot <= LastLodSlot)
+				{
+					LodStart = FirstLodSlot;
+					LodCount = LastLodSlot - FirstLodSlot + 1;
+				}
+			}
+
+			for (int32 LodSlotIdx = 0; LodSlotIdx < LodIntervalSize; ++LodSlotIdx)
+			{
+				const bool bInValidRange = LodSlotIdx >= LodStart && LodSlotIdx < LodStart + LodCount;
+				LodSlots[LodSlotIdx] = bInValidRange ? Slots[LodSlotIdx * DecimationFactor] : MissingSample;
+			}
+
+			if (ShardReader.IsCompressed())
+			{
+				FTrajectoryShardCodec::EncodeEntry(EntryHeader.TrajectoryId, LodStart, LodCount, LodSlots.GetData(), Quantization, EntryBytes);
+				EntryOffsets[EntryIdx] = WriteOffset;
+			}
+			else
+			{
+				const FTrajectoryEntryHeaderBinary LodEntryHeader = { EntryHeader.TrajectoryId, LodStart, LodCount };
+				EntryBytes.Reset();
+				EntryBytes.Append(reinterpret_cast<const uint8*>(&LodEntryHeader), sizeof(LodEntryHeader));
+				EntryBytes.Append(reinterpret_cast<const uint8*>(LodSlots.GetData()), LodIntervalSize * sizeof(FPositionSampleBinary));
+			}
+
+			bWriteOk &= LodFile->Write(EntryBytes.GetData(), EntryBytes.Num());
+			WriteOffset += EntryBytes.Num();
+		}
+
+		if (bWriteOk && ShardReader.IsCompressed())
+		{
+			EntryOffsets[EntryCount] = WriteOffset;
+			bWriteOk = LodFile->Seek(sizeof(FDataBlockHeaderBinary)) &&
+				LodFile->Write(reinterpret_cast<const uint8*>(EntryOffsets.GetData()), EntryOffsets.Num() * sizeof(uint64));
+		}
+
+		bWriteOk &= LodFile->Flush();
+		LodFile.Reset();
+
+		if (!bWriteOk)
+		{
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryLodPyramidCommandlet: Failed to write %s"), *LodShardPath);
+			PlatformFile.DeleteFile(*LodShardPath);
+			return false;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryLodPyramidCommandlet: Wrote %s (%d entries, %lld bytes)"), *LodShardPath, EntryCount, WriteOffset);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TrajectoryLodPyramidCommandlet: Built LOD level %d for %s (%d shards)"),
+		DecimationFactor, *DatasetPath, ShardInfoTable.Num());
+
+	return true;
+}
@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryMetaTable.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+FTrajectoryMetaTable::FTrajectoryMetaTable()
+	: Records(nullptr)
+	, NumRecords(0)
+	, bUnsorted(false)
+{
+}
+
+bool FTrajectoryMetaTable::Open(const FString& FilePath)
+{
+	Records = nullptr;
+	NumRecords = 0;
+	bUnsorted = false;
+	SourcePath = FilePath;
+	MappedRegion.Reset();
+	MappedFileHandle.Reset();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	const int64 FileSize = PlatformFile.FileSize(*FilePath);
+	if (FileSize <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryMetaTable: Invalid file size for %s"), *FilePath);
+		return false;
+	}
+
+	if (FileSize % sizeof(FTrajectoryMetaBinary) != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TrajectoryMetaTable: File size of %s is not a multiple of the trajectory meta size"), *FilePath);
+	}
+
+	const int64 NumFileRecords = FileSize / sizeof(FTrajectoryMetaBinary);
+	if (NumFileRecords > MAX_int32)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryMetaTable: Too many trajectories in %s (%lld)"), *FilePath, NumFileRecords);
+		return false;
+	}
+
+	MappedFileHandle.Reset(PlatformFile.OpenMapped(*FilePath));
+	if (!MappedFileHandle.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryMetaTable: Failed to memory-map file: %s"), *FilePath);
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFileHandle->MapRegion(0, FileSize));
+	if (!MappedRegion.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryMetaTable: Failed to map file region: %s"), *FilePath);
+		MappedFileHandle.Reset();
+		return false;
+	}
+
+	// FTrajectoryMetaBinary is packed (alignment 1), so the mapped bytes can be used in place
+	static_assert(alignof(FTrajectoryMetaBinary) == 1, "FTrajectoryMetaBinary must be byte-aligned (packed) for direct pointer cast");
+	Records = reinterpret_cast<const FTrajectoryMetaBinary*>(MappedRegion->GetMappedPtr());
+	NumRecords = static_cast<int32>(NumFileRecords);
+
+	// The sort order required by the specification is trusted here (checking it would read every page);
+	// Find() checks the records it visits instead
+	return true;
+}
+
+const FTrajectoryMetaBinary* FTrajectoryMetaTable::Find(int64 TrajectoryId) const
+{
+	const uint64 Key = static_cast<uint64>(TrajectoryId);
+
+	if (!bUnsorted.load(std::memory_order_relaxed))
+	{
+		// Every probe must lie between the IDs of the probes bracketing it; otherwise the file breaks the sort order
+		uint64 LowerId = 0;
+		uint64 UpperId = MAX_uint64;
+		bool bOrdered = true;
+
+		int32 Low = 0;
+		int32 High = NumRecords;
+		while (Low < High)
+		{
+			const int32 Mid = Low + (High - Low) / 2;
+			const uint64 MidId = Records[Mid].TrajectoryId;
+			if (MidId < LowerId || MidId > UpperId)
+			{
+				bOrdered = false;
+				break;
+			}
+
+			if (MidId < Key)
+			{
+				Low = Mid + 1;
+				LowerId = MidId;
+			}
+			else
+			{
+				High = Mid;
+				UpperId = MidId;
+			}
+		}
+
+		if (bOrdered)
+		{
+			return (Low < NumRecords && Records[Low].TrajectoryId == Key) ? &Records[Low] : nullptr;
+		}
+
+		if (!bUnsorted.exchange(true))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryMetaTable: %s is not sorted by trajectory ID, falling back to linear lookups"), *SourcePath);
+		}
+	}
+
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		if (Records[Index].TrajectoryId == Key)
+		{
+			return &Records[Index];
+		}
+	}
+	return nullptr;
+}
+
+int64 FTrajectoryMetaTable::GetAllocatedSize() const
+{
+	return (int64)NumRecords * sizeof(FTrajectoryMetaBinary);
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectorySampleArena.h"
+#include "Async/ParallelFor.h"
+
+int32 FTrajectorySampleArena::GetMaxSampleCount() const
+{
+	int32 MaxSamples = 0;
+	for (int32 SampleCount : SampleCounts)
+	{
+		MaxSamples = FMath::Max(MaxSamples, SampleCount);
+	}
+	return MaxSamples;
+}
+
+FLoadedTrajectoryView FTrajectorySampleArena::GetTrajectoryView(int32 TrajectoryIndex) const
+{
+	FLoadedTrajectoryView View;
+	View.TrajectoryId = TrajectoryIds[TrajectoryIndex];
+	View.StartTimeStep = StartTimeSteps[TrajectoryIndex];
+	View.EndTimeStep = EndTimeSteps[TrajectoryIndex];
+	View.Extent = Extents[TrajectoryIndex];
+	View.FirstSampleTimeStep = FirstSampleTimeSteps[TrajectoryIndex];
+	View.Samples = GetSamples(TrajectoryIndex);
+	return View;
+}
+
+void FTrajectorySampleArena::ReserveTrajectories(int32 NumTrajectories)
+{
+	TrajectoryIds.Reserve(NumTrajectories);
+	StartTimeSteps.Reserve(NumTrajectories);
+	EndTimeSteps.Reserve(NumTrajectories);
+	FirstSampleTimeSteps.Reserve(NumTrajectories);
+	Extents.Reserve(NumTrajectories);
+	SampleOffsets.Reserve(NumTrajectories);
+	SampleCounts.Reserve(NumTrajectories);
+}
+
+int32 FTrajectorySampleArena::AddTrajectory(int64 TrajectoryId, int32 StartTimeStep, int32 EndTimeStep, const FVector3f& Extent,
+	int32 FirstSampleTimeStep, int32 SampleCount)
+{
+	TrajectoryIds.Add(TrajectoryId);
+	StartTimeSteps.Add(StartTimeStep);
+	EndTimeSteps.Add(EndTimeStep);
+	FirstSampleTimeSteps.Add(FirstSampleTimeStep);
+	Extents.Add(Extent);
+	SampleOffsets.Add(0);
+	return SampleCounts.Add(FMath::Max(SampleCount, 0));
+}
+
+void FTrajectorySampleArena::AllocatePositions()
+{
+	// Prefix sum over sample counts gives each trajectory its contiguous range
+	int64 TotalSamples = 0;
+	for (int32 TrajIdx = 0; TrajIdx < SampleCounts.Num(); ++TrajIdx)
+	{
+		SampleOffsets[TrajIdx] = static_cast<int32>(TotalSamples);
+		TotalSamples += SampleCounts[TrajIdx];
+	}
+
+	checkf(TotalSamples <= MAX_int32, TEXT("Trajectory sample arena exceeds %d samples"), MAX_int32);
+
+	Positions.SetNumUninitialized(static_cast<int32>(TotalSamples));
+
+	// Mark all samples as missing; loaded samples overwrite their slots
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	const FVector3f NaNPosition(NaN, NaN, NaN);
+	constexpr int32 FillChunkSize = 64 * 1024;
+	const int32 NumChunks = FMath::DivideAndRoundUp(Positions.Num(), FillChunkSize);
+	ParallelFor(NumChunks, [this, &NaNPosition](int32 ChunkIdx)
+	{
+		const int32 ChunkStart = ChunkIdx * FillChunkSize;
+		const int32 ChunkEnd = FMath::Min(ChunkStart + FillChunkSize, Positions.Num());
+		for (int32 SampleIdx = ChunkStart; SampleIdx < ChunkEnd; ++SampleIdx)
+		{
+			Positions[SampleIdx] = NaNPosition;
+		}
+	});
+}
+
+int64 FTrajectorySampleArena::GetAllocatedSize() const
+{
+	return sizeof(FTrajectorySampleArena)
+		+ TrajectoryIds.GetAllocatedSize()
+		+ StartTimeSteps.GetAllocatedSize()
+		+ EndTimeSteps.GetAllocatedSize()
+		+ FirstSampleTimeSteps.GetAllocatedSize()
+		+ Extents.GetAllocatedSize()
+		+ SampleOffsets.GetAllocatedSize()
+		+ SampleCounts.GetAllocatedSize()
+		+ Positions.GetAllocatedSize();
+}
@@ -0,0 +1,255 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryShardCodec.h"
+#include <limits>
+
+FTrajectoryQuantization FTrajectoryQuantization::FromDatasetMeta(const FDatasetMetaBinary& DatasetMeta)
+{
+	FTrajectoryQuantization Quantization;
+	Quantization.Origin = FVector3f(DatasetMeta.BBoxMin[0], DatasetMeta.BBoxMin[1], DatasetMeta.BBoxMin[2]);
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float Range = DatasetMeta.BBoxMax[Axis] - DatasetMeta.BBoxMin[Axis];
+		Quantization.Scale[Axis] = (Range > 0.0f) ? Range / 65535.0f : 0.0f;
+	}
+
+	return Quantization;
+}
+
+void FTrajectoryQuantization::Quantize(const FPositionSampleBinary& Position, uint16 OutQuantized[3]) const
+{
+	const float Coordinates[3] = { Position.X, Position.Y, Position.Z };
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float Steps = (Scale[Axis] > 0.0f) ? (Coordinates[Axis] - Origin[Axis]) / Scale[Axis] : 0.0f;
+		OutQuantized[Axis] = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Steps), 0, 65535));
+	}
+}
+
+bool FTrajectoryShardCodec::DecodeEntry(TConstArrayView<uint8> EntryData, int32 TimeStepIntervalSize, const FTrajectoryQuantization& Quantization,
+	FPositionSampleBinary* OutSlots, FTrajectoryDecodeScratch& Scratch)
+{
+	if (EntryData.Num() < CompressedEntryHeaderSize)
+	{
+		return false;
+	}
+
+	const uint8* Data = EntryData.GetData();
+
+	int32 StartTimeStepInInterval;
+	int32 ValidSampleCount;
+	uint8 DeltaBytes;
+	uint32 PresentCount;
+	FMemory::Memcpy(&StartTimeStepInInterval, Data + 8, sizeof(int32));
+	FMemory::Memcpy(&ValidSampleCount, Data + 12, sizeof(int32));
+	FMemory::Memcpy(&DeltaBytes, Data + 16, sizeof(uint8));
+	FMemory::Memcpy(&PresentCount, Data + 20, sizeof(uint32));
+
+	// Per specification: start_time_step_in_interval == -1 means "none valid"
+	if (StartTimeStepInInterval == -1)
+	{
+		return true;
+	}
+
+	if (StartTimeStepInInterval < 0 || ValidSampleCount <= 0 ||
+		(int64)StartTimeStepInInterval + ValidSampleCount > TimeStepIntervalSize ||
+		PresentCount > (uint32)ValidSampleCount)
+	{
+		return false;
+	}
+
+	if (PresentCount > 0 && DeltaBytes != 1 && DeltaBytes != 2)
+	{
+		return false;
+	}
+
+	const int64 MaskBytes = (ValidSampleCount + 7) / 8;
+	const int64 PayloadBytes = (PresentCount > 0) ? 3 * sizeof(uint16) + (int64)(PresentCount - 1) * 3 * DeltaBytes : 0;
+	if (CompressedEntryHeaderSize + MaskBytes + PayloadBytes > EntryData.Num())
+	{
+		return false;
+	}
+
+	const uint8* PresenceMask = Data + CompressedEntryHeaderSize;
+	const uint8* Payload = PresenceMask + MaskBytes;
+	const int32 NumCoordinates = static_cast<int32>(PresentCount) * 3;
+
+	// 1. Reconstruct quantized coordinates - running sum of the deltas (modulo 65536)
+	Scratch.Quantized.SetNumUninitialized(NumCoordinates, EAllowShrinking::No);
+	uint16* Quantized = Scratch.Quantized.GetData();
+	if (PresentCount > 0)
+	{
+		FMemory::Memcpy(Quantized, Payload, 3 * sizeof(uint16));
+		const uint8* Deltas = Payload + 3 * sizeof(uint16);
+
+		if (DeltaBytes == 1)
+		{
+			const int8* Deltas8 = reinterpret_cast<const int8*>(Deltas);
+			for (int32 CoordIdx = 3; CoordIdx < NumCoordinates; ++CoordIdx)
+			{
+				Quantized[CoordIdx] = static_cast<uint16>(Quantized[CoordIdx - 3] + Deltas8[CoordIdx - 3]);
+			}
+		}
+		else
+		{
+			for (int32 CoordIdx = 3; CoordIdx < NumCoordinates; ++CoordIdx)
+			{
+				int16 Delta;
+				FMemory::Memcpy(&Delta, Deltas + (CoordIdx - 3) * sizeof(int16), sizeof(int16));
+				Quantized[CoordIdx] = static_cast<uint16>(Quantized[CoordIdx - 3] + Delta);
+			}
+		}
+	}
+
+	FPositionSampleBinary* EntrySlots = OutSlots + StartTimeStepInInterval;
+
+	// 2. Dequantize - without gaps the samples go straight into their slots
+	if (PresentCount == (uint32)ValidSampleCount)
+	{
+		DequantizePositions(Quantized, PresentCount, Quantization, EntrySlots);
+		return true;
+	}
+
+	Scratch.Positions.SetNumUninitialized(PresentCount, EAllowShrinking::No);
+	DequantizePositions(Quantized, PresentCount, Quantization, Scratch.Positions.GetData());
+
+	// 3. Scatter through the presence bitmask, gaps become NaN
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	const FPositionSampleBinary MissingSample = { NaN, NaN, NaN };
+	uint32 PresentIdx = 0;
+	for (int32 SlotIdx = 0; SlotIdx < ValidSampleCount; ++SlotIdx)
+	{
+		if (PresenceMask[SlotIdx >> 3] & (1 << (SlotIdx & 7)))
+		{
+			if (PresentIdx >= PresentCount)
+			{
+				return false;
+			}
+			EntrySlots[SlotIdx] = Scratch.Positions[PresentIdx++];
+		}
+		else
+		{
+			EntrySlots[SlotIdx] = MissingSample;
+		}
+	}
+
+	return PresentIdx == PresentCount;
+}
+
+void FTrajectoryShardCodec::EncodeEntry(uint64 TrajectoryId, int32 StartTimeStepInInterval, int32 ValidSampleCount,
+	const FPositionSampleBinary* Slots, const FTrajectoryQuantization& Quantization, TArray<uint8>& OutEntry)
+{
+	if (StartTimeStepInInterval < 0)
+	{
+		StartTimeStepInInterval = -1;
+		ValidSampleCount = 0;
+	}
+	ValidSampleCount = FMath::Max(ValidSampleCount, 0);
+
+	// Quantize present samples and build the presence bitmask
+	TArray<uint8> PresenceMask;
+	PresenceMask.SetNumZeroed((ValidSampleCount + 7) / 8);
+
+	TArray<uint16> Quantized;
+	Quantized.Reserve(ValidSampleCount * 3);
+
+	for (int32 SlotIdx = 0; SlotIdx < ValidSampleCount; ++SlotIdx)
+	{
+		const FPositionSampleBinary& Sample = Slots[StartTimeStepInInterval + SlotIdx];
+		if (FMath::IsNaN(Sample.X) || FMath::IsNaN(Sample.Y) || FMath::IsNaN(Sample.Z))
+		{
+			continue;
+		}
+
+		PresenceMask[SlotIdx >> 3] |= (1 << (SlotIdx & 7));
+		uint16 SampleQuantized[3];
+		Quantization.Quantize(Sample, SampleQuantized);
+		Quantized.Append(SampleQuantized, 3);
+	}
+
+	const uint32 PresentCount = Quantized.Num() / 3;
+
+	// Deltas modulo 65536 always fit into int16; use int8 when the whole entry allows it
+	uint8 DeltaBytes = 1;
+	for (int32 CoordIdx = 3; CoordIdx < Quantized.Num(); ++CoordIdx)
+	{
+		const int16 Delta = static_cast<int16>(static_cast<uint16>(Quantized[CoordIdx] - Quantized[CoordIdx - 3]));
+		if (Delta < MIN_int8 || Delta > MAX_int8)
+		{
+			DeltaBytes = 2;
+			break;
+		}
+	}
+
+	OutEntry.Reset();
+	auto AppendBytes = [&OutEntry](const void* Source, int32 NumBytes)
+	{
+		OutEntry.Append(static_cast<const uint8*>(Source), NumBytes);
+	};
+
+	const uint8 Reserved[3] = { 0, 0, 0 };
+	AppendBytes(&TrajectoryId, sizeof(uint64));
+	AppendBytes(&StartTimeStepInInterval, sizeof(int32));
+	AppendBytes(&ValidSampleCount, sizeof(int32));
+	AppendBytes(&DeltaBytes, sizeof(uint8));
+	AppendBytes(Reserved, sizeof(Reserved));
+	AppendBytes(&PresentCount, sizeof(uint32));
+	AppendBytes(PresenceMask.GetData(), PresenceMask.Num());
+
+	if (PresentCount > 0)
+	{
+		AppendBytes(Quantized.GetData(), 3 * sizeof(uint16));
+
+		for (int32 CoordIdx = 3; CoordIdx < Quantized.Num(); ++CoordIdx)
+		{
+			const int16 Delta = static_cast<int16>(static_cast<uint16>(Quantized[CoordIdx] - Quantized[CoordIdx - 3]));
+			if (DeltaBytes == 1)
+			{
+				const int8 Delta8 = static_cast<int8>(Delta);
+				AppendBytes(&Delta8, sizeof(int8));
+			}
+			else
+			{
+				AppendBytes(&Delta, sizeof(int16));
+			}
+		}
+	}
+}
+
+void FTrajectoryShardCodec::DequantizePositions(const uint16* Quantized, int32 NumSamples, const FTrajectoryQuantization& Quantization,
+	FPositionSampleBinary* OutPositions)
+{
+	const FVector3f& S = Quantization.Scale;
+	const FVector3f& O = Quantization.Origin;
+
+	// 4 samples = 12 interleaved coordinates = 3 vector registers; the x/y/z pattern repeats every 3 registers
+	const VectorRegister4Float Scale0 = MakeVectorRegisterFloat(S.X, S.Y, S.Z, S.X);
+	const VectorRegister4Float Scale1 = MakeVectorRegisterFloat(S.Y, S.Z, S.X, S.Y);
+	const VectorRegister4Float Scale2 = MakeVectorRegisterFloat(S.Z, S.X, S.Y, S.Z);
+	const VectorRegister4Float Origin0 = MakeVectorRegisterFloat(O.X, O.Y, O.Z, O.X);
+	const VectorRegister4Float Origin1 = MakeVectorRegisterFloat(O.Y, O.Z, O.X, O.Y);
+	const VectorRegister4Float Origin2 = MakeVectorRegisterFloat(O.Z, O.X, O.Y, O.Z);
+
+	int32 SampleIdx = 0;
+	for (; SampleIdx + 4 <= NumSamples; SampleIdx += 4)
+	{
+		const uint16* Q = Quantized + SampleIdx * 3;
+		const VectorRegister4Int Int0 = MakeVectorRegisterInt(Q[0], Q[1], Q[2], Q[3]);
+		const VectorRegister4Int Int1 = MakeVectorRegisterInt(Q[4], Q[5], Q[6], Q[7]);
+		const VectorRegister4Int Int2 = MakeVectorRegisterInt(Q[8], Q[9], Q[10], Q[11]);
+
+		float* Dst = &OutPositions[SampleIdx].X;
+		VectorStore(VectorMultiplyAdd(VectorIntToFloat(Int0), Scale0, Origin0), Dst);
+		VectorStore(VectorMultiplyAdd(VectorIntToFloat(Int1), Scale1, Origin1), Dst + 4);
+		VectorStore(VectorMultiplyAdd(VectorIntToFloat(Int2), Scale2, Origin2), Dst + 8);
+	}
+
+	for (; SampleIdx < NumSamples; ++SampleIdx)
+	{
+		const uint16* Q = Quantized + SampleIdx * 3;
+		OutPositions[SampleIdx].X = O.X + Q[0] * S.X;
+		OutPositions[SampleIdx].Y = O.Y + Q[1] * S.Y;
+		OutPositions[SampleIdx].Z = O.Z + Q[2] * S.Z;
+	}
+}
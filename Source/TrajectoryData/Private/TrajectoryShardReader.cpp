@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryShardReader.h"
+#include "TrajectoryShardCodec.h"
+
+FTrajectoryShardReader::FTrajectoryShardReader(const uint8* InMappedData, int64 InMappedSize, const FDataBlockHeaderBinary& InHeader, int32 InEntrySizeBytes)
+	: MappedData(InMappedData)
+	, MappedSize(InMappedSize)
+	, DataSectionOffset(InHeader.DataSectionOffset)
+	, EntrySizeBytes(InEntrySizeBytes)
+	, EntryCount(0)
+	, bIsCompressed(InHeader.FormatVersion >= TrajectoryShardFormat::Compressed)
+	, bIsValid(false)
+{
+	if (!MappedData || DataSectionOffset < (int64)sizeof(FDataBlockHeaderBinary) || DataSectionOffset > MappedSize)
+	{
+		return;
+	}
+
+	if (bIsCompressed)
+	{
+		// Entry offset table must fit; individual records are validated on access so only touched pages are read
+		const int64 TableBytes = ((int64)FMath::Max(InHeader.TrajectoryEntryCount, 0) + 1) * sizeof(uint64);
+		if (DataSectionOffset + TableBytes > MappedSize)
+		{
+			return;
+		}
+
+		EntryCount = FMath::Max(InHeader.TrajectoryEntryCount, 0);
+		bIsValid = true;
+		return;
+	}
+
+	// Entry must at least hold the fixed entry header
+	if (EntrySizeBytes < (int32)sizeof(FTrajectoryEntryHeaderBinary))
+	{
+		return;
+	}
+
+	// Only expose entries that are fully contained in the mapped region
+	// (guards against truncated files without having to check every access)
+	const int64 AvailableEntries = (MappedSize - DataSectionOffset) / EntrySizeBytes;
+	EntryCount = static_cast<int32>(FMath::Min<int64>(InHeader.TrajectoryEntryCount, AvailableEntries));
+	EntryCount = FMath::Max(EntryCount, 0);
+	bIsValid = true;
+}
+
+const uint8* FTrajectoryShardReader::GetEntryPtr(int64 EntryIdx) const
+{
+	if (!bIsValid || EntryIdx < 0 || EntryIdx >= EntryCount)
+	{
+		return nullptr;
+	}
+
+	if (bIsCompressed)
+	{
+		const TConstArrayView<uint8> EntryData = GetEntryData(EntryIdx);
+		return EntryData.Num() > 0 ? EntryData.GetData() : nullptr;
+	}
+
+	// Per specification: file_offset = data_section_offset + (entry_offset_index * entry_size_bytes)
+	return MappedData + DataSectionOffset + (EntryIdx * (int64)EntrySizeBytes);
+}
+
+TConstArrayView<uint8> FTrajectoryShardReader::GetEntryData(int64 EntryIdx) const
+{
+	if (!bIsValid || EntryIdx < 0 || EntryIdx >= EntryCount)
+	{
+		return TConstArrayView<uint8>();
+	}
+
+	if (!bIsCompressed)
+	{
+		return TConstArrayView<uint8>(MappedData + DataSectionOffset + (EntryIdx * (int64)EntrySizeBytes), EntrySizeBytes);
+	}
+
+	// Format version 2: entry i occupies [offsets[i], offsets[i + 1])
+	uint64 EntryOffsets[2];
+	FMemory::Memcpy(EntryOffsets, MappedData + DataSectionOffset + EntryIdx * sizeof(uint64), sizeof(EntryOffsets));
+
+	const uint64 EntriesBegin = DataSectionOffset + ((uint64)EntryCount + 1) * sizeof(uint64);
+	if (EntryOffsets[0] < EntriesBegin || EntryOffsets[1] > (uint64)MappedSize ||
+		EntryOffsets[1] < EntryOffsets[0] + sizeof(FTrajectoryEntryHeaderBinary))
+	{
+		return TConstArrayView<uint8>();
+	}
+
+	return TConstArrayView<uint8>(MappedData + EntryOffsets[0], static_cast<int32>(EntryOffsets[1] - EntryOffsets[0]));
+}
+
+bool FTrajectoryShardReader::ReadEntryTrajectoryId(int64 EntryIdx, uint64& OutTrajectoryId) const
+{
+	const uint8* EntryPtr = GetEntryPtr(EntryIdx);
+	if (!EntryPtr)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutTrajectoryId, EntryPtr, sizeof(uint64));
+	return true;
+}
+
+int32 FTrajectoryShardReader::FindEntryBySeekHint(uint64 TrajectoryId, uint64 HintEntryIdx) const
+{
+	if (HintEntryIdx >= (uint64)EntryCount)
+	{
+		return INDEX_NONE;
+	}
+
+	uint64 EntryTrajId;
+	if (ReadEntryTrajectoryId(static_cast<int64>(HintEntryIdx), EntryTrajId) && EntryTrajId == TrajectoryId)
+	{
+		return static_cast<int32>(HintEntryIdx);
+	}
+
+	return INDEX_NONE;
+}
+
+int32 FTrajectoryShardReader::FindEntryByBinarySearch(uint64 TrajectoryId) const
+{
+	int32 Low = 0;
+	int32 High = EntryCount - 1;
+
+	while (Low <= High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+
+		uint64 EntryTrajId;
+		if (!ReadEntryTrajectoryId(Mid, EntryTrajId))
+		{
+			return INDEX_NONE;
+		}
+
+		if (EntryTrajId == TrajectoryId)
+		{
+			return Mid;
+		}
+
+		if (EntryTrajId < TrajectoryId)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid - 1;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void FTrajectoryShardReader::BuildEntryIndex(FShardEntryIndex& OutIndex) const
+{
+	OutIndex.EntryIndexById.Reset();
+	OutIndex.EntryIndexById.Reserve(EntryCount);
+
+	for (int32 EntryIdx = 0; EntryIdx < EntryCount; ++EntryIdx)
+	{
+		uint64 EntryTrajId;
+		if (ReadEntryTrajectoryId(EntryIdx, EntryTrajId))
+		{
+			OutIndex.EntryIndexById.Add(static_cast<int64>(EntryTrajId), EntryIdx);
+		}
+	}
+}
@@ -0,0 +1,373 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectorySpatialIndex.h"
+#include "ConvexVolume.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+
+namespace TrajectorySpatialIndexFile
+{
+	/** "TDSI" */
+	constexpr uint32 Magic = 0x49534454;
+	constexpr uint32 Version = 1;
+}
+
+void FTrajectorySpatialIndex::AddInterval(int32 ShardIndex, int32 StartTimeStep, int32 EndTimeStep, TArray<uint64>&& TrajectoryIds, TArray<FBox3f>&& Bounds)
+{
+	check(TrajectoryIds.Num() == Bounds.Num());
+
+	FInterval& Interval = Intervals.AddDefaulted_GetRef();
+	Interval.ShardIndex = ShardIndex;
+	Interval.StartTimeStep = StartTimeStep;
+	Interval.EndTimeStep = EndTimeStep;
+	Interval.TrajectoryIds = MoveTemp(TrajectoryIds);
+	Interval.Bounds = MoveTemp(Bounds);
+
+	BuildHierarchy(Interval);
+}
+
+void FTrajectorySpatialIndex::Finalize()
+{
+	Intervals.Sort([](const FInterval& A, const FInterval& B)
+	{
+		return A.StartTimeStep < B.StartTimeStep;
+	});
+}
+
+void FTrajectorySpatialIndex::QueryBox(const FBox3f& Box, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const
+{
+	Query(StartTimeStep, EndTimeStep, [&Box](const FVector3f& Min, const FVector3f& Max)
+	{
+		return Min.X <= Box.Max.X && Max.X >= Box.Min.X
+			&& Min.Y <= Box.Max.Y && Max.Y >= Box.Min.Y
+			&& Min.Z <= Box.Max.Z && Max.Z >= Box.Min.Z;
+	}, OutTrajectoryIds);
+}
+
+void FTrajectorySpatialIndex::QuerySphere(const FVector3f& Center, float Radius, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const
+{
+	const float RadiusSquared = Radius * Radius;
+	Query(StartTimeStep, EndTimeStep, [&Center, RadiusSquared](const FVector3f& Min, const FVector3f& Max)
+	{
+		// Distance from the center to the closest point of the box
+		const FVector3f Closest(FMath::Clamp(Center.X, Min.X, Max.X), FMath::Clamp(Center.Y, Min.Y, Max.Y), FMath::Clamp(Center.Z, Min.Z, Max.Z));
+		return FVector3f::DistSquared(Center, Closest) <= RadiusSquared;
+	}, OutTrajectoryIds);
+}
+
+void FTrajectorySpatialIndex::QueryFrustum(const FConvexVolume& Frustum, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const
+{
+	Query(StartTimeStep, EndTimeStep, [&Frustum](const FVector3f& Min, const FVector3f& Max)
+	{
+		const FVector Origin = FVector((Min + Max) * 0.5f);
+		const FVector Extent = FVector((Max - Min) * 0.5f);
+		return Frustum.IntersectBox(Origin, Extent);
+	}, OutTrajectoryIds);
+}
+
+void FTrajectorySpatialIndex::QueryRegion(const FTrajectorySpatialRegion& Region, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const
+{
+	switch (Region.Shape)
+	{
+	case ETrajectoryRegionShape::Sphere:
+		QuerySphere(FVector3f(Region.SphereCenter), Region.SphereRadius, StartTimeStep, EndTimeStep, OutTrajectoryIds);
+		break;
+
+	case ETrajectoryRegionShape::Box:
+	default:
+		QueryBox(FBox3f(FVector3f(Region.BoxMin), FVector3f(Region.BoxMax)), StartTimeStep, EndTimeStep, OutTrajectoryIds);
+		break;
+	}
+}
+
+void FTrajectorySpatialIndex::Query(int32 StartTimeStep, int32 EndTimeStep, TFunctionRef<bool(const FVector3f&, const FVector3f&)> Overlaps,
+	TArray<int64>& OutTrajectoryIds) const
+{
+	OutTrajectoryIds.Reset();
+
+	TSet<int64> FoundIds;
+	TArray<int32, TInlineAllocator<64>> NodeStack;
+
+	for (const FInterval& Interval : Intervals)
+	{
+		if (Interval.EndTimeStep < StartTimeStep || Interval.StartTimeStep > EndTimeStep || Interval.Nodes.Num() == 0)
+		{
+			continue;
+		}
+
+		NodeStack.Reset();
+		NodeStack.Add(0);
+		while (NodeStack.Num() > 0)
+		{
+			const FNode& Node = Interval.Nodes[NodeStack.Pop(EAllowShrinking::No)];
+			if (!Overlaps(Node.Min, Node.Max))
+			{
+				continue;
+			}
+
+			if (Node.Count == 0)
+			{
+				NodeStack.Add(Node.FirstIndex);
+				NodeStack.Add(Node.FirstIndex + 1);
+				continue;
+			}
+
+			for (int32 BoxIdx = Node.FirstIndex; BoxIdx < Node.FirstIndex + Node.Count; ++BoxIdx)
+			{
+				const FBox3f& Bounds = Interval.Bounds[BoxIdx];
+				if (Overlaps(Bounds.Min, Bounds.Max))
+				{
+					FoundIds.Add(static_cast<int64>(Interval.TrajectoryIds[BoxIdx]));
+				}
+			}
+		}
+	}
+
+	// Sorted by ID, the order of the trajectory metadata
+	OutTrajectoryIds = FoundIds.Array();
+	OutTrajectoryIds.Sort();
+}
+
+void FTrajectorySpatialIndex::BuildHierarchy(FInterval& Interval)
+{
+	Interval.Nodes.Reset();
+
+	const int32 NumBoxes = Interval.Bounds.Num();
+	if (NumBoxes == 0)
+	{
+		return;
+	}
+
+	// Boxes are sorted through a permutation and reordered once at the end
+	TArray<int32> Order;
+	Order.SetNumUninitialized(NumBoxes);
+	for (int32 BoxIdx = 0; BoxIdx < NumBoxes; ++BoxIdx)
+	{
+		Order[BoxIdx] = BoxIdx;
+	}
+
+	struct FBuildTask
+	{
+		int32 NodeIdx;
+		int32 Begin;
+		int32 End;
+	};
+
+	Interval.Nodes.Reserve(2 * FMath::DivideAndRoundUp(NumBoxes, MaxLeafSize));
+	Interval.Nodes.AddUninitialized();
+
+	TArray<FBuildTask> Tasks;
+	Tasks.Add({ 0, 0, NumBoxes });
+
+	while (Tasks.Num() > 0)
+	{
+		const FBuildTask Task = Tasks.Pop(EAllowShrinking::No);
+
+		FBox3f NodeBounds(ForceInit);
+		FBox3f CenterBounds(ForceInit);
+		for (int32 OrderIdx = Task.Begin; OrderIdx < Task.End; ++OrderIdx)
+		{
+			const FBox3f& Bounds = Interval.Bounds[Order[OrderIdx]];
+			NodeBounds += Bounds;
+			CenterBounds += Bounds.GetCenter();
+		}
+
+		FNode& Node = Interval.Nodes[Task.NodeIdx];
+		Node.Min = NodeBounds.Min;
+		Node.Max = NodeBounds.Max;
+
+		const int32 NumNodeBoxes = Task.End - Task.Begin;
+		const FVector3f CenterExtent = CenterBounds.GetSize();
+		if (NumNodeBoxes <= MaxLeafSize || CenterExtent.IsNearlyZero())
+		{
+			Node.FirstIndex = Task.Begin;
+			Node.Count = NumNodeBoxes;
+			continue;
+		}
+
+		// Median split along the axis with the largest spread of box centers
+		const int32 Axis = (CenterExtent.X >= CenterExtent.Y && CenterExtent.X >= CenterExtent.Z) ? 0 : (CenterExtent.Y >= CenterExtent.Z ? 1 : 2);
+		TArrayView<int32>(Order.GetData() + Task.Begin, NumNodeBoxes).Sort([&Interval, Axis](int32 A, int32 B)
+		{
+			return Interval.Bounds[A].GetCenter()[Axis] < Interval.Bounds[B].GetCenter()[Axis];
+		});
+
+		const int32 FirstChild = Interval.Nodes.Num();
+		Interval.Nodes.AddUninitialized(2);
+
+		// Note: Node may be invalidated by AddUninitialized - index the array again
+		Interval.Nodes[Task.NodeIdx].FirstIndex = FirstChild;
+		Interval.Nodes[Task.NodeIdx].Count = 0;
+
+		const int32 Middle = Task.Begin + NumNodeBoxes / 2;
+		Tasks.Add({ FirstChild, Task.Begin, Middle });
+		Tasks.Add({ FirstChild + 1, Middle, Task.End });
+	}
+
+	TArray<uint64> SortedIds;
+	TArray<FBox3f> SortedBounds;
+	SortedIds.SetNumUninitialized(NumBoxes);
+	SortedBounds.SetNumUninitialized(NumBoxes);
+	for (int32 OrderIdx = 0; OrderIdx < NumBoxes; ++OrderIdx)
+	{
+		SortedIds[OrderIdx] = Interval.TrajectoryIds[Order[OrderIdx]];
+		SortedBounds[OrderIdx] = Interval.Bounds[Order[OrderIdx]];
+	}
+	Interval.TrajectoryIds = MoveTemp(SortedIds);
+	Interval.Bounds = MoveTemp(SortedBounds);
+}
+
+bool FTrajectorySpatialIndex::Save(const FString& FilePath, const TMap<FString, FTrajectoryFileStamp>& SourceStamps) const
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer.IsValid())
+	{
+		return false;
+	}
+
+	FArchive& Ar = *Writer;
+	uint32 Magic = TrajectorySpatialIndexFile::Magic;
+	uint32 Version = TrajectorySpatialIndexFile::Version;
+	Ar << Magic << Version;
+
+	// Source files by file name, so the dataset directory can be moved
+	int32 NumStamps = SourceStamps.Num();
+	Ar << NumStamps;
+	for (const auto& StampEntry : SourceStamps)
+	{
+		FString FileName = FPaths::GetCleanFilename(StampEntry.Key);
+		int64 FileSize = StampEntry.Value.FileSize;
+		int64 ModificationTicks = StampEntry.Value.ModificationTime.GetTicks();
+		Ar << FileName << FileSize << ModificationTicks;
+	}
+
+	int32 NumIntervals = Intervals.Num();
+	Ar << NumIntervals;
+	for (const FInterval& Interval : Intervals)
+	{
+		int32 ShardIndex = Interval.ShardIndex;
+		int32 StartTimeStep = Interval.StartTimeStep;
+		int32 EndTimeStep = Interval.EndTimeStep;
+		Ar << ShardIndex << StartTimeStep << EndTimeStep;
+
+		// Plain-old-data arrays are written in bulk
+		int32 NumBoxes = Interval.Bounds.Num();
+		int32 NumNodes = Interval.Nodes.Num();
+		Ar << NumBoxes << NumNodes;
+		Ar.Serialize(const_cast<uint64*>(Interval.TrajectoryIds.GetData()), NumBoxes * sizeof(uint64));
+		Ar.Serialize(const_cast<FBox3f*>(Interval.Bounds.GetData()), NumBoxes * sizeof(FBox3f));
+		Ar.Serialize(const_cast<FNode*>(Interval.Nodes.GetData()), NumNodes * sizeof(FNode));
+	}
+
+	return Writer->Close() && !Writer->IsError();
+}
+
+bool FTrajectorySpatialIndex::Load(const FString& FilePath, const TMap<FString, FTrajectoryFileStamp>& SourceStamps)
+{
+	Intervals.Reset();
+
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+
+	FArchive& Ar = *Reader;
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != TrajectorySpatialIndexFile::Magic || Version != TrajectorySpatialIndexFile::Version)
+	{
+		return false;
+	}
+
+	TMap<FString, FTrajectoryFileStamp> CurrentStamps;
+	for (const auto& StampEntry : SourceStamps)
+	{
+		CurrentStamps.Add(FPaths::GetCleanFilename(StampEntry.Key), StampEntry.Value);
+	}
+
+	int32 NumStamps = 0;
+	Ar << NumStamps;
+	if (NumStamps != CurrentStamps.Num())
+	{
+		return false;
+	}
+
+	for (int32 StampIdx = 0; StampIdx < NumStamps; ++StampIdx)
+	{
+		FString FileName;
+		int64 FileSize = 0;
+		int64 ModificationTicks = 0;
+		Ar << FileName << FileSize << ModificationTicks;
+
+		const FTrajectoryFileStamp* CurrentStamp = CurrentStamps.Find(FileName);
+		if (Ar.IsError() || !CurrentStamp || CurrentStamp->FileSize != FileSize || CurrentStamp->ModificationTime.GetTicks() != ModificationTicks)
+		{
+			return false;
+		}
+	}
+
+	const int64 FileSize = Ar.TotalSize();
+
+	int32 NumIntervals = 0;
+	Ar << NumIntervals;
+	if (NumIntervals < 0)
+	{
+		return false;
+	}
+
+	Intervals.SetNum(NumIntervals);
+	for (FInterval& Interval : Intervals)
+	{
+		Ar << Interval.ShardIndex << Interval.StartTimeStep << Interval.EndTimeStep;
+
+		int32 NumBoxes = 0;
+		int32 NumNodes = 0;
+		Ar << NumBoxes << NumNodes;
+
+		// Reject sizes that can't be in the file before allocating
+		const int64 PayloadBytes = (int64)NumBoxes * (sizeof(uint64) + sizeof(FBox3f)) + (int64)NumNodes * sizeof(FNode);
+		if (Ar.IsError() || NumBoxes < 0 || NumNodes < 0 || Ar.Tell() + PayloadBytes > FileSize)
+		{
+			Intervals.Reset();
+			return false;
+		}
+
+		Interval.TrajectoryIds.SetNumUninitialized(NumBoxes);
+		Interval.Bounds.SetNumUninitialized(NumBoxes);
+		Interval.Nodes.SetNumUninitialized(NumNodes);
+		Ar.Serialize(Interval.TrajectoryIds.GetData(), NumBoxes * sizeof(uint64));
+		Ar.Serialize(Interval.Bounds.GetData(), NumBoxes * sizeof(FBox3f));
+		Ar.Serialize(Interval.Nodes.GetData(), NumNodes * sizeof(FNode));
+	}
+
+	if (Ar.IsError())
+	{
+		Intervals.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+int64 FTrajectorySpatialIndex::GetNumBoxes() const
+{
+	int64 NumBoxes = 0;
+	for (const FInterval& Interval : Intervals)
+	{
+		NumBoxes += Interval.Bounds.Num();
+	}
+	return NumBoxes;
+}
+
+int64 FTrajectorySpatialIndex::GetAllocatedSize() const
+{
+	int64 TotalBytes = sizeof(FTrajectorySpatialIndex) + Intervals.GetAllocatedSize();
+	for (const FInterval& Interval : Intervals)
+	{
+		TotalBytes += Interval.TrajectoryIds.GetAllocatedSize() + Interval.Bounds.GetAllocatedSize() + Interval.Nodes.GetAllocatedSize();
+	}
+	return TotalBytes;
+}
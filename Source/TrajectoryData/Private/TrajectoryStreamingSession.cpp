@@ -0,0 +1,355 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TrajectoryStreamingSession.h"
+#include "TrajectoryDataLoader.h"
+#include "Async/Async.h"
+
+FTrajectoryStreamingSession::FTrajectoryStreamingSession(UTrajectoryDataLoader* InLoader, const FTrajectoryDatasetInfo& InDatasetInfo,
+	const FTrajectoryStreamingParams& InParams, const TSharedPtr<FTrajectoryDatasetHandle>& InDatasetHandle)
+	: Loader(InLoader)
+	, DatasetInfo(InDatasetInfo)
+	, Params(InParams)
+	, DatasetHandle(InDatasetHandle)
+	, bEmptySelection(false)
+	, StartTimeStep(0)
+	, EndTimeStep(0)
+	, Cursor(0.0f)
+	, PlaybackDirection(1)
+	, ResidentMemoryBytes(0)
+{
+	check(DatasetHandle.IsValid());
+
+	// Intervals are always loaded into sample arenas so their samples are indexed by time step
+	Params.LoadParams.SampleLayout = ETrajectorySampleLayout::SampleArena;
+	Params.LoadParams.SampleRate = FMath::Max(Params.LoadParams.SampleRate, 1);
+
+	const FDatasetMetaBinary& DatasetMeta = DatasetHandle->DatasetMeta;
+	StartTimeStep = (Params.LoadParams.StartTimeStep < 0) ? DatasetMeta.FirstTimeStep : Params.LoadParams.StartTimeStep;
+	EndTimeStep = (Params.LoadParams.EndTimeStep < 0) ? DatasetMeta.LastTimeStep : Params.LoadParams.EndTimeStep;
+	Cursor = StartTimeStep;
+
+	for (const auto& ShardEntry : DatasetHandle->ShardInfoTable)
+	{
+		const FShardInfo& ShardInfo = ShardEntry.Value;
+		if (ShardInfo.ContainsTimeRange(StartTimeStep, EndTimeStep))
+		{
+			FStreamingInterval Interval;
+			Interval.ShardIndex = ShardEntry.Key;
+			Interval.StartTimeStep = FMath::Max(ShardInfo.StartTimeStep, StartTimeStep);
+			Interval.EndTimeStep = FMath::Min(ShardInfo.EndTimeStep, EndTimeStep);
+			Intervals.Add(Interval);
+		}
+	}
+
+	Intervals.Sort([](const FStreamingInterval& A, const FStreamingInterval& B)
+	{
+		return A.StartTimeStep < B.StartTimeStep;
+	});
+
+	// Querying the region per interval would select a different set of trajectories in every interval, so the
+	// region is resolved once over the whole playback range (in the background: it may build the spatial index)
+	if (Params.LoadParams.SelectionStrategy == ETrajectorySelectionStrategy::SpatialRegion)
+	{
+		FTrajectoryLoadParams SelectionParams = Params.LoadParams;
+		SelectionParams.StartTimeStep = StartTimeStep;
+		SelectionParams.EndTimeStep = EndTimeStep;
+
+		UTrajectoryDataLoader* LoaderPtr = Loader;
+		SelectionFuture = Async(EAsyncExecution::ThreadPool, [LoaderPtr, Handle = DatasetHandle, SelectionParams]()
+		{
+			return LoaderPtr->BuildTrajectoryIdList(SelectionParams, Handle->DatasetMeta, Handle->TrajMetas, Handle);
+		});
+	}
+}
+
+FTrajectoryStreamingSession::~FTrajectoryStreamingSession()
+{
+	// Background loads reference the loader and the dataset handle - let them finish
+	if (SelectionFuture.IsValid())
+	{
+		SelectionFuture.Wait();
+	}
+
+	for (auto& PendingEntry : PendingLoads)
+	{
+		PendingEntry.Value.Wait();
+	}
+}
+
+bool FTrajectoryStreamingSession::ResolveSelection()
+{
+	if (SelectionFuture.IsValid())
+	{
+		if (!SelectionFuture.IsReady())
+		{
+			return false;
+		}
+
+		const TArray<int64> TrajectoryIds = SelectionFuture.Consume();
+		Params.LoadParams.SelectionStrategy = ETrajectorySelectionStrategy::ExplicitList;
+		Params.LoadParams.TrajectorySelections.Reset(TrajectoryIds.Num());
+		for (int64 TrajectoryId : TrajectoryIds)
+		{
+			FTrajectoryLoadSelection Selection;
+			Selection.TrajectoryId = TrajectoryId;
+			Params.LoadParams.TrajectorySelections.Add(Selection);
+		}
+
+		bEmptySelection = TrajectoryIds.Num() == 0;
+		if (bEmptySelection)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryStreamingSession: No trajectories in the spatial region over time steps %d-%d, nothing to stream"),
+				StartTimeStep, EndTimeStep);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("TrajectoryStreamingSession: Spatial region selected %d trajectories over time steps %d-%d"),
+				TrajectoryIds.Num(), StartTimeStep, EndTimeStep);
+		}
+	}
+
+	return !bEmptySelection;
+}
+
+void FTrajectoryStreamingSession::UpdateCursor(float TimeStep, float PlaybackSpeed)
+{
+	Cursor = FMath::Clamp(TimeStep, static_cast<float>(StartTimeStep), static_cast<float>(EndTimeStep));
+	if (PlaybackSpeed > 0.0f)
+	{
+		PlaybackDirection = 1;
+	}
+	else if (PlaybackSpeed < 0.0f)
+	{
+		PlaybackDirection = -1;
+	}
+
+	CollectFinishedLoads(false);
+
+	if (!ResolveSelection())
+	{
+		return;
+	}
+
+	const int32 CurrentIdx = FindIntervalIndex(FMath::FloorToInt(Cursor));
+	if (CurrentIdx == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Look ahead by the fixed window plus the distance covered during the prefetch lead time,
+	// so faster playback prefetches further ahead
+	const float LeadTimeSteps = FMath::Max(Params.WindowTimeSteps, 0) + FMath::Abs(PlaybackSpeed) * FMath::Max(Params.PrefetchLeadSeconds, 0.0f);
+	const int32 LeadTimeStep = FMath::Clamp(FMath::FloorToInt(Cursor + PlaybackDirection * LeadTimeSteps), StartTimeStep, EndTimeStep);
+	const int32 LeadIdx = FindIntervalIndex(LeadTimeStep);
+
+	// Wanted intervals in load priority order: current, then ahead in playback direction, then behind
+	TArray<int32> LoadOrder;
+	for (int32 IntervalIdx = CurrentIdx; ; IntervalIdx += PlaybackDirection)
+	{
+		LoadOrder.Add(IntervalIdx);
+		if (IntervalIdx == LeadIdx)
+		{
+			break;
+		}
+	}
+
+	for (int32 BehindCount = 1; BehindCount <= Params.KeepBehindIntervals; ++BehindCount)
+	{
+		const int32 IntervalIdx = CurrentIdx - PlaybackDirection * BehindCount;
+		if (Intervals.IsValidIndex(IntervalIdx))
+		{
+			LoadOrder.Add(IntervalIdx);
+		}
+	}
+
+	WantedIntervals.Reset();
+	WantedIntervals.Append(LoadOrder);
+
+	// Evict everything outside the window
+	TArray<int32> IntervalsToEvict;
+	for (const auto& ResidentEntry : ResidentIntervals)
+	{
+		if (!WantedIntervals.Contains(ResidentEntry.Key))
+		{
+			IntervalsToEvict.Add(ResidentEntry.Key);
+		}
+	}
+
+	for (int32 IntervalIdx : IntervalsToEvict)
+	{
+		EvictInterval(IntervalIdx);
+	}
+
+	// Prefetch missing intervals, nearest first
+	const int32 MaxConcurrentLoads = FMath::Max(Params.MaxConcurrentLoads, 1);
+	for (int32 IntervalIdx : LoadOrder)
+	{
+		if (PendingLoads.Num() >= MaxConcurrentLoads)
+		{
+			break;
+		}
+
+		if (!ResidentIntervals.Contains(IntervalIdx) && !PendingLoads.Contains(IntervalIdx))
+		{
+			StartIntervalLoad(IntervalIdx);
+		}
+	}
+}
+
+TSharedPtr<const FTrajectoryStreamedInterval> FTrajectoryStreamingSession::FindResidentInterval(int32 TimeStep) const
+{
+	const int32 IntervalIdx = FindIntervalIndex(TimeStep);
+	if (IntervalIdx == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<const FTrajectoryStreamedInterval> Interval = ResidentIntervals.FindRef(IntervalIdx);
+	return (Interval.IsValid() && Interval->ContainsTimeStep(TimeStep)) ? Interval : nullptr;
+}
+
+bool FTrajectoryStreamingSession::TryGetPosition(int32 TrajectoryIndex, int32 TimeStep, FVector3f& OutPosition) const
+{
+	TSharedPtr<const FTrajectoryStreamedInterval> Interval = FindResidentInterval(TimeStep);
+	if (!Interval.IsValid() || !Interval->SampleArena.IsValid() || TrajectoryIndex < 0 || TrajectoryIndex >= Interval->SampleArena->Num())
+	{
+		return false;
+	}
+
+	const FTrajectorySampleArena& Arena = *Interval->SampleArena;
+	const int32 FirstSampleTimeStep = Arena.FirstSampleTimeSteps[TrajectoryIndex];
+	if (TimeStep < FirstSampleTimeStep)
+	{
+		return false;
+	}
+
+	// Nearest sample at or before the time step
+	const int32 SampleIdx = (TimeStep - FirstSampleTimeStep) / Arena.SampleRate;
+	const TConstArrayView<FVector3f> Samples = Arena.GetSamples(TrajectoryIndex);
+	if (!Samples.IsValidIndex(SampleIdx) || FMath::IsNaN(Samples[SampleIdx].X))
+	{
+		return false;
+	}
+
+	OutPosition = Samples[SampleIdx];
+	return true;
+}
+
+void FTrajectoryStreamingSession::FlushPendingLoads()
+{
+	CollectFinishedLoads(true);
+}
+
+int32 FTrajectoryStreamingSession::FindIntervalIndex(int32 TimeStep) const
+{
+	if (Intervals.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// Last interval starting at or before the time step (time steps in gaps map to the preceding interval)
+	int32 Low = 0;
+	int32 High = Intervals.Num() - 1;
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low + 1) / 2;
+		if (Intervals[Mid].StartTimeStep <= TimeStep)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid - 1;
+		}
+	}
+
+	return Low;
+}
+
+void FTrajectoryStreamingSession::CollectFinishedLoads(bool bWait)
+{
+	TArray<int32> FinishedIntervals;
+	for (auto& PendingEntry : PendingLoads)
+	{
+		if (bWait)
+		{
+			PendingEntry.Value.Wait();
+		}
+
+		if (PendingEntry.Value.IsReady())
+		{
+			FinishedIntervals.Add(PendingEntry.Key);
+		}
+	}
+
+	for (int32 IntervalIdx : FinishedIntervals)
+	{
+		TSharedPtr<const FTrajectoryStreamedInterval> Interval = PendingLoads.FindChecked(IntervalIdx).Get();
+		PendingLoads.Remove(IntervalIdx);
+
+		// The cursor may have moved on while the interval was loading
+		if (!Interval.IsValid() || !WantedIntervals.Contains(IntervalIdx))
+		{
+			if (!ResidentIntervals.Contains(IntervalIdx))
+			{
+				DatasetHandle->ReleaseMappedShard(Intervals[IntervalIdx].ShardIndex);
+			}
+			continue;
+		}
+
+		ResidentIntervals.Add(IntervalIdx, Interval);
+		ResidentMemoryBytes += Interval->MemoryUsedBytes;
+	}
+}
+
+void FTrajectoryStreamingSession::StartIntervalLoad(int32 IntervalIdx)
+{
+	const FStreamingInterval Interval = Intervals[IntervalIdx];
+
+	FTrajectoryLoadParams IntervalParams = Params.LoadParams;
+	IntervalParams.StartTimeStep = Interval.StartTimeStep;
+	IntervalParams.EndTimeStep = Interval.EndTimeStep;
+
+	// Note: Capturing the loader is safe because the session waits for its loads before it is destroyed,
+	// and the session is owned by the (rooted) loader
+	UTrajectoryDataLoader* LoaderPtr = Loader;
+	PendingLoads.Add(IntervalIdx, Async(EAsyncExecution::ThreadPool,
+		[LoaderPtr, Info = DatasetInfo, Handle = DatasetHandle, IntervalParams, Interval]() -> TSharedPtr<const FTrajectoryStreamedInterval>
+	{
+		FTrajectoryLoadResult Result = LoaderPtr->LoadTrajectoriesInternal(Info, IntervalParams, false, Handle);
+		if (!Result.bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TrajectoryStreamingSession: Failed to load interval %d-%d: %s"),
+				Interval.StartTimeStep, Interval.EndTimeStep, *Result.ErrorMessage);
+			return nullptr;
+		}
+
+		TSharedPtr<FTrajectoryStreamedInterval> Loaded = MakeShared<FTrajectoryStreamedInterval>();
+		Loaded->ShardIndex = Interval.ShardIndex;
+		Loaded->StartTimeStep = Interval.StartTimeStep;
+		Loaded->EndTimeStep = Interval.EndTimeStep;
+		Loaded->SampleArena = Result.SampleArena;
+		Loaded->MemoryUsedBytes = Result.MemoryUsedBytes;
+		return Loaded;
+	}));
+
+	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryStreamingSession: Prefetching interval %d-%d (cursor %.1f)"),
+		Interval.StartTimeStep, Interval.EndTimeStep, Cursor);
+}
+
+void FTrajectoryStreamingSession::EvictInterval(int32 IntervalIdx)
+{
+	TSharedPtr<const FTrajectoryStreamedInterval> Interval;
+	if (!ResidentIntervals.RemoveAndCopyValue(IntervalIdx, Interval))
+	{
+		return;
+	}
+
+	ResidentMemoryBytes -= Interval->MemoryUsedBytes;
+
+	// The shard won't be read again until the cursor comes back - unmap it
+	DatasetHandle->ReleaseMappedShard(Interval->ShardIndex);
+
+	UE_LOG(LogTemp, Verbose, TEXT("TrajectoryStreamingSession: Evicted interval %d-%d (cursor %.1f)"),
+		Interval->StartTimeStep, Interval->EndTimeStep, Cursor);
+}
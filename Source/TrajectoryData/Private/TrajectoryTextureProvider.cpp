@@ -4,6 +4,61 @@
 #include "TrajectoryDataLoader.h"
 #include "Engine/Texture2DArray.h"
 #include "TextureResource.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace TrajectoryTexturePacking
+{
+	/** Texels filled per parallel work item when padding */
+	constexpr int32 FillChunkSize = 64 * 1024;
+
+	/** NaN in all channels, converted once and copied into every texel without trajectory data */
+	FFloat16Color MakeInvalidTexel()
+	{
+		const float InvalidValue = FTrajectoryTextureMetadata::InvalidPositionValue;
+		FFloat16Color InvalidTexel;
+		InvalidTexel.R = FFloat16(InvalidValue);
+		InvalidTexel.G = FFloat16(InvalidValue);
+		InvalidTexel.B = FFloat16(InvalidValue);
+		InvalidTexel.A = FFloat16(InvalidValue);
+		return InvalidTexel;
+	}
+
+	/** Fill texels [First, Last) with the invalid texel in parallel chunks */
+	void FillInvalid(FFloat16Color* Texels, int64 First, int64 Last)
+	{
+		const FFloat16Color InvalidTexel = MakeInvalidTexel();
+		const int32 NumChunks = static_cast<int32>(FMath::DivideAndRoundUp<int64>(FMath::Max<int64>(Last - First, 0), FillChunkSize));
+		ParallelFor(NumChunks, [Texels, First, Last, &InvalidTexel](int32 ChunkIdx)
+		{
+			const int64 ChunkStart = First + (int64)ChunkIdx * FillChunkSize;
+			const int64 ChunkEnd = FMath::Min(ChunkStart + FillChunkSize, Last);
+			for (int64 TexelIdx = ChunkStart; TexelIdx < ChunkEnd; ++TexelIdx)
+			{
+				Texels[TexelIdx] = InvalidTexel;
+			}
+		});
+	}
+
+	/**
+	 * Texels of a trajectory: it starts at OutStart and owns OutSlot texels (Slices layout: a full row,
+	 * packed atlas: exactly its samples)
+	 */
+	void GetTrajectorySlot(const FTrajectoryTextureMetadata& Metadata, TConstArrayView<int32> StartTexels, int32 TrajIdx, int32 NumSamples,
+		int64& OutStart, int32& OutSlot)
+	{
+		if (StartTexels.Num() > 0)
+		{
+			OutStart = StartTexels[TrajIdx];
+			OutSlot = NumSamples;
+		}
+		else
+		{
+			OutStart = (int64)TrajIdx * Metadata.TextureWidth;
+			OutSlot = Metadata.TextureWidth;
+		}
+	}
+}
 
 UTrajectoryTextureProvider::UTrajectoryTextureProvider()
 {
@@ -29,7 +84,7 @@ bool UTrajectoryTextureProvider::UpdateFromDataset(int32 DatasetIndex)
 
 	const FLoadedDataset& Dataset = Datasets[DatasetIndex];
 	
-	if (Dataset.Trajectories.Num() == 0)
+	if (Dataset.GetNumTrajectories() == 0)
 	{
 		UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: No trajectory data"));
 		return false;
@@ -38,9 +93,9 @@ bool UTrajectoryTextureProvider::UpdateFromDataset(int32 DatasetIndex)
 	// Find maximum samples across all trajectories
 	// This determines the actual texture width based on the dataset's time range
 	int32 MaxSamples = 0;
-	for (const FLoadedTrajectory& Traj : Dataset.Trajectories)
+	for (int32 TrajIdx = 0; TrajIdx < Dataset.GetNumTrajectories(); ++TrajIdx)
 	{
-		MaxSamples = FMath::Max(MaxSamples, Traj.Samples.Num());
+		MaxSamples = FMath::Max(MaxSamples, Dataset.GetTrajectoryView(TrajIdx).Samples.Num());
 	}
 
 	if (MaxSamples == 0)
@@ -48,15 +103,13 @@ bool UTrajectoryTextureProvider::UpdateFromDataset(int32 DatasetIndex)
 		UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: No samples in trajectories"));
 		return false;
 	}
-	
-	UE_LOG(LogTemp, Log, TEXT("TrajectoryTextureProvider: Texture width set to %d based on actual max samples"), MaxSamples);
 
 	// Calculate number of texture slices needed (1024 trajectories per slice)
 	const int32 MaxTrajPerTexture = 1024;
-	int32 NumSlices = FMath::DivideAndRoundUp(Dataset.Trajectories.Num(), MaxTrajPerTexture);
+	int32 NumSlices = FMath::DivideAndRoundUp(Dataset.GetNumTrajectories(), MaxTrajPerTexture);
 
 	// Update metadata
-	Metadata.NumTrajectories = Dataset.Trajectories.Num();
+	Metadata.NumTrajectories = Dataset.GetNumTrajectories();
 	Metadata.MaxSamplesPerTrajectory = MaxSamples;
 	Metadata.MaxTrajectoriesPerTexture = MaxTrajPerTexture;
 	Metadata.NumTextureSlices = NumSlices;
@@ -64,23 +117,67 @@ bool UTrajectoryTextureProvider::UpdateFromDataset(int32 DatasetIndex)
 	Metadata.BoundsMax = Dataset.DatasetInfo.Metadata.BoundingBoxMax;
 	Metadata.FirstTimeStep = Dataset.DatasetInfo.Metadata.FirstTimeStep;
 	Metadata.LastTimeStep = Dataset.DatasetInfo.Metadata.LastTimeStep;
+	Metadata.TimeStepStride = FMath::Max(Dataset.LoadParams.SampleRate, 1);
+	Metadata.Encoding = Encoding;
+	Metadata.TileSamples = 0;
+	Metadata.TilesPerTrajectory = 0;
+	Metadata.Layout = Layout;
+	Metadata.TextureWidth = MaxSamples;
+	Metadata.TextureHeight = MaxTrajPerTexture;
+	Metadata.SliceLayoutMemoryBytes = GetSliceLayoutBytes(Dataset.GetNumTrajectories(), MaxSamples);
+
+	TrajectoryStartTexels.Reset();
+	TrajectorySampleCounts.Reset();
+	if (Layout == ETrajectoryTextureLayout::PackedAtlas &&
+		!BuildAtlasLayout(Dataset, AtlasWidth, AtlasMaxRowsPerSlice, Metadata, TrajectoryStartTexels, TrajectorySampleCounts))
+	{
+		return false;
+	}
+
+	Metadata.TextureMemoryBytes = (int64)Metadata.TextureWidth * Metadata.TextureHeight * Metadata.NumTextureSlices * sizeof(FFloat16Color);
+
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryTextureProvider: Texture size %dx%d based on %s"), Metadata.TextureWidth, Metadata.TextureHeight,
+		Layout == ETrajectoryTextureLayout::PackedAtlas ? TEXT("packed atlas layout") : TEXT("actual max samples"));
 
 	// Build trajectory ID mapping
-	TrajectoryIds.SetNum(Dataset.Trajectories.Num());
-	for (int32 i = 0; i < Dataset.Trajectories.Num(); ++i)
+	TrajectoryIds.SetNum(Dataset.GetNumTrajectories());
+	for (int32 i = 0; i < Dataset.GetNumTrajectories(); ++i)
 	{
-		TrajectoryIds[i] = static_cast<int32>(Dataset.Trajectories[i].TrajectoryId);
+		TrajectoryIds[i] = static_cast<int32>(Dataset.GetTrajectoryView(i).TrajectoryId);
 	}
 
-	// Pack data into texture buffers (one per slice)
-	TArray<TArray<FFloat16Color>> TextureDataArray;
-	PackTrajectories(Dataset, TextureDataArray);
+	TileOrigins.Reset();
+	TileScales.Reset();
+	FirstSampleTimeSteps.Reset();
+	if (Encoding == ETrajectoryTextureEncoding::Relative)
+	{
+		Metadata.TileSamples = RelativeTileSamples > 0 ? FMath::Min(RelativeTileSamples, MaxSamples) : MaxSamples;
+		Metadata.TilesPerTrajectory = FMath::DivideAndRoundUp(MaxSamples, Metadata.TileSamples);
+		BuildTileTable(Dataset, Metadata, TileOrigins, TileScales);
+
+		// Samples lie on the trajectory's load grid (recorded by the loader for both layouts)
+		FirstSampleTimeSteps.SetNumUninitialized(Dataset.GetNumTrajectories());
+		for (int32 TrajIdx = 0; TrajIdx < Dataset.GetNumTrajectories(); ++TrajIdx)
+		{
+			FirstSampleTimeSteps[TrajIdx] = Dataset.GetTrajectoryView(TrajIdx).FirstSampleTimeStep;
+		}
+	}
 
-	// Update texture array resource
-	UpdateTextureArrayResource(TextureDataArray, MaxSamples);
+	// Pack data straight into the texture array's mip data
+	if (!UpdateTextureArrayResource(Dataset))
+	{
+		return false;
+	}
 
 	UE_LOG(LogTemp, Log, TEXT("TrajectoryTextureProvider: Created Texture2DArray with %d slices (%dx%d each) for %d trajectories"),
-		NumSlices, MaxSamples, MaxTrajPerTexture, Dataset.Trajectories.Num());
+		Metadata.NumTextureSlices, Metadata.TextureWidth, Metadata.TextureHeight, Dataset.GetNumTrajectories());
+
+	if (Layout == ETrajectoryTextureLayout::PackedAtlas && Metadata.SliceLayoutMemoryBytes > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("TrajectoryTextureProvider: Packed atlas uses %.2f MB instead of %.2f MB (%.1f%% saved)"),
+			Metadata.TextureMemoryBytes / (1024.0 * 1024.0), Metadata.SliceLayoutMemoryBytes / (1024.0 * 1024.0),
+			100.0 * (1.0 - (double)Metadata.TextureMemoryBytes / Metadata.SliceLayoutMemoryBytes));
+	}
 
 	return true;
 }
@@ -94,71 +191,268 @@ int64 UTrajectoryTextureProvider::GetTrajectoryId(int32 TrajectoryIndex) const
 	return -1;
 }
 
-void UTrajectoryTextureProvider::PackTrajectories(const FLoadedDataset& Dataset, TArray<TArray<FFloat16Color>>& OutTextureDataArray)
+int64 UTrajectoryTextureProvider::GetSliceLayoutBytes(int32 NumTrajectories, int32 MaxSamples)
 {
-	const int32 Width = Metadata.MaxSamplesPerTrajectory;
-	const int32 MaxTrajPerTexture = Metadata.MaxTrajectoriesPerTexture;
-	const int32 NumSlices = Metadata.NumTextureSlices;
+	const int32 MaxTrajPerTexture = 1024;
+	return (int64)FMath::DivideAndRoundUp(NumTrajectories, MaxTrajPerTexture) * MaxTrajPerTexture * MaxSamples * sizeof(FFloat16Color);
+}
 
-	// Initialize texture data arrays (one per slice)
-	OutTextureDataArray.SetNum(NumSlices);
-	
-	for (int32 SliceIdx = 0; SliceIdx < NumSlices; ++SliceIdx)
+bool UTrajectoryTextureProvider::BuildAtlasLayout(const FLoadedDataset& Dataset, int32 InAtlasWidth, int32 InMaxRowsPerSlice,
+	FTrajectoryTextureMetadata& InOutMetadata, TArray<int32>& OutStartTexels, TArray<int32>& OutSampleCounts)
+{
+	const int32 NumTrajectories = Dataset.GetNumTrajectories();
+	const int32 Width = FMath::Clamp(InAtlasWidth, 1, 16384);
+	const int32 MaxRowsPerSlice = FMath::Clamp(InMaxRowsPerSlice, 1, 16384);
+
+	// Exclusive scan over the sample counts gives each trajectory its first texel
+	OutStartTexels.SetNumUninitialized(NumTrajectories);
+	OutSampleCounts.SetNumUninitialized(NumTrajectories);
+	int64 TotalTexels = 0;
+	for (int32 TrajIdx = 0; TrajIdx < NumTrajectories; ++TrajIdx)
 	{
-		// Calculate height for this slice (last slice might have fewer trajectories)
-		int32 StartTraj = SliceIdx * MaxTrajPerTexture;
-		int32 EndTraj = FMath::Min(StartTraj + MaxTrajPerTexture, Dataset.Trajectories.Num());
-		int32 Height = EndTraj - StartTraj;
-		
-		// Note: For Texture2DArray, all slices must have same dimensions
-		// So we always use MaxTrajPerTexture height, padding with invalid data if needed
-		OutTextureDataArray[SliceIdx].SetNum(Width * MaxTrajPerTexture);
-		
-		// Initialize all with invalid data first
-		const float InvalidValue = FTrajectoryTextureMetadata::InvalidPositionValue;
-		for (int32 i = 0; i < OutTextureDataArray[SliceIdx].Num(); ++i)
+		OutStartTexels[TrajIdx] = static_cast<int32>(TotalTexels);
+		OutSampleCounts[TrajIdx] = Dataset.GetTrajectoryView(TrajIdx).Samples.Num();
+		TotalTexels += OutSampleCounts[TrajIdx];
+		if (TotalTexels > MAX_int32)
 		{
-			FFloat16Color& Texel = OutTextureDataArray[SliceIdx][i];
-			Texel.R = FFloat16(InvalidValue);
-			Texel.G = FFloat16(InvalidValue);
-			Texel.B = FFloat16(InvalidValue);
-			Texel.A = FFloat16(InvalidValue);
+			UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: Dataset exceeds %d texels, use the buffer provider instead"), MAX_int32);
+			OutStartTexels.Reset();
+			OutSampleCounts.Reset();
+			return false;
 		}
-		
-		// Pack actual trajectories for this slice
-		for (int32 LocalTrajIdx = 0; LocalTrajIdx < Height; ++LocalTrajIdx)
+	}
+
+	// Spread the rows evenly over the slices so only the end of the last slice is padded
+	const int64 NumRows = FMath::Max<int64>(FMath::DivideAndRoundUp<int64>(TotalTexels, Width), 1);
+	const int32 NumSlices = static_cast<int32>(FMath::DivideAndRoundUp<int64>(NumRows, MaxRowsPerSlice));
+	const int32 RowsPerSlice = static_cast<int32>(FMath::DivideAndRoundUp<int64>(NumRows, NumSlices));
+
+	InOutMetadata.TextureWidth = Width;
+	InOutMetadata.TextureHeight = RowsPerSlice;
+	InOutMetadata.NumTextureSlices = NumSlices;
+	return true;
+}
+
+void UTrajectoryTextureProvider::ReportLayoutMemory(int32 DatasetIndex, int32 InAtlasWidth)
+{
+	UTrajectoryDataLoader* Loader = UTrajectoryDataLoader::Get();
+	if (!Loader || !Loader->GetLoadedDatasets().IsValidIndex(DatasetIndex))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: Invalid dataset index %d"), DatasetIndex);
+		return;
+	}
+
+	const FLoadedDataset& Dataset = Loader->GetLoadedDatasets()[DatasetIndex];
+	int32 MaxSamples = 0;
+	int64 TotalSamples = 0;
+	for (int32 TrajIdx = 0; TrajIdx < Dataset.GetNumTrajectories(); ++TrajIdx)
+	{
+		const int32 NumSamples = Dataset.GetTrajectoryView(TrajIdx).Samples.Num();
+		MaxSamples = FMath::Max(MaxSamples, NumSamples);
+		TotalSamples += NumSamples;
+	}
+
+	FTrajectoryTextureMetadata AtlasMetadata;
+	TArray<int32> StartTexels;
+	TArray<int32> SampleCounts;
+	if (TotalSamples == 0 || !BuildAtlasLayout(Dataset, InAtlasWidth, 1024, AtlasMetadata, StartTexels, SampleCounts))
+	{
+		return;
+	}
+
+	const int64 SliceBytes = GetSliceLayoutBytes(Dataset.GetNumTrajectories(), MaxSamples);
+	const int64 AtlasBytes = (int64)AtlasMetadata.TextureWidth * AtlasMetadata.TextureHeight * AtlasMetadata.NumTextureSlices * sizeof(FFloat16Color);
+	const int64 SampleBytes = TotalSamples * sizeof(FFloat16Color);
+	const int64 TableBytes = (int64)Dataset.GetNumTrajectories() * 2 * sizeof(int32);
+
+	UE_LOG(LogTemp, Log, TEXT("TrajectoryTextureProvider: Dataset %d: %d trajectories, %lld samples (longest %d)"),
+		DatasetIndex, Dataset.GetNumTrajectories(), TotalSamples, MaxSamples);
+	UE_LOG(LogTemp, Log, TEXT("  Row per trajectory: %8.2f MB (%.1f%% padding)"),
+		SliceBytes / (1024.0 * 1024.0), 100.0 * (1.0 - (double)SampleBytes / SliceBytes));
+	UE_LOG(LogTemp, Log, TEXT("  Packed atlas:       %8.2f MB (%.1f%% padding, %dx%dx%d) + %.2f MB lookup table"),
+		AtlasBytes / (1024.0 * 1024.0), 100.0 * (1.0 - (double)SampleBytes / AtlasBytes),
+		AtlasMetadata.TextureWidth, AtlasMetadata.TextureHeight, AtlasMetadata.NumTextureSlices, TableBytes / (1024.0 * 1024.0));
+	UE_LOG(LogTemp, Log, TEXT("  Saved:              %8.2f MB (%.1f%%)"),
+		(SliceBytes - AtlasBytes - TableBytes) / (1024.0 * 1024.0), 100.0 * (1.0 - (double)(AtlasBytes + TableBytes) / SliceBytes));
+}
+
+static FAutoConsoleCommand GReportTextureLayoutCommand(
+	TEXT("TrajectoryData.ReportTextureLayout"),
+	TEXT("Compare the texel memory of the texture provider layouts. Usage: TrajectoryData.ReportTextureLayout [DatasetIndex] [AtlasWidth]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 DatasetIndex = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+		const int32 Width = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 2048;
+		UTrajectoryTextureProvider::ReportLayoutMemory(DatasetIndex, Width);
+	}));
+
+void UTrajectoryTextureProvider::PackTrajectories(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+	TConstArrayView<int32> InStartTexels, FFloat16Color* OutTexels)
+{
+	using namespace TrajectoryTexturePacking;
+
+	const int32 NumTrajectories = Dataset.GetNumTrajectories();
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumTrajectories, PackBlockSize);
+	const FFloat16Color InvalidTexel = MakeInvalidTexel();
+
+	ParallelFor(NumBlocks, [&](int32 BlockIdx)
+	{
+		const int32 BlockEnd = FMath::Min((BlockIdx + 1) * PackBlockSize, NumTrajectories);
+		for (int32 TrajIdx = BlockIdx * PackBlockSize; TrajIdx < BlockEnd; ++TrajIdx)
 		{
-			int32 GlobalTrajIdx = StartTraj + LocalTrajIdx;
-			const FLoadedTrajectory& Traj = Dataset.Trajectories[GlobalTrajIdx];
-			
-			for (int32 SampleIdx = 0; SampleIdx < Width; ++SampleIdx)
+			const FLoadedTrajectoryView Traj = Dataset.GetTrajectoryView(TrajIdx);
+			int64 StartTexel;
+			int32 SlotTexels;
+			GetTrajectorySlot(InMetadata, InStartTexels, TrajIdx, Traj.Samples.Num(), StartTexel, SlotTexels);
+
+			FFloat16Color* TrajTexels = OutTexels + StartTexel;
+			const int32 NumValid = FMath::Min(Traj.Samples.Num(), SlotTexels);
+			const FVector3f* Samples = Traj.Samples.GetData();
+
+			// Sample k lies on the load grid: time step FirstSampleTimeStep + k * TimeStepStride
+			const int32 FirstSampleTimeStep = Traj.FirstSampleTimeStep;
+			const int32 TimeStepStride = InMetadata.TimeStepStride;
+
+			// Pack into Float16 RGBA: XYZ + TimeStep, two texels per 8-wide conversion
+			// This provides ~3 decimal digit precision with range ±65504
+			int32 SampleIdx = 0;
+			for (; SampleIdx + 1 < NumValid; SampleIdx += 2)
+			{
+				const FVector3f& Pos0 = Samples[SampleIdx];
+				const FVector3f& Pos1 = Samples[SampleIdx + 1];
+				alignas(16) const float Source[8] = {
+					Pos0.X, Pos0.Y, Pos0.Z, static_cast<float>(FirstSampleTimeStep + SampleIdx * TimeStepStride),
+					Pos1.X, Pos1.Y, Pos1.Z, static_cast<float>(FirstSampleTimeStep + (SampleIdx + 1) * TimeStepStride) };
+				FPlatformMath::WideVectorStoreHalf(reinterpret_cast<uint16*>(TrajTexels + SampleIdx), Source);
+			}
+			if (SampleIdx < NumValid)
+			{
+				const FVector3f& Pos = Samples[SampleIdx];
+				alignas(16) const float Source[4] = { Pos.X, Pos.Y, Pos.Z, static_cast<float>(FirstSampleTimeStep + SampleIdx * TimeStepStride) };
+				FPlatformMath::VectorStoreHalf(reinterpret_cast<uint16*>(TrajTexels + SampleIdx), Source);
+			}
+
+			// Rest of the row (Slices layout: shorter trajectories) is invalid
+			for (int32 TexelIdx = NumValid; TexelIdx < SlotTexels; ++TexelIdx)
 			{
-				int32 TexelIndex = LocalTrajIdx * Width + SampleIdx;
-				
-				if (SampleIdx < Traj.Samples.Num())
+				TrajTexels[TexelIdx] = InvalidTexel;
+			}
+		}
+	});
+
+	// Everything after the last trajectory (padding rows / end of the atlas) is invalid
+	int64 LastStart;
+	int32 LastSlot;
+	GetTrajectorySlot(InMetadata, InStartTexels, NumTrajectories - 1, Dataset.GetTrajectoryView(NumTrajectories - 1).Samples.Num(), LastStart, LastSlot);
+	FillInvalid(OutTexels, LastStart + LastSlot, (int64)InMetadata.TextureWidth * InMetadata.TextureHeight * InMetadata.NumTextureSlices);
+}
+
+void UTrajectoryTextureProvider::BuildTileTable(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+	TArray<FVector3f>& OutTileOrigins, TArray<FVector3f>& OutTileScales)
+{
+	const int32 NumTrajectories = Dataset.GetNumTrajectories();
+	const int32 TileSamples = InMetadata.TileSamples;
+	const int32 TilesPerTrajectory = InMetadata.TilesPerTrajectory;
+
+	OutTileOrigins.SetNumUninitialized(NumTrajectories * TilesPerTrajectory);
+	OutTileScales.SetNumUninitialized(NumTrajectories * TilesPerTrajectory);
+
+	ParallelFor(NumTrajectories, [&Dataset, &OutTileOrigins, &OutTileScales, TileSamples, TilesPerTrajectory](int32 TrajIdx)
+	{
+		const FLoadedTrajectoryView Traj = Dataset.GetTrajectoryView(TrajIdx);
+		for (int32 TileIdx = 0; TileIdx < TilesPerTrajectory; ++TileIdx)
+		{
+			const int32 First = TileIdx * TileSamples;
+			const int32 Last = FMath::Min(First + TileSamples, Traj.Samples.Num());
+
+			// Bounds of the valid samples (NaN samples fail both comparisons and are skipped)
+			FVector3f Min(MAX_flt);
+			FVector3f Max(-MAX_flt);
+			for (int32 SampleIdx = First; SampleIdx < Last; ++SampleIdx)
+			{
+				const FVector3f& Pos = Traj.Samples[SampleIdx];
+				if (Pos.X == Pos.X && Pos.Y == Pos.Y && Pos.Z == Pos.Z)
 				{
-					const FVector3f& Pos = Traj.Samples[SampleIdx];
-					float TimeStep = static_cast<float>(Traj.StartTimeStep + SampleIdx);
-					
-					// Pack into Float16 RGBA: XYZ + TimeStep
-					// Float32 positions are automatically converted to Float16
-					// This provides ~3 decimal digit precision with range ±65504
-					FFloat16Color& Texel = OutTextureDataArray[SliceIdx][TexelIndex];
-					Texel.R = FFloat16(Pos.X);
-					Texel.G = FFloat16(Pos.Y);
-					Texel.B = FFloat16(Pos.Z);
-					Texel.A = FFloat16(TimeStep);
+					Min = FVector3f::Min(Min, Pos);
+					Max = FVector3f::Max(Max, Pos);
 				}
-				// else: Already initialized with invalid data above
 			}
+
+			const int32 Tile = TrajIdx * TilesPerTrajectory + TileIdx;
+			if (Min.X > Max.X)
+			{
+				// No valid samples: identity transform, texels are NaN anyway
+				OutTileOrigins[Tile] = FVector3f::ZeroVector;
+				OutTileScales[Tile] = FVector3f::OneVector;
+				continue;
+			}
+
+			// Scale is never zero so degenerate axes still decode to the origin
+			OutTileOrigins[Tile] = (Min + Max) * 0.5f;
+			OutTileScales[Tile] = FVector3f::Max((Max - Min) * 0.5f, FVector3f(UE_SMALL_NUMBER));
 		}
-	}
+	});
+}
+
+void UTrajectoryTextureProvider::PackTrajectoriesRelative(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+	TConstArrayView<int32> InStartTexels, TConstArrayView<FVector3f> InTileOrigins, TConstArrayView<FVector3f> InTileScales,
+	FFloat16Color* OutTexels)
+{
+	using namespace TrajectoryTexturePacking;
+
+	const int32 NumTrajectories = Dataset.GetNumTrajectories();
+	const int32 TileSamples = InMetadata.TileSamples;
+	const int32 TilesPerTrajectory = InMetadata.TilesPerTrajectory;
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumTrajectories, PackBlockSize);
+	const FFloat16Color InvalidTexel = MakeInvalidTexel();
+
+	ParallelFor(NumBlocks, [&](int32 BlockIdx)
+	{
+		const int32 BlockEnd = FMath::Min((BlockIdx + 1) * PackBlockSize, NumTrajectories);
+		for (int32 TrajIdx = BlockIdx * PackBlockSize; TrajIdx < BlockEnd; ++TrajIdx)
+		{
+			const FLoadedTrajectoryView Traj = Dataset.GetTrajectoryView(TrajIdx);
+			int64 StartTexel;
+			int32 SlotTexels;
+			GetTrajectorySlot(InMetadata, InStartTexels, TrajIdx, Traj.Samples.Num(), StartTexel, SlotTexels);
+
+			FFloat16Color* TrajTexels = OutTexels + StartTexel;
+			const int32 NumValid = FMath::Min(Traj.Samples.Num(), SlotTexels);
+
+			for (int32 TileIdx = 0; TileIdx * TileSamples < NumValid; ++TileIdx)
+			{
+				const int32 Tile = TrajIdx * TilesPerTrajectory + TileIdx;
+				const VectorRegister4Float Origin = VectorLoadFloat3(&InTileOrigins[Tile].X);
+				const VectorRegister4Float InvScale = VectorSetW0(VectorReciprocalAccurate(VectorLoadFloat3_W1(&InTileScales[Tile].X)));
+				const int32 TileEnd = FMath::Min((TileIdx + 1) * TileSamples, NumValid);
+
+				// (Position - Origin) / Scale with A = 0, converted four floats (one texel) at a time
+				for (int32 SampleIdx = TileIdx * TileSamples; SampleIdx < TileEnd; ++SampleIdx)
+				{
+					alignas(16) float Normalized[4];
+					VectorStoreAligned(VectorMultiply(VectorSubtract(VectorLoadFloat3(&Traj.Samples[SampleIdx].X), Origin), InvScale), Normalized);
+					FPlatformMath::VectorStoreHalf(reinterpret_cast<uint16*>(TrajTexels + SampleIdx), Normalized);
+				}
+			}
+
+			for (int32 TexelIdx = NumValid; TexelIdx < SlotTexels; ++TexelIdx)
+			{
+				TrajTexels[TexelIdx] = InvalidTexel;
+			}
+		}
+	});
+
+	int64 LastStart;
+	int32 LastSlot;
+	GetTrajectorySlot(InMetadata, InStartTexels, NumTrajectories - 1, Dataset.GetTrajectoryView(NumTrajectories - 1).Samples.Num(), LastStart, LastSlot);
+	FillInvalid(OutTexels, LastStart + LastSlot, (int64)InMetadata.TextureWidth * InMetadata.TextureHeight * InMetadata.NumTextureSlices);
 }
 
-void UTrajectoryTextureProvider::UpdateTextureArrayResource(const TArray<TArray<FFloat16Color>>& TextureDataArray, int32 Width)
+bool UTrajectoryTextureProvider::UpdateTextureArrayResource(const FLoadedDataset& Dataset)
 {
-	const int32 Height = Metadata.MaxTrajectoriesPerTexture;  // Always 1024 for Texture2DArray
-	const int32 NumSlices = TextureDataArray.Num();
+	const int32 Width = Metadata.TextureWidth;
+	const int32 Height = Metadata.TextureHeight;  // 1024 for the Slices layout
+	const int32 NumSlices = Metadata.NumTextureSlices;
 
 	// Create new texture array if needed or if dimensions changed
 	if (!PositionTextureArray || 
@@ -172,7 +466,7 @@ void UTrajectoryTextureProvider::UpdateTextureArrayResource(const TArray<TArray<
 		if (!PositionTextureArray)
 		{
 			UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: Failed to create Texture2DArray"));
-			return;
+			return false;
 		}
 		
 		// Configure texture settings
@@ -182,61 +476,36 @@ void UTrajectoryTextureProvider::UpdateTextureArrayResource(const TArray<TArray<
 		PositionTextureArray->AddressX = TA_Clamp;
 		PositionTextureArray->AddressY = TA_Clamp;
 		PositionTextureArray->AddressZ = TA_Clamp;
-		
-		// Update with source data
-		if (PositionTextureArray->GetPlatformData())
-		{
-			auto& Mip = PositionTextureArray->GetPlatformData()->Mips[0];
-			void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
-			
-			if (TextureData)
-			{
-				// Copy all slices into the bulk data
-				const int32 SliceSize = Width * Height * sizeof(FFloat16Color);
-				for (int32 SliceIdx = 0; SliceIdx < NumSlices; ++SliceIdx)
-				{
-					if (TextureDataArray.IsValidIndex(SliceIdx))
-					{
-						const FFloat16Color* SourceData = TextureDataArray[SliceIdx].GetData();
-						uint8* DestData = static_cast<uint8*>(TextureData) + (SliceIdx * SliceSize);
-						FMemory::Memcpy(DestData, SourceData, SliceSize);
-					}
-				}
-				
-				Mip.BulkData.Unlock();
-			}
-		}
-		
-		// Update the resource
-		PositionTextureArray->UpdateResource();
+	}
+
+	if (!PositionTextureArray->GetPlatformData())
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: Texture2DArray has no platform data"));
+		return false;
+	}
+
+	// Pack all slices straight into the bulk data (no intermediate per-slice copies)
+	auto& Mip = PositionTextureArray->GetPlatformData()->Mips[0];
+	const int64 ExpectedSize = (int64)Width * Height * NumSlices * sizeof(FFloat16Color);
+	void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+	if (!TextureData || Mip.BulkData.GetBulkDataSize() < ExpectedSize)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TrajectoryTextureProvider: Texture2DArray mip data is missing or too small"));
+		Mip.BulkData.Unlock();
+		return false;
+	}
+
+	if (Metadata.Encoding == ETrajectoryTextureEncoding::Relative)
+	{
+		PackTrajectoriesRelative(Dataset, Metadata, TrajectoryStartTexels, TileOrigins, TileScales, static_cast<FFloat16Color*>(TextureData));
 	}
 	else
 	{
-		// Texture exists with correct dimensions, just update the data
-		if (PositionTextureArray->GetPlatformData())
-		{
-			auto& Mip = PositionTextureArray->GetPlatformData()->Mips[0];
-			void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
-			
-			if (TextureData)
-			{
-				// Copy all slices into the bulk data
-				const int32 SliceSize = Width * Height * sizeof(FFloat16Color);
-				for (int32 SliceIdx = 0; SliceIdx < NumSlices; ++SliceIdx)
-				{
-					if (TextureDataArray.IsValidIndex(SliceIdx))
-					{
-						const FFloat16Color* SourceData = TextureDataArray[SliceIdx].GetData();
-						uint8* DestData = static_cast<uint8*>(TextureData) + (SliceIdx * SliceSize);
-						FMemory::Memcpy(DestData, SourceData, SliceSize);
-					}
-				}
-				
-				Mip.BulkData.Unlock();
-			}
-			
-			// Update the resource
-			PositionTextureArray->UpdateResource();
-		}
+		PackTrajectories(Dataset, Metadata, TrajectoryStartTexels, static_cast<FFloat16Color*>(TextureData));
 	}
+	Mip.BulkData.Unlock();
+	
+	// Update the resource
+	PositionTextureArray->UpdateResource();
+	return true;
 }
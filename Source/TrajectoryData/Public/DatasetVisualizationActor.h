@@ -8,6 +8,11 @@
 #include "TrajectoryBufferProvider.h"
 #include "DatasetVisualizationActor.generated.h"
 
+/**
+ * Delegate for budgeted Niagara population progress (Progress in [0, 1]; 1 once the visualization is ready)
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVisualizationPopulationProgress, float, Progress);
+
 /**
  * Actor for visualizing trajectory datasets in Niagara using built-in Position Array NDI
  * Provides complete GPU buffer access for rendering trajectories as ribbons
@@ -23,6 +28,7 @@
  * - Automatic metadata parameter passing
  * - Support for ribbon rendering
  * - Real-time dataset switching
+ * - Optional Trajectory Buffer NDI that reads the provider's GPU buffer without any copy (bUseTrajectoryBufferInterface)
  * - Works across all UE5+ versions
  * 
  * Usage in Blueprint:
@@ -49,6 +55,8 @@ protected:
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
+	virtual void Tick(float DeltaSeconds) override;
+
 	/**
 	 * Load trajectory dataset and bind to Niagara system
 	 * This is the main Blueprint-callable function that does everything
@@ -73,18 +81,47 @@ public:
 
 	/**
 	 * Update visualization to a different dataset
-	 * Can be called at runtime to switch datasets
+	 * Can be called at runtime to switch datasets. While a dataset is bound it keeps rendering: the new
+	 * buffers are packed and uploaded in the background and swapped in at a frame boundary once ready
+	 * (see UTrajectoryBufferProvider::UpdateFromDatasetDoubleBuffered). A later switch replaces a pending one.
+	 * After the swap the Niagara arrays are always filled by budgeted population (bBudgetedPopulation is implied),
+	 * or bound without a copy with bUseTrajectoryBufferInterface.
+	 * Without a bound dataset this loads synchronously like LoadAndBindDataset.
 	 * 
 	 * @param DatasetIndex New dataset index
-	 * @return True if successful
+	 * @return True if the dataset was bound or the switch was started
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Trajectory Visualization")
 	bool SwitchToDataset(int32 DatasetIndex);
 
+	/**
+	 * Check if a dataset switch is waiting for its buffers
+	 * 
+	 * @return True until the new dataset is swapped in
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Visualization")
+	bool IsDatasetSwitchPending() const;
+
+	/**
+	 * Check if budgeted population is still transferring data to Niagara
+	 * 
+	 * @return True until all arrays of the bound dataset are populated
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Visualization")
+	bool IsPopulating() const { return PopulationStage != EPopulationStage::Idle; }
+
+	/**
+	 * Get the progress of budgeted population
+	 * 
+	 * @return Fraction of the conversion and transfer work done (1 when not populating)
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Visualization")
+	float GetPopulationProgress() const;
+
 	/**
 	 * Check if visualization is ready
 	 * 
-	 * @return True if buffers are loaded and bound
+	 * @return True if buffers are loaded and bound and all Niagara arrays are populated
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Visualization")
 	bool IsVisualizationReady() const;
@@ -122,6 +159,22 @@ public:
 	UNiagaraComponent* GetNiagaraComponent() const { return NiagaraComponent; }
 
 protected:
+	/**
+	 * Transfer the provider's current data to Niagara (positions, trajectory info, time steps and metadata)
+	 * 
+	 * @param bForceBudgeted Populate the arrays over several frames even if bBudgetedPopulation is off
+	 * @return True if the positions were transferred or budgeted population started (the remaining transfers are non-critical)
+	 */
+	bool BindProviderDataToNiagara(bool bForceBudgeted = false);
+
+	/**
+	 * Bind the provider to the Trajectory Buffer NDI and pass metadata (bUseTrajectoryBufferInterface)
+	 * Replaces all array population: the NDI reads the provider's GPU buffer directly
+	 * 
+	 * @return True if the Trajectory Buffer user parameter was found
+	 */
+	bool BindTrajectoryBufferInterface();
+
 	/**
 	 * Populate Position Array NDI with trajectory data
 	 * This is the core C++ functionality that enables Blueprint workflows
@@ -138,9 +191,40 @@ protected:
 	 */
 	bool PopulateTrajectoryInfoArrays();
 
+	/** Convert provider positions [First, Last) into PendingPositions (parallel) */
+	void ConvertPositions(TConstArrayView<FVector3f> Positions, int32 First, int32 Last);
+
+	/** Set PendingPositions on the Position Array NDI, free them and release the provider's CPU positions */
+	void TransferPositions();
+
+	/** Convert trajectory info [First, Last) into the pending per-field arrays (parallel) */
+	void ConvertTrajectoryInfo(TConstArrayView<FTrajectoryBufferInfo> TrajectoryInfo, int32 First, int32 Last);
+
+	/** Set the pending per-field arrays on the TrajectoryInfo NDIs and free them */
+	void TransferTrajectoryInfo();
+
+	/**
+	 * Start populating the provider's current data over the next frames (bBudgetedPopulation)
+	 * Replaces a population in progress.
+	 * 
+	 * @return True if population was started
+	 */
+	bool StartBudgetedPopulation();
+
+	/**
+	 * Advance budgeted population by one frame: converts until the deadline, or performs a single transfer
+	 * 
+	 * @param Deadline FPlatformTime::Seconds() at which to stop converting
+	 */
+	void StepBudgetedPopulation(double Deadline);
+
+	/** Stop budgeted population, free its intermediate arrays and resume a simulation it paused */
+	void CancelBudgetedPopulation();
+
 	/**
 	 * Populate SampleTimeSteps array to Niagara
 	 * Transfers time step for each sample point (aligned with position data)
+	 * Only used if bTransferSampleTimeSteps is set
 	 * 
 	 * @return True if successful
 	 */
@@ -167,14 +251,56 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization")
 	FName PositionArrayParameterName = TEXT("PositionArray");
 
+	/**
+	 * Read positions through the Trajectory Buffer NDI instead of populating the Position Array and TrajectoryInfo arrays
+	 * The NDI binds the provider's GPU buffer directly, so samples are neither converted nor copied again
+	 * (GPU simulations only, single-buffer layout). Array population settings are ignored.
+	 * Datasets whose positions exceed FTrajectoryPositionBufferResource::MaxSingleBufferBytes (1 GB) are paged by the provider;
+	 * binding then fails with an error and the Position Array path has to be used instead.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization")
+	bool bUseTrajectoryBufferInterface = false;
+
+	/** Name of the Trajectory Buffer NDI parameter in Niagara (User Parameter of type Trajectory Buffer) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization", meta = (EditCondition = "bUseTrajectoryBufferInterface"))
+	FName TrajectoryBufferParameterName = TEXT("TrajectoryBuffer");
+
 	/** Enable TrajectoryInfo array transfer to Niagara (requires Int Array User Parameters) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization|TrajectoryInfo")
 	bool bTransferTrajectoryInfo = true;
 
-	/** Name prefix for TrajectoryInfo array parameters in Niagara (creates: <Prefix>StartIndex, <Prefix>SampleCount, etc.) */
+	/** Name prefix for TrajectoryInfo array parameters in Niagara (creates: <Prefix>StartIndex, <Prefix>FirstSampleTimeStep, etc.) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization|TrajectoryInfo")
 	FName TrajectoryInfoParameterPrefix = TEXT("TrajInfo");
 
+	/**
+	 * Also transfer the per-sample SampleTimeSteps array (4 bytes per sample)
+	 * Off by default: HLSL computes a sample's time step from <Prefix>FirstSampleTimeStep and the TimeStepStride parameter:
+	 * TimeStep = FirstSampleTimeStep[Traj] + (SampleIdx - StartIndex[Traj]) * TimeStepStride
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization|TrajectoryInfo")
+	bool bTransferSampleTimeSteps = false;
+
+	/**
+	 * Spread the Niagara array population over several frames instead of doing it in one call
+	 * Conversion runs in chunks within PopulationBudgetMs per frame; each array transfer gets a frame of its own.
+	 * The transfers themselves are not budgeted: the Niagara array library copies a whole array per call, so the
+	 * position transfer frame still copies every sample, and the double-precision staging array (24 bytes per sample)
+	 * is allocated in full when population starts.
+	 * The Niagara simulation is paused from the first transfer until the last, so it never runs with a mix of old and
+	 * new arrays (during a dataset switch the particles of the previous dataset stay on screen meanwhile).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization|Population")
+	bool bBudgetedPopulation = false;
+
+	/** Game thread time per frame for converting data during budgeted population (milliseconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization|Population", meta = (ClampMin = "0.5", EditCondition = "bBudgetedPopulation"))
+	float PopulationBudgetMs = 4.0f;
+
+	/** Progress of budgeted population, broadcast every frame until the visualization is ready */
+	UPROPERTY(BlueprintAssignable, Category = "Trajectory Visualization|Population")
+	FOnVisualizationPopulationProgress OnPopulationProgress;
+
 	/** Auto-activate Niagara system after loading dataset */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Visualization")
 	bool bAutoActivate = true;
@@ -201,4 +327,41 @@ protected:
 
 	/** Current dataset index */
 	int32 CurrentDatasetIndex = -1;
+
+private:
+	/** Steps of budgeted population, in order */
+	enum class EPopulationStage : uint8
+	{
+		Idle,
+		ConvertPositions,
+		TransferPositions,
+		ConvertTrajectoryInfo,
+		TransferTrajectoryInfo,
+		TransferSampleTimeSteps,
+		TransferMetadata
+	};
+
+	/** Elements converted per chunk; the budget is checked between chunks */
+	static constexpr int32 PopulationChunkSize = 256 * 1024;
+
+	EPopulationStage PopulationStage = EPopulationStage::Idle;
+
+	/** Positions and trajectories of the dataset being populated, and how many of them are converted */
+	int32 NumPopulationPositions = 0;
+	int32 NumPopulationTrajectories = 0;
+	int32 NumConvertedPositions = 0;
+	int32 NumConvertedTrajectories = 0;
+
+	/** Transfers done so far by budgeted population */
+	int32 NumPopulationTransfers = 0;
+
+	/** The Niagara component was paused by budgeted population while its arrays are replaced (unpaused when it ends) */
+	bool bPausedForPopulation = false;
+
+	/** Converted data waiting for its transfer (double precision as expected by the Niagara array library) */
+	TArray<FVector> PendingPositions;
+	TArray<int32> PendingTrajectoryIds;
+	TArray<int32> PendingStartIndices;
+	TArray<int32> PendingFirstSampleTimeSteps;
+	TArray<FVector> PendingExtents;
 };
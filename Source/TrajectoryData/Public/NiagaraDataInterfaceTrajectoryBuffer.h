@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NiagaraDataInterface.h"
+#include "NiagaraDataInterfaceTrajectoryBuffer.generated.h"
+
+class UNiagaraComponent;
+class UTrajectoryBufferProvider;
+
+/**
+ * Niagara data interface that reads trajectory samples straight from a UTrajectoryBufferProvider's GPU buffer
+ * Binds FTrajectoryPositionBufferResource::GetBufferSRV() as is, so positions are packed and uploaded once by the
+ * provider and shared with Niagara without conversion (no Float3 Array NDI copy, no double-precision staging array).
+ * Per trajectory only 16 bytes are uploaded: {StartIndex, SampleCount, FirstSampleTimeStep, TrajectoryId}.
+ *
+ * Provider: set with SetNiagaraTrajectoryBufferProvider(), otherwise the first UTrajectoryBufferProvider on the actor
+ * owning the Niagara component (e.g. ADatasetVisualizationActor). New data (UpdateFromDataset, a double-buffered swap)
+ * is picked up on the next tick.
+ *
+ * GPU simulations only. Supports the single-buffer layout; paged layouts (positions over 1 GB) and ring-buffer layouts
+ * bind no trajectories and log an error.
+ *
+ * HLSL Functions (TrajectoryBuffer is the user parameter name):
+ * - TrajectoryBuffer.GetNumTrajectories(out int NumTrajectories)
+ * - TrajectoryBuffer.GetTotalSampleCount(out int TotalSampleCount)
+ * - TrajectoryBuffer.GetTimeStepRange(out int FirstTimeStep, out int LastTimeStep, out int TimeStepStride)
+ * - TrajectoryBuffer.GetBounds(out float3 BoundsMin, out float3 BoundsMax)
+ * - TrajectoryBuffer.GetTrajectoryInfo(int Trajectory, out int StartIndex, out int SampleCount, out int FirstSampleTimeStep, out int TrajectoryId)
+ * - TrajectoryBuffer.GetSamplePosition(int Trajectory, int Sample, out float3 Position, out bool bValid)
+ * - TrajectoryBuffer.GetSampleTimeStep(int Trajectory, int Sample, out int TimeStep)
+ * - TrajectoryBuffer.GetPositionAtTimeStep(int Trajectory, float TimeStep, out float3 Position, out bool bValid)
+ *   (linear interpolation between the neighbouring samples)
+ * - TrajectoryBuffer.GetPositionByIndex(int Index, out float3 Position)
+ * bValid is false outside the trajectory's samples and for missing (NaN) samples.
+ */
+UCLASS(EditInlineNew, Category = "Trajectory Data", CollapseCategories, meta = (DisplayName = "Trajectory Buffer"))
+class TRAJECTORYDATA_API UNiagaraDataInterfaceTrajectoryBuffer : public UNiagaraDataInterface
+{
+	GENERATED_UCLASS_BODY()
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FShaderParameters, )
+		SHADER_PARAMETER(int32, NumTrajectories)
+		SHADER_PARAMETER(int32, TotalSampleCount)
+		SHADER_PARAMETER(int32, FirstTimeStep)
+		SHADER_PARAMETER(int32, LastTimeStep)
+		SHADER_PARAMETER(int32, TimeStepStride)
+		SHADER_PARAMETER(FVector3f, BoundsMin)
+		SHADER_PARAMETER(FVector3f, BoundsMax)
+		SHADER_PARAMETER_SRV(StructuredBuffer<float3>, Positions)
+		SHADER_PARAMETER_SRV(StructuredBuffer<int4>, TrajectoryInfo)
+	END_SHADER_PARAMETER_STRUCT()
+
+public:
+	/**
+	 * Bind a buffer provider to the Trajectory Buffer user parameter of a Niagara component
+	 *
+	 * @param NiagaraComponent Component whose system has the user parameter
+	 * @param OverrideName Name of the user parameter (type: Trajectory Buffer)
+	 * @param InProvider Provider whose GPU buffer is read (null: fall back to the owning actor's provider)
+	 * @return True if the parameter was found
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data", meta = (DisplayName = "Set Niagara Trajectory Buffer Provider"))
+	static bool SetNiagaraTrajectoryBufferProvider(UNiagaraComponent* NiagaraComponent, FName OverrideName, UTrajectoryBufferProvider* InProvider);
+
+	//UObject Interface
+	virtual void PostInitProperties() override;
+	//UObject Interface End
+
+	//UNiagaraDataInterface Interface
+	virtual bool CanExecuteOnTarget(ENiagaraSimTarget Target) const override { return Target == ENiagaraSimTarget::GPUComputeSim; }
+	virtual bool Equals(const UNiagaraDataInterface* Other) const override;
+
+	virtual bool InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual void DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual int32 PerInstanceDataSize() const override;
+	virtual bool PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds) override;
+	virtual bool HasPreSimulateTick() const override { return true; }
+	virtual void ProvidePerInstanceDataForRenderThread(void* DataForRenderThread, void* PerInstanceData, const FNiagaraSystemInstanceID& SystemInstance) override;
+
+#if WITH_EDITORONLY_DATA
+	virtual bool AppendCompileHash(FNiagaraCompileHashVisitor* InVisitor) const override;
+	virtual void GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, FString& OutHLSL) override;
+	virtual bool GetFunctionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo, int FunctionInstanceIndex, FString& OutHLSL) override;
+#endif
+	virtual void BuildShaderParameters(FNiagaraShaderParametersBuilder& ShaderParametersBuilder) const override;
+	virtual void SetShaderParameters(const FNiagaraDataInterfaceSetShaderParametersContext& Context) const override;
+	//UNiagaraDataInterface Interface End
+
+	/** Provider read by this interface (falls back to the owning actor's provider when unset) */
+	UPROPERTY(Transient)
+	TWeakObjectPtr<UTrajectoryBufferProvider> Provider;
+
+protected:
+#if WITH_EDITORONLY_DATA
+	virtual void GetFunctionsInternal(TArray<FNiagaraFunctionSignature>& OutFunctions) const override;
+#endif
+	virtual bool CopyToInternal(UNiagaraDataInterface* Destination) const override;
+};
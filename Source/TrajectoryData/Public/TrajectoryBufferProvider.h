@@ -7,9 +7,12 @@
 #include "RenderResource.h"
 #include "RHI.h"
 #include "RHIResources.h"
+#include "RenderCommandFence.h"
 #include "TrajectoryDataStructures.h"
 #include "TrajectoryBufferProvider.generated.h"
 
+class FTrajectoryStreamingSession;
+
 /**
  * Metadata for trajectory buffer
  */
@@ -20,7 +23,7 @@ struct TRAJECTORYDATA_API FTrajectoryBufferMetadata
 
 	/** Total number of position samples across all trajectories */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
-	int32 TotalSampleCount = 0;
+	int64 TotalSampleCount = 0;
 
 	/** Number of trajectories in the dataset */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
@@ -45,6 +48,18 @@ struct TRAJECTORYDATA_API FTrajectoryBufferMetadata
 	/** Last time step in dataset */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 LastTimeStep = 0;
+
+	/** Time steps between consecutive samples of a trajectory (the load's SampleRate) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TimeStepStride = 1;
+
+	/** Samples per GPU buffer page (0: positions are in a single buffer) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 PageSizeSamples = 0;
+
+	/** Number of GPU buffer pages (0: positions are in a single buffer) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 NumPages = 0;
 };
 
 /**
@@ -59,9 +74,9 @@ struct TRAJECTORYDATA_API FTrajectoryBufferInfo
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 TrajectoryId = 0;
 
-	/** Start index in the position buffer */
+	/** Start index in the position buffer (global sample index across all pages) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
-	int32 StartIndex = 0;
+	int64 StartIndex = 0;
 
 	/** Number of samples for this trajectory */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
@@ -78,6 +93,52 @@ struct TRAJECTORYDATA_API FTrajectoryBufferInfo
 	/** Object extent */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	FVector3f Extent = FVector3f::ZeroVector;
+
+	/** Time step of the first sample relative to StartTimeStep (the lifetime may be clipped by the loaded time range) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 FirstSampleOffset = 0;
+
+	/** Time steps between consecutive samples (the load's SampleRate) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TimeStepStride = 1;
+
+	/** Time step of a sample of this trajectory: StartTimeStep + FirstSampleOffset + SampleIndex * TimeStepStride */
+	int32 GetSampleTimeStep(int32 SampleIndex) const
+	{
+		return StartTimeStep + FirstSampleOffset + SampleIndex * TimeStepStride;
+	}
+};
+
+/**
+ * Per-trajectory entry of a ring segment (ring-buffer layout of FTrajectoryPositionBufferResource)
+ * Mirrored 1:1 into the ring entry structured buffer (12 bytes per entry)
+ */
+struct FTrajectoryRingEntry
+{
+	/** Index of the trajectory's first sample in the position buffer (-1 if it has no samples in the segment) */
+	int32 SampleOffset;
+
+	/** Time step of that sample */
+	int32 FirstSampleTimeStep;
+
+	/** Number of samples in the segment */
+	int32 SampleCount;
+};
+
+/**
+ * Page table entry of a paged position buffer (paged layout of FTrajectoryPositionBufferResource)
+ * Mirrored 1:1 into the page table structured buffer as uint4 {FirstSample low, FirstSample high, NumSamples, 0}
+ */
+struct FTrajectoryBufferPage
+{
+	/** Global index of the page's first sample */
+	int64 FirstSample;
+
+	/** Samples in the page (PageSizeSamples for all but the last page) */
+	int32 NumSamples;
+
+	/** Padding to 16 bytes */
+	int32 Reserved;
 };
 
 /**
@@ -96,6 +157,23 @@ struct TRAJECTORYDATA_API FTrajectoryBufferInfo
  * 2. Game Thread: Initialize() stores or moves data to CPUPositionData
  * 3. Render Thread: InitResource() uploads CPUPositionData to GPU buffer
  * 4. Optional: ReleaseCPUData() can be called to free CPUPositionData after GPU upload
+ *
+ * RING-BUFFER LAYOUT (time-window streaming):
+ * - InitializeRing() creates the buffer once with NumSegments fixed-size segments; it is never recreated while streaming
+ * - Each segment holds the samples of one loaded shard interval, in the interval's sample arena layout
+ * - The ring entry buffer holds one FTrajectoryRingEntry per (segment, trajectory): Entries[Segment * NumTrajectories + i]
+ * - UploadRingSegment() overwrites one segment by copying the interval from transient staging buffers into the
+ *   segment's region (positions and entries of that segment only), so advancing the window costs as much as the
+ *   newly loaded interval and the other segments are left intact
+ * - Sample j of trajectory i in a segment: Positions[Entry.SampleOffset + j], time step Entry.FirstSampleTimeStep + j * SampleRate
+ *
+ * PAGED LAYOUT (datasets beyond a single buffer):
+ * - Positions are split into pages of PageSizeSamples samples (a power of two), one structured buffer each
+ * - Global sample index N lives in page N >> log2(PageSizeSamples) at local index N & (PageSizeSamples - 1);
+ *   trajectories may straddle page boundaries
+ * - The page table (CPU: GetPageTable(), GPU: GetPageTableSRV()) holds each page's first global sample and size
+ * - All sample indices and byte sizes are 64-bit; only the samples of one page must fit a 32-bit buffer
+ * - There is no single position buffer: GetBufferSRV() returns null, bind GetPageSRV() per page instead
  */
 class FTrajectoryPositionBufferResource : public FRenderResource
 {
@@ -115,26 +193,98 @@ public:
 	 */
 	void Initialize(TArray<FVector3f>&& PositionData);
 
+	/**
+	 * Initialize with a loaded sample arena - shares the arena's positions without copying or repacking
+	 * GAME THREAD: Keeps a reference to the (immutable) arena, then queues GPU upload to render thread
+	 */
+	void Initialize(const TSharedPtr<const FTrajectorySampleArena>& SampleArena);
+
+	/**
+	 * Page size for the next Initialize() call
+	 * @param InPageSizeSamples Samples per page, rounded up to a power of two (0: single buffer, or
+	 *        DefaultPageSizeSamples if the positions exceed MaxSingleBufferBytes)
+	 */
+	void SetRequestedPageSize(int32 InPageSizeSamples) { RequestedPageSizeSamples = InPageSizeSamples; }
+
+	/** Page size used when a dataset doesn't fit a single buffer: 16M samples (192 MB) */
+	static constexpr int32 DefaultPageSizeSamples = 16 * 1024 * 1024;
+
+	/** Largest position buffer created as a single allocation (1 GB) */
+	static constexpr uint64 MaxSingleBufferBytes = 1024ull * 1024 * 1024;
+
+	/** Page and index within the page of a global sample index */
+	static void GetPageLocation(int64 SampleIndex, int32 PageSizeSamples, int32& OutPage, int32& OutLocalIndex)
+	{
+		OutPage = static_cast<int32>(SampleIndex / PageSizeSamples);
+		OutLocalIndex = static_cast<int32>(SampleIndex % PageSizeSamples);
+	}
+
 	/** 
 	 * Initialize resource
 	 * GAME THREAD: Queues initialization on render thread
+	 * Initialize() and InitializeRing() already queue their own initialization, don't call this alongside them
 	 */
 	void InitializeResource();
 
-	/** Get the structured buffer SRV */
-	FShaderResourceViewRHIRef GetBufferSRV() const { return BufferSRV; }
+	/**
+	 * Switch to the ring-buffer layout and (re)create the buffers with all segments empty (every entry has SampleOffset -1)
+	 * GAME THREAD: Queues buffer creation on render thread
+	 * @param InNumTrajectories Trajectories per segment (same trajectory indices in every interval)
+	 * @param InNumSegments Number of intervals the ring holds
+	 * @param InSamplesPerSegment Capacity of one segment in samples
+	 */
+	void InitializeRing(int32 InNumTrajectories, int32 InNumSegments, int32 InSamplesPerSegment);
+
+	/**
+	 * Overwrite one ring segment with the samples of a loaded interval (region copy, no buffer recreation)
+	 * GAME THREAD: Keeps a reference to the (immutable) arena until the render thread has copied it
+	 * @return False if the resource is not in ring layout or the arena doesn't fit the segment
+	 */
+	bool UploadRingSegment(int32 Segment, const TSharedPtr<const FTrajectorySampleArena>& IntervalArena);
+
+	/** Whether the resource uses the ring-buffer layout */
+	bool IsRingLayout() const { return bRingLayout; }
+
+	int32 GetRingNumTrajectories() const { return RingNumTrajectories; }
+	int32 GetRingNumSegments() const { return RingNumSegments; }
+	int32 GetRingSamplesPerSegment() const { return RingSamplesPerSegment; }
+
+	/** Get the ring entry structured buffer SRV (ring layout only) */
+	FShaderResourceViewRHIRef GetRingEntrySRV() const { return RingEntrySRV; }
+
+	/** Get the structured buffer SRV (paged layout: null, logs an error - use GetPageSRV() and GetPageTableSRV()) */
+	FShaderResourceViewRHIRef GetBufferSRV() const;
 
 	/** Get number of elements */
-	int32 GetNumElements() const { return NumElements; }
+	int64 GetNumElements() const { return NumElements; }
+
+	/** Whether positions are split into pages */
+	bool IsPaged() const { return PageSizeSamples > 0; }
+
+	/** Samples per page (0: single buffer) */
+	int32 GetPageSizeSamples() const { return PageSizeSamples; }
+
+	/** Page table (paged layout only; filled on the game thread by Initialize) */
+	const TArray<FTrajectoryBufferPage>& GetPageTable() const { return PageTable; }
+
+	/** Get the SRV of one page (paged layout only) */
+	FShaderResourceViewRHIRef GetPageSRV(int32 Page) const { return PageSRVs.IsValidIndex(Page) ? PageSRVs[Page] : FShaderResourceViewRHIRef(); }
+
+	/** Get the page table structured buffer SRV (paged layout only) */
+	FShaderResourceViewRHIRef GetPageTableSRV() const { return PageTableSRV; }
 
-	/** Get CPU position data */
-	const TArray<FVector3f>& GetCPUPositionData() const { return CPUPositionData; }
+	/** Get CPU position data (owned copy or shared sample arena) */
+	TConstArrayView<FVector3f> GetCPUPositionData() const
+	{
+		return SharedArena.IsValid() ? TConstArrayView<FVector3f>(SharedArena->Positions) : TConstArrayView<FVector3f>(CPUPositionData);
+	}
 
 	/** 
 	 * Release CPU position data to save memory after GPU upload is complete
 	 * Call this after the GPU buffer is initialized to reduce memory footprint
+	 * (a shared sample arena is only freed once the loaded dataset releases it as well)
 	 */
-	void ReleaseCPUData() { CPUPositionData.Empty(); }
+	void ReleaseCPUData() { CPUPositionData.Empty(); SharedArena.Reset(); }
 
 	// FRenderResource interface
 	virtual void InitResource(FRHICommandListBase& RHICmdList) override;
@@ -144,6 +294,9 @@ private:
 	/** CPU copy of position data */
 	TArray<FVector3f> CPUPositionData;
 
+	/** Sample arena shared with the loaded dataset (used instead of CPUPositionData when set) */
+	TSharedPtr<const FTrajectorySampleArena> SharedArena;
+
 	/** GPU structured buffer */
 	FBufferRHIRef StructuredBuffer;
 
@@ -151,7 +304,34 @@ private:
 	FShaderResourceViewRHIRef BufferSRV;
 
 	/** Number of elements in buffer */
-	int32 NumElements = 0;
+	int64 NumElements = 0;
+
+	/** Paged layout state (see SetRequestedPageSize) */
+	int32 RequestedPageSizeSamples = 0;
+	int32 PageSizeSamples = 0;
+	TArray<FTrajectoryBufferPage> PageTable;
+
+	/** Paged layout: one buffer per page, plus the page table */
+	TArray<FBufferRHIRef> PageBuffers;
+	TArray<FShaderResourceViewRHIRef> PageSRVs;
+	FBufferRHIRef PageTableBuffer;
+	FShaderResourceViewRHIRef PageTableSRV;
+
+	/** Choose the page size for NumElements and build the page table (game thread) */
+	void BuildPageTable();
+
+	/** Create and fill the page buffers from the CPU position data (render thread) */
+	void InitPagedResource(FRHICommandListBase& RHICmdList);
+
+	/** Ring-buffer layout state (see InitializeRing) */
+	bool bRingLayout = false;
+	int32 RingNumTrajectories = 0;
+	int32 RingNumSegments = 0;
+	int32 RingSamplesPerSegment = 0;
+
+	/** Ring layout: per-(segment, trajectory) entries */
+	FBufferRHIRef RingEntryBuffer;
+	FShaderResourceViewRHIRef RingEntrySRV;
 };
 
 /**
@@ -180,6 +360,9 @@ private:
  * - Positions stored sequentially: [Traj0_Sample0, Traj0_Sample1, ..., Traj1_Sample0, ...]
  * - Use TrajectoryInfo array to find start index and sample count for each trajectory
  * - Example: Position for Trajectory i, Sample j = PositionBuffer[TrajectoryInfo[i].StartIndex + j]
+ * - Datasets beyond MaxSingleBufferBytes (or with PageSizeSamples set) are split into pages; the same global index is
+ *   then resolved through the page table (see FTrajectoryPositionBufferResource)
+ * - Time step of Trajectory i, Sample j = TrajectoryInfo[i].GetSampleTimeStep(j) (start step + first-sample offset + j * stride)
  * 
  * Comparison to Texture Approach:
  * - Texture: ~5-10ms for 10K trajectories × 2K samples (iteration + encoding)
@@ -259,6 +442,13 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
 	bool IsBufferValid() const { return PositionBufferResource != nullptr; }
 
+	/**
+	 * Incremented whenever the GPU resource, metadata or trajectory info change
+	 * The resource is re-initialized in place, so readers that mirror it (e.g. UNiagaraDataInterfaceTrajectoryBuffer)
+	 * compare this instead of the resource pointer.
+	 */
+	uint32 GetDataGeneration() const { return DataGeneration; }
+
 	/**
 	 * Get all positions as a flat array
 	 * Returns the entire position data array for use with built-in Niagara array NDIs
@@ -273,16 +463,26 @@ public:
 	TArray<FVector3f> GetAllPositions() const;
 	
 	/**
-	 * Get all positions as const reference (C++ only - no copy)
+	 * Get all positions as const view (C++ only - no copy)
 	 * For efficient access from C++ code when you don't need to modify the array
-	 * @return Const reference to array of all position vectors
+	 * @return View of all position vectors (owned copy or the dataset's shared sample arena)
 	 */
-	const TArray<FVector3f>& GetAllPositionsRef() const;
+	TConstArrayView<FVector3f> GetAllPositionsRef() const;
+
+	/**
+	 * Get the time step of one sample
+	 * Computed from the trajectory's compact time encoding (see FTrajectoryBufferInfo::GetSampleTimeStep),
+	 * so it works without the per-sample array
+	 * @return Time step, or -1 if the trajectory index is invalid
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	int32 GetSampleTimeStep(int32 TrajectoryIndex, int32 SampleIndex) const;
 
 	/**
 	 * Get sample time steps array
 	 * Returns an array of time step values, one for each sample point
 	 * Aligned with position data (same indexing)
+	 * Only filled if bGenerateSampleTimeSteps is set; prefer GetSampleTimeStep() or the compact time encoding in TrajectoryInfo
 	 * 
 	 * For C++ code: Use GetSampleTimeStepsRef() for const reference (no copy)
 	 * For Blueprint: This function returns a copy (Blueprint requirement)
@@ -321,6 +521,69 @@ public:
 	 */
 	void UpdateFromDatasetAsync(int32 DatasetIndex, TFunction<void(bool)> OnComplete);
 
+	/**
+	 * Build the buffers of a dataset in a back buffer and swap them in at a frame boundary (C++ only)
+	 * Packing runs on a background thread and the upload on the render thread while the current buffers stay
+	 * bound and keep rendering. The first tick after the upload has completed swaps the GPU resource, metadata
+	 * and trajectory info in one step, so readers never see a half-updated provider.
+	 * A newer call (or UpdateFromDataset/UpdateFromDatasetAsync) replaces a pending one, whose OnSwapped is called with false.
+	 *
+	 * THREADING: This function must be called on the GAME THREAD and the component must be registered (the swap runs in its tick).
+	 * Do not call UnloadAll() or modify the loaded dataset while this is in progress.
+	 *
+	 * @param DatasetIndex Index into LoadedDatasets array
+	 * @param OnSwapped    Called on the game thread right after the swap with true, or with false on failure
+	 */
+	void UpdateFromDatasetDoubleBuffered(int32 DatasetIndex, TFunction<void(bool)> OnSwapped);
+
+	/** Whether a back buffer is being built or waiting for its swap */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	bool IsSwapPending() const { return bBackBufferPending; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * Mirror the resident intervals of a streaming session into a ring-buffer layout (C++ only)
+	 * Call after FTrajectoryStreamingSession::UpdateCursor(). The first call (or a call with a different session)
+	 * creates the ring; later calls only upload intervals that became resident since, each into a segment whose
+	 * interval was evicted. Upload cost is proportional to the newly loaded intervals, not the window.
+	 * Use FindRingSegment() to find the segment of a time step.
+	 *
+	 * @param Session Streaming session driven by the caller
+	 * @param NumSegments Intervals the ring holds (0: current window plus the prefetch slots of the session)
+	 * @return Number of intervals uploaded by this call
+	 */
+	int32 UpdateFromStreamingSession(const FTrajectoryStreamingSession& Session, int32 NumSegments = 0);
+
+	/**
+	 * Ring segment holding the samples of a time step
+	 * @return Segment index, or INDEX_NONE if the interval is not uploaded (or the buffer is not in ring layout)
+	 */
+	int32 FindRingSegment(int32 TimeStep) const;
+
+	/**
+	 * Time the packing of a loaded dataset with 1, 2, 4, ... workers and log the speedups
+	 * Console: TrajectoryData.BenchmarkBufferPacking [DatasetIndex] [Iterations]
+	 * @param DatasetIndex Index into LoadedDatasets array
+	 * @param Iterations Packing runs averaged per worker count
+	 */
+	static void BenchmarkPacking(int32 DatasetIndex, int32 Iterations);
+
+	/**
+	 * Also generate the per-sample SampleTimeSteps array (4 bytes per sample)
+	 * Off by default: each sample's time step follows from its trajectory's StartTimeStep, FirstSampleOffset and TimeStepStride.
+	 * Only needed by Niagara systems that still read the SampleTimeSteps array.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data")
+	bool bGenerateSampleTimeSteps = false;
+
+	/**
+	 * Samples per GPU buffer page, rounded up to a power of two
+	 * 0: one buffer, switching to 16M-sample pages automatically when the positions exceed 1 GB
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data", meta = (ClampMin = "0"))
+	int32 PageSizeSamples = 0;
+
 protected:
 	virtual void BeginDestroy() override;
 
@@ -332,7 +595,7 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<FTrajectoryBufferInfo> TrajectoryInfo;
 
-	/** Time step for each sample point (aligned with position data) */
+	/** Time step for each sample point (aligned with position data; empty unless bGenerateSampleTimeSteps is set) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<int32> SampleTimeSteps;
 
@@ -340,16 +603,72 @@ private:
 	/** GPU buffer resource for position data */
 	FTrajectoryPositionBufferResource* PositionBufferResource;
 
+	/** Interval stored in a ring segment */
+	struct FRingSegment
+	{
+		/** Time steps of the interval (EndTimeStep < StartTimeStep: segment is free) */
+		int32 StartTimeStep = 0;
+		int32 EndTimeStep = -1;
+	};
+
+	/** Ring layout: interval held by each segment */
+	TArray<FRingSegment> RingSegments;
+
+	/** Ring layout: session the ring mirrors (identity only, never dereferenced) */
+	const FTrajectoryStreamingSession* RingSession = nullptr;
+
+	/** Back buffer filled by UpdateFromDatasetDoubleBuffered (swapped with PositionBufferResource once uploaded) */
+	FTrajectoryPositionBufferResource* BackBufferResource = nullptr;
+
+	/** Passed by the render thread once the back buffer upload has executed */
+	FRenderCommandFence BackBufferFence;
+
+	/** Data that becomes current together with the back buffer */
+	FTrajectoryBufferMetadata BackMetadata;
+	TArray<FTrajectoryBufferInfo> BackTrajectoryInfo;
+	TArray<int32> BackSampleTimeSteps;
+	TFunction<void(bool)> OnBackBufferSwapped;
+
+	/** Incremented per double-buffered request so results of superseded requests are dropped */
+	uint32 BackBufferRequestId = 0;
+
+	/** Packing or upload of a back buffer is in flight */
+	bool bBackBufferPending = false;
+
+	/** See GetDataGeneration() */
+	uint32 DataGeneration = 0;
+
+	/** Swap the uploaded back buffer in and release the previous front buffer */
+	void SwapBackBuffer();
+
+	/** Drop a pending back buffer and report the failure to its requester */
+	void CancelBackBuffer();
+
+	/** Fill the dataset-level metadata (everything except TotalSampleCount) */
+	static void BuildMetadata(const FLoadedDataset& Dataset, FTrajectoryBufferMetadata& OutMetadata);
+
+	/** Release and delete a buffer resource on the render thread (after all commands already queued for it) */
+	static void ReleaseBufferResource(FTrajectoryPositionBufferResource*& Resource);
+
 	/** Pack trajectory data into flat position array and generate time steps (writes to class members) */
 	void PackTrajectories(const FLoadedDataset& Dataset, TArray<FVector3f>& OutPositionData);
 
 	/**
 	 * Thread-safe static packing helper – writes to the provided output arrays instead of class
 	 * members so it can safely run on any thread.
+	 * For datasets loaded into a sample arena OutPositionData stays empty: the arena is uploaded
+	 * as-is and only the trajectory info (and time steps, if requested) are generated.
+	 *
+	 * Runs in parallel: a blocked prefix sum over the sample counts gives each trajectory its start index,
+	 * then positions and time steps are filled in cache-sized sample chunks, each chunk by one worker.
+	 * @param bGenerateSampleTimeSteps Fill OutSampleTimeSteps (otherwise it is emptied)
+	 * @param MaxWorkers Maximum number of threads to use (<= 0: all task graph workers plus the calling thread)
 	 */
 	static void PackTrajectoriesStatic(
 		const FLoadedDataset& Dataset,
 		TArray<FVector3f>& OutPositionData,
 		TArray<int32>& OutSampleTimeSteps,
-		TArray<FTrajectoryBufferInfo>& OutTrajectoryInfo);
+		TArray<FTrajectoryBufferInfo>& OutTrajectoryInfo,
+		bool bGenerateSampleTimeSteps = false,
+		int32 MaxWorkers = 0);
 };
@@ -3,7 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "HAL/Runnable.h"
+#include "TrajectoryInterpolation.h"
+#include <atomic>
+
+class FEvent;
+class FThread;
 
 /**
  * Structure representing a single position sample at a specific time step
@@ -112,8 +116,168 @@ struct TRAJECTORYDATA_API FTrajectoryTimeRangeResult
 	}
 };
 
-// Forward declaration
+/**
+ * Read-only view over the samples of one chunk of a streaming time range query
+ * C++ Only: A chunk covers the part of the query range that falls into one shard interval. It only lists requested
+ * trajectories that live within that part. The views point into a buffer owned by the query and are only valid
+ * during the visitor call; copy what you need to keep.
+ */
+struct TRAJECTORYDATA_API FTrajectoryChunkView
+{
+	/** First time step of the chunk (inclusive) */
+	int32 StartTimeStep;
+	
+	/** Last time step of the chunk (inclusive) */
+	int32 EndTimeStep;
+	
+	/** Trajectories of this chunk (in request order) */
+	TConstArrayView<int64> TrajectoryIds;
+	
+	/** Positions indexed by [TrajectoryIndex * GetNumTimeSteps() + (TimeStep - StartTimeStep)]; NaN where a trajectory has no sample */
+	TConstArrayView<FVector3f> Positions;
+	
+	FTrajectoryChunkView()
+		: StartTimeStep(0)
+		, EndTimeStep(-1)
+	{
+	}
+	
+	/** Number of time steps per trajectory in this chunk */
+	int32 GetNumTimeSteps() const { return EndTimeStep - StartTimeStep + 1; }
+	
+	/** Samples of one trajectory of the chunk, indexed by (TimeStep - StartTimeStep) */
+	TConstArrayView<FVector3f> GetTrajectorySamples(int32 TrajectoryIndex) const
+	{
+		return Positions.Slice(TrajectoryIndex * GetNumTimeSteps(), GetNumTimeSteps());
+	}
+};
+
+/**
+ * Result structure for streaming time range queries
+ * C++ Only: Not exposed to Blueprints
+ */
+struct TRAJECTORYDATA_API FTrajectoryStreamResult
+{
+	/** Whether the query succeeded (also true if the visitor stopped it early) */
+	bool bSuccess;
+	
+	/** Error message if query failed */
+	FString ErrorMessage;
+	
+	/** Whether the visitor returned false and ended the query before all chunks were visited */
+	bool bStoppedByVisitor;
+	
+	/** Number of chunks passed to the visitor */
+	int32 NumChunks;
+	
+	/** Number of valid (non-NaN) samples passed to the visitor */
+	int64 NumSamples;
+	
+	FTrajectoryStreamResult()
+		: bSuccess(false)
+		, bStoppedByVisitor(false)
+		, NumChunks(0)
+		, NumSamples(0)
+	{
+	}
+};
+
+/**
+ * Result structure for interpolated position queries
+ * C++ Only: Not exposed to Blueprints
+ */
+struct TRAJECTORYDATA_API FTrajectoryInterpolatedResult
+{
+	/** Whether the query succeeded */
+	bool bSuccess;
+	
+	/** Error message if query failed */
+	FString ErrorMessage;
+	
+	/** Queried time in (fractional) time steps */
+	double Time;
+	
+	/** Requested trajectories (in request order, duplicates dropped) */
+	TArray<int64> TrajectoryIds;
+	
+	/** Interpolated position of the trajectory at the same index; NaN if the trajectory has no data around Time */
+	TArray<FVector3f> Positions;
+	
+	FTrajectoryInterpolatedResult()
+		: bSuccess(false)
+		, Time(0.0)
+	{
+	}
+	
+	/** Whether the trajectory at an index has a position at Time */
+	bool IsValid(int32 Index) const { return !FMath::IsNaN(Positions[Index].X); }
+};
+
+/**
+ * Scheduling priority of a query
+ * C++ Only: Queued queries are started highest priority first, in submission order within a priority
+ */
+enum class ETrajectoryQueryPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+/**
+ * Snapshot of the query scheduler state
+ * C++ Only: Not exposed to Blueprints
+ */
+struct TRAJECTORYDATA_API FTrajectoryQueryStats
+{
+	/** Queries waiting for a worker */
+	int32 QueuedQueries;
+	
+	/** Queries currently executing */
+	int32 RunningQueries;
+	
+	/** Queries finished since startup (including failed ones) */
+	int64 CompletedQueries;
+	
+	/** Queries refused because the queue was full */
+	int64 RejectedQueries;
+	
+	/** Queries that were executed as part of another query's batch (see UTrajectoryDataSettings::QueryCoalescingWindowMs) */
+	int64 CoalescedQueries;
+	
+	/** Batches executed; each batch reads every shard it needs once for all of its queries */
+	int64 Batches;
+	
+	/** Average time between submission and the start of execution, in milliseconds */
+	double AverageQueueLatencyMs;
+	
+	/** Longest time between submission and the start of execution, in milliseconds */
+	double MaxQueueLatencyMs;
+	
+	/** Average execution time, in milliseconds */
+	double AverageExecutionMs;
+	
+	FTrajectoryQueryStats()
+		: QueuedQueries(0)
+		, RunningQueries(0)
+		, CompletedQueries(0)
+		, RejectedQueries(0)
+		, CoalescedQueries(0)
+		, Batches(0)
+		, AverageQueueLatencyMs(0.0)
+		, MaxQueueLatencyMs(0.0)
+		, AverageExecutionMs(0.0)
+	{
+	}
+};
+
+// Forward declarations
 class FTrajectoryQueryTask;
+class FTrajectoryDatasetHandle;
+class UTrajectoryDataLoader;
+struct FShardInfo;
+struct FTrajectoryEntryHeaderBinary;
+struct FPositionSampleBinary;
 
 /**
  * Callback signature for single time step query completion
@@ -127,6 +291,24 @@ DECLARE_DELEGATE_OneParam(FOnTrajectoryQueryComplete, const FTrajectoryQueryResu
  */
 DECLARE_DELEGATE_OneParam(FOnTrajectoryTimeRangeComplete, const FTrajectoryTimeRangeResult&);
 
+/**
+ * Visitor signature for streaming time range queries
+ * Called on the query's worker thread once per chunk, in chronological order; return false to stop the query
+ */
+DECLARE_DELEGATE_RetVal_OneParam(bool, FOnTrajectoryChunk, const FTrajectoryChunkView&);
+
+/**
+ * Callback signature for streaming time range query completion
+ * Called on game thread after the last chunk was visited
+ */
+DECLARE_DELEGATE_OneParam(FOnTrajectoryStreamComplete, const FTrajectoryStreamResult&);
+
+/**
+ * Callback signature for interpolated position query completion
+ * Called on game thread after async query completes
+ */
+DECLARE_DELEGATE_OneParam(FOnTrajectoryInterpolatedComplete, const FTrajectoryInterpolatedResult&);
+
 /**
  * C++ API for loading trajectory data from other plugins
  * 
@@ -134,6 +316,13 @@ DECLARE_DELEGATE_OneParam(FOnTrajectoryTimeRangeComplete, const FTrajectoryTimeR
  * without requiring Blueprint integration. All queries execute on background threads
  * to avoid game thread lag.
  * 
+ * Queries are queued and executed by a bounded number of workers on the global thread pool
+ * (UTrajectoryDataSettings::MaxConcurrentQueries). A dedicated scheduler thread dispatches them, so waiting for
+ * the coalescing window or a free worker never blocks a thread pool worker. When the queue is full
+ * (UTrajectoryDataSettings::MaxQueuedQueries), new queries are rejected instead of piling up.
+ * Queries of the same dataset submitted within UTrajectoryDataSettings::QueryCoalescingWindowMs of each
+ * other are executed as one batch that reads each shard once; every query still gets its own result and callback.
+ * 
  * Usage Example - Single Time Step:
  * @code
  * FTrajectoryDataCppApi* Api = FTrajectoryDataCppApi::Get();
@@ -187,13 +376,15 @@ public:
 	 * @param TrajectoryIds Array of trajectory IDs to query
 	 * @param TimeStep Time step to query
 	 * @param OnComplete Callback invoked when query completes
-	 * @return True if query was successfully started, false otherwise
+	 * @param Priority Scheduling priority relative to other queued queries
+	 * @return True if query was queued, false if the arguments are invalid or the queue is full
 	 */
 	bool QuerySingleTimeStepAsync(
 		const FString& DatasetPath,
 		const TArray<int64>& TrajectoryIds,
 		int32 TimeStep,
-		FOnTrajectoryQueryComplete OnComplete
+		FOnTrajectoryQueryComplete OnComplete,
+		ETrajectoryQueryPriority Priority = ETrajectoryQueryPriority::Normal
 	);
 	
 	/**
@@ -206,18 +397,71 @@ public:
 	 * @param StartTimeStep Start time step (inclusive)
 	 * @param EndTimeStep End time step (inclusive)
 	 * @param OnComplete Callback invoked when query completes
-	 * @return True if query was successfully started, false otherwise
+	 * @param Priority Scheduling priority relative to other queued queries
+	 * @return True if query was queued, false if the arguments are invalid or the queue is full
 	 */
 	bool QueryTimeRangeAsync(
 		const FString& DatasetPath,
 		const TArray<int64>& TrajectoryIds,
 		int32 StartTimeStep,
 		int32 EndTimeStep,
-		FOnTrajectoryTimeRangeComplete OnComplete
+		FOnTrajectoryTimeRangeComplete OnComplete,
+		ETrajectoryQueryPriority Priority = ETrajectoryQueryPriority::Normal
 	);
 	
 	/**
-	 * Destructor - ensures all async tasks are cleaned up
+	 * Stream trajectory data for a time range through a visitor (async)
+	 * Unlike QueryTimeRangeAsync, the full result is never materialized: the visitor receives one chunk per shard
+	 * interval with float positions of the requested trajectories, so peak memory is bounded by one chunk.
+	 * The visitor runs on a background thread; the completion callback is invoked on game thread.
+	 * 
+	 * @param DatasetPath Full path to the dataset directory
+	 * @param TrajectoryIds Array of trajectory IDs to query
+	 * @param StartTimeStep Start time step (inclusive)
+	 * @param EndTimeStep End time step (inclusive)
+	 * @param OnChunk Visitor invoked for each chunk (must be thread-safe with respect to the data it touches)
+	 * @param OnComplete Callback invoked when query completes
+	 * @param Priority Scheduling priority relative to other queued queries
+	 * @return True if query was queued, false if the arguments are invalid or the queue is full
+	 */
+	bool QueryTimeRangeStreamingAsync(
+		const FString& DatasetPath,
+		const TArray<int64>& TrajectoryIds,
+		int32 StartTimeStep,
+		int32 EndTimeStep,
+		FOnTrajectoryChunk OnChunk,
+		FOnTrajectoryStreamComplete OnComplete,
+		ETrajectoryQueryPriority Priority = ETrajectoryQueryPriority::Normal
+	);
+	
+	/**
+	 * Query the positions of trajectories between time steps (async)
+	 * Reads the time steps around Time and interpolates all trajectories at once with vectorized kernels
+	 * (see FTrajectoryInterpolation for gap handling). Executes on background thread, callback invoked on game thread.
+	 * 
+	 * @param DatasetPath Full path to the dataset directory
+	 * @param TrajectoryIds Array of trajectory IDs to query
+	 * @param Time Time in time steps; the fraction selects the point between two time steps (e.g. 50.25).
+	 *             Physical times are converted by the caller with the simulation's time step duration.
+	 * @param Interpolation Interpolation between time steps
+	 * @param OnComplete Callback invoked when query completes
+	 * @param Priority Scheduling priority relative to other queued queries
+	 * @return True if query was queued, false if the arguments are invalid or the queue is full
+	 */
+	bool QueryPositionsAtTimeAsync(
+		const FString& DatasetPath,
+		const TArray<int64>& TrajectoryIds,
+		double Time,
+		ETrajectoryInterpolation Interpolation,
+		FOnTrajectoryInterpolatedComplete OnComplete,
+		ETrajectoryQueryPriority Priority = ETrajectoryQueryPriority::Normal
+	);
+	
+	/** Get queue depth, worker usage and latency statistics of the query scheduler */
+	FTrajectoryQueryStats GetStats() const;
+	
+	/**
+	 * Destructor - fails queued queries (their callbacks receive a "shutting down" error) and waits for running ones
 	 */
 	~FTrajectoryDataCppApi();
 
@@ -231,28 +475,72 @@ private:
 	/** Mutex for thread-safe singleton initialization */
 	static FCriticalSection InstanceMutex;
 	
-	/** Active query tasks */
-	TArray<TSharedPtr<FTrajectoryQueryTask>> ActiveTasks;
+	/** Queue a task and wake the scheduler */
+	bool SubmitTask(const TSharedPtr<FTrajectoryQueryTask>& Task);
+	
+	/**
+	 * Scheduler loop (SchedulerThread): once the highest priority task's coalescing window has passed and a worker slot
+	 * is free, hands its batch to a worker on the thread pool; otherwise waits on SchedulerEvent
+	 */
+	void RunScheduler();
+	
+	/** Remove the highest priority task and the queued tasks of the same dataset from the queue (TaskMutex must be held) */
+	void PopBatch(int32 MaxBatchSize, TArray<TSharedPtr<FTrajectoryQueryTask>>& OutBatch);
+	
+	/** Worker: executes one batch on the thread pool and reports each query's result */
+	void RunBatch(const TArray<TSharedPtr<FTrajectoryQueryTask>>& Batch);
+	
+	/** Heap order of PendingTasks: higher priority first, then lower sequence number */
+	static bool IsTaskOrderedBefore(const TSharedPtr<FTrajectoryQueryTask>& A, const TSharedPtr<FTrajectoryQueryTask>& B);
+	
+	/** Queued tasks (binary heap ordered by IsTaskOrderedBefore) */
+	TArray<TSharedPtr<FTrajectoryQueryTask>> PendingTasks;
+	
+	/** Number of batches currently scheduled on the thread pool */
+	int32 NumActiveWorkers;
+	
+	/** Number of tasks currently executing */
+	int32 NumRunningTasks;
+	
+	/** Sequence number assigned to the next submitted task (FIFO order within a priority) */
+	uint64 NextSequenceNumber;
 	
-	/** Critical section for thread safety */
-	FCriticalSection TaskMutex;
+	/** Set by the destructor; workers stop picking up tasks */
+	bool bShuttingDown;
 	
-	/** Clean up completed tasks */
-	void CleanupCompletedTasks();
+	/** Accumulated statistics (see FTrajectoryQueryStats) */
+	int64 NumCompletedTasks;
+	int64 NumRejectedTasks;
+	int64 NumCoalescedTasks;
+	int64 NumBatches;
+	double TotalQueueLatencySeconds;
+	double MaxQueueLatencySeconds;
+	double TotalExecutionSeconds;
+	
+	/** Protects the queue, worker counts and statistics */
+	mutable FCriticalSection TaskMutex;
+	
+	/** Dispatches queued tasks to workers (see RunScheduler) */
+	TUniquePtr<FThread> SchedulerThread;
+	
+	/** Wakes the scheduler: a task was queued, a worker finished or the API is shutting down */
+	FEvent* SchedulerEvent;
 	
 	friend class FTrajectoryQueryTask;
 };
 
 /**
- * Async task for executing trajectory queries on background thread
+ * Single query executed by a worker of FTrajectoryDataCppApi
  */
-class FTrajectoryQueryTask : public FRunnable
+class FTrajectoryQueryTask
 {
 public:
 	enum class EQueryType
 	{
 		SingleTimeStep,
-		TimeRange
+		TimeRange,
+		TimeRangeStream,
+		Interpolated
 	};
 	
 	FTrajectoryQueryTask(
@@ -262,19 +550,45 @@ public:
 		int32 InStartTimeStep,
 		int32 InEndTimeStep,
 		FOnTrajectoryQueryComplete InSingleCallback,
-		FOnTrajectoryTimeRangeComplete InRangeCallback
+		FOnTrajectoryTimeRangeComplete InRangeCallback,
+		ETrajectoryQueryPriority InPriority
 	);
 	
-	virtual ~FTrajectoryQueryTask();
+	/** Create a streaming time range query */
+	FTrajectoryQueryTask(
+		const FString& InDatasetPath,
+		const TArray<int64>& InTrajectoryIds,
+		int32 InStartTimeStep,
+		int32 InEndTimeStep,
+		FOnTrajectoryChunk InChunkVisitor,
+		FOnTrajectoryStreamComplete InStreamCallback,
+		ETrajectoryQueryPriority InPriority
+	);
 	
-	// FRunnable interface
-	virtual bool Init() override;
-	virtual uint32 Run() override;
-	virtual void Stop() override;
-	virtual void Exit() override;
+	/** Create an interpolated position query */
+	FTrajectoryQueryTask(
+		const FString& InDatasetPath,
+		const TArray<int64>& InTrajectoryIds,
+		double InTime,
+		ETrajectoryInterpolation InInterpolation,
+		FOnTrajectoryInterpolatedComplete InInterpolatedCallback,
+		ETrajectoryQueryPriority InPriority
+	);
+	
+	/**
+	 * Run queries of one dataset on the calling thread with a single pass over each shard
+	 * Every requested trajectory is resolved and decoded once per shard and handed to all tasks that asked for it.
+	 * @param Tasks Queries that all target the same dataset path
+	 */
+	static void ExecuteBatch(const TArray<TSharedPtr<FTrajectoryQueryTask>>& Tasks);
 	
-	/** Check if task has completed */
-	bool IsComplete() const { return bIsComplete; }
+	/** Request cancellation (a running query stops before its next shard) */
+	void Cancel() { bShouldStop = true; }
+	
+	/** Invoke the completion callback on the game thread (the task is kept alive until then) */
+	static void InvokeCallbackOnGameThread(const TSharedPtr<FTrajectoryQueryTask>& Task);
+	
+	ETrajectoryQueryPriority GetPriority() const { return Priority; }
 	
 private:
 	/** Type of query to execute */
@@ -298,27 +612,97 @@ private:
 	/** Callback for time range queries */
 	FOnTrajectoryTimeRangeComplete TimeRangeCallback;
 	
+	/** Visitor for streaming time range queries */
+	FOnTrajectoryChunk ChunkVisitor;
+	
+	/** Callback for streaming time range queries */
+	FOnTrajectoryStreamComplete StreamCallback;
+	
+	/** Callback for interpolated position queries */
+	FOnTrajectoryInterpolatedComplete InterpolatedCallback;
+	
+	/** Loader owning the dataset handle cache (resolved on the thread that starts the query) */
+	UTrajectoryDataLoader* Loader;
+	
 	/** Result for single time step query */
 	FTrajectoryQueryResult SingleResult;
 	
 	/** Result for time range query */
 	FTrajectoryTimeRangeResult RangeResult;
 	
-	/** Thread running this task */
-	FRunnableThread* Thread;
+	/** Result for streaming time range query */
+	FTrajectoryStreamResult StreamResult;
+	
+	/** Result for interpolated position query */
+	FTrajectoryInterpolatedResult InterpolatedResult;
+	
+	/** Scheduling priority */
+	ETrajectoryQueryPriority Priority;
+	
+	/** Submission order, assigned by FTrajectoryDataCppApi::SubmitTask */
+	uint64 SequenceNumber;
+	
+	/** Time the task was queued (FPlatformTime::Seconds) */
+	double SubmitTime;
 	
 	/** Whether task should stop */
-	bool bShouldStop;
+	std::atomic<bool> bShouldStop;
+	
+	/** Whether the result already holds an error */
+	bool bFailed;
+	
+	/** Requested trajectory ID -> index into SingleResult.Samples or RangeResult.TimeSeries (filled by Prepare) */
+	TMap<int64, int32> ResultIndexById;
+	
+	/** Single time step queries: whether the sample at the same index was found */
+	TBitArray<> SampleFound;
+	
+	/** Streaming queries: requested trajectories in request order (ResultIndexById indexes this array) */
+	TArray<int64> StreamTrajectoryIds;
+	
+	/** Streaming queries: chunk of the shard being processed */
+	int32 ChunkStartTimeStep;
+	int32 ChunkEndTimeStep;
+	TArray<int64> ChunkTrajectoryIds;
+	TArray<FVector3f> ChunkPositions;
+	
+	/** Streaming queries: StreamTrajectoryIds index -> row in the current chunk (INDEX_NONE if not in the chunk) */
+	TArray<int32> ChunkRowByResultIndex;
+	
+	/** Interpolated queries: interpolation between time steps */
+	ETrajectoryInterpolation Interpolation;
+	
+	/** Interpolated queries: time step of tap 0 (floor(Time) - 1) */
+	int32 FirstTapTimeStep;
+	
+	/** Interpolated queries: samples around the queried time, indexed like InterpolatedResult.TrajectoryIds */
+	FTrajectoryInterpolationTaps InterpolationTaps;
+	
+	/** Validate the query against the dataset and set up one result slot per requested trajectory */
+	bool Prepare(const FTrajectoryDatasetHandle& DatasetHandle);
+	
+	/** Mark the query as failed */
+	void Fail(const FString& InErrorMessage);
+	
+	/** Append the requested trajectories that have samples within both the query range and a shard interval */
+	void CollectShardTrajectories(const FTrajectoryDatasetHandle& DatasetHandle, const FShardInfo& ShardInfo,
+		TArray<int64>& OutTrajectoryIds) const;
+	
+	/**
+	 * Copy the samples of a shard entry that fall into the query range (ignored if the trajectory wasn't requested)
+	 * @param EntrySlots All TimeStepIntervalSize slots of the entry (decoded for compressed shards)
+	 */
+	void ConsumeEntry(const FShardInfo& ShardInfo, const FTrajectoryEntryHeaderBinary& EntryHeader,
+		int32 TimeStepIntervalSize, const FPositionSampleBinary* EntrySlots);
 	
-	/** Whether task has completed */
-	bool bIsComplete;
+	/** Streaming queries: set up the chunk for a shard interval */
+	void BeginShard(const FTrajectoryDatasetHandle& DatasetHandle, const FShardInfo& ShardInfo);
 	
-	/** Execute single time step query */
-	void ExecuteSingleTimeStepQuery();
+	/** Streaming queries: pass the chunk of the current shard to the visitor */
+	void EndShard();
 	
-	/** Execute time range query */
-	void ExecuteTimeRangeQuery();
+	/** Finalize the result once all shards were processed */
+	void Finish();
 	
-	/** Callback to invoke results on game thread */
-	void InvokeCallbackOnGameThread();
+	friend class FTrajectoryDataCppApi;
 };
@@ -6,46 +6,37 @@
 #include "UObject/NoExportTypes.h"
 #include "TrajectoryDataStructures.h"
 #include "TrajectoryDataTypes.h"
+#include "TrajectoryShardReader.h"
+#include "TrajectoryDatasetHandle.h"
+#include "TrajectoryStreamingSession.h"
+#include "TrajectorySpatialIndex.h"
 #include "HAL/Runnable.h"
 #include "TrajectoryDataLoader.generated.h"
 
 // Forward declarations
 class FTrajectoryLoadTask;
-class IMappedFileHandle;
-class IMappedFileRegion;
 
 /**
- * Helper structure to manage memory-mapped shard files
+ * Range of position samples to read from one shard entry (indices relative to the shard interval)
  */
-struct FMappedShardFile
+struct FShardEntryLoadRange
 {
-	TUniquePtr<IMappedFileHandle> MappedFileHandle;
-	TUniquePtr<IMappedFileRegion> MappedRegion;
-	FString ShardPath;
-};
-
-/**
- * Information about a discovered shard file
- */
-struct FShardInfo
-{
-	int32 GlobalIntervalIndex;    // From shard header
-	int32 StartTimeStep;          // Calculated: GlobalIntervalIndex * TimeStepIntervalSize + FirstTimeStep
-	int32 EndTimeStep;            // Calculated: StartTimeStep + TimeStepIntervalSize - 1
-	FString FilePath;             // Full path to shard file
-	
-	FShardInfo()
-		: GlobalIntervalIndex(-1)
-		, StartTimeStep(0)
-		, EndTimeStep(0)
+	int32 StartTimeStepInInterval;  // From entry header
+	int32 ValidSampleCount;         // From entry header
+	int32 ValidRangeStart;          // First valid index
+	int32 ValidRangeEnd;            // One past the last valid index
+	int32 LoadStart;                // First index to read (valid range clamped to the requested time range)
+	int32 LoadEnd;                  // One past the last index to read
+
+	FShardEntryLoadRange()
+		: StartTimeStepInInterval(-1)
+		, ValidSampleCount(0)
+		, ValidRangeStart(0)
+		, ValidRangeEnd(0)
+		, LoadStart(0)
+		, LoadEnd(0)
 	{
 	}
-	
-	/** Check if this shard contains data for the given time range */
-	bool ContainsTimeRange(int32 RangeStart, int32 RangeEnd) const
-	{
-		return EndTimeStep >= RangeStart && StartTimeStep <= RangeEnd;
-	}
 };
 
 /**
@@ -73,6 +64,8 @@ public:
 
 	/**
 	 * Validate load parameters before actually loading
+	 * SpatialRegion selections are only resolved if the dataset's spatial index is already open; otherwise the
+	 * estimate is an upper bound (every candidate trajectory) and the load itself resolves the region.
 	 * @param DatasetInfo Dataset information to load from
 	 * @param Params Load parameters to validate
 	 * @return Validation result with memory estimates
@@ -141,6 +134,107 @@ public:
 	 */
 	FShardFileData LoadShardFile(const FString& ShardFilePath);
 
+	/**
+	 * Get the open handle of a dataset, building it if it is not cached or its files changed on disk
+	 * C++ Only: FTrajectoryDatasetHandle is not Blueprint-exposed.
+	 * The returned handle stays valid while referenced, even if it is evicted from the cache.
+	 * @param DatasetPath Dataset directory containing dataset-meta.bin, dataset-trajmeta.bin and shard files
+	 * @return Handle with parsed metadata and shard table, or nullptr if the dataset could not be opened
+	 */
+	TSharedPtr<FTrajectoryDatasetHandle> AcquireDatasetHandle(const FString& DatasetPath);
+
+	/**
+	 * Close the cached handle of a dataset (metadata and shard mappings are released once no load uses them)
+	 * Call this after rewriting a dataset in place if its files may keep the same size and modification time.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Loading")
+	void InvalidateDatasetHandle(const FString& DatasetPath);
+
+	/**
+	 * Close all cached dataset handles
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Loading")
+	void ClearDatasetHandleCache();
+
+	/**
+	 * Get memory held by cached dataset handles (parsed metadata + mapped shard bytes)
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data|Loading")
+	int64 GetDatasetHandleCacheMemoryUsage() const;
+
+	/**
+	 * Get the spatial index of a dataset (per-interval trajectory bounding boxes)
+	 * C++ Only: FTrajectorySpatialIndex is not Blueprint-exposed; use it for box, sphere and frustum queries.
+	 * The index is read from dataset-spatial-index.bin, or built from the shards (reading all positions once)
+	 * and written there if the file is missing or older than the shards.
+	 * @return Index, or nullptr if the dataset could not be opened
+	 */
+	TSharedPtr<const FTrajectorySpatialIndex> GetSpatialIndex(const FString& DatasetPath);
+
+	/**
+	 * Find trajectories passing through a region during a time range without reading position samples
+	 * Results are candidates from per-interval bounding boxes (see FTrajectorySpatialIndex).
+	 * @param DatasetInfo Dataset to query
+	 * @param Region Box or sphere in dataset coordinates
+	 * @param StartTimeStep First time step of interest (-1 for dataset start)
+	 * @param EndTimeStep Last time step of interest (-1 for dataset end)
+	 * @param OutTrajectoryIds Sorted trajectory IDs
+	 * @return False if the dataset or its spatial index could not be opened
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Loading")
+	bool QueryTrajectoriesInRegion(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectorySpatialRegion& Region,
+		int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds);
+
+	/**
+	 * Start streaming playback of a dataset
+	 * Only the shard intervals around the playback cursor are kept in memory; drive the cursor with
+	 * UpdateStreamingCursor(). Replaces any active streaming session. Streamed data is not added to
+	 * GetLoadedDatasets() and does not count towards GetLoadedDataMemoryUsage().
+	 * @param DatasetInfo Dataset to stream
+	 * @param Params Trajectory selection, playback range and window configuration
+	 * @return True if the session was started
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Streaming")
+	bool StartStreaming(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryStreamingParams& Params);
+
+	/**
+	 * Move the streaming playback cursor (call every frame while playing or scrubbing)
+	 * @param TimeStep Current playback position
+	 * @param PlaybackSpeed Time steps per second (negative for reverse playback); faster playback prefetches further ahead
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Streaming")
+	void UpdateStreamingCursor(float TimeStep, float PlaybackSpeed);
+
+	/**
+	 * Stop streaming and release all streamed intervals
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Trajectory Data|Streaming")
+	void StopStreaming();
+
+	/**
+	 * Check if a streaming session is active
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data|Streaming")
+	bool IsStreaming() const { return StreamingSession.IsValid(); }
+
+	/**
+	 * Check whether the samples of a time step are loaded in the active streaming session
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data|Streaming")
+	bool IsStreamingTimeStepResident(int32 TimeStep) const;
+
+	/**
+	 * Get memory used by the intervals resident in the active streaming session
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data|Streaming")
+	int64 GetStreamingMemoryUsage() const;
+
+	/**
+	 * Get the active streaming session
+	 * C++ Only: FTrajectoryStreamingSession is not Blueprint-exposed. Use it to access resident interval samples.
+	 */
+	TSharedPtr<FTrajectoryStreamingSession> GetStreamingSession() const { return StreamingSession; }
+
 	/** Progress callback for async loading */
 	UPROPERTY(BlueprintAssignable, Category = "Trajectory Data|Loading")
 	FOnTrajectoryLoadProgress OnLoadProgress;
@@ -156,8 +250,8 @@ private:
 	/** Read dataset-meta.bin file */
 	bool ReadDatasetMeta(const FString& DatasetPath, FDatasetMetaBinary& OutMeta);
 
-	/** Read dataset-trajmeta.bin file */
-	bool ReadTrajectoryMeta(const FString& DatasetPath, TArray<FTrajectoryMetaBinary>& OutMetas);
+	/** Map dataset-trajmeta.bin file */
+	bool ReadTrajectoryMeta(const FString& DatasetPath, FTrajectoryMetaTable& OutMetas);
 
 	/** Read shard file header */
 	bool ReadShardHeader(const FString& ShardPath, FDataBlockHeaderBinary& OutHeader);
@@ -171,12 +265,68 @@ private:
 	/** Discover all shard files in dataset and build information table */
 	TMap<int32, FShardInfo> DiscoverShardFiles(const FString& DatasetPath, const FDatasetMetaBinary& DatasetMeta);
 
-	/** Internal implementation of synchronous loading */
-	FTrajectoryLoadResult LoadTrajectoriesInternal(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryLoadParams& Params);
+	/** Find the LOD pyramid levels (lod-<factor>/ directories) of a dataset */
+	TArray<FTrajectoryLodLevel> DiscoverLodLevels(const FString& DatasetPath, const FDatasetMetaBinary& DatasetMeta);
+
+	/** Read metadata and discover shards of a dataset into a new (uncached) handle */
+	TSharedPtr<FTrajectoryDatasetHandle> BuildDatasetHandle(const FString& DatasetPath);
+
+	/** Get a shard mapping from the handle, mapping the shard file and storing it in the handle if needed */
+	TSharedPtr<FMappedShardFile> GetOrMapShardFile(const TSharedPtr<FTrajectoryDatasetHandle>& Handle, int32 FileIndex, const FString& ShardPath,
+		int32 DecimationFactor = 1);
+
+	/** Get the spatial index stored in a handle, loading or building it on first use */
+	TSharedPtr<const FTrajectorySpatialIndex> GetOrBuildSpatialIndex(const TSharedPtr<FTrajectoryDatasetHandle>& Handle);
 
-	/** Build list of trajectory IDs to load based on selection strategy */
+	/** Compute the bounding box of every (trajectory, shard) entry of a dataset */
+	TSharedPtr<FTrajectorySpatialIndex> BuildSpatialIndex(const TSharedPtr<FTrajectoryDatasetHandle>& Handle);
+
+	/** Evict least recently used dataset handles until the cache fits the configured count and byte budget */
+	void TrimDatasetHandleCache();
+
+	/** Normalized cache key for a dataset directory */
+	static FString GetDatasetHandleKey(const FString& DatasetPath);
+
+	/**
+	 * Resolve the entry index of each requested trajectory within a mapped shard
+	 * DirectSeek: metadata seek hint -> cached shard index -> binary search -> full ID scan (cached for later loads)
+	 * FullScan: scans all entry IDs of the shard (legacy behaviour)
+	 * @param OutEntryIndices Entry index per element of TrajIds, INDEX_NONE if the trajectory has no entry in this shard
+	 */
+	void ResolveShardEntryIndices(const FTrajectoryShardReader& ShardReader, const FString& ShardPath,
+		int32 ShardStartTimeStep, int32 ShardEndTimeStep, const TArray<int64>& TrajIds,
+		const FTrajectoryMetaTable& TrajMetaTable, ETrajectoryEntryLookup EntryLookup,
+		TArray<int32>& OutEntryIndices);
+
+	/**
+	 * Read an entry header and clamp its valid sample range to the requested time range
+	 * Used by both the count and fill passes of a load, so both always agree on the number of samples.
+	 * @param DecimationFactor Time steps per slot of the shard (LOD level factor, 1 for full-resolution shards)
+	 * @param EntryPtr Entry from FTrajectoryShardReader::GetEntryPtr (null for malformed entries, which load nothing)
+	 * @param GridFirstTimeStep First time step of the trajectory's sample grid; LoadStart is moved onto the grid
+	 * @return False if the entry has no samples to load
+	 */
+	static bool GetEntryLoadRange(const uint8* EntryPtr, int32 ShardStartTimeStep, int32 TimeStepIntervalSize, int32 DecimationFactor,
+		int32 GridFirstTimeStep, const FTrajectoryLoadParams& Params, FShardEntryLoadRange& OutRange);
+
+	/** Get the cached ID -> entry index of a shard if it is still valid for the file on disk */
+	TSharedPtr<const FShardEntryIndex> FindCachedShardEntryIndex(const FString& ShardPath);
+
+	/** Get the cached ID -> entry index of a shard, scanning the shard to build it if necessary */
+	TSharedPtr<const FShardEntryIndex> GetOrBuildShardEntryIndex(const FString& ShardPath, const FTrajectoryShardReader& ShardReader);
+
+	/**
+	 * Internal implementation of synchronous loading
+	 * @param bRegisterDataset Add the result to LoadedDatasets and the loaded memory total (false for streaming intervals)
+	 * @param InDatasetHandle Open dataset to load from (acquired from the handle cache if not set)
+	 */
+	FTrajectoryLoadResult LoadTrajectoriesInternal(const FTrajectoryDatasetInfo& DatasetInfo, const FTrajectoryLoadParams& Params,
+		bool bRegisterDataset = true, const TSharedPtr<FTrajectoryDatasetHandle>& InDatasetHandle = nullptr);
+
+	/** Build list of trajectory IDs to load based on selection strategy (SpatialRegion queries the handle's spatial index) */
 	TArray<int64> BuildTrajectoryIdList(const FTrajectoryLoadParams& Params,
-		const FDatasetMetaBinary& DatasetMeta, const TArray<FTrajectoryMetaBinary>& TrajMetas);
+		const FDatasetMetaBinary& DatasetMeta, const FTrajectoryMetaTable& TrajMetas,
+		const TSharedPtr<FTrajectoryDatasetHandle>& DatasetHandle);
 
 	/** Calculate memory requirement for load parameters */
 	int64 CalculateMemoryRequirement(const FTrajectoryLoadParams& Params,
@@ -204,7 +354,34 @@ private:
 	/** Critical section for thread safety */
 	FCriticalSection LoadMutex;
 
+	/** Per-shard ID -> entry indices built by fallback scans, keyed by shard file path */
+	TMap<FString, TSharedPtr<const FShardEntryIndex>> ShardEntryIndexCache;
+
+	/** Total memory used by ShardEntryIndexCache in bytes */
+	int64 ShardEntryIndexCacheBytes;
+
+	/** Critical section for ShardEntryIndexCache (accessed from parallel shard workers) */
+	FCriticalSection ShardEntryIndexMutex;
+
+	/** Upper bound for ShardEntryIndexCache; the cache is flushed when a new index would exceed it */
+	static constexpr int64 MaxShardEntryIndexCacheBytes = 256LL * 1024 * 1024; // 256 MB
+
+	/** Open datasets keyed by normalized dataset path */
+	TMap<FString, TSharedPtr<FTrajectoryDatasetHandle>> DatasetHandleCache;
+
+	/** Monotonic counter used to order DatasetHandleCache entries by last access */
+	uint64 DatasetHandleAccessCounter;
+
+	/** Critical section for DatasetHandleCache */
+	mutable FCriticalSection DatasetHandleMutex;
+
+	/** Active streaming playback session (game thread only) */
+	TSharedPtr<FTrajectoryStreamingSession> StreamingSession;
+
 	friend class FTrajectoryLoadTask;
+	friend class FTrajectoryQueryTask;
+	friend class FTrajectoryStreamingSession;
+	friend class UTrajectoryLodPyramidCommandlet;
 };
 
 /**
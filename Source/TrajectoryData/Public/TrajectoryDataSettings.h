@@ -30,6 +30,43 @@ public:
 	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data", meta = (DisplayName = "Debug Logging"))
 	bool bDebugLogging;
 
+	/**
+	 * Maximum number of datasets kept open between loads (parsed metadata, shard table and mapped shard files)
+	 * 0 disables the dataset handle cache
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Caching", meta = (DisplayName = "Max Cached Datasets", ClampMin = "0"))
+	int32 MaxCachedDatasetHandles;
+
+	/** Memory budget in MB for open datasets (parsed metadata + mapped shard bytes); least recently used datasets are closed first */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Caching", meta = (DisplayName = "Dataset Cache Budget (MB)", ClampMin = "0"))
+	int32 DatasetHandleCacheBudgetMB;
+
+	/**
+	 * Minimum time in seconds between checks of an open dataset's files for changes on disk
+	 * Loads and queries within this time of the last check reuse the open dataset without stat calls. 0 checks on every acquire.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Caching", meta = (DisplayName = "Dataset Recheck Interval (s)", ClampMin = "0"))
+	float DatasetHandleRecheckIntervalSeconds;
+
+	/** Maximum number of FTrajectoryDataCppApi queries executing at the same time (workers on the global thread pool) */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Queries", meta = (DisplayName = "Max Concurrent Queries", ClampMin = "1"))
+	int32 MaxConcurrentQueries;
+
+	/** Maximum number of FTrajectoryDataCppApi queries waiting for a worker; further queries are rejected */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Queries", meta = (DisplayName = "Max Queued Queries", ClampMin = "1"))
+	int32 MaxQueuedQueries;
+
+	/**
+	 * Time in milliseconds the FTrajectoryDataCppApi scheduler holds a query back for more queries of the same dataset
+	 * Queries collected this way share a single pass over each shard. 0 only batches queries that are already queued.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Queries", meta = (DisplayName = "Query Coalescing Window (ms)", ClampMin = "0"))
+	float QueryCoalescingWindowMs;
+
+	/** Maximum number of FTrajectoryDataCppApi queries executed as one batch (1 disables batching) */
+	UPROPERTY(config, EditAnywhere, Category = "Trajectory Data|Queries", meta = (DisplayName = "Max Coalesced Queries", ClampMin = "1"))
+	int32 MaxCoalescedQueries;
+
 	/** Get the singleton instance of the settings */
 	static UTrajectoryDataSettings* Get();
 };
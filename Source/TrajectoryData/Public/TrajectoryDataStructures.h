@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "TrajectoryDataTypes.h"
+#include "TrajectorySampleArena.h"
 #include "TrajectoryDataStructures.generated.h"
 
 /**
@@ -14,14 +15,14 @@
 struct FDatasetMetaBinary
 {
 	char Magic[4];                      // "TDSH"
-	uint8 FormatVersion;                // = 1
+	uint8 FormatVersion;                // 1 = float32 entries, 2 = compressed entries
 	uint8 EndiannessFlag;               // 0 = little, 1 = big
-	uint8 FloatPrecision;               // 0 = float32, 1 = float64
+	uint8 FloatPrecision;               // 0 = float32, 1 = float64, 2 = uint16 quantized to bbox (format version 2)
 	uint8 Reserved;
 	int32 FirstTimeStep;
 	int32 LastTimeStep;
 	int32 TimeStepIntervalSize;
-	int32 EntrySizeBytes;
+	int32 EntrySizeBytes;               // 0 for format version 2 (variable-size entries)
 	float BBoxMin[3];
 	float BBoxMax[3];
 	uint64 TrajectoryCount;
@@ -234,6 +235,10 @@ struct TRAJECTORYDATA_API FLoadedTrajectory
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	FVector3f Extent;
 
+	/** Time step of the first sample; sample k holds time step FirstSampleTimeStep + k * SampleRate of the load */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 FirstSampleTimeStep;
+
 	/** Array of position samples - stored as FVector3f (12 bytes) for Niagara compatibility */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<FVector3f> Samples;
@@ -246,6 +251,7 @@ struct TRAJECTORYDATA_API FLoadedTrajectory
 		, StartTimeStep(0)
 		, EndTimeStep(0)
 		, Extent(FVector3f(DefaultExtentMeters, DefaultExtentMeters, DefaultExtentMeters))
+		, FirstSampleTimeStep(0)
 	{
 	}
 };
@@ -291,7 +297,89 @@ enum class ETrajectorySelectionStrategy : uint8
 	Distributed UMETA(DisplayName = "Distributed N Trajectories"),
 	
 	/** Load trajectories by explicit ID list */
-	ExplicitList UMETA(DisplayName = "Explicit Trajectory List")
+	ExplicitList UMETA(DisplayName = "Explicit Trajectory List"),
+
+	/** Load trajectories passing through a spatial region during the requested time range (uses the dataset's spatial index) */
+	SpatialRegion UMETA(DisplayName = "Spatial Region")
+};
+
+/**
+ * Enum for the shape of a spatial region
+ */
+UENUM(BlueprintType)
+enum class ETrajectoryRegionShape : uint8
+{
+	/** Axis-aligned box (BoxMin, BoxMax) */
+	Box UMETA(DisplayName = "Box"),
+
+	/** Sphere (SphereCenter, SphereRadius) */
+	Sphere UMETA(DisplayName = "Sphere")
+};
+
+/**
+ * Region of space for spatial trajectory selection (in dataset coordinates)
+ */
+USTRUCT(BlueprintType)
+struct TRAJECTORYDATA_API FTrajectorySpatialRegion
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	ETrajectoryRegionShape Shape;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	FVector BoxMin;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	FVector BoxMax;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	FVector SphereCenter;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	float SphereRadius;
+
+	FTrajectorySpatialRegion()
+		: Shape(ETrajectoryRegionShape::Box)
+		, BoxMin(FVector::ZeroVector)
+		, BoxMax(FVector::ZeroVector)
+		, SphereCenter(FVector::ZeroVector)
+		, SphereRadius(0.0f)
+	{
+	}
+};
+
+/**
+ * Enum for how trajectory entries are located inside shard files
+ */
+UENUM(BlueprintType)
+enum class ETrajectoryEntryLookup : uint8
+{
+	/**
+	 * Seek directly to entries using trajectory metadata (EntryOffsetIndex) or a cached per-shard index.
+	 * Only the pages holding requested entries are touched; shards are scanned only when the layout can't be trusted.
+	 */
+	DirectSeek UMETA(DisplayName = "Direct Seek"),
+
+	/** Scan the IDs of all entries in every relevant shard (legacy behaviour, useful for diagnosing broken metadata) */
+	FullScan UMETA(DisplayName = "Full Scan")
+};
+
+/**
+ * Enum for how loaded samples are stored in FLoadedDataset
+ */
+UENUM(BlueprintType)
+enum class ETrajectorySampleLayout : uint8
+{
+	/**
+	 * One contiguous position arena with per-trajectory columns (FLoadedDataset::SampleArena, C++ only).
+	 * Filled in place by the loader and uploaded to the GPU without repacking.
+	 * Samples are indexed by time step; missing samples within a trajectory's lifetime are NaN.
+	 */
+	SampleArena UMETA(DisplayName = "Sample Arena"),
+
+	/** One FLoadedTrajectory with its own Samples array per trajectory (required to read samples from Blueprint) */
+	PerTrajectoryArrays UMETA(DisplayName = "Per-Trajectory Arrays")
 };
 
 /**
@@ -318,7 +406,7 @@ struct TRAJECTORYDATA_API FTrajectoryLoadParams
 	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
 	ETrajectorySelectionStrategy SelectionStrategy;
 
-	/** Number of trajectories to load (when using FirstN or Distributed) */
+	/** Number of trajectories to load (when using FirstN or Distributed; with SpatialRegion, 0 loads all matches) */
 	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
 	int32 NumTrajectories;
 
@@ -326,12 +414,72 @@ struct TRAJECTORYDATA_API FTrajectoryLoadParams
 	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
 	TArray<FTrajectoryLoadSelection> TrajectorySelections;
 
+	/** Region trajectories must pass through (when using SpatialRegion) */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	FTrajectorySpatialRegion SpatialRegion;
+
+	/** How trajectory entries are located inside shard files */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	ETrajectoryEntryLookup EntryLookup;
+
+	/** How loaded samples are stored (SampleArena is C++ only and leaves Trajectories empty) */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	ETrajectorySampleLayout SampleLayout;
+
+	/** Read pre-decimated LOD shards (if the dataset has any) when SampleRate > 1 */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	bool bUseLodPyramid;
+
 	FTrajectoryLoadParams()
 		: StartTimeStep(-1)
 		, EndTimeStep(-1)
 		, SampleRate(1)
 		, SelectionStrategy(ETrajectorySelectionStrategy::FirstN)
 		, NumTrajectories(0)
+		, EntryLookup(ETrajectoryEntryLookup::DirectSeek)
+		, SampleLayout(ETrajectorySampleLayout::PerTrajectoryArrays)
+		, bUseLodPyramid(true)
+	{
+	}
+};
+
+/**
+ * Parameters for streaming playback of a dataset (see UTrajectoryDataLoader::StartStreaming)
+ * Only the shard intervals around the playback cursor are kept in memory.
+ */
+USTRUCT(BlueprintType)
+struct TRAJECTORYDATA_API FTrajectoryStreamingParams
+{
+	GENERATED_BODY()
+
+	/**
+	 * Trajectory selection, sample rate and playback range (StartTimeStep/EndTimeStep)
+	 * Intervals are always loaded into a sample arena; SampleLayout is ignored.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	FTrajectoryLoadParams LoadParams;
+
+	/** Time steps ahead of the cursor (in playback direction) that are always kept resident */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	int32 WindowTimeSteps;
+
+	/** Intervals the cursor will reach within this many seconds at the current playback speed are prefetched */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	float PrefetchLeadSeconds;
+
+	/** Number of intervals behind the cursor kept resident for short scrubs back (older ones are evicted) */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	int32 KeepBehindIntervals;
+
+	/** Maximum number of intervals loading in the background at the same time */
+	UPROPERTY(BlueprintReadWrite, Category = "Trajectory Data")
+	int32 MaxConcurrentLoads;
+
+	FTrajectoryStreamingParams()
+		: WindowTimeSteps(0)
+		, PrefetchLeadSeconds(2.0f)
+		, KeepBehindIntervals(1)
+		, MaxConcurrentLoads(2)
 	{
 	}
 };
@@ -353,10 +501,16 @@ struct TRAJECTORYDATA_API FLoadedDataset
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	FTrajectoryDatasetInfo DatasetInfo;
 
-	/** Array of loaded trajectories for this dataset */
+	/** Array of loaded trajectories for this dataset (only filled for ETrajectorySampleLayout::PerTrajectoryArrays) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<FLoadedTrajectory> Trajectories;
 
+	/**
+	 * Structure-of-arrays sample storage (only set for ETrajectorySampleLayout::SampleArena)
+	 * C++ Only: Shared and immutable, so copies of the dataset don't duplicate samples.
+	 */
+	TSharedPtr<const FTrajectorySampleArena> SampleArena;
+
 	/** Memory used by this dataset in bytes */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int64 MemoryUsedBytes;
@@ -365,6 +519,34 @@ struct TRAJECTORYDATA_API FLoadedDataset
 		: MemoryUsedBytes(0)
 	{
 	}
+
+	/** Number of loaded trajectories (either layout) */
+	int32 GetNumTrajectories() const
+	{
+		return SampleArena.IsValid() ? SampleArena->Num() : Trajectories.Num();
+	}
+
+	/**
+	 * View of a loaded trajectory (either layout)
+	 * C++ Only: The view references the dataset's samples; do not keep it beyond the dataset's lifetime.
+	 */
+	FLoadedTrajectoryView GetTrajectoryView(int32 TrajectoryIndex) const
+	{
+		if (SampleArena.IsValid())
+		{
+			return SampleArena->GetTrajectoryView(TrajectoryIndex);
+		}
+
+		const FLoadedTrajectory& Traj = Trajectories[TrajectoryIndex];
+		FLoadedTrajectoryView View;
+		View.TrajectoryId = Traj.TrajectoryId;
+		View.StartTimeStep = Traj.StartTimeStep;
+		View.EndTimeStep = Traj.EndTimeStep;
+		View.Extent = Traj.Extent;
+		View.FirstSampleTimeStep = Traj.FirstSampleTimeStep;
+		View.Samples = Traj.Samples;
+		return View;
+	}
 };
 
 /**
@@ -383,10 +565,20 @@ struct TRAJECTORYDATA_API FTrajectoryLoadResult
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	FString ErrorMessage;
 
-	/** Loaded trajectories */
+	/** Loaded trajectories (only filled for ETrajectorySampleLayout::PerTrajectoryArrays) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<FLoadedTrajectory> Trajectories;
 
+	/**
+	 * Loaded samples (only set for ETrajectorySampleLayout::SampleArena)
+	 * C++ Only: Shared with the loaded dataset, no copy is made.
+	 */
+	TSharedPtr<const FTrajectorySampleArena> SampleArena;
+
+	/** Number of loaded trajectories (either layout) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 NumTrajectoriesLoaded;
+
 	/** Actual time step range loaded */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 LoadedStartTimeStep;
@@ -401,6 +593,7 @@ struct TRAJECTORYDATA_API FTrajectoryLoadResult
 	FTrajectoryLoadResult()
 		: bSuccess(false)
 		, ErrorMessage(TEXT(""))
+		, NumTrajectoriesLoaded(0)
 		, LoadedStartTimeStep(0)
 		, LoadedEndTimeStep(0)
 		, MemoryUsedBytes(0)
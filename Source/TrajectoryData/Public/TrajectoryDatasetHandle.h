@@ -0,0 +1,208 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+#include "TrajectoryDataStructures.h"
+#include "TrajectoryMetaTable.h"
+#include <atomic>
+
+class FTrajectorySpatialIndex;
+
+/**
+ * Helper structure to manage memory-mapped shard files
+ */
+struct FMappedShardFile
+{
+	TUniquePtr<IMappedFileHandle> MappedFileHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	FString ShardPath;
+};
+
+/**
+ * Information about a discovered shard file
+ */
+struct FShardInfo
+{
+	int32 GlobalIntervalIndex;    // From shard header
+	int32 StartTimeStep;          // Calculated: GlobalIntervalIndex * TimeStepIntervalSize + FirstTimeStep
+	int32 EndTimeStep;            // Calculated: StartTimeStep + TimeStepIntervalSize - 1
+	FString FilePath;             // Full path to shard file
+
+	FShardInfo()
+		: GlobalIntervalIndex(-1)
+		, StartTimeStep(0)
+		, EndTimeStep(0)
+	{
+	}
+
+	/** Check if this shard contains data for the given time range */
+	bool ContainsTimeRange(int32 RangeStart, int32 RangeEnd) const
+	{
+		return EndTimeStep >= RangeStart && StartTimeStep <= RangeEnd;
+	}
+};
+
+/**
+ * Pre-decimated copy of a dataset's shards (one level of the LOD pyramid)
+ * Built by UTrajectoryLodPyramidCommandlet into <dataset>/lod-<DecimationFactor>/. LOD shards cover the same
+ * time intervals as the full-resolution shards with the same file index, but slot k of an entry holds time step
+ * shard_start + k * DecimationFactor. Entries are written in the same order, so entry_offset_index stays valid.
+ */
+struct FTrajectoryLodLevel
+{
+	/** Time steps between two slots of a LOD shard */
+	int32 DecimationFactor;
+
+	/** Slots per LOD shard entry */
+	int32 TimeStepIntervalSize;
+
+	/** Entry size of the LOD shards (0 for compressed shards) */
+	int32 EntrySizeBytes;
+
+	/** Directory holding the LOD shards */
+	FString DirectoryPath;
+
+	/** Shard file index -> LOD shard path */
+	TMap<int32, FString> ShardPaths;
+
+	FTrajectoryLodLevel()
+		: DecimationFactor(1)
+		, TimeStepIntervalSize(0)
+		, EntrySizeBytes(0)
+	{
+	}
+};
+
+/**
+ * Size and modification time of a file, used to detect files rewritten on disk
+ */
+struct FTrajectoryFileStamp
+{
+	int64 FileSize;
+	FDateTime ModificationTime;
+
+	FTrajectoryFileStamp()
+		: FileSize(-1)
+		, ModificationTime(FDateTime::MinValue())
+	{
+	}
+
+	/** Read the current stamp of a file (FileSize is -1 if the file does not exist) */
+	static FTrajectoryFileStamp Capture(const FString& FilePath);
+
+	bool operator==(const FTrajectoryFileStamp& Other) const
+	{
+		return FileSize == Other.FileSize && ModificationTime == Other.ModificationTime;
+	}
+
+	bool operator!=(const FTrajectoryFileStamp& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+/**
+ * Open dataset kept alive between loads
+ * C++ Only: Holds the parsed dataset/trajectory metadata, the shard table and the memory-mapped
+ * shard files of one dataset so repeated loads (e.g. scrubbing time ranges) skip the cold-start cost.
+ *
+ * Handles are created and cached by UTrajectoryDataLoader. Metadata members are filled once when the
+ * handle is built and must not be modified afterwards; mapped shards are added lazily and are thread-safe.
+ * Holding a TSharedPtr to a handle (or to one of its mapped shards) keeps the data valid even if the
+ * loader evicts the handle from its cache.
+ */
+class TRAJECTORYDATA_API FTrajectoryDatasetHandle
+{
+public:
+	explicit FTrajectoryDatasetHandle(const FString& InDatasetPath);
+
+	/** Dataset directory this handle was opened for */
+	const FString& GetDatasetPath() const { return DatasetPath; }
+
+	/**
+	 * Check that no file captured while building the handle was changed or removed since
+	 * (stat calls only, no file content is read). A rewritten dataset always changes its metadata files.
+	 * @param RecheckIntervalSeconds Skip the stat calls if the last successful check is more recent than this (0: always check)
+	 */
+	bool IsUpToDate(double RecheckIntervalSeconds = 0.0) const;
+
+	/**
+	 * Get the coarsest LOD level that can serve a sample rate (its decimation factor divides the rate)
+	 * @return LOD level, or nullptr if loads with this rate have to read full-resolution shards
+	 */
+	const FTrajectoryLodLevel* FindLodLevel(int32 SampleRate) const;
+
+	/**
+	 * Get a previously mapped shard file, or nullptr if it has not been mapped through this handle
+	 * @param DecimationFactor 1 for the full-resolution shard, otherwise the LOD level's factor
+	 */
+	TSharedPtr<FMappedShardFile> FindMappedShard(int32 FileIndex, int32 DecimationFactor = 1) const;
+
+	/**
+	 * Keep a mapped shard file alive in this handle
+	 * @return The mapping stored in the handle (an existing one wins if another load mapped the shard concurrently)
+	 */
+	TSharedPtr<FMappedShardFile> AddMappedShard(int32 FileIndex, const TSharedPtr<FMappedShardFile>& MappedShard, int32 DecimationFactor = 1);
+
+	/** Drop the mappings of a shard file and its LOD shards (loads still holding a mapping keep it alive) */
+	void ReleaseMappedShard(int32 FileIndex);
+
+	/** Drop all shard mappings held by this handle (loads still holding a mapping keep it alive) */
+	void ReleaseMappedShards();
+
+	/** Number of bytes of shard files currently mapped through this handle */
+	int64 GetMappedBytes() const;
+
+	/** Approximate memory held by this handle (parsed metadata + mapped shard bytes) */
+	int64 GetAllocatedSize() const;
+
+	/** Parsed dataset-meta.bin */
+	FDatasetMetaBinary DatasetMeta;
+
+	/** Memory-mapped dataset-trajmeta.bin (sorted by trajectory ID, looked up by binary search) */
+	FTrajectoryMetaTable TrajMetas;
+
+	/** Shard file index (from filename) -> shard information */
+	TMap<int32, FShardInfo> ShardInfoTable;
+
+	/** LOD pyramid levels found next to the shards, sorted by ascending decimation factor */
+	TArray<FTrajectoryLodLevel> LodLevels;
+
+	/** Stamps of all files the handle was built from (metadata files and shard files), keyed by full path */
+	TMap<FString, FTrajectoryFileStamp> FileStamps;
+
+	/** Spatial index, loaded or built on first use by UTrajectoryDataLoader::GetSpatialIndex (guarded by SpatialIndexMutex) */
+	TSharedPtr<const FTrajectorySpatialIndex> SpatialIndex;
+
+	/** Serializes loading/building the spatial index */
+	mutable FCriticalSection SpatialIndexMutex;
+
+	/** Memory held by SpatialIndex, published once it is set (readable without SpatialIndexMutex, which a build holds for seconds) */
+	std::atomic<int64> SpatialIndexBytes;
+
+	/** Access counter value of the last time the handle was acquired (used for LRU eviction) */
+	uint64 LastAccess;
+
+private:
+	FString DatasetPath;
+
+	/** Key of a mapped shard: file index in the low 32 bits, decimation factor in the high 32 bits */
+	static int64 GetMappedShardKey(int32 FileIndex, int32 DecimationFactor)
+	{
+		return ((int64)DecimationFactor << 32) | (uint32)FileIndex;
+	}
+
+	/** Shard key -> mapping, filled lazily by loads */
+	TMap<int64, TSharedPtr<FMappedShardFile>> MappedShards;
+
+	/** Total size of the regions in MappedShards */
+	int64 MappedBytes;
+
+	/** Protects MappedShards and MappedBytes (shards are mapped from parallel workers) */
+	mutable FCriticalSection MappedShardMutex;
+
+	/** FPlatformTime::Seconds() of the last successful IsUpToDate check */
+	mutable std::atomic<double> LastValidatedTime;
+};
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Interpolation between the integer time steps of a trajectory
+ * C++ Only: Not exposed to Blueprints
+ */
+enum class ETrajectoryInterpolation : uint8
+{
+	/** Straight line between the two neighbouring time steps */
+	Linear,
+
+	/** Uniform Catmull-Rom spline through the four surrounding time steps (passes through every sample) */
+	CatmullRom
+};
+
+/**
+ * Positions of many trajectories at the four time steps around a fractional time, in structure-of-arrays layout
+ * C++ Only: Tap k holds time step floor(t) - 1 + k, so taps 1 and 2 enclose t. Missing samples are NaN.
+ * Arrays are padded to a multiple of 4 trajectories so kernels can process whole vector registers.
+ */
+struct TRAJECTORYDATA_API FTrajectoryInterpolationTaps
+{
+	static constexpr int32 NumTaps = 4;
+
+	/** Tap k, axis a (0 = X, 1 = Y, 2 = Z) is stored in Coords[k * 3 + a] */
+	TArray<float> Coords[NumTaps * 3];
+
+	/** Number of trajectories (without padding) */
+	int32 Num;
+
+	FTrajectoryInterpolationTaps()
+		: Num(0)
+	{
+	}
+
+	/** Allocate taps for a number of trajectories, all samples missing */
+	void Init(int32 InNum);
+
+	/** Set one tap of one trajectory */
+	void Set(int32 Index, int32 Tap, float X, float Y, float Z)
+	{
+		Coords[Tap * 3 + 0][Index] = X;
+		Coords[Tap * 3 + 1][Index] = Y;
+		Coords[Tap * 3 + 2][Index] = Z;
+	}
+
+	/** Number of elements per array including padding */
+	int32 GetPaddedNum() const { return Coords[0].Num(); }
+};
+
+/**
+ * Vectorized interpolation kernels over FTrajectoryInterpolationTaps
+ * C++ Only: Four trajectories per SIMD iteration.
+ *
+ * Gaps: a result is NaN if the time steps enclosing t (taps 1 and 2) are not both present, unless t is exactly
+ * on tap 1. Catmull-Rom replaces a missing outer tap (gap, lifetime start/end or dataset border) by reflecting
+ * the inner taps (p0 = 2 p1 - p2, p3 = 2 p2 - p1), which keeps the curve defined next to gaps.
+ */
+class TRAJECTORYDATA_API FTrajectoryInterpolation
+{
+public:
+	/**
+	 * Interpolate all trajectories of a tap set
+	 * @param Alpha Fraction of the way from tap 1 to tap 2, in [0, 1)
+	 * @param OutPositions Receives Taps.Num positions (NaN where no position can be interpolated)
+	 */
+	static void Interpolate(const FTrajectoryInterpolationTaps& Taps, float Alpha, ETrajectoryInterpolation Mode,
+		TArray<FVector3f>& OutPositions);
+};
@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TrajectoryLodPyramidCommandlet.generated.h"
+
+/**
+ * Builds the LOD pyramid of a dataset: pre-decimated copies of its shards for coarse sample rates
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=TrajectoryLodPyramid -Dataset=<dataset directory> [-Factors=2,4,8,16]
+ *
+ * Each factor F is written to <dataset>/lod-F/ as dataset-meta.bin (time_step_interval_size divided by F) and one
+ * shard per full-resolution shard with the same file name, interval index, format version and entry order.
+ * Slot k of a LOD entry holds slot k * F of the full-resolution entry. Factors that don't divide the dataset's
+ * time_step_interval_size are skipped. Loads with a SampleRate divisible by F then read the LOD shards for every
+ * trajectory whose first loaded sample lies on first_time_step + k * F; other trajectories read the full-resolution shards.
+ */
+UCLASS()
+class TRAJECTORYDATA_API UTrajectoryLodPyramidCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTrajectoryLodPyramidCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+
+	/**
+	 * Build one LOD level of a dataset (overwrites an existing level)
+	 * @param DatasetPath Dataset directory containing dataset-meta.bin and the full-resolution shards
+	 * @param DecimationFactor Time steps between two LOD slots (must divide time_step_interval_size)
+	 * @return True if all shards were written
+	 */
+	static bool BuildLodLevel(const FString& DatasetPath, int32 DecimationFactor);
+};
@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+#include "TrajectoryDataStructures.h"
+#include <atomic>
+
+/**
+ * Read-only view over the records of dataset-trajmeta.bin
+ * C++ Only: The file stays memory-mapped instead of being copied and indexed by a hash map, so opening a dataset
+ * with millions of trajectories costs one mapping and only the pages of looked-up records are read.
+ * Lookups by trajectory ID use binary search on the records, which the specification requires to be sorted
+ * ascending by trajectory_id. The order is not verified up front; a lookup that meets out-of-order records on its
+ * search path switches the table to linear lookups (with a warning). A violation no probe happens to meet goes unnoticed.
+ */
+class TRAJECTORYDATA_API FTrajectoryMetaTable
+{
+public:
+	FTrajectoryMetaTable();
+
+	FTrajectoryMetaTable(const FTrajectoryMetaTable&) = delete;
+	FTrajectoryMetaTable& operator=(const FTrajectoryMetaTable&) = delete;
+
+	/**
+	 * Map a dataset-trajmeta.bin file (replaces any previously opened file)
+	 * @return False if the file is missing, empty or can't be mapped
+	 */
+	bool Open(const FString& FilePath);
+
+	/** Number of trajectory records */
+	int32 Num() const { return NumRecords; }
+
+	/** All records in file order (ascending by trajectory ID for files following the specification) */
+	TConstArrayView<FTrajectoryMetaBinary> GetView() const { return TConstArrayView<FTrajectoryMetaBinary>(Records, NumRecords); }
+
+	const FTrajectoryMetaBinary& operator[](int32 Index) const
+	{
+		check(Index >= 0 && Index < NumRecords);
+		return Records[Index];
+	}
+
+	/** Find the record of a trajectory by binary search (linear scan for unsorted files), or nullptr if the dataset has no such trajectory */
+	const FTrajectoryMetaBinary* Find(int64 TrajectoryId) const;
+
+	/** Find the record of a trajectory that is known to exist */
+	const FTrajectoryMetaBinary& FindChecked(int64 TrajectoryId) const
+	{
+		const FTrajectoryMetaBinary* Record = Find(TrajectoryId);
+		check(Record);
+		return *Record;
+	}
+
+	bool Contains(int64 TrajectoryId) const { return Find(TrajectoryId) != nullptr; }
+
+	/** Bytes mapped for the records */
+	int64 GetAllocatedSize() const;
+
+	const FTrajectoryMetaBinary* begin() const { return Records; }
+	const FTrajectoryMetaBinary* end() const { return Records + NumRecords; }
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFileHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Points into MappedRegion */
+	const FTrajectoryMetaBinary* Records;
+
+	int32 NumRecords;
+
+	/** Set by the first lookup that finds the records out of order */
+	mutable std::atomic<bool> bUnsorted;
+
+	/** Opened file, for diagnostics */
+	FString SourcePath;
+};
@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ContainerAllocationPolicies.h"
+
+/** Position storage of the sample arena (cache-line aligned for bulk copies and vectorized access) */
+using FTrajectoryPositionArena = TArray<FVector3f, TAlignedHeapAllocator<64>>;
+
+/**
+ * Read-only view of a single loaded trajectory
+ * C++ Only: Works for both sample layouts (per-trajectory arrays and sample arena).
+ * The view does not own the samples; keep the dataset (or its arena) alive while using it.
+ */
+struct FLoadedTrajectoryView
+{
+	/** Unique trajectory ID */
+	int64 TrajectoryId;
+
+	/** Start time step (from metadata) */
+	int32 StartTimeStep;
+
+	/** End time step (from metadata) */
+	int32 EndTimeStep;
+
+	/** Object half-extent in meters */
+	FVector3f Extent;
+
+	/** Time step of the first sample (sample k: FirstSampleTimeStep + k * SampleRate) */
+	int32 FirstSampleTimeStep;
+
+	/** Position samples (NaN marks missing samples) */
+	TConstArrayView<FVector3f> Samples;
+
+	FLoadedTrajectoryView()
+		: TrajectoryId(0)
+		, StartTimeStep(0)
+		, EndTimeStep(0)
+		, Extent(FVector3f::ZeroVector)
+		, FirstSampleTimeStep(0)
+	{
+	}
+};
+
+/**
+ * Structure-of-arrays storage for all samples of a loaded dataset
+ * C++ Only: Replaces one heap-allocated sample array per trajectory with a single position arena
+ * plus per-trajectory columns. Filled in place by the loader's shard workers.
+ *
+ * Layout:
+ * - Trajectory i owns Positions[SampleOffsets[i] .. SampleOffsets[i] + SampleCounts[i])
+ * - Sample j of trajectory i belongs to time step FirstSampleTimeSteps[i] + j * SampleRate
+ * - Time steps inside the trajectory's lifetime without data (gaps, missing shards) are NaN
+ *
+ * The arena is immutable once loading completes and is shared via TSharedPtr<const FTrajectorySampleArena>,
+ * so GPU providers can upload Positions directly without repacking.
+ */
+class TRAJECTORYDATA_API FTrajectorySampleArena
+{
+public:
+	FTrajectorySampleArena()
+		: SampleRate(1)
+	{
+	}
+
+	/** Number of trajectories in the arena */
+	int32 Num() const { return TrajectoryIds.Num(); }
+
+	/** Total number of samples across all trajectories */
+	int32 GetTotalSampleCount() const { return Positions.Num(); }
+
+	/** Largest sample count of a single trajectory */
+	int32 GetMaxSampleCount() const;
+
+	/** Samples of a single trajectory */
+	TConstArrayView<FVector3f> GetSamples(int32 TrajectoryIndex) const
+	{
+		return TConstArrayView<FVector3f>(Positions.GetData() + SampleOffsets[TrajectoryIndex], SampleCounts[TrajectoryIndex]);
+	}
+
+	/** View of a single trajectory */
+	FLoadedTrajectoryView GetTrajectoryView(int32 TrajectoryIndex) const;
+
+	/** Time step of a sample (sample index relative to the trajectory) */
+	int32 GetSampleTimeStep(int32 TrajectoryIndex, int32 SampleIndex) const
+	{
+		return FirstSampleTimeSteps[TrajectoryIndex] + SampleIndex * SampleRate;
+	}
+
+	/**
+	 * Reserve the per-trajectory columns
+	 * @param NumTrajectories Number of trajectories that will be added
+	 */
+	void ReserveTrajectories(int32 NumTrajectories);
+
+	/**
+	 * Append a trajectory slot; samples are allocated later by AllocatePositions()
+	 * @return Index of the new trajectory
+	 */
+	int32 AddTrajectory(int64 TrajectoryId, int32 StartTimeStep, int32 EndTimeStep, const FVector3f& Extent,
+		int32 FirstSampleTimeStep, int32 SampleCount);
+
+	/**
+	 * Compute sample offsets and allocate the position arena for all added trajectories
+	 * All samples are initialized to NaN (missing) so workers only need to write the samples they load.
+	 */
+	void AllocatePositions();
+
+	/** Approximate memory used by the arena in bytes */
+	int64 GetAllocatedSize() const;
+
+	/** Trajectory IDs */
+	TArray<int64> TrajectoryIds;
+
+	/** Start time step of each trajectory (from metadata) */
+	TArray<int32> StartTimeSteps;
+
+	/** End time step of each trajectory (from metadata) */
+	TArray<int32> EndTimeSteps;
+
+	/** Time step of the first sample of each trajectory */
+	TArray<int32> FirstSampleTimeSteps;
+
+	/** Object half-extent of each trajectory in meters */
+	TArray<FVector3f> Extents;
+
+	/** Index of each trajectory's first sample in Positions */
+	TArray<int32> SampleOffsets;
+
+	/** Number of samples of each trajectory */
+	TArray<int32> SampleCounts;
+
+	/** All position samples, trajectory after trajectory */
+	FTrajectoryPositionArena Positions;
+
+	/** Time steps between two consecutive samples */
+	int32 SampleRate;
+};
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrajectoryDataStructures.h"
+
+/**
+ * Shard format versions understood by the loader
+ */
+namespace TrajectoryShardFormat
+{
+	/** Fixed-size entries with float32 positions for every slot of the interval */
+	constexpr uint8 Uncompressed = 1;
+
+	/** Variable-size entries with bbox-relative uint16 quantization and delta coding, located through an entry offset table */
+	constexpr uint8 Compressed = 2;
+
+	/** dataset-meta.bin float_precision value for quantized positions */
+	constexpr uint8 FloatPrecisionQuantized16 = 2;
+}
+
+/**
+ * Mapping between quantized uint16 coordinates and positions (format version 2)
+ * position = Origin + quantized * Scale, per axis; Origin/Scale are derived from the dataset bounding box.
+ */
+struct TRAJECTORYDATA_API FTrajectoryQuantization
+{
+	FVector3f Origin;
+	FVector3f Scale;
+
+	FTrajectoryQuantization()
+		: Origin(FVector3f::ZeroVector)
+		, Scale(FVector3f::ZeroVector)
+	{
+	}
+
+	/** Quantization covering the bounding box of a dataset (bbox_min maps to 0, bbox_max to 65535) */
+	static FTrajectoryQuantization FromDatasetMeta(const FDatasetMetaBinary& DatasetMeta);
+
+	/** Quantize a position (clamped to the bounding box) */
+	void Quantize(const FPositionSampleBinary& Position, uint16 OutQuantized[3]) const;
+};
+
+/**
+ * Reusable buffers for decoding compressed entries
+ * C++ Only: Keep one per worker (not thread-safe) so decoding doesn't allocate per entry.
+ */
+struct FTrajectoryDecodeScratch
+{
+	TArray<uint16> Quantized;
+	TArray<FPositionSampleBinary> Positions;
+};
+
+/**
+ * Encoder/decoder for compressed shard entries (format version 2)
+ * C++ Only: See specification-trajectory-data-shard.md for the byte layout.
+ *
+ * Entry layout (packed, little-endian):
+ *   offset 0:  uint64 trajectory_id
+ *   offset 8:  int32 start_time_step_in_interval (-1 if none valid)
+ *   offset 12: int32 valid_sample_count (slots covered, starting at start_time_step_in_interval)
+ *   offset 16: uint8 delta_bytes (1 = int8 deltas, 2 = int16 deltas)
+ *   offset 17: uint8 reserved[3]
+ *   offset 20: uint32 present_count (non-NaN samples within the covered slots)
+ *   offset 24: presence bitmask, ceil(valid_sample_count / 8) bytes, LSB first
+ *   then:      uint16 first[3] (quantized first present sample)
+ *   then:      (present_count - 1) x 3 signed deltas of delta_bytes each (modulo 65536)
+ */
+class TRAJECTORYDATA_API FTrajectoryShardCodec
+{
+public:
+	/** Size of the fixed part of a compressed entry */
+	static constexpr int32 CompressedEntryHeaderSize = 24;
+
+	/**
+	 * Decode the samples of a compressed entry
+	 * Writes OutSlots[start_time_step_in_interval .. start_time_step_in_interval + valid_sample_count);
+	 * slots without a sample are set to NaN, slots outside that range are not touched.
+	 * @param EntryData Complete entry (as returned by FTrajectoryShardReader::GetEntryData)
+	 * @param TimeStepIntervalSize Number of slots in OutSlots
+	 * @return False if the entry is malformed (OutSlots content is then undefined)
+	 */
+	static bool DecodeEntry(TConstArrayView<uint8> EntryData, int32 TimeStepIntervalSize, const FTrajectoryQuantization& Quantization,
+		FPositionSampleBinary* OutSlots, FTrajectoryDecodeScratch& Scratch);
+
+	/**
+	 * Encode one trajectory's interval as a compressed entry
+	 * @param Slots Positions of all TimeStepIntervalSize slots (NaN for missing samples)
+	 * @param OutEntry Receives the encoded entry (existing content is discarded)
+	 */
+	static void EncodeEntry(uint64 TrajectoryId, int32 StartTimeStepInInterval, int32 ValidSampleCount,
+		const FPositionSampleBinary* Slots, const FTrajectoryQuantization& Quantization, TArray<uint8>& OutEntry);
+
+	/**
+	 * Convert quantized coordinates to positions (4 samples per SIMD iteration)
+	 * @param Quantized NumSamples x 3 interleaved coordinates
+	 */
+	static void DequantizePositions(const uint16* Quantized, int32 NumSamples, const FTrajectoryQuantization& Quantization,
+		FPositionSampleBinary* OutPositions);
+};
@@ -0,0 +1,103 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrajectoryDataStructures.h"
+
+/**
+ * Cached mapping from trajectory ID to entry index for a single shard file
+ * C++ Only: Built once by scanning the entry IDs of a shard and reused by later loads
+ * as long as the shard file on disk has not changed (same size and modification time).
+ */
+struct TRAJECTORYDATA_API FShardEntryIndex
+{
+	/** Trajectory ID -> entry index within the shard */
+	TMap<int64, int32> EntryIndexById;
+
+	/** Modification time of the shard file when the index was built */
+	FDateTime FileTimeStamp;
+
+	/** Size of the shard file when the index was built */
+	int64 FileSize;
+
+	FShardEntryIndex()
+		: FileTimeStamp(FDateTime::MinValue())
+		, FileSize(0)
+	{
+	}
+
+	/** Approximate memory used by this index in bytes */
+	int64 GetAllocatedSize() const
+	{
+		return sizeof(FShardEntryIndex) + EntryIndexById.GetAllocatedSize();
+	}
+};
+
+/**
+ * Read-only view over the entries of a memory-mapped shard file
+ * C++ Only: Does not own the mapped memory; the caller keeps the mapping alive.
+ *
+ * Format version 1: every entry has the same size, so the entry for index i starts at
+ *   file_offset = data_section_offset + (i * entry_size_bytes)
+ * Format version 2: entries have variable size and a table of (entry_count + 1) uint64 file offsets
+ * at data_section_offset locates them; entry i occupies [offsets[i], offsets[i + 1]).
+ * Both allow resolving a trajectory with a single seek instead of scanning all entry IDs,
+ * which only touches the pages that actually hold requested data.
+ */
+class TRAJECTORYDATA_API FTrajectoryShardReader
+{
+public:
+	FTrajectoryShardReader(const uint8* InMappedData, int64 InMappedSize, const FDataBlockHeaderBinary& InHeader, int32 InEntrySizeBytes);
+
+	/** Whether the header and entry size describe a layout that fits into the mapped region */
+	bool IsValid() const { return bIsValid; }
+
+	/** Number of entries that are fully contained in the mapped region */
+	int32 GetEntryCount() const { return EntryCount; }
+
+	/** Size of each entry in bytes (0 for compressed shards, whose entries vary in size) */
+	int32 GetEntrySize() const { return bIsCompressed ? 0 : EntrySizeBytes; }
+
+	/** Whether entries use the compressed format version 2 layout (decode with FTrajectoryShardCodec) */
+	bool IsCompressed() const { return bIsCompressed; }
+
+	/** Get pointer to the start of an entry, or nullptr if the index is out of range */
+	const uint8* GetEntryPtr(int64 EntryIdx) const;
+
+	/** Get the complete bytes of an entry, or an empty view if the index (or its offset table record) is invalid */
+	TConstArrayView<uint8> GetEntryData(int64 EntryIdx) const;
+
+	/** Read the trajectory ID stored at the start of an entry */
+	bool ReadEntryTrajectoryId(int64 EntryIdx, uint64& OutTrajectoryId) const;
+
+	/**
+	 * Resolve an entry by direct seek using an index hint (e.g. EntryOffsetIndex from trajectory metadata)
+	 * The hint is only trusted if the entry at that position carries the requested trajectory ID.
+	 * @return Entry index, or INDEX_NONE if the hint does not match
+	 */
+	int32 FindEntryBySeekHint(uint64 TrajectoryId, uint64 HintEntryIdx) const;
+
+	/**
+	 * Resolve an entry by binary search over the entry IDs
+	 * Only touches O(log N) entries. Valid for shards whose entries are sorted by trajectory ID
+	 * (the converter writes them in Trajectory-Meta order); a miss does not prove absence for unsorted shards.
+	 * @return Entry index, or INDEX_NONE if not found
+	 */
+	int32 FindEntryByBinarySearch(uint64 TrajectoryId) const;
+
+	/**
+	 * Build a complete ID -> entry index by scanning all entry IDs (touches every entry once)
+	 * @param OutIndex Index to fill (existing content is discarded)
+	 */
+	void BuildEntryIndex(FShardEntryIndex& OutIndex) const;
+
+private:
+	const uint8* MappedData;
+	int64 MappedSize;
+	int64 DataSectionOffset;
+	int32 EntrySizeBytes;
+	int32 EntryCount;
+	bool bIsCompressed;
+	bool bIsValid;
+};
@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TrajectoryDatasetHandle.h"
+
+struct FConvexVolume;
+
+/**
+ * Spatial index over the trajectories of a dataset
+ * C++ Only: Holds the bounding box of every (trajectory, shard interval) pair, organized as one bounding
+ * volume hierarchy per interval. Region queries touch only the intervals overlapping the requested time range
+ * and never read position samples. Results are candidates: a trajectory is returned if its samples within an
+ * overlapping interval have a bounding box intersecting the region.
+ *
+ * Built by UTrajectoryDataLoader::GetSpatialIndex() and stored next to the shards as dataset-spatial-index.bin.
+ * Immutable once built; queries are thread-safe.
+ */
+class TRAJECTORYDATA_API FTrajectorySpatialIndex
+{
+public:
+	/** Maximum number of boxes in a leaf node */
+	static constexpr int32 MaxLeafSize = 8;
+
+	/** BVH node; children of an inner node are stored next to each other */
+	struct FNode
+	{
+		FVector3f Min;
+		FVector3f Max;
+
+		/** Leaf: first box; inner node: index of the first child */
+		int32 FirstIndex;
+
+		/** Leaf: number of boxes; inner node: 0 */
+		int32 Count;
+	};
+
+	/** Boxes and hierarchy of one shard interval */
+	struct FInterval
+	{
+		int32 ShardIndex = INDEX_NONE;
+		int32 StartTimeStep = 0;
+		int32 EndTimeStep = 0;
+
+		/** Box i belongs to TrajectoryIds[i] (reordered by the BVH build) */
+		TArray<uint64> TrajectoryIds;
+		TArray<FBox3f> Bounds;
+
+		/** Nodes[0] is the root (empty if the interval has no boxes) */
+		TArray<FNode> Nodes;
+	};
+
+	/**
+	 * Add the boxes of one shard interval and build its hierarchy
+	 * @param TrajectoryIds Trajectory of each box
+	 * @param Bounds Bounding box of the trajectory's samples within the interval
+	 */
+	void AddInterval(int32 ShardIndex, int32 StartTimeStep, int32 EndTimeStep, TArray<uint64>&& TrajectoryIds, TArray<FBox3f>&& Bounds);
+
+	/** Sort intervals by time (call once after all intervals were added) */
+	void Finalize();
+
+	/**
+	 * Trajectories with samples inside an axis-aligned box
+	 * @param StartTimeStep First time step of interest (inclusive)
+	 * @param EndTimeStep Last time step of interest (inclusive)
+	 * @param OutTrajectoryIds Sorted candidate IDs without duplicates (existing content is discarded)
+	 */
+	void QueryBox(const FBox3f& Box, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const;
+
+	/** Trajectories with samples inside a sphere (see QueryBox) */
+	void QuerySphere(const FVector3f& Center, float Radius, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const;
+
+	/** Trajectories with samples inside a convex volume such as a view frustum (see QueryBox) */
+	void QueryFrustum(const FConvexVolume& Frustum, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const;
+
+	/** Trajectories with samples inside a box or sphere region (see QueryBox) */
+	void QueryRegion(const FTrajectorySpatialRegion& Region, int32 StartTimeStep, int32 EndTimeStep, TArray<int64>& OutTrajectoryIds) const;
+
+	/**
+	 * Write the index to a file
+	 * @param SourceStamps Stamps of the files the index was built from (checked by Load)
+	 */
+	bool Save(const FString& FilePath, const TMap<FString, FTrajectoryFileStamp>& SourceStamps) const;
+
+	/**
+	 * Read an index written by Save
+	 * @param SourceStamps Current stamps of the source files; the file is rejected if any of them changed
+	 * @return False if the file is missing, malformed or stale
+	 */
+	bool Load(const FString& FilePath, const TMap<FString, FTrajectoryFileStamp>& SourceStamps);
+
+	const TArray<FInterval>& GetIntervals() const { return Intervals; }
+
+	/** Total number of (trajectory, interval) boxes */
+	int64 GetNumBoxes() const;
+
+	/** Approximate memory held by the index */
+	int64 GetAllocatedSize() const;
+
+private:
+	/**
+	 * Collect the trajectories of all boxes accepted by an overlap test in intervals overlapping a time range
+	 * @param Overlaps Returns true if a box may intersect the region (used for both nodes and boxes)
+	 */
+	void Query(int32 StartTimeStep, int32 EndTimeStep, TFunctionRef<bool(const FVector3f&, const FVector3f&)> Overlaps,
+		TArray<int64>& OutTrajectoryIds) const;
+
+	/** Build the BVH of an interval (reorders its boxes) */
+	static void BuildHierarchy(FInterval& Interval);
+
+	TArray<FInterval> Intervals;
+};
@@ -0,0 +1,176 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "TrajectoryDataStructures.h"
+#include "TrajectoryDataTypes.h"
+#include "TrajectoryDatasetHandle.h"
+
+class UTrajectoryDataLoader;
+
+/**
+ * Samples of one shard interval loaded by a streaming session
+ * C++ Only: Trajectory index i refers to the same trajectory in every interval of a session.
+ */
+struct FTrajectoryStreamedInterval
+{
+	/** Shard file index the interval was loaded from */
+	int32 ShardIndex;
+
+	/** First and last loaded time step (shard interval clipped to the playback range) */
+	int32 StartTimeStep;
+	int32 EndTimeStep;
+
+	/** Loaded samples (FirstSampleTimeSteps are global time steps) */
+	TSharedPtr<const FTrajectorySampleArena> SampleArena;
+
+	/** Memory used by the interval's samples in bytes */
+	int64 MemoryUsedBytes;
+
+	FTrajectoryStreamedInterval()
+		: ShardIndex(INDEX_NONE)
+		, StartTimeStep(0)
+		, EndTimeStep(0)
+		, MemoryUsedBytes(0)
+	{
+	}
+
+	bool ContainsTimeStep(int32 TimeStep) const
+	{
+		return TimeStep >= StartTimeStep && TimeStep <= EndTimeStep;
+	}
+};
+
+/**
+ * Sliding window of resident shard intervals around a playback cursor
+ * C++ Only: Created by UTrajectoryDataLoader::StartStreaming and driven from the game thread through
+ * UpdateCursor(). Intervals ahead of the cursor are loaded in the background (further ahead the faster
+ * the playback), intervals behind it are evicted, so memory stays bounded by the window instead of the
+ * dataset length.
+ *
+ * All methods must be called from the game thread; background loads only hand their results back
+ * through futures that are collected by UpdateCursor().
+ *
+ * A SpatialRegion selection is resolved once over the whole playback range (in the background, since it may build
+ * the spatial index) and every interval then loads that list as an ExplicitList selection, so trajectory index i
+ * is the same trajectory in every interval. No interval is loaded before the selection is resolved.
+ */
+class TRAJECTORYDATA_API FTrajectoryStreamingSession
+{
+public:
+	FTrajectoryStreamingSession(UTrajectoryDataLoader* InLoader, const FTrajectoryDatasetInfo& InDatasetInfo,
+		const FTrajectoryStreamingParams& InParams, const TSharedPtr<FTrajectoryDatasetHandle>& InDatasetHandle);
+
+	/** Waits for background loads still in flight */
+	~FTrajectoryStreamingSession();
+
+	/**
+	 * Move the playback cursor, collect finished loads, evict intervals outside the window and start prefetching
+	 * @param TimeStep Current playback position
+	 * @param PlaybackSpeed Time steps per second (negative for reverse playback, 0 keeps the last direction)
+	 */
+	void UpdateCursor(float TimeStep, float PlaybackSpeed);
+
+	/** Get the resident interval containing a time step, or nullptr if it is not loaded (yet) */
+	TSharedPtr<const FTrajectoryStreamedInterval> FindResidentInterval(int32 TimeStep) const;
+
+	/** Get all resident intervals (in no particular order) */
+	void GetResidentIntervals(TArray<TSharedPtr<const FTrajectoryStreamedInterval>>& OutIntervals) const
+	{
+		ResidentIntervals.GenerateValueArray(OutIntervals);
+	}
+
+	/** Check whether the samples of a time step are resident */
+	bool IsTimeStepResident(int32 TimeStep) const { return FindResidentInterval(TimeStep).IsValid(); }
+
+	/**
+	 * Position of a trajectory at a time step
+	 * @return False if the interval is not resident or the trajectory has no sample at this time step
+	 */
+	bool TryGetPosition(int32 TrajectoryIndex, int32 TimeStep, FVector3f& OutPosition) const;
+
+	/** Block until all background loads have finished and collect their results */
+	void FlushPendingLoads();
+
+	/** Playback range of the session (inclusive) */
+	int32 GetStartTimeStep() const { return StartTimeStep; }
+	int32 GetEndTimeStep() const { return EndTimeStep; }
+
+	/** Current playback cursor */
+	float GetCursor() const { return Cursor; }
+
+	/** Number of shard intervals overlapping the playback range */
+	int32 GetNumIntervals() const { return Intervals.Num(); }
+
+	int32 GetNumResidentIntervals() const { return ResidentIntervals.Num(); }
+	int32 GetNumPendingLoads() const { return PendingLoads.Num(); }
+
+	/** Memory used by all resident intervals in bytes */
+	int64 GetResidentMemoryBytes() const { return ResidentMemoryBytes; }
+
+	const FTrajectoryDatasetInfo& GetDatasetInfo() const { return DatasetInfo; }
+	const FTrajectoryStreamingParams& GetParams() const { return Params; }
+
+private:
+	/** Shard interval of the dataset that overlaps the playback range */
+	struct FStreamingInterval
+	{
+		int32 ShardIndex;
+		int32 StartTimeStep;
+		int32 EndTimeStep;
+	};
+
+	/**
+	 * Turn a finished background spatial selection into an explicit list in Params
+	 * @return False while the selection is still being resolved or if it matched no trajectories
+	 */
+	bool ResolveSelection();
+
+	/** Index into Intervals of the interval containing a time step (clamped to the playback range) */
+	int32 FindIntervalIndex(int32 TimeStep) const;
+
+	/** Move finished background loads into ResidentIntervals (results no longer wanted are dropped) */
+	void CollectFinishedLoads(bool bWait);
+
+	/** Start loading an interval in the background */
+	void StartIntervalLoad(int32 IntervalIdx);
+
+	/** Drop a resident interval and its shard mapping */
+	void EvictInterval(int32 IntervalIdx);
+
+	UTrajectoryDataLoader* Loader;
+	FTrajectoryDatasetInfo DatasetInfo;
+	FTrajectoryStreamingParams Params;
+
+	/** Keeps metadata and shard mappings of the dataset alive for the session */
+	TSharedPtr<FTrajectoryDatasetHandle> DatasetHandle;
+
+	/** Intervals overlapping the playback range, sorted by time */
+	TArray<FStreamingInterval> Intervals;
+
+	/** Interval index -> loaded samples */
+	TMap<int32, TSharedPtr<const FTrajectoryStreamedInterval>> ResidentIntervals;
+
+	/** Interval index -> background load */
+	TMap<int32, TFuture<TSharedPtr<const FTrajectoryStreamedInterval>>> PendingLoads;
+
+	/** Interval indices the current window wants resident */
+	TSet<int32> WantedIntervals;
+
+	/** SpatialRegion sessions: IDs of the trajectories in the region over the playback range, until ResolveSelection() */
+	TFuture<TArray<int64>> SelectionFuture;
+
+	/** The session's selection matched no trajectories, so there is nothing to stream */
+	bool bEmptySelection;
+
+	int32 StartTimeStep;
+	int32 EndTimeStep;
+	float Cursor;
+
+	/** +1 for forward playback, -1 for reverse */
+	int32 PlaybackDirection;
+
+	int64 ResidentMemoryBytes;
+};
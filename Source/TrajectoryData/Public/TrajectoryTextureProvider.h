@@ -8,6 +8,38 @@
 #include "TrajectoryDataStructures.h"
 #include "TrajectoryTextureProvider.generated.h"
 
+/**
+ * How positions are stored in the half-float texels of UTrajectoryTextureProvider
+ */
+UENUM(BlueprintType)
+enum class ETrajectoryTextureEncoding : uint8
+{
+	/** RGB: absolute position, A: absolute time step (precision drops with distance from the origin, time steps above 2048 are rounded) */
+	Absolute UMETA(DisplayName = "Absolute"),
+
+	/**
+	 * RGB: position relative to its tile, normalized to [-1, 1]: Position = TileOrigin + RGB * TileScale
+	 * A: unused (0). Time steps come from the per-trajectory side table: FirstSampleTimeStep + SampleIdx * TimeStepStride
+	 */
+	Relative UMETA(DisplayName = "Relative To Tile")
+};
+
+/**
+ * How trajectories are arranged in the texels of UTrajectoryTextureProvider
+ */
+UENUM(BlueprintType)
+enum class ETrajectoryTextureLayout : uint8
+{
+	/** One row per trajectory, MaxSamplesPerTrajectory wide, 1024 rows per slice (short trajectories and the last slice are padded) */
+	Slices UMETA(DisplayName = "Row Per Trajectory"),
+
+	/**
+	 * Trajectories back to back in one texel stream that wraps across rows and slices (AtlasWidth wide)
+	 * Trajectory i starts at texel TrajectoryStartTexels[i]; only the end of the last slice is padded
+	 */
+	PackedAtlas UMETA(DisplayName = "Packed Atlas")
+};
+
 /**
  * Metadata for trajectory texture array
  */
@@ -28,7 +60,7 @@ struct TRAJECTORYDATA_API FTrajectoryTextureMetadata
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 MaxSamplesPerTrajectory = 0;
 
-	/** Maximum trajectories per texture slice (1024 for standard GPUs) */
+	/** Maximum trajectories per texture slice (1024 for standard GPUs; Slices layout only) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 MaxTrajectoriesPerTexture = 1024;
 
@@ -51,6 +83,41 @@ struct TRAJECTORYDATA_API FTrajectoryTextureMetadata
 	/** Last time step in dataset */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	int32 LastTimeStep = 0;
+
+	/** Time steps between consecutive samples (the load's SampleRate) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TimeStepStride = 1;
+
+	/** Encoding of the texels */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	ETrajectoryTextureEncoding Encoding = ETrajectoryTextureEncoding::Absolute;
+
+	/** Relative encoding: samples per tile (consecutive samples of one trajectory sharing an origin and scale) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TileSamples = 0;
+
+	/** Relative encoding: tiles per trajectory; tile of sample j of trajectory i = i * TilesPerTrajectory + j / TileSamples */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TilesPerTrajectory = 0;
+
+	/** Arrangement of the texels */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	ETrajectoryTextureLayout Layout = ETrajectoryTextureLayout::Slices;
+
+	/** Texture size per slice (Slices layout: MaxSamplesPerTrajectory × MaxTrajectoriesPerTexture) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TextureWidth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int32 TextureHeight = 0;
+
+	/** Texel memory of the texture array in bytes */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int64 TextureMemoryBytes = 0;
+
+	/** Texel memory the Slices layout needs for the same dataset (compare with TextureMemoryBytes) */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	int64 SliceLayoutMemoryBytes = 0;
 	
 	/**
 	 * Invalid position marker value (NaN)
@@ -80,12 +147,26 @@ struct TRAJECTORYDATA_API FTrajectoryTextureMetadata
  *   - A: Time Step (Float16 encoding of integer time step value)
  * 
  * Float16 Encoding:
- * - Float32 values are automatically converted to Float16 by FFloat16 constructor
+ * - Float32 values are converted to Float16 with vectorized conversions (F16C where available), in parallel per row block
  * - Range: ±65504 (max representable value)
  * - Precision: ~3 decimal digits
  * - Special values: NaN preserved, infinity clamped to max
  * - Invalid positions marked with NaN in all RGB channels
  * 
+ * Packed Atlas Layout (Layout = PackedAtlas):
+ * - Samples of all trajectories form one texel stream, row-major across AtlasWidth-wide rows and then slices
+ * - Texel T is at slice T / (Width × Height), row (T / Width) % Height, column T % Width
+ * - Sample j of trajectory i is texel TrajectoryStartTexels[i] + j (j < TrajectorySampleCounts[i])
+ * - Slices hold up to AtlasMaxRowsPerSlice rows, balanced so only the end of the stream is padded
+ * 
+ * Relative Encoding (Encoding = Relative):
+ * - Each trajectory is cut into tiles of TileSamples samples; a tile stores its bounds center (origin) and half size (scale)
+ *   in a side table of 24 bytes per tile (GetTileOrigins(), GetTileScales())
+ * - Texels hold (Position - TileOrigin) / TileScale in [-1, 1], so the half-float error is bounded by TileScale / 2048
+ *   instead of growing with the absolute coordinate
+ * - The per-texel time step is dropped; GetFirstSampleTimeSteps() and TimeStepStride give every sample's time step
+ * - HLSL: Position = TileOrigins[Traj * TilesPerTrajectory + Sample / TileSamples] + Texel.rgb * TileScales[...]
+ * 
  * Invalid Position Handling:
  * - Texels where no trajectory data exists are set to NaN
  * - In HLSL, check with: isnan(Position.x) || isnan(Position.y) || isnan(Position.z)
@@ -138,6 +219,52 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
 	TArray<int32> GetTrajectoryIds() const { return TrajectoryIds; }
 
+	/** Relative encoding: origin of each tile (for a Niagara Position Array) */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	TArray<FVector3f> GetTileOrigins() const { return TileOrigins; }
+
+	/** Relative encoding: per-axis scale of each tile */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	TArray<FVector3f> GetTileScales() const { return TileScales; }
+
+	/** Relative encoding: time step of each trajectory's first sample */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	TArray<int32> GetFirstSampleTimeSteps() const { return FirstSampleTimeSteps; }
+
+	/** Packed atlas layout: first texel of each trajectory (for a Niagara Int Array) */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	TArray<int32> GetTrajectoryStartTexels() const { return TrajectoryStartTexels; }
+
+	/** Packed atlas layout: number of samples of each trajectory */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Trajectory Data")
+	TArray<int32> GetTrajectorySampleCounts() const { return TrajectorySampleCounts; }
+
+	/**
+	 * Log the texel memory of both layouts for a loaded dataset without creating a texture
+	 * Console: TrajectoryData.ReportTextureLayout [DatasetIndex] [AtlasWidth]
+	 */
+	static void ReportLayoutMemory(int32 DatasetIndex, int32 InAtlasWidth);
+
+	/** Texel arrangement used by the next UpdateFromDataset() */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data")
+	ETrajectoryTextureLayout Layout = ETrajectoryTextureLayout::Slices;
+
+	/** Packed atlas layout: texture width in texels */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data", meta = (ClampMin = "1", ClampMax = "16384", EditCondition = "Layout == ETrajectoryTextureLayout::PackedAtlas"))
+	int32 AtlasWidth = 2048;
+
+	/** Packed atlas layout: maximum rows per slice */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data", meta = (ClampMin = "1", ClampMax = "16384", EditCondition = "Layout == ETrajectoryTextureLayout::PackedAtlas"))
+	int32 AtlasMaxRowsPerSlice = 1024;
+
+	/** Texel encoding used by the next UpdateFromDataset() */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data")
+	ETrajectoryTextureEncoding Encoding = ETrajectoryTextureEncoding::Absolute;
+
+	/** Relative encoding: samples per tile (0: one tile per trajectory). Smaller tiles: more precision, larger side table */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trajectory Data", meta = (ClampMin = "0", EditCondition = "Encoding == ETrajectoryTextureEncoding::Relative"))
+	int32 RelativeTileSamples = 64;
+
 protected:
 	/** Position texture array (single texture with multiple slices) */
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
@@ -151,10 +278,59 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
 	TArray<int32> TrajectoryIds;
 
+	/** Relative encoding side table: origin and scale of each tile */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	TArray<FVector3f> TileOrigins;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	TArray<FVector3f> TileScales;
+
+	/** Relative encoding side table: time step of each trajectory's first sample */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	TArray<int32> FirstSampleTimeSteps;
+
+	/** Packed atlas lookup table: first texel and sample count of each trajectory */
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	TArray<int32> TrajectoryStartTexels;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Trajectory Data")
+	TArray<int32> TrajectorySampleCounts;
+
 private:
-	/** Pack trajectory data into texture buffers */
-	void PackTrajectories(const FLoadedDataset& Dataset, TArray<TArray<FFloat16Color>>& OutTextureDataArray);
+	/** Trajectories converted per parallel work item */
+	static constexpr int32 PackBlockSize = 64;
+
+	/**
+	 * Pack trajectory data straight into the texel memory of all slices (TextureWidth × TextureHeight × NumTextureSlices)
+	 * Runs in parallel over blocks of trajectories; samples are converted to half precision two texels (8 floats) at a time
+	 * and padding is filled with a NaN texel converted once
+	 * @param InStartTexels First texel of each trajectory (empty: Slices layout, trajectory i starts at row i)
+	 */
+	static void PackTrajectories(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+		TConstArrayView<int32> InStartTexels, FFloat16Color* OutTexels);
+
+	/**
+	 * Relative encoding: pack positions as offsets from their tile's origin, scaled by the tile's inverse scale
+	 * (same layouts and parallelization as PackTrajectories)
+	 */
+	static void PackTrajectoriesRelative(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+		TConstArrayView<int32> InStartTexels, TConstArrayView<FVector3f> InTileOrigins, TConstArrayView<FVector3f> InTileScales,
+		FFloat16Color* OutTexels);
+
+	/**
+	 * Packed atlas layout: assign each trajectory its first texel and size the texture
+	 * @return False if the dataset exceeds the texel count addressable with int32
+	 */
+	static bool BuildAtlasLayout(const FLoadedDataset& Dataset, int32 InAtlasWidth, int32 InMaxRowsPerSlice,
+		FTrajectoryTextureMetadata& InOutMetadata, TArray<int32>& OutStartTexels, TArray<int32>& OutSampleCounts);
+
+	/** Texel memory of the Slices layout for a dataset */
+	static int64 GetSliceLayoutBytes(int32 NumTrajectories, int32 MaxSamples);
+
+	/** Relative encoding: compute tile origins and scales from the bounds of each tile's valid samples */
+	static void BuildTileTable(const FLoadedDataset& Dataset, const FTrajectoryTextureMetadata& InMetadata,
+		TArray<FVector3f>& OutTileOrigins, TArray<FVector3f>& OutTileScales);
 	
-	/** Create or update texture array resource */
-	void UpdateTextureArrayResource(const TArray<TArray<FFloat16Color>>& TextureDataArray, int32 Width);
+	/** Create or update texture array resource, packing the dataset directly into the locked mip data */
+	bool UpdateTextureArrayResource(const FLoadedDataset& Dataset);
 };
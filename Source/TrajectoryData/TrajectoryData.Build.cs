@@ -32,7 +32,9 @@ public class TrajectoryData : ModuleRules
 				"JsonUtilities",
 				"RenderCore",      // For texture types
 				"RHI",             // For texture formats
-				"Niagara"          // For UNiagaraComponent binding
+				"Niagara",         // For UNiagaraComponent binding
+				"NiagaraCore",     // For the trajectory buffer data interface
+				"NiagaraShader"    // For data interface shader parameters
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);